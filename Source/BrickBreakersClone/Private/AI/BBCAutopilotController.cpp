@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/BBCAutopilotController.h"
+
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Ball/BBCTrajectorySubsystem.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Headless/BBCSimProfiler.h"
+
+/**
+ * @brief Constructor for the ABBCAutopilotController class.
+ *
+ * @note Stops within 4 units of the landing point and slows down within 40
+ */
+ABBCAutopilotController::ABBCAutopilotController(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer),
+	DeadZone(4.f),
+	SlowdownDistance(40.f)
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void ABBCAutopilotController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterAutopilot(this);
+	}
+}
+
+void ABBCAutopilotController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterAutopilot(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABBCAutopilotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	Paddle = Cast<ABBCPaddle>(InPawn);
+	if (Paddle == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Paddle is Invalid"));
+	}
+}
+
+void ABBCAutopilotController::OnUnPossess()
+{
+	Paddle = nullptr;
+
+	Super::OnUnPossess();
+}
+
+/**
+ * @brief Steers the paddle towards the predicted landing point.
+ *
+ * The axis falls off linearly inside SlowdownDistance so the paddle does not overshoot and oscillate around
+ * the target. Without a prediction the paddle is left still.
+ */
+void ABBCAutopilotController::UpdateInput()
+{
+	BBC_SIM_SCOPE("ABBCAutopilotController");
+	if (Paddle == nullptr)
+	{
+		return;
+	}
+
+	double LandingX = 0.0;
+	if (!PredictLanding(LandingX))
+	{
+		return;
+	}
+	const double Offset = LandingX - Paddle->GetActorLocation().X;
+	if (FMath::Abs(Offset) > DeadZone)
+	{
+		Paddle->AddMoveInput(static_cast<float>(FMath::Clamp(Offset / SlowdownDistance, -1.0, 1.0)));
+	}
+}
+
+/**
+ * @brief Picks the ball to play and looks up its predicted path.
+ *
+ * The nearest ball moving towards the paddle (+Y) wins; when every ball is moving away, the lowest moving
+ * ball is followed through its bounces instead so the paddle is already in place when it comes back.
+ *
+ * @param OutLandingX X of the ball centre when it reaches the paddle.
+ * @return true if a moving ball reaches the paddle within UBBCTrajectorySubsystem::MaxSegments segments.
+ *
+ * @note Paths come from UBBCTrajectorySubsystem's cache, so a frame where nothing deviated costs a lookup.
+ */
+bool ABBCAutopilotController::PredictLanding(double& OutLandingX) const
+{
+	const UBBCBallSubsystem* BallSubsystem = GetWorld()->GetSubsystem<UBBCBallSubsystem>();
+	UBBCTrajectorySubsystem* Trajectories = GetWorld()->GetSubsystem<UBBCTrajectorySubsystem>();
+	if (BallSubsystem == nullptr || Trajectories == nullptr)
+	{
+		return false;
+	}
+
+	FBBCBallState Best;
+	int32 BestHandle = INDEX_NONE;
+	bool bBestIncoming = false;
+	for (int32 Index = 0; Index < BallSubsystem->GetNumBalls(); ++Index)
+	{
+		FBBCBallState State;
+		const int32 Handle = BallSubsystem->GetBallHandle(Index);
+		if (!BallSubsystem->GetBallState(Handle, State) || State.Speed <= 0.0)
+		{
+			continue;
+		}
+		const bool bIncoming = State.Direction.Y > 0.0;
+		if (BestHandle == INDEX_NONE || (bIncoming && !bBestIncoming) || (bIncoming == bBestIncoming && State.Position.Y > Best.Position.Y))
+		{
+			Best = State;
+			BestHandle = Handle;
+			bBestIncoming = bIncoming;
+		}
+	}
+	if (BestHandle == INDEX_NONE)
+	{
+		return false;
+	}
+
+	++NumPredictions;
+	const FBBCTrajectory* Trajectory = Trajectories->GetTrajectory(BestHandle);
+	FVector2D Landing;
+	if (Trajectory == nullptr || !Trajectory->GetLanding(Landing))
+	{
+		return false;
+	}
+	OutLandingX = Landing.X;
+	return true;
+}
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Assets/BBCAssetSubsystem.h"
+
+#include "Engine/GameInstance.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "InputAction.h"
+#include "InputMappingContext.h"
+#include "Misc/CommandLine.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundBase.h"
+#include "Stats/BBCStats.h"
+#include "Tuning/BBCTuningAsset.h"
+
+namespace
+{
+	const TCHAR* GetBundleName(EBBCAssetBundle Bundle)
+	{
+		switch (Bundle)
+		{
+		case EBBCAssetBundle::Input: return TEXT("Input");
+		case EBBCAssetBundle::Gameplay: return TEXT("Gameplay");
+		case EBBCAssetBundle::Effects: return TEXT("Effects");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	FAutoConsoleCommandWithWorld AssetStatsCommand(
+		TEXT("BBC.Assets.Stats"),
+		TEXT("Logs when each asset bundle finished loading and how often gameplay reached a bundle before it was in."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(World))
+			{
+				Assets->LogStats();
+			}
+		}));
+
+#if BBC_TUNING_HOT_RELOAD
+	FAutoConsoleCommandWithWorld ReloadTuningCommand(
+		TEXT("BBC.Tuning.Reload"),
+		TEXT("Applies the tuning asset of the asset manifest again, then the -BBCTuning= overrides."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(World))
+			{
+				Assets->ApplyTuning();
+			}
+		}));
+#endif
+}
+
+UBBCAssetSubsystem* UBBCAssetSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+	return GameInstance != nullptr ? GameInstance->GetSubsystem<UBBCAssetSubsystem>() : nullptr;
+}
+
+/**
+ * @brief Requests every bundle of the manifest.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ *
+ * @note The game instance starts before the first map loads, so the bundles load alongside it.
+ */
+void UBBCAssetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RequestSeconds = FPlatformTime::Seconds();
+	for (int32 Bundle = 0; Bundle < static_cast<int32>(EBBCAssetBundle::Num); ++Bundle)
+	{
+		TArray<FSoftObjectPath> Assets;
+		GetBundleAssets(static_cast<EBBCAssetBundle>(Bundle), Assets);
+		if (Assets.Num() == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Asset bundle %s is empty"), GetBundleName(static_cast<EBBCAssetBundle>(Bundle)));
+			HandleBundleLoaded(static_cast<EBBCAssetBundle>(Bundle));
+			continue;
+		}
+		Bundles[Bundle].Handle = StreamableManager.RequestAsyncLoad(MoveTemp(Assets),
+			FStreamableDelegate::CreateUObject(this, &UBBCAssetSubsystem::HandleBundleLoaded, static_cast<EBBCAssetBundle>(Bundle)),
+			FStreamableManager::AsyncLoadHighPriority);
+	}
+}
+
+/**
+ * @brief Cancels the loads still in flight and releases the loaded bundles.
+ */
+void UBBCAssetSubsystem::Deinitialize()
+{
+	for (FBundleState& State : Bundles)
+	{
+		if (State.Handle.IsValid())
+		{
+			State.Handle->CancelHandle();
+		}
+		State = FBundleState();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UBBCAssetSubsystem::IsBundleLoaded(EBBCAssetBundle Bundle) const
+{
+	return Bundles[static_cast<int32>(Bundle)].bLoaded;
+}
+
+/**
+ * @brief Runs Callback once Bundle is loaded.
+ *
+ * @param Bundle Bundle the caller needs.
+ * @param Callback Called immediately if the bundle is in, otherwise from the streaming completion.
+ *
+ * @note A deferred callback is a load stall: gameplay got to the bundle before the loading phase finished it.
+ */
+void UBBCAssetSubsystem::WhenLoaded(EBBCAssetBundle Bundle, FSimpleDelegate Callback)
+{
+	FBundleState& State = Bundles[static_cast<int32>(Bundle)];
+	if (State.bLoaded)
+	{
+		Callback.ExecuteIfBound();
+		return;
+	}
+	++NumStalls;
+	SET_DWORD_STAT(STAT_BBC_AssetLoadStalls, NumStalls);
+	UE_LOG(LogTemp, Display, TEXT("Waiting for asset bundle %s, %.1f ms after the request"), GetBundleName(Bundle), (FPlatformTime::Seconds() - RequestSeconds) * 1000.0);
+	State.Callbacks.Add(MoveTemp(Callback));
+}
+
+void UBBCAssetSubsystem::LogStats() const
+{
+	for (int32 Bundle = 0; Bundle < static_cast<int32>(EBBCAssetBundle::Num); ++Bundle)
+	{
+		const FBundleState& State = Bundles[Bundle];
+		if (State.bLoaded)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Asset bundle %s: loaded in %.1f ms"), GetBundleName(static_cast<EBBCAssetBundle>(Bundle)), State.LoadedSeconds * 1000.0);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("Asset bundle %s: loading, %d callbacks waiting"), GetBundleName(static_cast<EBBCAssetBundle>(Bundle)), State.Callbacks.Num());
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("Asset load stalls: %d"), NumStalls);
+}
+
+/**
+ * @brief Makes the tuning asset's values the active tuning, then applies the -BBCTuning= overrides on top.
+ *
+ * Without a tuning asset, or before the Gameplay bundle is in, the overrides apply on top of the compile-time values.
+ */
+void UBBCAssetSubsystem::ApplyTuning() const
+{
+#if BBC_TUNING_HOT_RELOAD
+	const UBBCTuningAsset* Tuning = TuningAsset.Get();
+	BBCTuning::Apply(Tuning != nullptr ? Tuning->Values : BBCTuning::Defaults);
+	FString Overrides;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BBCTuning="), Overrides, false))
+	{
+		BBCTuning::ApplyOverrides(Overrides);
+	}
+#endif
+}
+
+void UBBCAssetSubsystem::GetBundleAssets(EBBCAssetBundle Bundle, TArray<FSoftObjectPath>& OutAssets) const
+{
+	const auto AddAsset = [&OutAssets](const FSoftObjectPath& Path)
+	{
+		if (!Path.IsNull())
+		{
+			OutAssets.Add(Path);
+		}
+	};
+
+	switch (Bundle)
+	{
+	case EBBCAssetBundle::Input:
+		AddAsset(PlayerMappingContext.ToSoftObjectPath());
+		AddAsset(StartAction.ToSoftObjectPath());
+		break;
+	case EBBCAssetBundle::Gameplay:
+		AddAsset(BallMesh.ToSoftObjectPath());
+		AddAsset(BrickMesh.ToSoftObjectPath());
+#if BBC_TUNING_HOT_RELOAD
+		AddAsset(TuningAsset.ToSoftObjectPath());
+#endif
+		break;
+	case EBBCAssetBundle::Effects:
+		AddAsset(BreakEffect.ToSoftObjectPath());
+		AddAsset(ReducedBreakEffect.ToSoftObjectPath());
+		AddAsset(BreakSound.ToSoftObjectPath());
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Marks a bundle as loaded and runs the callbacks waiting for it.
+ *
+ * The Gameplay bundle applies the tuning first, so the level starts with it.
+ *
+ * @param Bundle The bundle that finished loading.
+ */
+void UBBCAssetSubsystem::HandleBundleLoaded(EBBCAssetBundle Bundle)
+{
+	FBundleState& State = Bundles[static_cast<int32>(Bundle)];
+	State.bLoaded = true;
+	State.LoadedSeconds = FPlatformTime::Seconds() - RequestSeconds;
+	if (Bundle == EBBCAssetBundle::Gameplay)
+	{
+		SET_DWORD_STAT(STAT_BBC_AssetLoadMs, static_cast<uint32>(State.LoadedSeconds * 1000.0));
+		ApplyTuning();
+	}
+	UE_LOG(LogTemp, Display, TEXT("Asset bundle %s loaded in %.1f ms, %.3f s after process start"),
+		GetBundleName(Bundle), State.LoadedSeconds * 1000.0, FPlatformTime::Seconds() - GStartTime);
+
+	TArray<FSimpleDelegate> Callbacks = MoveTemp(State.Callbacks);
+	for (const FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
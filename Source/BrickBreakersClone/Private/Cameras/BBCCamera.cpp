@@ -6,6 +6,7 @@
 
 ABBCCamera::ABBCCamera() :
 FieldOfView(120.f),
+OrthoWidth(1000.f),
 SpawnLocation(0.f,0.f,500.f),
 SpawnRotation(-90.f,0.f,-90.f)
 {
@@ -15,4 +16,5 @@ SpawnRotation(-90.f,0.f,-90.f)
 	SetActorRelativeScale3D(FVector::OneVector);
 	BBCCameraComponent->ProjectionMode = ECameraProjectionMode::Orthographic;
 	BBCCameraComponent->SetFieldOfView(FieldOfView);
+	BBCCameraComponent->SetOrthoWidth(OrthoWidth);
 }
@@ -3,57 +3,49 @@
 
 #include "Core/Ball/BBCBall.h"
 
-#include "Core/Paddle/BBCPaddle.h"
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/StaticMeshComponent.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Tuning/BBCTuning.h"
 
 /**
  * @brief Constructor for the ABBCBall class, initializing a ball for a brick breaker game.
  *
- * Sets up the ball's physical properties, mesh, and initial state:
- * - Enables actor tick
- * - Creates a sphere mesh from the StarterContent
- * - Configures physics constraints to allow movement on X and Y axes
+ * Sets up the ball's mesh and initial state:
+ * - Disables actor tick, movement is owned by UBBCBallSubsystem
+ * - Creates the mesh component; the sphere mesh itself comes from the asset manifest in BeginPlay
+ * - Disables physics simulation and collision, bounces are resolved by swept tests in the subsystem
  * - Disables gravity and shadow casting
- * - Locks rotational movement
- * - Enables physics simulation and collision detection
  *
  * @param ObjectInitializer Reference to object initialization parameters
  *
- * @note Initializes ball with zero direction and velocity
+ * @note Initializes ball with no simulation handle; launch speed and scale come from BBCTuning
  * @note Calls ResetBall() to set initial positioning
  */
 ABBCBall::ABBCBall(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer),
-                                                                  Direction(0.f,0.f,0.f),
-                                                                  Velocity(0.f)
+                                                                  BallHandle(INDEX_NONE),
+                                                                  bReturnToPoolWhenLost(false)
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 	
-	SetActorEnableCollision(true);
-	
-	const ConstructorHelpers::FObjectFinder<UStaticMesh> BallRef(TEXT("StaticMesh'/Game/StarterContent/Shapes/Shape_Sphere.Shape_Sphere'"));
 	Mesh = ObjectInitializer.CreateDefaultSubobject<UStaticMeshComponent>(this, TEXT("BallMesh"));
-	Mesh->SetStaticMesh(BallRef.Object);
 	SetRootComponent(Mesh);
 	Mesh->SetEnableGravity(false);
-	Mesh->SetConstraintMode(EDOFMode::SixDOF);
-	Mesh->GetBodyInstance()->bLockXRotation = true;
-	Mesh->GetBodyInstance()->bLockYRotation = true;
-	Mesh->GetBodyInstance()->bLockZRotation = true;
-	Mesh->GetBodyInstance()->bLockXTranslation = false;
-	Mesh->GetBodyInstance()->bLockYTranslation = false;
-	Mesh->GetBodyInstance()->bLockZTranslation = true;
-	Mesh->SetNotifyRigidBodyCollision(true);
-	Mesh->SetLinearDamping( 0.0f );
-	Mesh->SetSimulatePhysics( true );
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	Mesh->SetCastShadow(false);
 	ResetBall();
 }
 
 /**
- * @brief Initializes the ball when the game starts or when the actor is spawned.
+ * @brief Registers the ball with the ball subsystem when the game starts or when the actor is spawned.
  *
- * This method is called automatically by the game engine when the ball is first created
- * or when the game begins. It calls the parent class's BeginPlay method and then
- * immediately resets the ball to its initial state using the ResetBall() method.
+ * Takes the ball mesh from the asset manifest unless a subclass set one. The game mode only spawns balls once
+ * the Gameplay bundle is in, so this does not wait; a ball placed in the map gets its mesh when the bundle
+ * arrives, and only then its radius, which is pushed to the subsystem at that point. Then resets the ball so
+ * the subsystem starts from the spawn position and the scaled mesh radius.
  *
  * @note Overrides the base class implementation to add custom initialization logic.
  */
@@ -61,107 +53,169 @@ void ABBCBall::BeginPlay()
 {
 	Super::BeginPlay();
 
+	UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	if(Mesh->GetStaticMesh() == nullptr && Assets != nullptr)
+	{
+		Assets->WhenLoaded(EBBCAssetBundle::Gameplay, FSimpleDelegate::CreateWeakLambda(this, [this, Assets]()
+		{
+			Mesh->SetStaticMesh(Assets->GetBallMesh());
+			if(UBBCBallSubsystem* LoadedBallSubsystem = GetBallSubsystem())
+			{
+				LoadedBallSubsystem->SetBallRadius(BallHandle, GetBallRadius());
+			}
+		}));
+	}
+
 	ResetBall();
+
+	UBBCBallSubsystem* BallSubsystem = GetBallSubsystem();
+	if(BallSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BallSubsystem is Invalid"));
+		return;
+	}
+	const FVector Location = GetActorLocation();
+	BallHandle = BallSubsystem->RegisterBall(this, FVector2D(Location.X, Location.Y), GetBallRadius());
 }
 
 /**
- * @brief Updates the ball's position every frame based on its current direction and velocity.
- *
- * This method is called automatically by the game engine for each frame. It moves the ball
- * by calculating a new translation based on the ball's direction, velocity, and the time
- * elapsed since the last frame (DeltaTime).
+ * @brief Removes the ball from the ball subsystem when it leaves play.
  *
- * @param DeltaTime The time elapsed since the last frame, used to calculate smooth movement.
- *
- * @note Calls the parent class's Tick method to ensure standard actor update behavior.
- * @note The ball's movement is frame-rate independent due to the use of DeltaTime.
+ * @param EndPlayReason Why the actor is leaving play.
  */
-void ABBCBall::Tick(float DeltaTime)
+void ABBCBall::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-	
-	FTransform Transform = GetActorTransform();
-	Transform.AddToTranslation(Direction * Velocity * DeltaTime);
-	SetActorTransform(Transform);
+	if(UBBCBallSubsystem* BallSubsystem = GetBallSubsystem())
+	{
+		BallSubsystem->UnregisterBall(BallHandle);
+	}
+	BallHandle = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
- * @brief Handles collision events for the ball, updating its direction and responding to specific collision types.
+ * @brief Puts a pooled ball back into the simulation where the pool placed it.
  *
- * This method is called when the ball collides with another component. It performs the following actions:
- * - Mirrors the ball's direction based on the collision normal
- * - Resets the ball if it hits an "UnSafeBound" component
- * - Adjusts the ball's horizontal direction if it collides with a paddle, incorporating the paddle's velocity
- *
- * @param MyComp The primitive component of this ball that was involved in the collision
- * @param Other The actor that was hit
- * @param OtherComp The primitive component of the other actor that was hit
- * @param bSelfMoved Indicates whether this actor moved during the collision
- * @param HitLocation The world space location of the collision
- * @param HitNormal The normal vector of the collision surface
- * @param NormalImpulse The impulse applied during the collision
- * @param Hit Detailed information about the collision
- *
- * @note If the collision is with a paddle, the ball's X direction is modified based on the paddle's velocity
- * @note The method returns early if the paddle cannot be cast correctly
+ * @note A ball spawned on a pool miss is already registered by BeginPlay and is only moved.
  */
-void ABBCBall::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved,
-	FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
+void ABBCBall::OnAcquiredFromPool()
 {
-	Direction = Direction.MirrorByVector(HitNormal).GetSafeNormal();
-	
-	if(OtherComp->ComponentHasTag("UnSafeBound"))
+	UBBCBallSubsystem* BallSubsystem = GetBallSubsystem();
+	if(BallSubsystem == nullptr)
 	{
-		ResetBall();
+		UE_LOG(LogTemp, Error, TEXT("BallSubsystem is Invalid"));
+		return;
 	}
-	
-	if (Other->ActorHasTag("Paddle"))
+	const FVector Location = GetActorLocation();
+	if(BallHandle == INDEX_NONE)
 	{
-		ABBCPaddle* Paddle = Cast<ABBCPaddle>(Other);
-		if(Paddle == nullptr)
-		{
-			return;
-		}
-		const float PaddleInfluence = FMath::Clamp(Paddle->GetPaddleVelocity() / Velocity,-0.75f, 0.75f);
-		Direction.X += PaddleInfluence;
-		Direction = Direction.GetSafeNormal();
+		BallHandle = BallSubsystem->RegisterBall(this, FVector2D(Location.X, Location.Y), GetBallRadius());
+		return;
+	}
+	BallSubsystem->ResetBall(BallHandle, FVector2D(Location.X, Location.Y));
+}
+
+/**
+ * @brief Takes a ball out of the simulation while it waits in the pool.
+ */
+void ABBCBall::OnReturnedToPool()
+{
+	if(UBBCBallSubsystem* BallSubsystem = GetBallSubsystem())
+	{
+		BallSubsystem->UnregisterBall(BallHandle);
 	}
+	BallHandle = INDEX_NONE;
+	bReturnToPoolWhenLost = false;
 }
 
 /**
  * @brief Initiates the ball's movement by setting its initial direction and velocity.
  *
  * Sets the ball's primary direction downward (negative Y-axis) and adds a random horizontal
- * component to create a more dynamic trajectory. The ball's velocity is set to a constant
- * speed of 300 units.
+ * component of up to BallLaunchSpreadX to create a more dynamic trajectory. The direction is
+ * handed to the ball subsystem together with the tuned launch speed.
  *
  * @note The random X-axis component ensures the ball does not always move straight down,
- * adding unpredictability to its initial path.
+ * adding unpredictability to its initial path. It is drawn from LaunchRandom, see SetLaunchSeed().
  */
 void ABBCBall::StartMoving()
 {
-	Direction = FVector( 0.f, -1.f, 0.f );
-	Direction.X = FMath::RandRange(-1.f,1.f);
-	Velocity = 300.0f;
+	const FBBCTuningValues& Tuning = BBCTuning::Get();
+	FVector2D Direction( 0.f, -1.f );
+	Direction.X = LaunchRandom.FRandRange(-Tuning.BallLaunchSpreadX,Tuning.BallLaunchSpreadX);
+
+	if(UBBCBallSubsystem* BallSubsystem = GetBallSubsystem())
+	{
+		BallSubsystem->LaunchBall(BallHandle, Direction, Tuning.BallLaunchSpeed);
+	}
 }
 
 /**
  * @brief Resets the ball to its initial state and position.
  *
  * This method performs the following actions:
- * - Sets the ball's location to a predefined fixed point (0, 370, 0)
- * - Scales the ball down to 30% of its original size
- * - Clears the ball's current direction
- * - Resets the ball's velocity to zero
+ * - Sets the ball's location to the ball spawn of the playfield layout, (0, 370, 0) for the class default object
+ * - Scales the ball to the tuned ball scale, 30% of its original size by default
+ * - Stops the ball in the ball subsystem, once it has been registered
  *
  * @note Typically used to return the ball to its starting configuration, such as after losing a life or at the beginning of a game.
  */
 void ABBCBall::ResetBall()
 {
-	SetActorLocation(FVector(0.f,370.f,0.f));
-	SetActorScale3D(FVector(0.3f,0.3f,0.3f));
-	Direction = FVector::Zero();
-	Velocity = 0.f;
+	const FVector2D Spawn = UBBCPlayfieldSubsystem::GetLayout(this).BallSpawn;
+	SetActorLocation(FVector(Spawn.X,Spawn.Y,0.f));
+	SetActorScale3D(FVector(BBCTuning::Get().BallScale));
+
+	if(BallHandle == INDEX_NONE)
+	{
+		return;
+	}
+	if(UBBCBallSubsystem* BallSubsystem = GetBallSubsystem())
+	{
+		BallSubsystem->ResetBall(BallHandle, Spawn);
+	}
+}
+
+void ABBCBall::SetLaunchSeed(int32 Seed)
+{
+	LaunchRandom.Initialize(Seed);
 }
 
+/**
+ * @brief Tells whether the ball has been launched and not reset since.
+ *
+ * @return true if the ball subsystem is moving this ball.
+ */
+bool ABBCBall::IsMoving() const
+{
+	const UBBCBallSubsystem* BallSubsystem = GetBallSubsystem();
+	FBBCBallState State;
+	return BallSubsystem != nullptr && BallSubsystem->GetBallState(BallHandle, State) && State.Speed > 0.0;
+}
 
+/**
+ * @brief Returns the collision radius used by the ball subsystem.
+ *
+ * @return Half the scaled mesh extent, which is the sphere radius for the StarterContent sphere, or 0 while
+ * the mesh is not loaded yet. BeginPlay pushes the radius again once it is.
+ */
+float ABBCBall::GetBallRadius() const
+{
+	if(Mesh == nullptr || Mesh->GetStaticMesh() == nullptr)
+	{
+		return 0.f;
+	}
+	return Mesh->GetStaticMesh()->GetBounds().BoxExtent.X * GetActorScale3D().X;
+}
+
+UStaticMesh* ABBCBall::GetBallMesh() const
+{
+	return Mesh != nullptr ? Mesh->GetStaticMesh() : nullptr;
+}
+
+UBBCBallSubsystem* ABBCBall::GetBallSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<UBBCBallSubsystem>() : nullptr;
+}
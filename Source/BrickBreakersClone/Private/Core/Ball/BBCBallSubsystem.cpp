@@ -0,0 +1,1198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Ball/BBCBallSubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "EngineUtils.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Core/Ball/BBCBall.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Core/Pool/BBCActorPoolSubsystem.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Headless/BBCSimProfiler.h"
+#include "Stats/BBCStats.h"
+#include "Tuning/BBCTuning.h"
+
+namespace
+{
+	/** Distance the ball is pushed off a surface after a bounce so the next sweep does not start in contact. */
+	constexpr double ContactOffset = 0.01;
+
+	/**
+	 * @brief Spawns instanced balls at the ball spawn point with seeded random directions.
+	 *
+	 * Usage: BBC.Balls.Spawn <Count> [Seed]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs SpawnBallsCommand(
+		TEXT("BBC.Balls.Spawn"),
+		TEXT("Spawns <Count> instanced balls moving in seeded random directions. Usage: BBC.Balls.Spawn <Count> [Seed]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCBallSubsystem* BallSubsystem = World != nullptr ? World->GetSubsystem<UBBCBallSubsystem>() : nullptr;
+			if (BallSubsystem == nullptr || Args.Num() < 1)
+			{
+				return;
+			}
+			const int32 Count = FCString::Atoi(*Args[0]);
+			FRandomStream Stream(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const FVector2D Direction(Stream.FRandRange(-1.0, 1.0), -1.0);
+				BallSubsystem->SpawnBall(UBBCPlayfieldSubsystem::GetLayout(World).BallSpawn, Direction, BBCTuning::Get().SpawnedBallSpeed, BBCTuning::Get().SpawnedBallRadius);
+			}
+		}));
+
+	/**
+	 * @brief Takes actor balls from the actor pool and launches them with seeded random directions.
+	 *
+	 * Usage: BBC.Balls.SpawnActors <Count> [Seed]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs SpawnActorBallsCommand(
+		TEXT("BBC.Balls.SpawnActors"),
+		TEXT("Launches <Count> pooled actor balls that return to the pool when lost. Usage: BBC.Balls.SpawnActors <Count> [Seed]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCActorPoolSubsystem* Pool = World != nullptr ? World->GetSubsystem<UBBCActorPoolSubsystem>() : nullptr;
+			if (Pool == nullptr || Args.Num() < 1)
+			{
+				return;
+			}
+			const int32 Count = FCString::Atoi(*Args[0]);
+			FRandomStream Stream(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+			const FVector2D Spawn = UBBCPlayfieldSubsystem::GetLayout(World).BallSpawn;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				if (ABBCBall* Ball = Pool->Acquire<ABBCBall>(FVector(Spawn.X, Spawn.Y, 0.0)))
+				{
+					Ball->SetReturnToPoolWhenLost(true);
+					Ball->SetLaunchSeed(Stream.GetUnsignedInt());
+					Ball->StartMoving();
+				}
+			}
+		}));
+
+	FAutoConsoleCommandWithWorld ClearBallsCommand(
+		TEXT("BBC.Balls.Clear"),
+		TEXT("Removes every instanced ball."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UBBCBallSubsystem* BallSubsystem = World != nullptr ? World->GetSubsystem<UBBCBallSubsystem>() : nullptr)
+			{
+				BallSubsystem->ClearSpawnedBalls();
+			}
+		}));
+
+	FAutoConsoleCommandWithWorld BallStatsCommand(
+		TEXT("BBC.Balls.Stats"),
+		TEXT("Logs the ball count and the cost of the last frame's simulation and render sync."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UBBCBallSubsystem* BallSubsystem = World != nullptr ? World->GetSubsystem<UBBCBallSubsystem>() : nullptr;
+			if (BallSubsystem == nullptr)
+			{
+				return;
+			}
+			const int32 NumBalls = BallSubsystem->GetNumBalls();
+			const double SimulationMs = BallSubsystem->GetLastSimulationSeconds() * 1000.0;
+			const double RenderSyncMs = BallSubsystem->GetLastRenderSyncSeconds() * 1000.0;
+			UE_LOG(LogTemp, Display, TEXT("Balls: %d, Simulation: %.3f ms, Render sync: %.3f ms, Per ball: %.3f us"),
+				NumBalls, SimulationMs, RenderSyncMs, NumBalls > 0 ? (SimulationMs + RenderSyncMs) * 1000.0 / NumBalls : 0.0);
+		}));
+}
+
+int32 FBBCBallBuffers::Add(int32 Handle, ABBCBall* Actor, const FVector2D& Position, const FVector2D& Direction, double Speed, double Radius)
+{
+	Positions.Add(Position);
+	Directions.Add(Direction);
+	Speeds.Add(Speed);
+	Radii.Add(Radius);
+	Handles.Add(Handle);
+	return Actors.Add(Actor);
+}
+
+void FBBCBallBuffers::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Directions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Speeds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Radii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Handles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+/**
+ * @brief Runs Advance first in the Balls phase of UBBCTickManagerSubsystem.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ */
+void UBBCBallSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Balls, EBBCTickOrder::BeforeActors, FBBCTickUpdate::CreateUObject(this, &UBBCBallSubsystem::Advance));
+	}
+}
+
+/**
+ * @brief Collects the static colliders placed in the level once play begins, and adds the playfield bounds.
+ *
+ * @param InWorld The world that just started play.
+ *
+ * @note Runs before ABBCGameMode::StartPlay, so the ball and paddle spawned there are not picked up here. The
+ * bounds start from the default layout and move when the game mode lays the playfield out.
+ */
+void UBBCBallSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	GameEvents = InWorld.GetSubsystem<UBBCGameEventSubsystem>();
+	GatherLevelColliders(InWorld);
+	ApplyPlayfieldLayout();
+	if (GameEvents != nullptr)
+	{
+		GameEvents->OnPlayfieldChanged().AddUObject(this, &UBBCBallSubsystem::HandlePlayfieldChanged);
+	}
+}
+
+void UBBCBallSubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	if (GameEvents != nullptr)
+	{
+		GameEvents->OnPlayfieldChanged().RemoveAll(this);
+	}
+	BallInstances = nullptr;
+	GameEvents = nullptr;
+
+	Super::Deinitialize();
+}
+
+/**
+ * @brief Accumulates frame time and advances the simulation in whole fixed steps.
+ *
+ * The number of steps only depends on the accumulated time, never on how that time was split into frames,
+ * so a trajectory is identical whether the game runs at 30, 60 or 240 Hz. Actor transforms and instances
+ * are written once after all steps of the frame have run.
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ *
+ * @note Steps are capped at MaxStepsPerFrame; time beyond the cap is dropped to avoid a spiral after a long hitch.
+ */
+void UBBCBallSubsystem::Advance(float DeltaTime)
+{
+	BBC_SIM_SCOPE("UBBCBallSubsystem");
+	BBC_SET_DWORD_STAT(STAT_BBC_ActiveBalls, Buffers.Num());
+
+	const int32 NumSteps = GetNumStepsFor(DeltaTime);
+	Accumulator += DeltaTime;
+	if (Accumulator >= (NumSteps + 1) * FixedStepSeconds)
+	{
+		Accumulator = NumSteps * FixedStepSeconds;
+	}
+	if (NumSteps == 0)
+	{
+		return;
+	}
+
+	const double SimulationStart = FPlatformTime::Seconds();
+	{
+		BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_BallMovement);
+		UpdatePaddleCollider(NumSteps);
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			BeginPaddleStep(Step);
+			StepFixed();
+			Accumulator -= FixedStepSeconds;
+		}
+	}
+	const double RenderSyncStart = FPlatformTime::Seconds();
+	{
+		BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_RenderSync);
+		SyncActors();
+		SyncInstances();
+	}
+	const double RenderSyncEnd = FPlatformTime::Seconds();
+
+	LastSimulationSeconds = RenderSyncStart - SimulationStart;
+	LastRenderSyncSeconds = RenderSyncEnd - RenderSyncStart;
+}
+
+/**
+ * @brief Predicts the step count of the next Advance, so the paddle can be integrated over the same steps.
+ *
+ * @param DeltaTime Time the next Advance will be given.
+ */
+int32 UBBCBallSubsystem::GetNumStepsFor(float DeltaTime) const
+{
+	return FMath::Min(FMath::FloorToInt32((Accumulator + DeltaTime) / FixedStepSeconds), MaxStepsPerFrame);
+}
+
+bool UBBCBallSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UBBCBallSubsystem::AllocateHandle(int32 DenseIndex)
+{
+	if (FreeHandles.Num() > 0)
+	{
+		const int32 BallHandle = FreeHandles.Pop(EAllowShrinking::No);
+		HandleToIndex[BallHandle] = DenseIndex;
+		return BallHandle;
+	}
+	return HandleToIndex.Add(DenseIndex);
+}
+
+/**
+ * @brief Adds a ball mirrored by an actor to the simulation.
+ *
+ * @param Ball Actor that mirrors the simulated position.
+ * @param Position Starting position on the gameplay plane.
+ * @param Radius Collision radius of the ball.
+ *
+ * @return Handle used for every later call about this ball.
+ */
+int32 UBBCBallSubsystem::RegisterBall(ABBCBall* Ball, const FVector2D& Position, double Radius)
+{
+	const int32 BallHandle = AllocateHandle(Buffers.Num());
+	Buffers.Add(BallHandle, Ball, Position, FVector2D::ZeroVector, 0.0, Radius);
+	++NumActorBalls;
+	return BallHandle;
+}
+
+/**
+ * @brief Adds a ball that has no actor and is drawn through the shared instanced mesh.
+ *
+ * @param Position Starting position on the gameplay plane.
+ * @param Direction Direction of travel, normalized here.
+ * @param Speed Speed in units per second.
+ * @param Radius Collision radius of the ball.
+ *
+ * @return Handle used for every later call about this ball.
+ *
+ * @note Instanced balls are removed when they reach the kill zone instead of being reset.
+ */
+int32 UBBCBallSubsystem::SpawnBall(const FVector2D& Position, const FVector2D& Direction, double Speed, double Radius)
+{
+	const int32 BallHandle = AllocateHandle(Buffers.Num());
+	Buffers.Add(BallHandle, nullptr, Position, Direction.GetSafeNormal(), Speed, Radius);
+	return BallHandle;
+}
+
+/**
+ * @brief Removes a ball from the simulation.
+ *
+ * The last ball in the buffers is swapped into the freed slot, so the handle of the moved ball is patched.
+ * Listeners are told the handle is gone, since the next ball registered may reuse it.
+ *
+ * @param BallHandle Handle returned by RegisterBall or SpawnBall.
+ */
+void UBBCBallSubsystem::UnregisterBall(int32 BallHandle)
+{
+	if (!HandleToIndex.IsValidIndex(BallHandle) || HandleToIndex[BallHandle] == INDEX_NONE)
+	{
+		return;
+	}
+
+	UnstickBall(BallHandle);
+	const int32 Index = HandleToIndex[BallHandle];
+	if (!Buffers.Actors[Index].IsExplicitlyNull())
+	{
+		--NumActorBalls;
+	}
+
+	const int32 LastIndex = Buffers.Num() - 1;
+	if (Index != LastIndex)
+	{
+		HandleToIndex[Buffers.Handles[LastIndex]] = Index;
+	}
+	Buffers.RemoveAtSwap(Index);
+	HandleToIndex[BallHandle] = INDEX_NONE;
+	FreeHandles.Add(BallHandle);
+
+	if (GameEvents != nullptr)
+	{
+		GameEvents->Publish(FBBCBallRemovedEvent{BallHandle});
+	}
+}
+
+void UBBCBallSubsystem::ClearSpawnedBalls()
+{
+	for (int32 Index = Buffers.Num() - 1; Index >= 0; --Index)
+	{
+		if (Buffers.Actors[Index].IsExplicitlyNull())
+		{
+			UnregisterBall(Buffers.Handles[Index]);
+		}
+	}
+	SyncInstances();
+}
+
+/**
+ * @brief Sets a ball in motion.
+ *
+ * @param BallHandle Handle returned by RegisterBall.
+ * @param Direction Direction of travel, normalized here.
+ * @param Speed Speed in units per second.
+ */
+void UBBCBallSubsystem::LaunchBall(int32 BallHandle, const FVector2D& Direction, double Speed)
+{
+	if (!HandleToIndex.IsValidIndex(BallHandle) || HandleToIndex[BallHandle] == INDEX_NONE)
+	{
+		return;
+	}
+	UnstickBall(BallHandle);
+	const int32 Index = HandleToIndex[BallHandle];
+	Buffers.Directions[Index] = Direction.GetSafeNormal();
+	Buffers.Speeds[Index] = Speed;
+}
+
+/**
+ * @brief Stops a ball and places it at the given position.
+ *
+ * @param BallHandle Handle returned by RegisterBall.
+ * @param Position New position on the gameplay plane.
+ */
+void UBBCBallSubsystem::ResetBall(int32 BallHandle, const FVector2D& Position)
+{
+	if (!HandleToIndex.IsValidIndex(BallHandle) || HandleToIndex[BallHandle] == INDEX_NONE)
+	{
+		return;
+	}
+	UnstickBall(BallHandle);
+	const int32 Index = HandleToIndex[BallHandle];
+	Buffers.Positions[Index] = Position;
+	Buffers.Directions[Index] = FVector2D::ZeroVector;
+	Buffers.Speeds[Index] = 0.0;
+}
+
+/**
+ * @brief Changes the collision radius of a ball from the next step on.
+ *
+ * @param BallHandle Handle returned by RegisterBall or SpawnBall.
+ * @param Radius New collision radius.
+ */
+void UBBCBallSubsystem::SetBallRadius(int32 BallHandle, double Radius)
+{
+	if (!HandleToIndex.IsValidIndex(BallHandle) || HandleToIndex[BallHandle] == INDEX_NONE)
+	{
+		return;
+	}
+	Buffers.Radii[HandleToIndex[BallHandle]] = FMath::Max(Radius, 0.0);
+}
+
+int32 UBBCBallSubsystem::AddCollider(const FBBCCollider& Collider)
+{
+	const int32 ColliderIndex = Colliders.Add(Collider);
+	ColliderHandles.Add(Collider.bEnabled ? Broadphase.Insert(Collider.Box, ColliderIndex) : INDEX_NONE);
+	return ColliderIndex;
+}
+
+/**
+ * @brief Moves a static collider, keeping the broadphase in step.
+ *
+ * @param ColliderIndex Index returned by AddCollider.
+ * @param Box The collider's new bounds.
+ */
+void UBBCBallSubsystem::SetColliderBox(int32 ColliderIndex, const FBox2D& Box)
+{
+	if (!Colliders.IsValidIndex(ColliderIndex))
+	{
+		return;
+	}
+	Colliders[ColliderIndex].Box = Box;
+	if (ColliderHandles[ColliderIndex] != INDEX_NONE)
+	{
+		Broadphase.Move(ColliderHandles[ColliderIndex], Box);
+	}
+}
+
+/**
+ * @brief Turns a collider on or off. Disabled colliders leave the broadphase, so they cost nothing to sweeps.
+ *
+ * @param ColliderIndex Index returned by AddCollider.
+ * @param bEnabled Whether balls should collide with it.
+ */
+void UBBCBallSubsystem::SetColliderEnabled(int32 ColliderIndex, bool bEnabled)
+{
+	if (!Colliders.IsValidIndex(ColliderIndex) || Colliders[ColliderIndex].bEnabled == bEnabled)
+	{
+		return;
+	}
+	Colliders[ColliderIndex].bEnabled = bEnabled;
+	if (bEnabled)
+	{
+		ColliderHandles[ColliderIndex] = Broadphase.Insert(Colliders[ColliderIndex].Box, ColliderIndex);
+	}
+	else
+	{
+		Broadphase.Remove(ColliderHandles[ColliderIndex]);
+		ColliderHandles[ColliderIndex] = INDEX_NONE;
+	}
+}
+
+/**
+ * @brief Sets the paddle whose mesh bounds are used as a moving collider.
+ *
+ * @param InPaddle The paddle possessed by the player.
+ */
+void UBBCBallSubsystem::SetPaddle(ABBCPaddle* InPaddle)
+{
+	Paddle = InPaddle;
+	if (InPaddle == nullptr)
+	{
+		return;
+	}
+
+	const FBox2D PaddleBox = BBCCollision::ToBox2D(InPaddle->GetPaddleBounds());
+	LastPaddleX = PaddleBox.GetCenter().X;
+	PaddleStepDelta = FVector2D::ZeroVector;
+	PaddleStepVelocity = 0.0;
+	PaddleStepDeltas.Reset();
+	PaddleStepVelocities.Reset();
+
+	FBBCCollider Collider;
+	Collider.Box = PaddleBox;
+	Collider.Type = EBBCColliderType::Paddle;
+	if (Colliders.IsValidIndex(PaddleColliderIndex))
+	{
+		Colliders[PaddleColliderIndex].Box = PaddleBox;
+		UpdatePaddleBroadphase();
+	}
+	else
+	{
+		PaddleColliderIndex = AddCollider(Collider);
+	}
+}
+
+/**
+ * @brief Sets the brick wall balls are swept against.
+ *
+ * @param InBrickField The level's brick field. Its grid answers ball queries by cell lookup.
+ */
+void UBBCBallSubsystem::SetBrickField(UBBCBrickFieldComponent* InBrickField)
+{
+	BrickField = InBrickField;
+}
+
+bool UBBCBallSubsystem::GetBallState(int32 BallHandle, FBBCBallState& OutState) const
+{
+	if (!HandleToIndex.IsValidIndex(BallHandle) || HandleToIndex[BallHandle] == INDEX_NONE)
+	{
+		return false;
+	}
+	const int32 Index = HandleToIndex[BallHandle];
+	OutState.Position = Buffers.Positions[Index];
+	OutState.Direction = Buffers.Directions[Index];
+	OutState.Speed = Buffers.Speeds[Index];
+	OutState.Radius = Buffers.Radii[Index];
+	return true;
+}
+
+/**
+ * @brief Finds the first collider or brick a ball would touch moving along Delta.
+ *
+ * @param Start Probe centre at the start of the trace.
+ * @param Delta Displacement to trace.
+ * @param Radius Probe radius, usually the ball radius.
+ * @param OutHit Earliest contact, if any.
+ * @return true if the probe touches something.
+ */
+bool UBBCBallSubsystem::TraceBall(const FVector2D& Start, const FVector2D& Delta, double Radius, FBBCSweepHit& OutHit) const
+{
+	OutHit = FBBCSweepHit();
+	return FindEarliestHit(Start, Radius, Delta, OutHit);
+}
+
+int32 UBBCBallSubsystem::GetNumBrickColliders() const
+{
+	int32 NumBricks = 0;
+	for (const FBBCCollider& Collider : Colliders)
+	{
+		NumBricks += Collider.Type == EBBCColliderType::Brick && Collider.bEnabled ? 1 : 0;
+	}
+	return NumBricks;
+}
+
+/**
+ * @brief Advances every ball by one fixed step in a single pass over the ball buffers.
+ *
+ * The paddle collider is moved by its per-step share of this frame's paddle motion after the balls have
+ * been resolved, so contacts with a moving paddle are found at the right sub-step, and balls stuck to the
+ * paddle move with it. Balls lost during the step are removed once the pass is over so the dense indices stay
+ * stable while iterating.
+ */
+void UBBCBallSubsystem::StepFixed()
+{
+	const int32 NumBalls = Buffers.Num();
+	for (int32 Index = 0; Index < NumBalls; ++Index)
+	{
+		StepBall(Index);
+	}
+	FlushPendingRemovals();
+
+	if (Colliders.IsValidIndex(PaddleColliderIndex))
+	{
+		Colliders[PaddleColliderIndex].Box = Colliders[PaddleColliderIndex].Box.ShiftBy(PaddleStepDelta);
+		UpdatePaddleBroadphase();
+	}
+	if (StuckBalls.Num() > 0)
+	{
+		MoveStuckBalls();
+	}
+	++StepCount;
+}
+
+/**
+ * @brief Moves one ball through a single fixed step, resolving up to MaxBouncesPerStep contacts.
+ *
+ * After each contact the ball is placed at the contact point, its direction is reflected, and the rest of
+ * the step is swept again from there. A ball in a tight corner can therefore bounce several times in one step
+ * instead of tunnelling through the geometry.
+ *
+ * @param Index Dense index of the ball to move.
+ */
+void UBBCBallSubsystem::StepBall(int32 Index)
+{
+	if (Buffers.Speeds[Index] <= 0.0)
+	{
+		return;
+	}
+
+	FVector2D& Position = Buffers.Positions[Index];
+	double Remaining = 1.0;
+	for (int32 Bounce = 0; Bounce < MaxBouncesPerStep && Remaining > 0.0; ++Bounce)
+	{
+		const FVector2D Delta = Buffers.Directions[Index] * (Buffers.Speeds[Index] * SpeedScale * FixedStepSeconds * Remaining);
+		FBBCSweepHit Hit;
+		if (!FindEarliestHit(Position, Buffers.Radii[Index], Delta, Hit))
+		{
+			Position += Delta;
+			return;
+		}
+
+		Position += Delta * Hit.Time + Hit.Normal * ContactOffset;
+		Remaining *= 1.0 - Hit.Time;
+		ResolveHit(Index, Hit);
+		if (Buffers.Speeds[Index] <= 0.0)
+		{
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Sweeps a ball against the colliders the broadphase finds around its path, the brick field and the
+ * brick source, and keeps the earliest contact.
+ *
+ * @param Position Ball position at the start of the sweep.
+ * @param Radius Ball radius.
+ * @param Delta Displacement for the remaining part of the step.
+ * @param OutHit Earliest contact, if any.
+ *
+ * @return true if the ball touches a collider during the sweep.
+ *
+ * @note The paddle is swept in its own frame of reference so a paddle moving into the ball is not missed.
+ */
+bool UBBCBallSubsystem::FindEarliestHit(const FVector2D& Position, double Radius, const FVector2D& Delta, FBBCSweepHit& OutHit) const
+{
+	bool bFoundHit = false;
+	const FVector2D RadiusExtent(Radius, Radius);
+	FBox2D SweptBox(Position - RadiusExtent, Position + RadiusExtent);
+	SweptBox += FBox2D(Position + Delta - RadiusExtent, Position + Delta + RadiusExtent);
+	BroadphaseCandidates.Reset();
+	Broadphase.Query(SweptBox, BroadphaseCandidates);
+
+	for (const int32 Handle : BroadphaseCandidates)
+	{
+		const int32 ColliderIndex = Broadphase.GetUserData(Handle);
+		const FBBCCollider& Collider = Colliders[ColliderIndex];
+
+		const FVector2D SweepDelta = ColliderIndex == PaddleColliderIndex ? Delta - PaddleStepDelta : Delta;
+		double Time = 0.0;
+		FVector2D Normal;
+		if (BBCCollision::SweepCircleAABB(Position, SweepDelta, Radius, Collider.Box, Time, Normal)
+			&& Time < OutHit.Time)
+		{
+			OutHit.Time = Time;
+			OutHit.Normal = Normal;
+			OutHit.ColliderIndex = ColliderIndex;
+			OutHit.Type = Collider.Type;
+			bFoundHit = true;
+		}
+	}
+
+	if (const UBBCBrickFieldComponent* Bricks = BrickField.Get())
+	{
+		double Time = 0.0;
+		FVector2D Normal;
+		int32 Cell = INDEX_NONE;
+		if (Bricks->SweepBall(Position, Delta, Radius, Time, Normal, Cell) && Time < OutHit.Time)
+		{
+			OutHit.Time = Time;
+			OutHit.Normal = Normal;
+			OutHit.ColliderIndex = INDEX_NONE;
+			OutHit.BrickCell = Cell;
+			OutHit.Type = EBBCColliderType::Brick;
+			bFoundHit = true;
+		}
+	}
+
+	if (BrickSource != nullptr)
+	{
+		double Time = 0.0;
+		FVector2D Normal;
+		int32 Cell = INDEX_NONE;
+		if (BrickSource->SweepBall(Position, Delta, Radius, Time, Normal, Cell) && Time < OutHit.Time)
+		{
+			OutHit.Time = Time;
+			OutHit.Normal = Normal;
+			OutHit.ColliderIndex = INDEX_NONE;
+			OutHit.BrickCell = Cell;
+			OutHit.BrickSource = BrickSource;
+			OutHit.Type = EBBCColliderType::Brick;
+			bFoundHit = true;
+		}
+	}
+	return bFoundHit;
+}
+
+/**
+ * @brief Applies the gameplay response for a contact.
+ *
+ * - Mirrors the ball's direction about the contact normal
+ * - Queues an extra ball for removal when it reaches the kill zone. The player's ball takes over an extra ball
+ *   still in play, see PromoteBall(), and is reset only when it was the last one
+ * - Adds the paddle's velocity during the current step to the horizontal direction on paddle contacts, and
+ *   holds the ball on the paddle while it is sticky
+ * - Damages the brick on brick contacts, see DamageBrick()
+ * - Publishes ball losses and destroyed bricks to UBBCGameEventSubsystem
+ *
+ * @param Index Dense index of the ball that collided.
+ * @param Hit The contact to respond to.
+ */
+void UBBCBallSubsystem::ResolveHit(int32 Index, const FBBCSweepHit& Hit)
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_CollisionResponse);
+	BBC_INC_DWORD_STAT(STAT_BBC_Collisions);
+	FVector2D& Direction = Buffers.Directions[Index];
+	Direction = BBCCollision::Reflect(Direction, Hit.Normal).GetSafeNormal();
+	++CollisionCounts[static_cast<int32>(Hit.Type)];
+
+	switch (Hit.Type)
+	{
+	case EBBCColliderType::KillZone:
+	{
+		ABBCBall* Ball = Buffers.Actors[Index].Get();
+		const bool bPlayerBall = Ball != nullptr && !Ball->ShouldReturnToPoolWhenLost();
+		const bool bPromoted = bPlayerBall && PromoteBall(Index);
+		if (GameEvents != nullptr)
+		{
+			GameEvents->Publish(FBBCBallLostEvent{Buffers.Handles[Index], bPlayerBall, bPlayerBall && !bPromoted});
+		}
+		if (bPromoted)
+		{
+			break;
+		}
+		if (bPlayerBall)
+		{
+			Ball->ResetBall();
+		}
+		else
+		{
+			Buffers.Speeds[Index] = 0.0;
+			PendingRemovals.Add(Buffers.Handles[Index]);
+		}
+		break;
+	}
+
+	case EBBCColliderType::Paddle:
+	{
+		const double MaxPaddleInfluence = BBCTuning::Get().MaxPaddleInfluence;
+		const double PaddleInfluence = FMath::Clamp(PaddleStepVelocity / (Buffers.Speeds[Index] * SpeedScale), -MaxPaddleInfluence, MaxPaddleInfluence);
+		Direction.X += PaddleInfluence;
+		Direction = Direction.GetSafeNormal();
+		if (StickyHoldSeconds > 0.0)
+		{
+			StickBall(Index);
+		}
+		break;
+	}
+
+	case EBBCColliderType::Brick:
+		DamageBrick(Hit);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Moves the player's ball onto another ball still in play and queues that ball for removal, so the
+ * player keeps a ball, and its actor, for as long as any ball is in play.
+ *
+ * A moving ball is taken first; otherwise a ball held by the sticky paddle, whose hold the player's ball takes
+ * over. Balls already queued for removal have no speed and are never taken.
+ *
+ * @param Index Dense index of the player's ball.
+ * @return false if no other ball is in play.
+ */
+bool UBBCBallSubsystem::PromoteBall(int32 Index)
+{
+	int32 Other = INDEX_NONE;
+	for (int32 Candidate = 0; Candidate < Buffers.Num(); ++Candidate)
+	{
+		if (Candidate != Index && Buffers.Speeds[Candidate] > 0.0)
+		{
+			Other = Candidate;
+			break;
+		}
+	}
+	if (Other == INDEX_NONE)
+	{
+		for (FStuckBall& Stuck : StuckBalls)
+		{
+			if (Stuck.BallHandle != Buffers.Handles[Index])
+			{
+				Other = HandleToIndex[Stuck.BallHandle];
+				Stuck.BallHandle = Buffers.Handles[Index];
+				break;
+			}
+		}
+	}
+	if (Other == INDEX_NONE)
+	{
+		return false;
+	}
+
+	Buffers.Positions[Index] = Buffers.Positions[Other];
+	Buffers.Directions[Index] = Buffers.Directions[Other];
+	Buffers.Speeds[Index] = Buffers.Speeds[Other];
+	Buffers.Speeds[Other] = 0.0;
+	PendingRemovals.Add(Buffers.Handles[Other]);
+	return true;
+}
+
+/**
+ * @brief Damages the brick of a brick contact.
+ *
+ * - Damages the cell of the brick source or the brick field the contact is with
+ * - Disables and hides a level-placed brick
+ * - Publishes the bricks destroyed to UBBCGameEventSubsystem
+ *
+ * @param Hit A contact of type Brick, from a ball step or from TraceBall.
+ */
+void UBBCBallSubsystem::DamageBrick(const FBBCSweepHit& Hit)
+{
+	if (Hit.Type != EBBCColliderType::Brick)
+	{
+		return;
+	}
+
+	if (Hit.BrickSource != nullptr)
+	{
+		if (Hit.BrickSource->DamageCell(Hit.BrickCell) && GameEvents != nullptr)
+		{
+			const FBox2D Box = Hit.BrickSource->GetCellBox(Hit.BrickCell);
+			GameEvents->Publish(FBBCBrickDestroyedEvent{INDEX_NONE, Box.GetCenter(), Box});
+		}
+	}
+	else if (Hit.BrickCell != INDEX_NONE)
+	{
+		UBBCBrickFieldComponent* Bricks = BrickField.Get();
+		if (Bricks != nullptr && Bricks->DamageCell(Hit.BrickCell) && GameEvents != nullptr)
+		{
+			const FBox2D Box = Bricks->GetCellBox(Hit.BrickCell);
+			GameEvents->Publish(FBBCBrickDestroyedEvent{Hit.BrickCell, Box.GetCenter(), Box});
+		}
+	}
+	else if (Colliders.IsValidIndex(Hit.ColliderIndex) && Colliders[Hit.ColliderIndex].bEnabled)
+	{
+		SetColliderEnabled(Hit.ColliderIndex, false);
+		const FBBCCollider& Collider = Colliders[Hit.ColliderIndex];
+		if (UPrimitiveComponent* Component = Collider.Component.Get())
+		{
+			Component->SetVisibility(false);
+		}
+		if (GameEvents != nullptr)
+		{
+			GameEvents->Publish(FBBCBrickDestroyedEvent{INDEX_NONE, Collider.Box.GetCenter(), Collider.Box});
+		}
+	}
+}
+
+/**
+ * @brief Holds a ball that bounced off the sticky paddle. Its bounced direction is kept for the release.
+ *
+ * @param Index Dense index of the ball.
+ */
+void UBBCBallSubsystem::StickBall(int32 Index)
+{
+	const uint64 HoldSteps = FMath::Max<uint64>(FMath::CeilToInt64(StickyHoldSeconds / FixedStepSeconds), 1);
+	StuckBalls.Add(FStuckBall{Buffers.Handles[Index], Buffers.Speeds[Index], StepCount + HoldSteps});
+	Buffers.Speeds[Index] = 0.0;
+}
+
+void UBBCBallSubsystem::UnstickBall(int32 BallHandle)
+{
+	StuckBalls.RemoveAllSwap([BallHandle](const FStuckBall& Stuck) { return Stuck.BallHandle == BallHandle; }, EAllowShrinking::No);
+}
+
+/**
+ * @brief Carries the stuck balls along with the paddle's step and releases those whose hold is over.
+ */
+void UBBCBallSubsystem::MoveStuckBalls()
+{
+	for (int32 StuckIndex = StuckBalls.Num() - 1; StuckIndex >= 0; --StuckIndex)
+	{
+		const FStuckBall& Stuck = StuckBalls[StuckIndex];
+		const int32 Index = HandleToIndex[Stuck.BallHandle];
+		Buffers.Positions[Index].X += PaddleStepDelta.X;
+		if (StepCount >= Stuck.ReleaseStep)
+		{
+			Buffers.Speeds[Index] = Stuck.Speed;
+			StuckBalls.RemoveAtSwap(StuckIndex, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+/**
+ * @brief Turns the sticky paddle on or off.
+ *
+ * @param HoldSeconds Time a ball stays on the paddle after hitting it; 0 or less turns stickiness off and
+ * releases the balls held now.
+ */
+void UBBCBallSubsystem::SetStickyPaddle(double HoldSeconds)
+{
+	StickyHoldSeconds = FMath::Max(HoldSeconds, 0.0);
+	if (StickyHoldSeconds <= 0.0)
+	{
+		ReleaseStuckBalls();
+	}
+}
+
+/**
+ * @brief Releases every stuck ball before its hold is over, in the direction and at the speed it bounced with.
+ */
+void UBBCBallSubsystem::ReleaseStuckBalls()
+{
+	for (const FStuckBall& Stuck : StuckBalls)
+	{
+		Buffers.Speeds[HandleToIndex[Stuck.BallHandle]] = Stuck.Speed;
+	}
+	StuckBalls.Reset();
+}
+
+/**
+ * @brief Removes the balls lost during the last step. Pooled actor balls go back to the actor pool, which
+ * takes them out of the simulation.
+ */
+void UBBCBallSubsystem::FlushPendingRemovals()
+{
+	if (PendingRemovals.Num() == 0)
+	{
+		return;
+	}
+
+	UBBCActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UBBCActorPoolSubsystem>();
+	for (const int32 BallHandle : PendingRemovals)
+	{
+		const int32 Index = HandleToIndex.IsValidIndex(BallHandle) ? HandleToIndex[BallHandle] : INDEX_NONE;
+		ABBCBall* Ball = Index != INDEX_NONE ? Buffers.Actors[Index].Get() : nullptr;
+		if (Ball != nullptr && Pool != nullptr)
+		{
+			Pool->Release(Ball);
+		}
+		else
+		{
+			UnregisterBall(BallHandle);
+		}
+	}
+	PendingRemovals.Reset();
+}
+
+/**
+ * @brief Recomputes the paddle collider and its per-step motion at the start of a frame's steps.
+ *
+ * When the paddle was integrated over this frame's steps (ABBCPaddle::TickMovement), the collider starts where
+ * the paddle was before the first step and follows the paddle's own step positions and velocities. Otherwise
+ * it is moved an equal fraction of the paddle's frame displacement on every step, with the frame's average
+ * velocity. Either way contacts are spread across the frame instead of snapping.
+ *
+ * @param NumSteps Number of fixed steps that will run this frame.
+ */
+void UBBCBallSubsystem::UpdatePaddleCollider(int32 NumSteps)
+{
+	const ABBCPaddle* PaddleActor = Paddle.Get();
+	if (PaddleActor == nullptr || !Colliders.IsValidIndex(PaddleColliderIndex))
+	{
+		return;
+	}
+
+	const FBox2D PaddleBox = BBCCollision::ToBox2D(PaddleActor->GetPaddleBounds());
+	const double CurrentX = PaddleBox.GetCenter().X;
+	const TConstArrayView<double> StepPositions = PaddleActor->GetStepPositions();
+	const TConstArrayView<float> StepVelocities = PaddleActor->GetStepVelocities();
+	PaddleStepDeltas.Reset();
+	PaddleStepVelocities.Reset();
+	if (StepPositions.Num() == NumSteps + 1 && StepVelocities.Num() == NumSteps)
+	{
+		Colliders[PaddleColliderIndex].Box = PaddleBox.ShiftBy(FVector2D(StepPositions[0] - StepPositions.Last(), 0.0));
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			PaddleStepDeltas.Add(StepPositions[Step + 1] - StepPositions[Step]);
+			PaddleStepVelocities.Add(StepVelocities[Step]);
+		}
+	}
+	else
+	{
+		Colliders[PaddleColliderIndex].Box = PaddleBox.ShiftBy(FVector2D(LastPaddleX - CurrentX, 0.0));
+		PaddleStepDeltas.Init((CurrentX - LastPaddleX) / NumSteps, NumSteps);
+		PaddleStepVelocities.Init(PaddleActor->GetPaddleVelocity(), NumSteps);
+	}
+	LastPaddleX = CurrentX;
+}
+
+/**
+ * @brief Selects the paddle motion of one of this frame's steps.
+ *
+ * @param Step Index of the step about to run.
+ */
+void UBBCBallSubsystem::BeginPaddleStep(int32 Step)
+{
+	if (!Colliders.IsValidIndex(PaddleColliderIndex) || !PaddleStepDeltas.IsValidIndex(Step))
+	{
+		return;
+	}
+	PaddleStepDelta = FVector2D(PaddleStepDeltas[Step], 0.0);
+	PaddleStepVelocity = PaddleStepVelocities[Step];
+	UpdatePaddleBroadphase();
+}
+
+/**
+ * @brief Gives the paddle broadphase bounds that cover its motion over the next fixed step.
+ *
+ * Balls are swept against the paddle in the paddle's frame, so a ball can reach the paddle anywhere between
+ * its position at the start and the end of the step. The entry is moved in place, which only touches the cells
+ * the paddle enters or leaves.
+ */
+void UBBCBallSubsystem::UpdatePaddleBroadphase()
+{
+	const FBox2D& PaddleBox = Colliders[PaddleColliderIndex].Box;
+	Broadphase.Move(ColliderHandles[PaddleColliderIndex], PaddleBox + PaddleBox.ShiftBy(PaddleStepDelta));
+}
+
+/**
+ * @brief Writes simulated positions back to the ball actors.
+ */
+void UBBCBallSubsystem::SyncActors()
+{
+	if (NumActorBalls == 0)
+	{
+		return;
+	}
+	for (int32 Index = 0; Index < Buffers.Num(); ++Index)
+	{
+		if (Buffers.Speeds[Index] <= 0.0)
+		{
+			continue;
+		}
+		if (ABBCBall* Ball = Buffers.Actors[Index].Get())
+		{
+			Ball->SetActorLocation(FVector(Buffers.Positions[Index], 0.0));
+		}
+	}
+	for (const FStuckBall& Stuck : StuckBalls)
+	{
+		const int32 Index = HandleToIndex[Stuck.BallHandle];
+		if (ABBCBall* Ball = Buffers.Actors[Index].Get())
+		{
+			Ball->SetActorLocation(FVector(Buffers.Positions[Index], 0.0));
+		}
+	}
+}
+
+/**
+ * @brief Writes every instanced ball into the shared instanced mesh in one batched update.
+ *
+ * Instances are not tied to particular balls; the instance count is grown or shrunk to match and every
+ * transform is rewritten in buffer order, so removing a ball never needs an index fix-up on the render side.
+ */
+void UBBCBallSubsystem::SyncInstances()
+{
+	const int32 NumInstancedBalls = Buffers.Num() - NumActorBalls;
+	if (NumInstancedBalls == 0 && BallInstances == nullptr)
+	{
+		return;
+	}
+
+	UInstancedStaticMeshComponent* Instances = GetOrCreateInstances();
+	if (Instances == nullptr)
+	{
+		return;
+	}
+
+	const UStaticMesh* StaticMesh = Instances->GetStaticMesh();
+	const double MeshRadius = StaticMesh != nullptr ? StaticMesh->GetBounds().BoxExtent.X : 50.0;
+
+	InstanceTransforms.Reset(NumInstancedBalls);
+	for (int32 Index = 0; Index < Buffers.Num(); ++Index)
+	{
+		if (!Buffers.Actors[Index].IsExplicitlyNull())
+		{
+			continue;
+		}
+		InstanceTransforms.Emplace(FQuat::Identity, FVector(Buffers.Positions[Index], 0.0), FVector(Buffers.Radii[Index] / MeshRadius));
+	}
+
+	const int32 NumInstances = Instances->GetInstanceCount();
+	if (NumInstances > NumInstancedBalls)
+	{
+		TArray<int32> InstancesToRemove;
+		InstancesToRemove.Reserve(NumInstances - NumInstancedBalls);
+		for (int32 InstanceIndex = NumInstancedBalls; InstanceIndex < NumInstances; ++InstanceIndex)
+		{
+			InstancesToRemove.Add(InstanceIndex);
+		}
+		Instances->RemoveInstances(InstancesToRemove);
+	}
+	else if (NumInstances < NumInstancedBalls)
+	{
+		const TArray<FTransform> NewInstances(InstanceTransforms.GetData() + NumInstances, NumInstancedBalls - NumInstances);
+		Instances->AddInstances(NewInstances, false, true);
+	}
+
+	if (NumInstancedBalls > 0)
+	{
+		Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+	}
+}
+
+/**
+ * @brief Returns the instanced mesh used for balls without actors, creating it on first use.
+ *
+ * The component lives on a bare actor and uses the ball mesh of the asset manifest. If the mesh is still
+ * loading, the component is created without one and picks it up on a later call.
+ *
+ * @return The instanced mesh, or null if the world is not available.
+ */
+UInstancedStaticMeshComponent* UBBCBallSubsystem::GetOrCreateInstances()
+{
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	if (BallInstances != nullptr)
+	{
+		if (BallInstances->GetStaticMesh() == nullptr && Assets != nullptr && Assets->GetBallMesh() != nullptr)
+		{
+			BallInstances->SetStaticMesh(Assets->GetBallMesh());
+		}
+		return BallInstances;
+	}
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("BallInstances");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* InstancesActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(InstancesActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn ball instances actor. "));
+		return nullptr;
+	}
+
+	BallInstances = NewObject<UInstancedStaticMeshComponent>(InstancesActor, TEXT("BallInstances"));
+	BallInstances->SetMobility(EComponentMobility::Movable);
+	BallInstances->SetStaticMesh(Assets != nullptr ? Assets->GetBallMesh() : nullptr);
+	BallInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BallInstances->SetCastShadow(false);
+	InstancesActor->SetRootComponent(BallInstances);
+	BallInstances->RegisterComponent();
+	return BallInstances;
+}
+
+/**
+ * @brief Builds static colliders from the blocking primitives placed in the level.
+ *
+ * Only components tagged "Brick" that cross the ball plane (Z = 0) and block dynamic objects are used; they
+ * become breakable bricks.
+ *
+ * @param InWorld The world to scan.
+ *
+ * @note Walls and "UnSafeBound" kill zones placed in the level are not used: the playfield layout provides
+ * them, sized to the camera rather than to wherever the level put its bound actors.
+ */
+void UBBCBallSubsystem::GatherLevelColliders(UWorld& InWorld)
+{
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		const AActor* Actor = *It;
+		if (Actor->IsA<APawn>() || Actor->IsA<ABBCBall>())
+		{
+			continue;
+		}
+
+		TInlineComponentArray<UPrimitiveComponent*> Primitives(Actor);
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (!Primitive->ComponentHasTag("Brick") || !Primitive->IsCollisionEnabled() || Primitive->GetCollisionResponseToChannel(ECC_WorldDynamic) != ECR_Block)
+			{
+				continue;
+			}
+
+			const FBox Bounds = Primitive->Bounds.GetBox();
+			if (Bounds.Min.Z > 0.0 || Bounds.Max.Z < 0.0)
+			{
+				continue;
+			}
+
+			FBBCCollider Collider;
+			Collider.Box = BBCCollision::ToBox2D(Bounds);
+			Collider.Component = Primitive;
+			Collider.Type = EBBCColliderType::Brick;
+			AddCollider(Collider);
+		}
+	}
+}
+
+/**
+ * @brief Adds the walls and kill zone of the current playfield layout, or moves them to it.
+ */
+void UBBCBallSubsystem::ApplyPlayfieldLayout()
+{
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	const FBox2D Boxes[] = {Layout.LeftWall, Layout.RightWall, Layout.TopWall, Layout.KillZone};
+	for (int32 Bound = 0; Bound < UE_ARRAY_COUNT(Boxes); ++Bound)
+	{
+		if (BoundColliderIndices[Bound] != INDEX_NONE)
+		{
+			SetColliderBox(BoundColliderIndices[Bound], Boxes[Bound]);
+			continue;
+		}
+		FBBCCollider Collider;
+		Collider.Box = Boxes[Bound];
+		Collider.Type = Bound == 3 ? EBBCColliderType::KillZone : EBBCColliderType::Wall;
+		BoundColliderIndices[Bound] = AddCollider(Collider);
+	}
+}
+
+void UBBCBallSubsystem::HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event)
+{
+	ApplyPlayfieldLayout();
+}
@@ -0,0 +1,493 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Ball/BBCTrajectorySubsystem.h"
+
+#include "DrawDebugHelpers.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Length of a traced segment that starts outside the playfield, which the arena cannot bound. */
+	constexpr double TraceDistance = 4000.0;
+	constexpr double ContactOffset = 0.01;
+	/** Distance off a cached segment under which a ball is still considered on it. */
+	constexpr double OnPathTolerance = 0.05;
+	constexpr double DirectionTolerance = 1.e-6;
+
+	/**
+	 * @brief Distance along a ray from a point inside a box to where it leaves the box.
+	 *
+	 * @return The distance, or TraceDistance if Position is outside Bounds.
+	 */
+	double GetExitDistance(const FBox2D& Bounds, const FVector2D& Position, const FVector2D& Direction)
+	{
+		if (!Bounds.IsInsideOrOn(Position))
+		{
+			return TraceDistance;
+		}
+		double Distance = TraceDistance;
+		for (int32 Axis = 0; Axis < 2; ++Axis)
+		{
+			if (Direction[Axis] > UE_SMALL_NUMBER)
+			{
+				Distance = FMath::Min(Distance, (Bounds.Max[Axis] - Position[Axis]) / Direction[Axis]);
+			}
+			else if (Direction[Axis] < -UE_SMALL_NUMBER)
+			{
+				Distance = FMath::Min(Distance, (Bounds.Min[Axis] - Position[Axis]) / Direction[Axis]);
+			}
+		}
+		return Distance;
+	}
+
+	TAutoConsoleVariable<bool> CVarDrawTrajectories(
+		TEXT("BBC.Trajectory.Draw"),
+		false,
+		TEXT("Draws the predicted path of every moving ball, as an aim assist overlay."));
+
+	/**
+	 * @brief Prints the trajectory cache counters.
+	 *
+	 * Usage: BBC.Trajectory.Stats
+	 */
+	FAutoConsoleCommandWithWorld TrajectoryStatsCommand(
+		TEXT("BBC.Trajectory.Stats"),
+		TEXT("Prints trajectory cache hits and rebuilds. Usage: BBC.Trajectory.Stats"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UBBCTrajectorySubsystem* Trajectories = World != nullptr ? World->GetSubsystem<UBBCTrajectorySubsystem>() : nullptr;
+			if (Trajectories == nullptr)
+			{
+				return;
+			}
+			UE_LOG(LogTemp, Display, TEXT("Trajectory cache: %lld hits, %lld partial rebuilds, %lld full rebuilds"),
+				Trajectories->GetNumCacheHits(), Trajectories->GetNumPartialRebuilds(), Trajectories->GetNumFullRebuilds());
+		}));
+
+	/**
+	 * @brief Times repeated queries on the first moving ball, cached against rebuilt from scratch every time.
+	 *
+	 * Usage: BBC.Trajectory.Bench [Queries]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs TrajectoryBenchCommand(
+		TEXT("BBC.Trajectory.Bench"),
+		TEXT("Times cached and uncached path queries on the first moving ball. Usage: BBC.Trajectory.Bench [Queries]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCTrajectorySubsystem* Trajectories = World != nullptr ? World->GetSubsystem<UBBCTrajectorySubsystem>() : nullptr;
+			const UBBCBallSubsystem* BallSubsystem = World != nullptr ? World->GetSubsystem<UBBCBallSubsystem>() : nullptr;
+			if (Trajectories == nullptr || BallSubsystem == nullptr)
+			{
+				return;
+			}
+			const int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+			int32 BallHandle = INDEX_NONE;
+			for (int32 Index = 0; Index < BallSubsystem->GetNumBalls() && BallHandle == INDEX_NONE; ++Index)
+			{
+				if (Trajectories->GetTrajectory(BallSubsystem->GetBallHandle(Index)) != nullptr)
+				{
+					BallHandle = BallSubsystem->GetBallHandle(Index);
+				}
+			}
+			if (BallHandle == INDEX_NONE)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("BBC.Trajectory.Bench needs a moving ball"));
+				return;
+			}
+
+			int32 NumSegments = 0;
+			double StartSeconds = FPlatformTime::Seconds();
+			for (int32 Query = 0; Query < NumQueries; ++Query)
+			{
+				NumSegments += Trajectories->GetTrajectory(BallHandle)->Segments.Num();
+			}
+			const double CachedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+			const int32 NumUncached = FMath::Max(1, NumQueries / 100);
+			StartSeconds = FPlatformTime::Seconds();
+			for (int32 Query = 0; Query < NumUncached; ++Query)
+			{
+				Trajectories->InvalidateAll();
+				NumSegments += Trajectories->GetTrajectory(BallHandle)->Segments.Num();
+			}
+			const double UncachedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+			UE_LOG(LogTemp, Display, TEXT("Trajectory query: cached %.1f ns, rebuilt %.1f ns (%d segments seen)"),
+				CachedSeconds * 1.e9 / NumQueries, UncachedSeconds * 1.e9 / NumUncached, NumSegments);
+		}));
+}
+
+/**
+ * @brief Finds where the path meets the paddle or the kill zone.
+ *
+ * @param OutLocation Ball centre at the contact.
+ * @return true if the path ends on the paddle or the kill zone.
+ */
+bool FBBCTrajectory::GetLanding(FVector2D& OutLocation) const
+{
+	if (!bTerminated || Segments.IsEmpty())
+	{
+		return false;
+	}
+	const FBBCTrajectorySegment& Last = Segments.Last();
+	if (Last.Hit.Type != EBBCColliderType::Paddle && Last.Hit.Type != EBBCColliderType::KillZone)
+	{
+		return false;
+	}
+	OutLocation = Last.End;
+	return true;
+}
+
+/**
+ * @brief Registers the overlay in the Balls phase, after the ball subsystem it depends on has advanced.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ */
+void UBBCTrajectorySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	BallSubsystem = Collection.InitializeDependency<UBBCBallSubsystem>();
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Balls, EBBCTickOrder::BeforeActors, FBBCTickUpdate::CreateWeakLambda(this, [this](float) { DrawOverlay(); }));
+	}
+}
+
+/**
+ * @brief Subscribes to the events that change the playfield under cached paths.
+ *
+ * @param InWorld The world that just started play.
+ */
+void UBBCTrajectorySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	UBBCGameEventSubsystem* GameEvents = InWorld.GetSubsystem<UBBCGameEventSubsystem>();
+	if (GameEvents == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GameEvents is Invalid"));
+		return;
+	}
+	GameEvents->OnLevelStarted().AddUObject(this, &UBBCTrajectorySubsystem::HandleLevelStarted);
+	GameEvents->OnBrickDestroyed().AddUObject(this, &UBBCTrajectorySubsystem::HandleBrickDestroyed);
+	GameEvents->OnBallLost().AddUObject(this, &UBBCTrajectorySubsystem::HandleBallLost);
+	GameEvents->OnBallRemoved().AddUObject(this, &UBBCTrajectorySubsystem::HandleBallRemoved);
+	GameEvents->OnBricksRestored().AddUObject(this, &UBBCTrajectorySubsystem::HandleBricksRestored);
+	GameEvents->OnPlayfieldChanged().AddUObject(this, &UBBCTrajectorySubsystem::HandlePlayfieldChanged);
+}
+
+void UBBCTrajectorySubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	if (UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnLevelStarted().RemoveAll(this);
+		GameEvents->OnBrickDestroyed().RemoveAll(this);
+		GameEvents->OnBallLost().RemoveAll(this);
+		GameEvents->OnBallRemoved().RemoveAll(this);
+		GameEvents->OnBricksRestored().RemoveAll(this);
+		GameEvents->OnPlayfieldChanged().RemoveAll(this);
+	}
+	Trajectories.Empty();
+	BallSubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UBBCTrajectorySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Returns the predicted path of a ball, reusing as much of the cached one as still holds.
+ *
+ * A ball still on the first cached segment only moves that segment's start. A ball that bounced where the
+ * path said it would drops the first segment. Either way the path is extended again if an invalidation left
+ * it short. Anything else (a paddle deflection, a regenerated brick, a teleport) rebuilds the path.
+ *
+ * @param BallHandle Handle from UBBCBallSubsystem.
+ * @return The path, valid until the next query or invalidation, or null if the ball is unknown or at rest.
+ */
+const FBBCTrajectory* UBBCTrajectorySubsystem::GetTrajectory(int32 BallHandle)
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_TrajectoryQuery);
+	FBBCBallState State;
+	if (BallSubsystem == nullptr || !BallSubsystem->GetBallState(BallHandle, State) || State.Speed <= 0.0)
+	{
+		Trajectories.Remove(BallHandle);
+		return nullptr;
+	}
+
+	SyncPaddle();
+
+	FBBCTrajectory& Trajectory = Trajectories.FindOrAdd(BallHandle);
+	const auto IsOnSegment = [&State](const FBBCTrajectorySegment& Segment, const FVector2D& Direction)
+	{
+		if (!Segment.Direction.Equals(Direction, DirectionTolerance))
+		{
+			return false;
+		}
+		const FVector2D FromStart = State.Position - Segment.Start;
+		const double Along = FVector2D::DotProduct(FromStart, Segment.Direction);
+		return FMath::Abs(FVector2D::CrossProduct(FromStart, Segment.Direction)) <= OnPathTolerance
+			&& Along >= -OnPathTolerance && Along <= FVector2D::Distance(Segment.Start, Segment.End) + OnPathTolerance;
+	};
+
+	const bool bSameRadius = Trajectory.Radius == State.Radius;
+	const bool bFirstHitRemoved = Trajectory.bFirstHitRemoved;
+	Trajectory.bFirstHitRemoved = false;
+	if (bSameRadius && !bFirstHitRemoved && !Trajectory.Segments.IsEmpty() && IsOnSegment(Trajectory.Segments[0], State.Direction))
+	{
+		Trajectory.Segments[0].Start = State.Position;
+	}
+	else if (bSameRadius && Trajectory.Segments.Num() > 1 && IsOnSegment(Trajectory.Segments[1], State.Direction))
+	{
+		Trajectory.Segments.RemoveAt(0, 1, EAllowShrinking::No);
+		Trajectory.Segments[0].Start = State.Position;
+	}
+	else
+	{
+		Trajectory.Segments.Reset();
+		Trajectory.Radius = State.Radius;
+		Trajectory.bTerminated = false;
+		Extend(Trajectory, State.Position, State.Direction);
+		++NumFullRebuilds;
+		return &Trajectory;
+	}
+
+	if (!Trajectory.bTerminated && Trajectory.Segments.Num() < MaxSegments)
+	{
+		const FBBCTrajectorySegment Last = Trajectory.Segments.Last();
+		Extend(Trajectory, Last.End + Last.Hit.Normal * ContactOffset, Last.ReflectedDirection);
+		++NumPartialRebuilds;
+	}
+	else
+	{
+		++NumCacheHits;
+	}
+	return &Trajectory;
+}
+
+void UBBCTrajectorySubsystem::InvalidateAll()
+{
+	Trajectories.Reset();
+}
+
+/**
+ * @brief Drops the part of every path from the first segment whose swept area overlaps Area.
+ *
+ * @param Area Region whose colliders changed.
+ */
+void UBBCTrajectorySubsystem::InvalidateArea(const FBox2D& Area)
+{
+	for (TPair<int32, FBBCTrajectory>& Pair : Trajectories)
+	{
+		const TArray<FBBCTrajectorySegment, TInlineAllocator<8>>& Segments = Pair.Value.Segments;
+		const int32 FirstStale = Segments.IndexOfByPredicate([&Area](const FBBCTrajectorySegment& Segment)
+		{
+			return Segment.Bounds.Intersect(Area);
+		});
+		Truncate(Pair.Value, FirstStale);
+	}
+}
+
+/**
+ * @brief Draws each cached path, green up to the last bounce and red on the segment that lands.
+ */
+void UBBCTrajectorySubsystem::DrawOverlay()
+{
+#if ENABLE_DRAW_DEBUG
+	if (!CVarDrawTrajectories.GetValueOnGameThread() || BallSubsystem == nullptr)
+	{
+		return;
+	}
+	for (int32 Index = 0; Index < BallSubsystem->GetNumBalls(); ++Index)
+	{
+		const FBBCTrajectory* Trajectory = GetTrajectory(BallSubsystem->GetBallHandle(Index));
+		if (Trajectory == nullptr)
+		{
+			continue;
+		}
+		FVector2D Landing;
+		const bool bLands = Trajectory->GetLanding(Landing);
+		for (int32 Segment = 0; Segment < Trajectory->Segments.Num(); ++Segment)
+		{
+			const bool bLandingSegment = bLands && Segment == Trajectory->Segments.Num() - 1;
+			DrawDebugLine(GetWorld(), FVector(Trajectory->Segments[Segment].Start, 0.0), FVector(Trajectory->Segments[Segment].End, 0.0),
+				bLandingSegment ? FColor::Red : FColor::Green, false, -1.f, SDPG_Foreground, 1.f);
+		}
+	}
+#endif
+}
+
+/**
+ * @brief Truncates every path that crosses the area the paddle moved through since the last query.
+ *
+ * The paddle collider moves almost every frame, but only the segments near the paddle line care.
+ */
+void UBBCTrajectorySubsystem::SyncPaddle()
+{
+	const FBBCCollider* Paddle = BallSubsystem->GetPaddleCollider();
+	const FBox2D CurrentBox = Paddle != nullptr && Paddle->bEnabled ? Paddle->Box : FBox2D(ForceInit);
+	if (CurrentBox == PaddleBox)
+	{
+		return;
+	}
+
+	FBox2D Changed = PaddleBox;
+	Changed += CurrentBox;
+	PaddleBox = CurrentBox;
+	InvalidateArea(Changed);
+}
+
+/**
+ * @brief Appends segments to a path until it lands or reaches MaxSegments.
+ *
+ * Each segment is swept with the ball's own radius against the ball subsystem's colliders and brick field, so
+ * the path bounces exactly where the ball will. Bricks are treated as reflectors even though the ball breaks
+ * them, since the ball bounces off them either way.
+ *
+ * Each sweep stops where the ball would leave the playfield's walls and kill zone, so the broadphase only
+ * visits the cells the ball can actually cross instead of a fixed, much longer distance.
+ *
+ * @param Trajectory Path to extend; its Radius must be set.
+ * @param Position Ball centre where the new segments start.
+ * @param Direction Unit direction of travel from Position.
+ */
+void UBBCTrajectorySubsystem::Extend(FBBCTrajectory& Trajectory, FVector2D Position, FVector2D Direction) const
+{
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	const FBox2D Bounds = (Layout.Arena + Layout.LeftWall + Layout.RightWall + Layout.TopWall + Layout.KillZone).ExpandBy(Trajectory.Radius);
+
+	while (Trajectory.Segments.Num() < MaxSegments)
+	{
+		const double Distance = GetExitDistance(Bounds, Position, Direction);
+		FBBCSweepHit Hit;
+		if (!BallSubsystem->TraceBall(Position, Direction * Distance, Trajectory.Radius, Hit))
+		{
+			Trajectory.bTerminated = true;
+			return;
+		}
+
+		FBBCTrajectorySegment& Segment = Trajectory.Segments.AddDefaulted_GetRef();
+		Segment.Start = Position;
+		Segment.End = Position + Direction * (Distance * Hit.Time);
+		Segment.Direction = Direction;
+		Segment.ReflectedDirection = BBCCollision::Reflect(Direction, Hit.Normal);
+		Segment.Bounds = FBox2D(Segment.Start, Segment.Start).ExpandBy(Trajectory.Radius) + FBox2D(Segment.End, Segment.End).ExpandBy(Trajectory.Radius);
+		Segment.Hit = Hit;
+
+		if (Hit.Type == EBBCColliderType::Paddle || Hit.Type == EBBCColliderType::KillZone)
+		{
+			Trajectory.bTerminated = true;
+			return;
+		}
+		Position = Segment.End + Hit.Normal * ContactOffset;
+		Direction = Segment.ReflectedDirection;
+	}
+}
+
+/**
+ * @brief Drops a path's segments from FirstStaleSegment on, keeping the unaffected prefix.
+ *
+ * @note Dropping the first segment makes the next query a full rebuild, as the path no longer says anything
+ * about the ball.
+ */
+void UBBCTrajectorySubsystem::Truncate(FBBCTrajectory& Trajectory, int32 FirstStaleSegment)
+{
+	if (FirstStaleSegment == INDEX_NONE)
+	{
+		return;
+	}
+	Trajectory.Segments.SetNum(FirstStaleSegment, EAllowShrinking::No);
+	Trajectory.bTerminated = false;
+}
+
+void UBBCTrajectorySubsystem::HandleLevelStarted(const FBBCLevelStartedEvent& Event)
+{
+	InvalidateAll();
+}
+
+void UBBCTrajectorySubsystem::HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event)
+{
+	InvalidateAll();
+}
+
+/**
+ * @brief Truncates paths at the first segment that touches the destroyed brick; everything before it still holds.
+ *
+ * A segment touches the brick when it ends on it, or when the area it sweeps overlaps the brick, as for a ball
+ * grazing a corner. When the first segment ends on the brick, the brick was usually broken by that very ball,
+ * which has already bounced off it and is now on the second segment. The first segment is kept and flagged so
+ * the next query accepts the path only if the ball did bounce.
+ */
+void UBBCTrajectorySubsystem::HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event)
+{
+	const auto EndsOnBrick = [this, &Event](const FBBCTrajectorySegment& Segment)
+	{
+		if (Segment.Hit.Type != EBBCColliderType::Brick)
+		{
+			return false;
+		}
+		if (Event.Cell != INDEX_NONE)
+		{
+			return Segment.Hit.BrickCell == Event.Cell;
+		}
+		const FBBCCollider* Collider = BallSubsystem->GetCollider(Segment.Hit.ColliderIndex);
+		return Segment.Hit.BrickCell == INDEX_NONE && Collider != nullptr && Collider->Box.GetCenter().Equals(Event.Location);
+	};
+
+	const auto TouchesBrick = [&Event, &EndsOnBrick](const FBBCTrajectorySegment& Segment)
+	{
+		return EndsOnBrick(Segment) || (Event.Box.bIsValid && Segment.Bounds.Intersect(Event.Box));
+	};
+
+	for (TPair<int32, FBBCTrajectory>& Pair : Trajectories)
+	{
+		FBBCTrajectory& Trajectory = Pair.Value;
+		int32 FirstSearched = 0;
+		if (!Trajectory.Segments.IsEmpty() && EndsOnBrick(Trajectory.Segments[0]))
+		{
+			Trajectory.bFirstHitRemoved = true;
+			FirstSearched = 1;
+		}
+		for (int32 Segment = FirstSearched; Segment < Trajectory.Segments.Num(); ++Segment)
+		{
+			if (TouchesBrick(Trajectory.Segments[Segment]))
+			{
+				Truncate(Trajectory, Segment);
+				break;
+			}
+		}
+	}
+}
+
+void UBBCTrajectorySubsystem::HandleBallLost(const FBBCBallLostEvent& Event)
+{
+	Trajectories.Remove(Event.BallHandle);
+}
+
+/**
+ * @brief Drops the path of an unregistered ball, whose handle may be reused by the next ball registered.
+ */
+void UBBCTrajectorySubsystem::HandleBallRemoved(const FBBCBallRemovedEvent& Event)
+{
+	Trajectories.Remove(Event.BallHandle);
+}
+
+void UBBCTrajectorySubsystem::HandleBricksRestored(const FBBCBricksRestoredEvent& Event)
+{
+	InvalidateArea(Event.Area);
+}
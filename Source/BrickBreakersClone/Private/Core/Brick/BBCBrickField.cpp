@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Brick/BBCBrickField.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+
+/**
+ * @brief Constructor for the ABBCBrickField class, creating the brick field component as the root.
+ *
+ * @param ObjectInitializer Reference to object initialization parameters
+ *
+ * @note The actor never ticks; the field is updated by the Bricks phase of UBBCTickManagerSubsystem.
+ */
+ABBCBrickField::ABBCBrickField(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	BrickField = ObjectInitializer.CreateDefaultSubobject<UBBCBrickFieldComponent>(this, TEXT("BrickField"));
+	SetRootComponent(BrickField);
+}
+
+/**
+ * @brief Builds the wall, hands it to the ball subsystem for ball versus brick queries and registers it
+ * with the gameplay tick manager.
+ *
+ * The brick mesh comes from the asset manifest unless a subclass set one; if its bundle is still loading the
+ * wall is built right away and drawn once the mesh arrives.
+ *
+ * @note Logs an error if the ball subsystem is unavailable; the wall is still drawn but cannot be hit.
+ */
+void ABBCBrickField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	if(BrickField->GetStaticMesh() == nullptr && Assets != nullptr)
+	{
+		Assets->WhenLoaded(EBBCAssetBundle::Gameplay, FSimpleDelegate::CreateWeakLambda(BrickField, [this, Assets]()
+		{
+			BrickField->SetStaticMesh(Assets->GetBrickMesh());
+		}));
+	}
+
+	BrickField->BuildField();
+
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterBrickField(BrickField);
+	}
+
+	UBBCBallSubsystem* BallSubsystem = GetWorld()->GetSubsystem<UBBCBallSubsystem>();
+	if(BallSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BallSubsystem is Invalid"));
+		return;
+	}
+	BallSubsystem->SetBrickField(BrickField);
+}
+
+void ABBCBrickField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterBrickField(BrickField);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
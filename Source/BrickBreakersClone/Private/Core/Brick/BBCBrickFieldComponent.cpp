@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Brick/BBCBrickFieldComponent.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "Core/Collision/BBCCollisionBatch.h"
+#include "Core/Level/BBCLevelLayout.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarBrickWorkers(
+		TEXT("BBC.Bricks.Workers"),
+		0,
+		TEXT("Worker tasks sharing the brick field update. 0 uses one per task graph worker thread."));
+
+	TAutoConsoleVariable<bool> CVarBrickVectorKernel(
+		TEXT("BBC.Collision.VectorKernel"),
+		true,
+		TEXT("Sweep balls against bricks with the 4-wide vector kernel (true) or its scalar reference (false)."));
+}
+
+/**
+ * @brief Constructor for the UBBCBrickFieldComponent class, setting up the brick mesh and default grid.
+ *
+ * - Leaves the mesh to ABBCBrickField, which takes it from the asset manifest
+ * - Disables collision and physics, ball contacts are resolved against the grid
+ * - Disables shadow casting
+ *
+ * @param ObjectInitializer Reference to object initialization parameters
+ *
+ * @note Defaults to a 10 x 5 wall of 60 x 24 unit bricks with one hit point each, regenerating bricks
+ * healing every 2 seconds and explosions dealing one hit point
+ */
+UBBCBrickFieldComponent::UBBCBrickFieldComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer),
+	Columns(10),
+	Rows(5),
+	BrickSize(60.f, 24.f),
+	DefaultHitPoints(1),
+	RegenSeconds(2.f),
+	ExplosionDamage(1),
+	NumAlive(0)
+{
+	SetMobility(EComponentMobility::Movable);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetSimulatePhysics(false);
+	SetCastShadow(false);
+}
+
+/**
+ * @brief Fills the grid with live bricks of DefaultHitPoints and creates one instance per brick.
+ */
+void UBBCBrickFieldComponent::BuildField()
+{
+	TArray<uint8> HitPoints;
+	HitPoints.Init(DefaultHitPoints, GetNumCells());
+	Grid.Init(Columns, Rows, HitPoints.GetData(), nullptr);
+	RebuildInstances();
+}
+
+/**
+ * @brief Replaces the wall with a cooked level.
+ *
+ * The hit points and brick kinds are copied straight from the level blob.
+ *
+ * @param Layout A valid cooked level.
+ */
+void UBBCBrickFieldComponent::ApplyLayout(const FBBCLevelLayout& Layout)
+{
+	Columns = Layout.GetHeader().Columns;
+	Rows = Layout.GetHeader().Rows;
+	BrickSize = Layout.GetBrickSize();
+	Grid.Init(Columns, Rows, Layout.GetHitPoints(), Layout.GetKinds());
+	RebuildInstances();
+}
+
+/**
+ * @brief Derives the alive bits from the hit points and creates one instance per live brick.
+ *
+ * Hit points, alive bits and the cell to instance maps are sized once here; breaking bricks later never
+ * grows or shrinks them. The whole field is published as restored, since any empty cell may be filled again.
+ */
+void UBBCBrickFieldComponent::RebuildInstances()
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_BrickUpdate);
+	const int32 NumCells = GetNumCells();
+
+	ClearInstances();
+	PendingInstanceRemovals.Reset();
+	Grid.RegenSeconds = RegenSeconds;
+	Grid.ExplosionDamage = ExplosionDamage;
+	AliveBits.Init(false, NumCells);
+	CellToInstance.Init(INDEX_NONE, NumCells);
+	InstanceToCell.Reset(NumCells);
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(NumCells);
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		if (Grid.GetHitPoints(Cell) == 0)
+		{
+			continue;
+		}
+		AliveBits[Cell] = true;
+		CellToInstance[Cell] = InstanceToCell.Add(Cell);
+		Transforms.Add(GetCellTransform(Cell));
+	}
+	AddInstances(Transforms, false);
+	NumAlive = Transforms.Num();
+	BBC_SET_DWORD_STAT(STAT_BBC_LiveBricks, NumAlive);
+
+	if (NumAlive > 0)
+	{
+		PublishRestored(GetFieldBox());
+	}
+}
+
+/**
+ * @brief Tells listeners that bricks appeared in an area, so cached paths through it are recomputed.
+ *
+ * @param Area Area covered by the restored bricks.
+ */
+void UBBCBrickFieldComponent::PublishRestored(const FBox2D& Area) const
+{
+	const UWorld* World = GetWorld();
+	if (const UBBCGameEventSubsystem* GameEvents = World != nullptr ? World->GetSubsystem<UBBCGameEventSubsystem>() : nullptr)
+	{
+		GameEvents->Publish(FBBCBricksRestoredEvent{Area});
+	}
+}
+
+/**
+ * @brief Replaces the drawn bricks with a recorded set of live cells.
+ *
+ * Instances are rebuilt only when the set differs, which during playback is a handful of frames per second.
+ * Cells that come back to life are published as restored.
+ *
+ * @param Cells Alive bit of every cell, for a wall of the current size.
+ *
+ * @return False if Cells is for a wall of another size.
+ */
+bool UBBCBrickFieldComponent::ShowCells(const TBitArray<>& Cells)
+{
+	if (Cells.Num() != GetNumCells())
+	{
+		return false;
+	}
+	if (Cells == AliveBits)
+	{
+		return true;
+	}
+
+	FBox2D Restored(ForceInit);
+	for (TConstSetBitIterator<> It(Cells); It; ++It)
+	{
+		if (!AliveBits.IsValidIndex(It.GetIndex()) || !AliveBits[It.GetIndex()])
+		{
+			Restored += GetCellBox(It.GetIndex());
+		}
+	}
+
+	ClearInstances();
+	PendingInstanceRemovals.Reset();
+	AliveBits = Cells;
+	CellToInstance.Init(INDEX_NONE, Cells.Num());
+	InstanceToCell.Reset(Cells.Num());
+
+	TArray<FTransform> Transforms;
+	for (TConstSetBitIterator<> It(AliveBits); It; ++It)
+	{
+		CellToInstance[It.GetIndex()] = InstanceToCell.Add(It.GetIndex());
+		Transforms.Add(GetCellTransform(It.GetIndex()));
+	}
+	AddInstances(Transforms, false);
+	NumAlive = Transforms.Num();
+
+	if (Restored.bIsValid)
+	{
+		PublishRestored(Restored);
+	}
+	return true;
+}
+
+/**
+ * @brief Sweeps a ball against the live bricks overlapped by its swept bounds.
+ *
+ * The swept bounds grown by the radius are converted to a range of grid cells and only those cells are
+ * tested, so a ball costs the same against a 10 x 5 wall as against a 200 x 100 one. The live cells in range
+ * are gathered relative to the ball and tested four at a time by the batched kernel.
+ *
+ * @param Start Ball centre at the beginning of the sweep, in world space.
+ * @param Delta Ball displacement for the sweep.
+ * @param Radius Ball radius.
+ * @param OutTime Fraction of Delta at which the first brick is touched.
+ * @param OutNormal Surface normal at the contact.
+ * @param OutCell Cell of the brick that was touched.
+ *
+ * @return true if the ball touches a live brick during the sweep.
+ */
+bool UBBCBrickFieldComponent::SweepBall(const FVector2D& Start, const FVector2D& Delta, double Radius, double& OutTime,
+	FVector2D& OutNormal, int32& OutCell) const
+{
+	if (NumAlive == 0)
+	{
+		return false;
+	}
+
+	const FVector Location = GetComponentLocation();
+	const FVector2D Origin(Location.X, Location.Y);
+	const FVector2D End = Start + Delta;
+	const FVector2D SweepMin = FVector2D(FMath::Min(Start.X, End.X), FMath::Min(Start.Y, End.Y)) - FVector2D(Radius, Radius) - Origin;
+	const FVector2D SweepMax = FVector2D(FMath::Max(Start.X, End.X), FMath::Max(Start.Y, End.Y)) + FVector2D(Radius, Radius) - Origin;
+	if (SweepMax.X < 0.0 || SweepMax.Y < 0.0 || SweepMin.X >= Columns * BrickSize.X || SweepMin.Y >= Rows * BrickSize.Y)
+	{
+		return false;
+	}
+
+	const int32 FirstColumn = FMath::Max(FMath::FloorToInt32(SweepMin.X / BrickSize.X), 0);
+	const int32 LastColumn = FMath::Min(FMath::FloorToInt32(SweepMax.X / BrickSize.X), Columns - 1);
+	const int32 FirstRow = FMath::Max(FMath::FloorToInt32(SweepMin.Y / BrickSize.Y), 0);
+	const int32 LastRow = FMath::Min(FMath::FloorToInt32(SweepMax.Y / BrickSize.Y), Rows - 1);
+
+	SweepCandidates.Reset();
+	for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+	{
+		for (int32 Column = FirstColumn; Column <= LastColumn; ++Column)
+		{
+			const int32 Cell = Row * Columns + Column;
+			if (AliveBits[Cell])
+			{
+				SweepCandidates.Add(GetCellBox(Cell), Start, Cell);
+			}
+		}
+	}
+	if (SweepCandidates.Num() == 0)
+	{
+		return false;
+	}
+	SweepCandidates.Finalize();
+
+	const FVector2f SweepDelta(Delta);
+	const float SweepRadius = static_cast<float>(Radius);
+	FBBCBatchHit Hit;
+	const bool bFoundHit = CVarBrickVectorKernel.GetValueOnGameThread()
+		? BBCCollision::SweepCircleBoxBatch(SweepDelta, SweepRadius, SweepCandidates, Hit)
+		: BBCCollision::SweepCircleBoxBatchScalar(SweepDelta, SweepRadius, SweepCandidates, Hit);
+	if (!bFoundHit)
+	{
+		return false;
+	}
+
+	OutTime = Hit.Time;
+	OutNormal = FVector2D(Hit.Normal).GetSafeNormal();
+	OutCell = Hit.Id;
+	return true;
+}
+
+/**
+ * @brief Removes hit points from a brick and destroys it once it runs out.
+ *
+ * @param Cell Cell of the brick that was hit.
+ * @param Damage Hit points to remove.
+ *
+ * @return true if the brick was destroyed by this hit.
+ */
+bool UBBCBrickFieldComponent::DamageCell(int32 Cell, uint8 Damage)
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_BrickUpdate);
+	if (!IsCellAlive(Cell))
+	{
+		return false;
+	}
+
+	if (!Grid.Damage(Cell, Damage))
+	{
+		return false;
+	}
+	DestroyCell(Cell);
+	return true;
+}
+
+/**
+ * @brief Clears a brick's alive bit and queues its instance for removal.
+ *
+ * The brick stops colliding at once; its instance goes with the next FlushRemovedInstances, so a frame
+ * that breaks many bricks only touches the instance tree once.
+ *
+ * @param Cell Cell of the brick to destroy.
+ */
+void UBBCBrickFieldComponent::DestroyCell(int32 Cell)
+{
+	AliveBits[Cell] = false;
+	--NumAlive;
+	PendingInstanceRemovals.Add(CellToInstance[Cell]);
+	BBC_SET_DWORD_STAT(STAT_BBC_LiveBricks, NumAlive);
+}
+
+/**
+ * @brief Advances explosions and regeneration, then applies the removed instances.
+ *
+ * Bricks broken by the wave are destroyed here on the game thread, in the grid's deterministic order, and
+ * published to UBBCGameEventSubsystem like bricks broken by a ball.
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ */
+void UBBCBrickFieldComponent::UpdateField(float DeltaTime)
+{
+	if (Grid.HasPendingWork())
+	{
+		BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_BrickUpdate);
+		const int32 Workers = CVarBrickWorkers.GetValueOnGameThread();
+		Grid.Update(DeltaTime, Workers > 0 ? Workers : FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1), GridDestroyed);
+
+		const UBBCGameEventSubsystem* GameEvents = GridDestroyed.Num() > 0 ? GetWorld()->GetSubsystem<UBBCGameEventSubsystem>() : nullptr;
+		for (const int32 Cell : GridDestroyed)
+		{
+			DestroyCell(Cell);
+			if (GameEvents != nullptr)
+			{
+				const FBox2D Box = GetCellBox(Cell);
+				GameEvents->Publish(FBBCBrickDestroyedEvent{Cell, Box.GetCenter(), Box});
+			}
+		}
+	}
+	FlushRemovedInstances();
+}
+
+/**
+ * @brief Removes the instances of the bricks destroyed since the last call.
+ *
+ * The hierarchical instanced mesh removes a batch from the highest index down, swapping the last instance
+ * into each freed slot. The cell maps are patched in the same order so every cell keeps pointing at the
+ * instance that draws it.
+ */
+void UBBCBrickFieldComponent::FlushRemovedInstances()
+{
+	if (PendingInstanceRemovals.Num() == 0)
+	{
+		return;
+	}
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_BrickUpdate);
+
+	PendingInstanceRemovals.Sort(TGreater<int32>());
+	int32 LastInstanceIndex = GetInstanceCount() - 1;
+	for (const int32 InstanceIndex : PendingInstanceRemovals)
+	{
+		CellToInstance[InstanceToCell[InstanceIndex]] = INDEX_NONE;
+		if (InstanceIndex != LastInstanceIndex)
+		{
+			const int32 MovedCell = InstanceToCell[LastInstanceIndex];
+			CellToInstance[MovedCell] = InstanceIndex;
+			InstanceToCell[InstanceIndex] = MovedCell;
+		}
+		InstanceToCell[LastInstanceIndex] = INDEX_NONE;
+		--LastInstanceIndex;
+	}
+	RemoveInstances(PendingInstanceRemovals);
+	PendingInstanceRemovals.Reset();
+}
+
+FBox2D UBBCBrickFieldComponent::GetCellBox(int32 Cell) const
+{
+	const FVector Location = GetComponentLocation();
+	const FVector2D Min(Location.X + (Cell % Columns) * BrickSize.X, Location.Y + (Cell / Columns) * BrickSize.Y);
+	return FBox2D(Min, Min + BrickSize);
+}
+
+FBox2D UBBCBrickFieldComponent::GetFieldBox() const
+{
+	const FVector Location = GetComponentLocation();
+	const FVector2D Min(Location.X, Location.Y);
+	return FBox2D(Min, Min + FVector2D(Columns * BrickSize.X, Rows * BrickSize.Y));
+}
+
+/**
+ * @brief Returns the local transform of the instance drawn for a cell.
+ *
+ * The mesh is centred in the cell and scaled so its XY bounds fill the cell.
+ *
+ * @param Cell Cell to place.
+ *
+ * @return Transform relative to this component.
+ */
+FTransform UBBCBrickFieldComponent::GetCellTransform(int32 Cell) const
+{
+	const FVector2D Centre((Cell % Columns + 0.5) * BrickSize.X, (Cell / Columns + 0.5) * BrickSize.Y);
+
+	FVector Scale = FVector::OneVector;
+	if (const UStaticMesh* BrickMesh = GetStaticMesh())
+	{
+		const FVector MeshSize = BrickMesh->GetBounds().BoxExtent * 2.0;
+		Scale.X = MeshSize.X > 0.0 ? BrickSize.X / MeshSize.X : 1.0;
+		Scale.Y = MeshSize.Y > 0.0 ? BrickSize.Y / MeshSize.Y : 1.0;
+		Scale.Z = FMath::Min(Scale.X, Scale.Y);
+	}
+	return FTransform(FQuat::Identity, FVector(Centre, 0.0), Scale);
+}
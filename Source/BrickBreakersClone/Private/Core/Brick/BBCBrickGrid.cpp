@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Brick/BBCBrickGrid.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "Tasks/Task.h"
+
+namespace
+{
+	/**
+	 * @brief Builds a random wall with explosive and regenerating bricks and sets a few explosions off.
+	 */
+	void InitBenchGrid(FBBCBrickGrid& Grid, int32 Columns, int32 Rows)
+	{
+		FRandomStream Stream(Columns * 7919 + Rows);
+		const int32 NumCells = Columns * Rows;
+		TArray<uint8> HitPoints;
+		TArray<uint8> Kinds;
+		HitPoints.SetNumUninitialized(NumCells);
+		Kinds.SetNumUninitialized(NumCells);
+		for (int32 Cell = 0; Cell < NumCells; ++Cell)
+		{
+			HitPoints[Cell] = static_cast<uint8>(Stream.RandRange(1, 3));
+			const float Roll = Stream.FRand();
+			Kinds[Cell] = static_cast<uint8>(Roll < 0.3f ? EBBCBrickKind::Explosive : Roll < 0.5f ? EBBCBrickKind::Regenerating : EBBCBrickKind::Normal);
+		}
+		Grid.Init(Columns, Rows, HitPoints.GetData(), Kinds.GetData());
+		for (int32 Detonation = 0; Detonation < 64; ++Detonation)
+		{
+			Grid.Damage(Stream.RandRange(0, NumCells - 1), MAX_uint8);
+		}
+	}
+
+	/**
+	 * @brief Times the brick update on a large wall for 1 to N workers and checks every run ends identical.
+	 *
+	 * Usage: BBC.Bricks.BenchUpdate [Columns] [Rows] [Waves]
+	 */
+	FAutoConsoleCommand BenchUpdateCommand(
+		TEXT("BBC.Bricks.BenchUpdate"),
+		TEXT("Times the parallel brick update from 1 to N workers. Usage: BBC.Bricks.BenchUpdate [Columns] [Rows] [Waves]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const int32 Columns = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1024;
+			const int32 Rows = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 512;
+			const int32 Waves = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 120;
+			const int32 MaxWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+
+			TArray<int32> WorkerCounts;
+			for (int32 NumWorkers = 1; NumWorkers < MaxWorkers; NumWorkers *= 2)
+			{
+				WorkerCounts.Add(NumWorkers);
+			}
+			WorkerCounts.Add(MaxWorkers);
+
+			FBBCBrickGrid Grid;
+			TArray<int32> Destroyed;
+			double SingleWorkerMs = 0.0;
+			uint32 ReferenceChecksum = 0;
+			for (const int32 NumWorkers : WorkerCounts)
+			{
+				InitBenchGrid(Grid, Columns, Rows);
+				int64 NumDestroyed = 0;
+				const double Start = FPlatformTime::Seconds();
+				for (int32 Wave = 0; Wave < Waves; ++Wave)
+				{
+					Grid.Update(1.f / 60.f, NumWorkers, Destroyed);
+					NumDestroyed += Destroyed.Num();
+				}
+				const double Ms = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+				const uint32 Checksum = Grid.GetChecksum();
+				if (NumWorkers == 1)
+				{
+					SingleWorkerMs = Ms;
+					ReferenceChecksum = Checksum;
+				}
+				UE_LOG(LogTemp, Display, TEXT("Brick update bench: %dx%d, %d workers, %.3f ms per wave, speedup %.2fx, %lld destroyed, %s"),
+					Columns, Rows, NumWorkers, Ms / Waves, Ms > 0.0 ? SingleWorkerMs / Ms : 0.0, NumDestroyed,
+					Checksum == ReferenceChecksum ? TEXT("deterministic") : TEXT("MISMATCH"));
+			}
+		}));
+}
+
+/**
+ * @brief Sizes the grid for a new wall.
+ *
+ * @param InColumns Number of columns.
+ * @param InRows Number of rows.
+ * @param InHitPoints Columns * Rows starting hit points; zero is an empty cell.
+ * @param InKinds Columns * Rows EBBCBrickKind values, or null.
+ */
+void FBBCBrickGrid::Init(int32 InColumns, int32 InRows, const uint8* InHitPoints, const uint8* InKinds)
+{
+	Columns = InColumns;
+	Rows = InRows;
+	TilesX = FMath::DivideAndRoundUp(Columns, TileSize);
+	NumTiles = TilesX * FMath::DivideAndRoundUp(Rows, TileSize);
+	const int32 NumCells = Columns * Rows;
+
+	HitPoints.SetNumUninitialized(NumCells);
+	FMemory::Memcpy(HitPoints.GetData(), InHitPoints, NumCells);
+	MaxHitPoints = HitPoints;
+	NextHitPoints.SetNumUninitialized(NumCells);
+	Detonating.SetNumZeroed(NumCells);
+	NextDetonating.SetNumZeroed(NumCells);
+	RegenTimers.SetNumZeroed(NumCells);
+
+	Kinds.SetNumZeroed(NumCells);
+	if (InKinds != nullptr)
+	{
+		FMemory::Memcpy(Kinds.GetData(), InKinds, NumCells);
+	}
+	// Every brick starts at full health, so none is regenerating yet.
+	NumRegenerating = 0;
+	NumDetonating = 0;
+
+	TileDestroyed.SetNum(NumTiles);
+	for (TArray<int32>& Destroyed : TileDestroyed)
+	{
+		Destroyed.Reset();
+	}
+	TileRegenDelta.SetNumZeroed(NumTiles);
+}
+
+/**
+ * @brief Applies ball damage on the game thread. A destroyed explosive brick detonates on the next wave.
+ *
+ * @param Cell The brick that was hit.
+ * @param Amount Hit points to remove.
+ *
+ * @return true if the brick was destroyed by this hit.
+ */
+bool FBBCBrickGrid::Damage(int32 Cell, uint8 Amount)
+{
+	if (!HitPoints.IsValidIndex(Cell) || HitPoints[Cell] == 0)
+	{
+		return false;
+	}
+
+	const uint8 Current = HitPoints[Cell];
+	HitPoints[Cell] = Current > Amount ? Current - Amount : 0;
+	if (Kinds[Cell] == static_cast<uint8>(EBBCBrickKind::Regenerating))
+	{
+		NumRegenerating += IsHealing(Cell, HitPoints[Cell]) - IsHealing(Cell, Current);
+	}
+	if (HitPoints[Cell] > 0)
+	{
+		return false;
+	}
+	if (Kinds[Cell] == static_cast<uint8>(EBBCBrickKind::Explosive))
+	{
+		Detonating[Cell] = 1;
+		++NumDetonating;
+	}
+	return true;
+}
+
+/**
+ * @brief Runs one wave over every tile and swaps the buffers.
+ *
+ * Tiles are dealt round robin to NumWorkers tasks, and the game thread waits for all of them. The merge
+ * afterwards walks the tiles in order, so OutDestroyed does not depend on which task finished first.
+ */
+void FBBCBrickGrid::Update(float DeltaTime, int32 NumWorkers, TArray<int32>& OutDestroyed)
+{
+	OutDestroyed.Reset();
+	if (NumTiles == 0)
+	{
+		return;
+	}
+
+	NumWorkers = FMath::Clamp(NumWorkers, 1, NumTiles);
+	if (NumWorkers == 1)
+	{
+		for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+		{
+			UpdateTile(Tile, DeltaTime);
+		}
+	}
+	else
+	{
+		TArray<UE::Tasks::FTask, TInlineAllocator<32>> Workers;
+		for (int32 Worker = 0; Worker < NumWorkers; ++Worker)
+		{
+			Workers.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Worker, NumWorkers, DeltaTime]()
+			{
+				for (int32 Tile = Worker; Tile < NumTiles; Tile += NumWorkers)
+				{
+					UpdateTile(Tile, DeltaTime);
+				}
+			}));
+		}
+		UE::Tasks::Wait(Workers);
+	}
+
+	Swap(HitPoints, NextHitPoints);
+	Swap(Detonating, NextDetonating);
+
+	NumDetonating = 0;
+	for (TArray<int32>& Destroyed : TileDestroyed)
+	{
+		for (const int32 Cell : Destroyed)
+		{
+			NumDetonating += Detonating[Cell];
+		}
+		OutDestroyed.Append(Destroyed);
+		Destroyed.Reset();
+	}
+	for (int32& Delta : TileRegenDelta)
+	{
+		NumRegenerating += Delta;
+		Delta = 0;
+	}
+}
+
+uint32 FBBCBrickGrid::GetChecksum() const
+{
+	return FCrc::MemCrc32(HitPoints.GetData(), HitPoints.Num());
+}
+
+/**
+ * @brief Computes the next state of every cell in a tile.
+ *
+ * - A live brick next to bricks that detonated last wave loses ExplosionDamage per detonation
+ * - Otherwise a damaged regenerating brick heals one hit point every RegenSeconds
+ * - A brick reaching zero hit points is recorded as destroyed, and detonates next wave if explosive
+ *
+ * @param Tile Index of the tile, row major.
+ * @param DeltaTime Time since the last wave.
+ */
+void FBBCBrickGrid::UpdateTile(int32 Tile, float DeltaTime)
+{
+	const int32 FirstColumn = (Tile % TilesX) * TileSize;
+	const int32 FirstRow = (Tile / TilesX) * TileSize;
+	const int32 LastColumn = FMath::Min(FirstColumn + TileSize, Columns) - 1;
+	const int32 LastRow = FMath::Min(FirstRow + TileSize, Rows) - 1;
+	TArray<int32>& Destroyed = TileDestroyed[Tile];
+
+	for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+	{
+		for (int32 Column = FirstColumn; Column <= LastColumn; ++Column)
+		{
+			const int32 Cell = Row * Columns + Column;
+			const uint8 Current = HitPoints[Cell];
+			NextDetonating[Cell] = 0;
+			if (Current == 0)
+			{
+				NextHitPoints[Cell] = 0;
+				continue;
+			}
+
+			int32 Blast = 0;
+			if (NumDetonating > 0)
+			{
+				for (int32 NeighbourRow = FMath::Max(Row - 1, 0); NeighbourRow <= FMath::Min(Row + 1, Rows - 1); ++NeighbourRow)
+				{
+					for (int32 NeighbourColumn = FMath::Max(Column - 1, 0); NeighbourColumn <= FMath::Min(Column + 1, Columns - 1); ++NeighbourColumn)
+					{
+						Blast += Detonating[NeighbourRow * Columns + NeighbourColumn];
+					}
+				}
+			}
+
+			uint8 Next = Current;
+			const uint8 Kind = Kinds[Cell];
+			if (Blast > 0)
+			{
+				const int32 Damage = Blast * ExplosionDamage;
+				Next = Current > Damage ? static_cast<uint8>(Current - Damage) : 0;
+			}
+			else if (Kind == static_cast<uint8>(EBBCBrickKind::Regenerating) && Current < MaxHitPoints[Cell])
+			{
+				RegenTimers[Cell] += DeltaTime;
+				if (RegenTimers[Cell] >= RegenSeconds)
+				{
+					RegenTimers[Cell] -= RegenSeconds;
+					Next = Current + 1;
+				}
+			}
+
+			NextHitPoints[Cell] = Next;
+			if (Kind == static_cast<uint8>(EBBCBrickKind::Regenerating))
+			{
+				TileRegenDelta[Tile] += IsHealing(Cell, Next) - IsHealing(Cell, Current);
+			}
+			if (Next == 0)
+			{
+				NextDetonating[Cell] = Kind == static_cast<uint8>(EBBCBrickKind::Explosive) ? 1 : 0;
+				Destroyed.Add(Cell);
+			}
+		}
+	}
+}
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Collision/BBCCollision.h"
+
+namespace BBCCollision
+{
+	/**
+	 * @brief Finds the first time a moving point enters a circle.
+	 *
+	 * Solves |Start + Delta * t - Center|^2 = Radius^2 for the smallest root in [0, 1].
+	 *
+	 * @return true if the point enters the circle during the sweep.
+	 */
+	static bool SweepPointCircle(const FVector2D& Start, const FVector2D& Delta, const FVector2D& Center, double Radius, double& OutTime)
+	{
+		const FVector2D Offset = Start - Center;
+		const double A = FVector2D::DotProduct(Delta, Delta);
+		const double B = FVector2D::DotProduct(Offset, Delta);
+		const double C = FVector2D::DotProduct(Offset, Offset) - Radius * Radius;
+		if (A <= UE_DOUBLE_SMALL_NUMBER || B >= 0.0)
+		{
+			return false;
+		}
+		const double Discriminant = B * B - A * C;
+		if (Discriminant < 0.0)
+		{
+			return false;
+		}
+		const double Time = (-B - FMath::Sqrt(Discriminant)) / A;
+		if (Time < 0.0 || Time > 1.0)
+		{
+			return false;
+		}
+		OutTime = Time;
+		return true;
+	}
+}
+
+/**
+ * @brief Sweeps a circle along a delta and reports the first contact with an axis aligned box.
+ *
+ * The test runs a slab test against the box grown by the radius. If the entry point lands in one of the
+ * grown corners, the result is refined against the rounded corner so the normal points away from the corner.
+ *
+ * @param Start Circle centre at the beginning of the sweep.
+ * @param Delta Full displacement for the sweep.
+ * @param Radius Circle radius.
+ * @param Box Box to test against.
+ * @param OutTime Fraction of Delta at which contact happens.
+ * @param OutNormal Surface normal at the contact point.
+ *
+ * @return true if the circle touches the box during the sweep.
+ *
+ * @note Only doubles and a fixed sequence of operations are used, so the same inputs always give the same bits.
+ */
+bool BBCCollision::SweepCircleAABB(const FVector2D& Start, const FVector2D& Delta, double Radius, const FBox2D& Box,
+	double& OutTime, FVector2D& OutNormal)
+{
+	const FVector2D GrownMin = Box.Min - FVector2D(Radius, Radius);
+	const FVector2D GrownMax = Box.Max + FVector2D(Radius, Radius);
+
+	double EnterTime = -UE_DOUBLE_BIG_NUMBER;
+	double ExitTime = UE_DOUBLE_BIG_NUMBER;
+	FVector2D EnterNormal = FVector2D::ZeroVector;
+
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		const double Origin = Start[Axis];
+		const double Step = Delta[Axis];
+		if (FMath::Abs(Step) <= UE_DOUBLE_SMALL_NUMBER)
+		{
+			if (Origin <= GrownMin[Axis] || Origin >= GrownMax[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const double InvStep = 1.0 / Step;
+		double Near = (GrownMin[Axis] - Origin) * InvStep;
+		double Far = (GrownMax[Axis] - Origin) * InvStep;
+		double Sign = -1.0;
+		if (Near > Far)
+		{
+			Swap(Near, Far);
+			Sign = 1.0;
+		}
+		if (Near > EnterTime)
+		{
+			EnterTime = Near;
+			EnterNormal = FVector2D::ZeroVector;
+			EnterNormal[Axis] = Sign;
+		}
+		ExitTime = FMath::Min(ExitTime, Far);
+		if (EnterTime > ExitTime)
+		{
+			return false;
+		}
+	}
+
+	if (EnterTime < 0.0 || EnterTime > 1.0)
+	{
+		return false;
+	}
+
+	const FVector2D Contact = Start + Delta * EnterTime;
+	const bool bOutsideX = Contact.X < Box.Min.X || Contact.X > Box.Max.X;
+	const bool bOutsideY = Contact.Y < Box.Min.Y || Contact.Y > Box.Max.Y;
+	if (bOutsideX && bOutsideY)
+	{
+		const FVector2D Corner(Contact.X < Box.Min.X ? Box.Min.X : Box.Max.X, Contact.Y < Box.Min.Y ? Box.Min.Y : Box.Max.Y);
+		double CornerTime = 0.0;
+		if (!SweepPointCircle(Start, Delta, Corner, Radius, CornerTime))
+		{
+			return false;
+		}
+		OutTime = CornerTime;
+		OutNormal = (Start + Delta * CornerTime - Corner).GetSafeNormal();
+		return true;
+	}
+
+	OutTime = EnterTime;
+	OutNormal = EnterNormal;
+	return true;
+}
@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Collision/BBCCollisionBatch.h"
+
+#include "Core/Collision/BBCCollision.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	/** Coordinate used for padding boxes; far enough that the slab test always misses. */
+	constexpr float PaddingCoordinate = 1.0e20f;
+	/** Delta components smaller than this are replaced by it, so parallel sweeps never divide by zero. */
+	constexpr float MinDeltaComponent = 1.0e-6f;
+	constexpr float MissTime = 2.f;
+
+	/**
+	 * @brief Cross-checks the vector and scalar kernels on random walls.
+	 *
+	 * Usage: BBC.Collision.VerifyKernel [Iterations] [Seed]
+	 */
+	FAutoConsoleCommand VerifyKernelCommand(
+		TEXT("BBC.Collision.VerifyKernel"),
+		TEXT("Runs random sweeps through the vector and scalar brick kernels and fails on any disagreement. Usage: BBC.Collision.VerifyKernel [Iterations] [Seed]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const int32 Iterations = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000;
+			const int32 Seed = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0;
+			int32 Hits = 0;
+			const int32 Mismatches = BBCCollision::VerifyBoxBatchKernel(Iterations, Seed, Hits);
+			UE_LOG(LogTemp, Display, TEXT("Brick kernel verify: %d sweeps, %d hits, %d mismatches"), Iterations, Hits, Mismatches);
+			ensureMsgf(Mismatches == 0, TEXT("Vector brick kernel disagrees with the scalar kernel on %d of %d sweeps (seed %d)"), Mismatches, Iterations, Seed);
+		}));
+
+	/**
+	 * @brief Times the vector and scalar kernels against a dense wall.
+	 *
+	 * Usage: BBC.Collision.BenchKernel [Boxes] [Iterations]
+	 */
+	FAutoConsoleCommand BenchKernelCommand(
+		TEXT("BBC.Collision.BenchKernel"),
+		TEXT("Times the vector and scalar brick kernels against a dense wall. Usage: BBC.Collision.BenchKernel [Boxes] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const int32 NumBoxes = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 64;
+			const int32 Iterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100000;
+			const int32 Columns = FMath::Max(FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumBoxes))), 1);
+
+			FBBCBoxBatch Boxes;
+			for (int32 BoxIndex = 0; BoxIndex < NumBoxes; ++BoxIndex)
+			{
+				const FVector2D Min((BoxIndex % Columns) * 60.0 - Columns * 30.0, (BoxIndex / Columns) * 24.0 - Columns * 12.0);
+				Boxes.Add(FBox2D(Min, Min + FVector2D(60.0, 24.0)), FVector2D::ZeroVector, BoxIndex);
+			}
+			Boxes.Finalize();
+
+			FRandomStream Stream(0);
+			TArray<FVector2f> Deltas;
+			Deltas.SetNumUninitialized(1024);
+			for (FVector2f& Delta : Deltas)
+			{
+				Delta = FVector2f(Stream.FRandRange(-80.f, 80.f), Stream.FRandRange(-80.f, 80.f));
+			}
+
+			int32 Checksum = 0;
+			FBBCBatchHit Hit;
+			const double VectorStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Checksum += BBCCollision::SweepCircleBoxBatch(Deltas[Iteration & 1023], 15.f, Boxes, Hit) ? Hit.Id : 0;
+			}
+			const double ScalarStart = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Checksum -= BBCCollision::SweepCircleBoxBatchScalar(Deltas[Iteration & 1023], 15.f, Boxes, Hit) ? Hit.Id : 0;
+			}
+			const double ScalarEnd = FPlatformTime::Seconds();
+
+			const double VectorNs = (ScalarStart - VectorStart) * 1.0e9 / Iterations;
+			const double ScalarNs = (ScalarEnd - ScalarStart) * 1.0e9 / Iterations;
+			UE_LOG(LogTemp, Display, TEXT("Brick kernel bench: %d boxes, vector %.1f ns, scalar %.1f ns per sweep, speedup %.2fx (checksum %d)"),
+				NumBoxes, VectorNs, ScalarNs, VectorNs > 0.0 ? ScalarNs / VectorNs : 0.0, Checksum);
+		}));
+}
+
+void FBBCBoxBatch::Reset()
+{
+	MinX.Reset();
+	MinY.Reset();
+	MaxX.Reset();
+	MaxY.Reset();
+	Ids.Reset();
+}
+
+void FBBCBoxBatch::Add(const FBox2D& Box, const FVector2D& Origin, int32 Id)
+{
+	MinX.Add(static_cast<float>(Box.Min.X - Origin.X));
+	MinY.Add(static_cast<float>(Box.Min.Y - Origin.Y));
+	MaxX.Add(static_cast<float>(Box.Max.X - Origin.X));
+	MaxY.Add(static_cast<float>(Box.Max.Y - Origin.Y));
+	Ids.Add(Id);
+}
+
+void FBBCBoxBatch::Finalize()
+{
+	while (MinX.Num() % LaneCount != 0)
+	{
+		MinX.Add(PaddingCoordinate);
+		MinY.Add(PaddingCoordinate);
+		MaxX.Add(PaddingCoordinate);
+		MaxY.Add(PaddingCoordinate);
+	}
+}
+
+/**
+ * @brief Sweeps a circle starting at the batch origin against four boxes per iteration.
+ *
+ * For each lane the box is grown by the radius and a slab test gives the entry time and face. If the entry
+ * point lies in a grown corner, the entry is replaced by the circle versus corner solution. Both answers are
+ * computed for every lane and picked with masks. Lane results are stored and reduced in box order, so ties
+ * resolve exactly as in the scalar reference.
+ *
+ * @param Delta Displacement of the circle for the sweep.
+ * @param Radius Circle radius.
+ * @param Boxes Finalized batch of boxes relative to the circle start.
+ * @param OutHit Earliest contact and the id of the box hit.
+ *
+ * @return true if any box is touched during the sweep.
+ */
+bool BBCCollision::SweepCircleBoxBatch(const FVector2f& Delta, float Radius, const FBBCBoxBatch& Boxes, FBBCBatchHit& OutHit)
+{
+	const float SafeDeltaX = FMath::Abs(Delta.X) < MinDeltaComponent ? MinDeltaComponent : Delta.X;
+	const float SafeDeltaY = FMath::Abs(Delta.Y) < MinDeltaComponent ? MinDeltaComponent : Delta.Y;
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Miss = VectorSetFloat1(MissTime);
+	const VectorRegister4Float RadiusV = VectorSetFloat1(Radius);
+	const VectorRegister4Float RadiusSquared = VectorSetFloat1(Radius * Radius);
+	const VectorRegister4Float DeltaX = VectorSetFloat1(Delta.X);
+	const VectorRegister4Float DeltaY = VectorSetFloat1(Delta.Y);
+	const VectorRegister4Float InvDeltaX = VectorSetFloat1(1.f / SafeDeltaX);
+	const VectorRegister4Float InvDeltaY = VectorSetFloat1(1.f / SafeDeltaY);
+	const VectorRegister4Float DeltaLengthSquared = VectorSetFloat1(Delta.X * Delta.X + Delta.Y * Delta.Y);
+	const VectorRegister4Float FaceNormalX = VectorSetFloat1(SafeDeltaX > 0.f ? -1.f : 1.f);
+	const VectorRegister4Float FaceNormalY = VectorSetFloat1(SafeDeltaY > 0.f ? -1.f : 1.f);
+
+	alignas(16) float LaneTimes[FBBCBoxBatch::LaneCount];
+	alignas(16) float LaneNormalX[FBBCBoxBatch::LaneCount];
+	alignas(16) float LaneNormalY[FBBCBoxBatch::LaneCount];
+
+	bool bFoundHit = false;
+	OutHit.Time = 1.f;
+	for (int32 First = 0; First < Boxes.NumPadded(); First += FBBCBoxBatch::LaneCount)
+	{
+		const VectorRegister4Float MinX = VectorLoadAligned(&Boxes.MinX[First]);
+		const VectorRegister4Float MinY = VectorLoadAligned(&Boxes.MinY[First]);
+		const VectorRegister4Float MaxX = VectorLoadAligned(&Boxes.MaxX[First]);
+		const VectorRegister4Float MaxY = VectorLoadAligned(&Boxes.MaxY[First]);
+
+		const VectorRegister4Float NearX0 = VectorMultiply(VectorSubtract(MinX, RadiusV), InvDeltaX);
+		const VectorRegister4Float FarX0 = VectorMultiply(VectorAdd(MaxX, RadiusV), InvDeltaX);
+		const VectorRegister4Float NearY0 = VectorMultiply(VectorSubtract(MinY, RadiusV), InvDeltaY);
+		const VectorRegister4Float FarY0 = VectorMultiply(VectorAdd(MaxY, RadiusV), InvDeltaY);
+		const VectorRegister4Float NearX = VectorMin(NearX0, FarX0);
+		const VectorRegister4Float FarX = VectorMax(NearX0, FarX0);
+		const VectorRegister4Float NearY = VectorMin(NearY0, FarY0);
+		const VectorRegister4Float FarY = VectorMax(NearY0, FarY0);
+
+		const VectorRegister4Float EnterTime = VectorMax(NearX, NearY);
+		const VectorRegister4Float ExitTime = VectorMin(FarX, FarY);
+		const VectorRegister4Float EnterOnX = VectorCompareGT(NearX, NearY);
+		VectorRegister4Float Valid = VectorBitwiseAnd(VectorCompareLE(EnterTime, ExitTime),
+			VectorBitwiseAnd(VectorCompareGE(EnterTime, Zero), VectorCompareLE(EnterTime, One)));
+		if (VectorMaskBits(Valid) == 0)
+		{
+			continue;
+		}
+
+		const VectorRegister4Float ContactX = VectorMultiply(DeltaX, EnterTime);
+		const VectorRegister4Float ContactY = VectorMultiply(DeltaY, EnterTime);
+		const VectorRegister4Float BelowX = VectorCompareLT(ContactX, MinX);
+		const VectorRegister4Float BelowY = VectorCompareLT(ContactY, MinY);
+		const VectorRegister4Float OutsideX = VectorBitwiseOr(BelowX, VectorCompareGT(ContactX, MaxX));
+		const VectorRegister4Float OutsideY = VectorBitwiseOr(BelowY, VectorCompareGT(ContactY, MaxY));
+		const VectorRegister4Float InCorner = VectorBitwiseAnd(OutsideX, OutsideY);
+
+		// Circle versus corner point, solved for all lanes and only kept where the slab entry is in a corner.
+		const VectorRegister4Float CornerX = VectorSelect(BelowX, MinX, MaxX);
+		const VectorRegister4Float CornerY = VectorSelect(BelowY, MinY, MaxY);
+		const VectorRegister4Float OffsetX = VectorNegate(CornerX);
+		const VectorRegister4Float OffsetY = VectorNegate(CornerY);
+		const VectorRegister4Float B = VectorAdd(VectorMultiply(OffsetX, DeltaX), VectorMultiply(OffsetY, DeltaY));
+		const VectorRegister4Float C = VectorSubtract(VectorAdd(VectorMultiply(OffsetX, OffsetX), VectorMultiply(OffsetY, OffsetY)), RadiusSquared);
+		const VectorRegister4Float Discriminant = VectorSubtract(VectorMultiply(B, B), VectorMultiply(DeltaLengthSquared, C));
+		const VectorRegister4Float Root = VectorSqrt(VectorMax(Discriminant, Zero));
+		const VectorRegister4Float CornerTime = VectorDivide(VectorNegate(VectorAdd(B, Root)), DeltaLengthSquared);
+		const VectorRegister4Float CornerValid = VectorBitwiseAnd(
+			VectorBitwiseAnd(VectorCompareLT(B, Zero), VectorCompareGE(Discriminant, Zero)),
+			VectorBitwiseAnd(VectorCompareGE(CornerTime, Zero), VectorCompareLE(CornerTime, One)));
+
+		Valid = VectorBitwiseAnd(Valid, VectorSelect(InCorner, CornerValid, Valid));
+		const VectorRegister4Float Time = VectorSelect(Valid, VectorSelect(InCorner, CornerTime, EnterTime), Miss);
+
+		const VectorRegister4Float CornerNormalX = VectorDivide(VectorSubtract(VectorMultiply(DeltaX, CornerTime), CornerX), RadiusV);
+		const VectorRegister4Float CornerNormalY = VectorDivide(VectorSubtract(VectorMultiply(DeltaY, CornerTime), CornerY), RadiusV);
+		const VectorRegister4Float NormalX = VectorSelect(InCorner, CornerNormalX, VectorSelect(EnterOnX, FaceNormalX, Zero));
+		const VectorRegister4Float NormalY = VectorSelect(InCorner, CornerNormalY, VectorSelect(EnterOnX, Zero, FaceNormalY));
+
+		VectorStoreAligned(Time, LaneTimes);
+		VectorStoreAligned(NormalX, LaneNormalX);
+		VectorStoreAligned(NormalY, LaneNormalY);
+		for (int32 Lane = 0; Lane < FBBCBoxBatch::LaneCount; ++Lane)
+		{
+			if (LaneTimes[Lane] < OutHit.Time || (!bFoundHit && LaneTimes[Lane] <= 1.f))
+			{
+				OutHit.Time = LaneTimes[Lane];
+				OutHit.Normal = FVector2f(LaneNormalX[Lane], LaneNormalY[Lane]);
+				OutHit.Id = Boxes.Ids[First + Lane];
+				bFoundHit = true;
+			}
+		}
+	}
+	return bFoundHit;
+}
+
+/**
+ * @brief Scalar reference for SweepCircleBoxBatch.
+ *
+ * Evaluates the same expressions in the same order for one box at a time, so the vector kernel can be
+ * checked against it.
+ *
+ * @param Delta Displacement of the circle for the sweep.
+ * @param Radius Circle radius.
+ * @param Boxes Batch of boxes relative to the circle start.
+ * @param OutHit Earliest contact and the id of the box hit.
+ *
+ * @return true if any box is touched during the sweep.
+ */
+bool BBCCollision::SweepCircleBoxBatchScalar(const FVector2f& Delta, float Radius, const FBBCBoxBatch& Boxes, FBBCBatchHit& OutHit)
+{
+	const float SafeDeltaX = FMath::Abs(Delta.X) < MinDeltaComponent ? MinDeltaComponent : Delta.X;
+	const float SafeDeltaY = FMath::Abs(Delta.Y) < MinDeltaComponent ? MinDeltaComponent : Delta.Y;
+	const float InvDeltaX = 1.f / SafeDeltaX;
+	const float InvDeltaY = 1.f / SafeDeltaY;
+	const float DeltaLengthSquared = Delta.X * Delta.X + Delta.Y * Delta.Y;
+
+	bool bFoundHit = false;
+	OutHit.Time = 1.f;
+	for (int32 BoxIndex = 0; BoxIndex < Boxes.Num(); ++BoxIndex)
+	{
+		const float MinX = Boxes.MinX[BoxIndex];
+		const float MinY = Boxes.MinY[BoxIndex];
+		const float MaxX = Boxes.MaxX[BoxIndex];
+		const float MaxY = Boxes.MaxY[BoxIndex];
+
+		const float NearX0 = (MinX - Radius) * InvDeltaX;
+		const float FarX0 = (MaxX + Radius) * InvDeltaX;
+		const float NearY0 = (MinY - Radius) * InvDeltaY;
+		const float FarY0 = (MaxY + Radius) * InvDeltaY;
+		const float NearX = FMath::Min(NearX0, FarX0);
+		const float FarX = FMath::Max(NearX0, FarX0);
+		const float NearY = FMath::Min(NearY0, FarY0);
+		const float FarY = FMath::Max(NearY0, FarY0);
+
+		const float EnterTime = FMath::Max(NearX, NearY);
+		const float ExitTime = FMath::Min(FarX, FarY);
+		if (EnterTime > ExitTime || EnterTime < 0.f || EnterTime > 1.f)
+		{
+			continue;
+		}
+
+		float Time = EnterTime;
+		FVector2f Normal = NearX > NearY ? FVector2f(SafeDeltaX > 0.f ? -1.f : 1.f, 0.f) : FVector2f(0.f, SafeDeltaY > 0.f ? -1.f : 1.f);
+
+		const float ContactX = Delta.X * EnterTime;
+		const float ContactY = Delta.Y * EnterTime;
+		const bool bBelowX = ContactX < MinX;
+		const bool bBelowY = ContactY < MinY;
+		if ((bBelowX || ContactX > MaxX) && (bBelowY || ContactY > MaxY))
+		{
+			const float CornerX = bBelowX ? MinX : MaxX;
+			const float CornerY = bBelowY ? MinY : MaxY;
+			const float B = -CornerX * Delta.X + -CornerY * Delta.Y;
+			const float C = CornerX * CornerX + CornerY * CornerY - Radius * Radius;
+			const float Discriminant = B * B - DeltaLengthSquared * C;
+			if (B >= 0.f || Discriminant < 0.f)
+			{
+				continue;
+			}
+			Time = -(B + FMath::Sqrt(Discriminant)) / DeltaLengthSquared;
+			if (Time < 0.f || Time > 1.f)
+			{
+				continue;
+			}
+			Normal = FVector2f((Delta.X * Time - CornerX) / Radius, (Delta.Y * Time - CornerY) / Radius);
+		}
+
+		if (Time < OutHit.Time || !bFoundHit)
+		{
+			OutHit.Time = Time;
+			OutHit.Normal = Normal;
+			OutHit.Id = Boxes.Ids[BoxIndex];
+			bFoundHit = true;
+		}
+	}
+	return bFoundHit;
+}
+
+/**
+ * @brief Cross-checks the vector kernel against the scalar reference on random walls of 1 to 37 boxes, so
+ * batches with and without padding lanes are both covered.
+ *
+ * @param Iterations Number of random sweeps.
+ * @param Seed Seed of the random walls and sweeps.
+ * @param OutHits Sweeps that hit a box, per the scalar kernel.
+ *
+ * @return Sweeps on which the kernels disagree on the hit, the box, the time or the normal.
+ */
+int32 BBCCollision::VerifyBoxBatchKernel(int32 Iterations, int32 Seed, int32& OutHits)
+{
+	FRandomStream Stream(Seed);
+	FBBCBoxBatch Boxes;
+	int32 Mismatches = 0;
+	OutHits = 0;
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		Boxes.Reset();
+		const int32 NumBoxes = Stream.RandRange(1, 37);
+		for (int32 BoxIndex = 0; BoxIndex < NumBoxes; ++BoxIndex)
+		{
+			const FVector2D Min(Stream.FRandRange(-60.0, 60.0), Stream.FRandRange(-60.0, 60.0));
+			const FVector2D Size(Stream.FRandRange(4.0, 40.0), Stream.FRandRange(4.0, 20.0));
+			Boxes.Add(FBox2D(Min, Min + Size), FVector2D::ZeroVector, BoxIndex);
+		}
+		Boxes.Finalize();
+
+		const FVector2f Delta(Stream.FRandRange(-40.f, 40.f), Stream.FRandRange(-40.f, 40.f));
+		const float Radius = Stream.FRandRange(1.f, 15.f);
+		FBBCBatchHit VectorHit;
+		FBBCBatchHit ScalarHit;
+		const bool bVectorHit = SweepCircleBoxBatch(Delta, Radius, Boxes, VectorHit);
+		const bool bScalarHit = SweepCircleBoxBatchScalar(Delta, Radius, Boxes, ScalarHit);
+		OutHits += bScalarHit ? 1 : 0;
+		if (bVectorHit != bScalarHit || (bScalarHit && (VectorHit.Id != ScalarHit.Id
+			|| !FMath::IsNearlyEqual(VectorHit.Time, ScalarHit.Time, 1.0e-4f)
+			|| !VectorHit.Normal.Equals(ScalarHit.Normal, 1.0e-3f))))
+		{
+			++Mismatches;
+		}
+	}
+	return Mismatches;
+}
@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Collision/BBCSpatialHash.h"
+
+#include "CollisionQueryParams.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	constexpr double BenchHalfExtent = 12.0;
+	constexpr double BenchFieldSize = 4000.0;
+	constexpr double BenchMaxStep = 8.0;
+
+	/**
+	 * @brief Times the spatial hash against the physics scene on the same moving boxes.
+	 *
+	 * Each iteration moves every object by a small random step, then runs one overlap query per object. The
+	 * physics side uses query-only box components registered with the world and OverlapMultiByObjectType,
+	 * which is what relying on the Chaos broadphase costs; the hash side uses Move and QueryBatch.
+	 *
+	 * Usage: BBC.Collision.BenchBroadphase [Iterations] [Counts...]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs BenchBroadphaseCommand(
+		TEXT("BBC.Collision.BenchBroadphase"),
+		TEXT("Times the spatial hash against physics scene overlaps for moving boxes. Usage: BBC.Collision.BenchBroadphase [Iterations] [Counts...]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (World == nullptr)
+			{
+				return;
+			}
+			const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10;
+			TArray<int32> Counts;
+			for (int32 ArgIndex = 1; ArgIndex < Args.Num(); ++ArgIndex)
+			{
+				Counts.Add(FCString::Atoi(*Args[ArgIndex]));
+			}
+			if (Counts.Num() == 0)
+			{
+				Counts = {100, 1000, 10000};
+			}
+
+			const FVector2D Extent(BenchHalfExtent, BenchHalfExtent);
+			for (const int32 Count : Counts)
+			{
+				FRandomStream Stream(Count);
+				TArray<FVector2D> Positions;
+				Positions.SetNumUninitialized(Count);
+				for (FVector2D& Position : Positions)
+				{
+					Position = FVector2D(Stream.FRandRange(0.0, BenchFieldSize), Stream.FRandRange(0.0, BenchFieldSize));
+				}
+				TArray<FVector2D> Steps;
+				Steps.SetNumUninitialized(Count * Iterations);
+				for (FVector2D& Step : Steps)
+				{
+					Step = FVector2D(Stream.FRandRange(-BenchMaxStep, BenchMaxStep), Stream.FRandRange(-BenchMaxStep, BenchMaxStep));
+				}
+
+				// Spatial hash.
+				FBBCSpatialHash Hash(BenchHalfExtent * 4.0);
+				TArray<FVector2D> HashPositions = Positions;
+				TArray<int32> Handles;
+				Handles.SetNumUninitialized(Count);
+				for (int32 Index = 0; Index < Count; ++Index)
+				{
+					Handles[Index] = Hash.Insert(FBox2D(HashPositions[Index] - Extent, HashPositions[Index] + Extent), Index);
+				}
+				TArray<FBox2D> QueryBoxes;
+				QueryBoxes.SetNumUninitialized(Count);
+				TArray<int32> Found;
+				TArray<int32> Offsets;
+				int64 HashPairs = 0;
+				const double HashStart = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						HashPositions[Index] += Steps[Iteration * Count + Index];
+						QueryBoxes[Index] = FBox2D(HashPositions[Index] - Extent, HashPositions[Index] + Extent);
+						Hash.Move(Handles[Index], QueryBoxes[Index]);
+					}
+					Hash.QueryBatch(QueryBoxes, Found, Offsets);
+					HashPairs += Found.Num();
+				}
+				const double HashMs = (FPlatformTime::Seconds() - HashStart) * 1000.0 / Iterations;
+
+				// Physics scene.
+				FActorSpawnParameters SpawnParameters;
+				SpawnParameters.ObjectFlags = RF_Transient;
+				AActor* Holder = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+				if (Holder == nullptr)
+				{
+					UE_LOG(LogTemp, Error, TEXT("Holder is Invalid"));
+					return;
+				}
+				TArray<FVector2D> PhysicsPositions = Positions;
+				TArray<UBoxComponent*> Boxes;
+				Boxes.Reserve(Count);
+				for (int32 Index = 0; Index < Count; ++Index)
+				{
+					UBoxComponent* Box = NewObject<UBoxComponent>(Holder);
+					Box->SetBoxExtent(FVector(BenchHalfExtent));
+					Box->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+					Box->SetCollisionObjectType(ECC_WorldDynamic);
+					Box->SetCollisionResponseToAllChannels(ECR_Overlap);
+					Box->SetGenerateOverlapEvents(false);
+					Box->SetWorldLocation(FVector(PhysicsPositions[Index], 0.0));
+					Box->RegisterComponent();
+					Boxes.Add(Box);
+				}
+				const FCollisionObjectQueryParams ObjectParams(ECC_WorldDynamic);
+				const FCollisionShape Shape = FCollisionShape::MakeBox(FVector(BenchHalfExtent));
+				TArray<FOverlapResult> Overlaps;
+				int64 PhysicsPairs = 0;
+				const double PhysicsStart = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						PhysicsPositions[Index] += Steps[Iteration * Count + Index];
+						Boxes[Index]->SetWorldLocation(FVector(PhysicsPositions[Index], 0.0), false, nullptr, ETeleportType::TeleportPhysics);
+					}
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						World->OverlapMultiByObjectType(Overlaps, FVector(PhysicsPositions[Index], 0.0), FQuat::Identity, ObjectParams, Shape);
+						PhysicsPairs += Overlaps.Num();
+					}
+				}
+				const double PhysicsMs = (FPlatformTime::Seconds() - PhysicsStart) * 1000.0 / Iterations;
+				Holder->Destroy();
+
+				UE_LOG(LogTemp, Display, TEXT("Broadphase bench: %d objects, hash %.3f ms (%lld pairs, %d cells), physics %.3f ms (%lld pairs), speedup %.2fx"),
+					Count, HashMs, HashPairs / Iterations, Hash.GetNumOccupiedCells(), PhysicsMs, PhysicsPairs / Iterations, HashMs > 0.0 ? PhysicsMs / HashMs : 0.0);
+			}
+		}));
+}
+
+FBBCSpatialHash::FBBCSpatialHash(double InCellSize) :
+	CellSize(InCellSize),
+	InvCellSize(1.0 / InCellSize)
+{
+}
+
+/**
+ * @brief Adds an object to every cell its bounds overlap.
+ *
+ * @param Bounds Bounds of the object on the gameplay plane.
+ * @param UserData Caller defined value stored with the object, typically an index into the caller's arrays.
+ * @return Handle of the object, valid until it is removed.
+ */
+int32 FBBCSpatialHash::Insert(const FBox2D& Bounds, int32 UserData)
+{
+	const int32 Handle = FreeHandles.Num() > 0 ? FreeHandles.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	FEntry& Entry = Entries[Handle];
+	Entry.Bounds = Bounds;
+	Entry.UserData = UserData;
+	Entry.bUsed = true;
+	GetCellRange(Bounds, Entry.MinCell, Entry.MaxCell);
+	AddToCells(Handle, Entry.MinCell, Entry.MaxCell);
+	return Handle;
+}
+
+/**
+ * @brief Updates the bounds of an object in place.
+ *
+ * Only the buckets of cells the object leaves or enters are touched; cells covered before and after keep it.
+ *
+ * @param Handle Handle returned by Insert.
+ * @param Bounds New bounds of the object.
+ */
+void FBBCSpatialHash::Move(int32 Handle, const FBox2D& Bounds)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return;
+	}
+
+	FEntry& Entry = Entries[Handle];
+	Entry.Bounds = Bounds;
+	FIntPoint MinCell;
+	FIntPoint MaxCell;
+	GetCellRange(Bounds, MinCell, MaxCell);
+	if (MinCell == Entry.MinCell && MaxCell == Entry.MaxCell)
+	{
+		return;
+	}
+
+	RemoveFromCells(Handle, Entry.MinCell, Entry.MaxCell, MinCell, MaxCell);
+	AddToCells(Handle, MinCell, MaxCell, Entry.MinCell, Entry.MaxCell);
+	Entry.MinCell = MinCell;
+	Entry.MaxCell = MaxCell;
+}
+
+void FBBCSpatialHash::Remove(int32 Handle)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return;
+	}
+
+	FEntry& Entry = Entries[Handle];
+	RemoveFromCells(Handle, Entry.MinCell, Entry.MaxCell);
+	Entry.bUsed = false;
+	Entry.UserData = INDEX_NONE;
+	FreeHandles.Add(Handle);
+}
+
+void FBBCSpatialHash::Reset(double InCellSize)
+{
+	CellSize = InCellSize;
+	InvCellSize = 1.0 / InCellSize;
+	Entries.Reset();
+	FreeHandles.Reset();
+	Buckets.Reset();
+	NumOccupiedCells = 0;
+}
+
+/**
+ * @brief Collects the objects overlapping a box.
+ *
+ * @param Box Query bounds on the gameplay plane.
+ * @param OutHandles Receives the handles of the overlapping objects; existing entries are kept.
+ */
+void FBBCSpatialHash::Query(const FBox2D& Box, TArray<int32>& OutHandles) const
+{
+	FIntPoint QueryMin;
+	FIntPoint QueryMax;
+	GetCellRange(Box, QueryMin, QueryMax);
+
+	for (int32 Y = QueryMin.Y; Y <= QueryMax.Y; ++Y)
+	{
+		for (int32 X = QueryMin.X; X <= QueryMax.X; ++X)
+		{
+			const TArray<int32>* Bucket = Buckets.Find(GetCellKey(X, Y));
+			if (Bucket == nullptr)
+			{
+				continue;
+			}
+			for (const int32 Handle : *Bucket)
+			{
+				// Report the object from the first cell it shares with the query only.
+				const FEntry& Entry = Entries[Handle];
+				if (X == FMath::Max(Entry.MinCell.X, QueryMin.X) && Y == FMath::Max(Entry.MinCell.Y, QueryMin.Y)
+					&& Entry.Bounds.Intersect(Box))
+				{
+					OutHandles.Add(Handle);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Runs a query per box, writing every result into one flat buffer.
+ *
+ * @param Boxes Query bounds.
+ * @param OutHandles Receives the handles of every query back to back; reset first.
+ * @param OutOffsets Receives Boxes.Num() + 1 offsets into OutHandles; reset first.
+ */
+void FBBCSpatialHash::QueryBatch(TConstArrayView<FBox2D> Boxes, TArray<int32>& OutHandles, TArray<int32>& OutOffsets) const
+{
+	OutHandles.Reset();
+	OutOffsets.Reset(Boxes.Num() + 1);
+	for (const FBox2D& Box : Boxes)
+	{
+		OutOffsets.Add(OutHandles.Num());
+		Query(Box, OutHandles);
+	}
+	OutOffsets.Add(OutHandles.Num());
+}
+
+void FBBCSpatialHash::GetCellRange(const FBox2D& Box, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+	OutMin = FIntPoint(FMath::FloorToInt32(Box.Min.X * InvCellSize), FMath::FloorToInt32(Box.Min.Y * InvCellSize));
+	OutMax = FIntPoint(FMath::FloorToInt32(Box.Max.X * InvCellSize), FMath::FloorToInt32(Box.Max.Y * InvCellSize));
+}
+
+void FBBCSpatialHash::AddToCells(int32 Handle, const FIntPoint& MinCell, const FIntPoint& MaxCell, const FIntPoint& SkipMin, const FIntPoint& SkipMax)
+{
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			if (X >= SkipMin.X && X <= SkipMax.X && Y >= SkipMin.Y && Y <= SkipMax.Y)
+			{
+				continue;
+			}
+			TArray<int32>& Bucket = Buckets.FindOrAdd(GetCellKey(X, Y));
+			NumOccupiedCells += Bucket.Num() == 0 ? 1 : 0;
+			Bucket.Add(Handle);
+		}
+	}
+}
+
+/**
+ * @brief Takes an object out of a range of cells. Buckets that become empty stay in the map, with their
+ * allocation, for the next object to enter the cell.
+ */
+void FBBCSpatialHash::RemoveFromCells(int32 Handle, const FIntPoint& MinCell, const FIntPoint& MaxCell, const FIntPoint& SkipMin, const FIntPoint& SkipMax)
+{
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			if (X >= SkipMin.X && X <= SkipMax.X && Y >= SkipMin.Y && Y <= SkipMax.Y)
+			{
+				continue;
+			}
+			TArray<int32>* Bucket = Buckets.Find(GetCellKey(X, Y));
+			if (Bucket == nullptr)
+			{
+				continue;
+			}
+			if (Bucket->RemoveSingleSwap(Handle, EAllowShrinking::No) > 0 && Bucket->Num() == 0)
+			{
+				--NumOccupiedCells;
+			}
+		}
+	}
+}
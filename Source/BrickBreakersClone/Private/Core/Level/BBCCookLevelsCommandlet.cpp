@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Level/BBCCookLevelsCommandlet.h"
+
+#include "Core/Level/BBCLevelLayout.h"
+#include "HAL/FileManager.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+UBBCCookLevelsCommandlet::UBBCCookLevelsCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+/**
+ * @brief Cooks one level, or every CSV source in Content/Levels.
+ *
+ * @param Params Command line; -Level=<Name> limits cooking to one level.
+ *
+ * @return 0 if every level cooked, 1 otherwise.
+ */
+int32 UBBCCookLevelsCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Names;
+	FString Level;
+	if (FParse::Value(*Params, TEXT("Level="), Level))
+	{
+		Names.Add(Level);
+	}
+	else
+	{
+		TArray<FString> Sources;
+		IFileManager::Get().FindFiles(Sources, *FPaths::GetPath(BBCLevel::GetSourcePath(TEXT("*"))), TEXT("csv"));
+		for (const FString& Source : Sources)
+		{
+			Names.Add(FPaths::GetBaseFilename(Source));
+		}
+	}
+
+	int32 NumFailed = 0;
+	for (const FString& Name : Names)
+	{
+		FString Error;
+		if (!BBCLevel::CookLevel(Name, Error))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s"), *Error);
+			++NumFailed;
+			continue;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Cooked %s"), *BBCLevel::GetCookedPath(Name));
+	}
+	return NumFailed == 0 ? 0 : 1;
+}
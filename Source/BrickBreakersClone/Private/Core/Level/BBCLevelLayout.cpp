@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Level/BBCLevelLayout.h"
+
+#include "Core/Brick/BBCBrickGrid.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	constexpr float DefaultBrickWidth = 60.f;
+	constexpr float DefaultBrickHeight = 24.f;
+}
+
+/**
+ * @brief Takes ownership of a cooked blob after checking its header and size.
+ *
+ * @param InBlob The file bytes.
+ *
+ * @return true if the blob holds a complete level of the current version.
+ */
+bool FBBCLevelLayout::Initialize(TArray<uint8>&& InBlob)
+{
+	Blob.Reset();
+	if (InBlob.Num() < static_cast<int32>(sizeof(FBBCLevelHeader)))
+	{
+		return false;
+	}
+
+	const FBBCLevelHeader& Header = *reinterpret_cast<const FBBCLevelHeader*>(InBlob.GetData());
+	if (Header.FileMagic != FBBCLevelHeader::Magic || Header.FileVersion != FBBCLevelHeader::Version
+		|| Header.Columns <= 0 || Header.Rows <= 0 || Header.BrickWidth <= 0.f || Header.BrickHeight <= 0.f)
+	{
+		return false;
+	}
+	const int64 NumPlanes = (Header.Flags & FBBCLevelHeader::FlagHasKinds) != 0 ? 2 : 1;
+	const int64 ExpectedSize = sizeof(FBBCLevelHeader) + static_cast<int64>(Header.Columns) * Header.Rows * NumPlanes;
+	if (InBlob.Num() != ExpectedSize)
+	{
+		return false;
+	}
+
+	Blob = MoveTemp(InBlob);
+	return true;
+}
+
+int32 FBBCLevelLayout::CountBricks() const
+{
+	const uint8* HitPoints = GetHitPoints();
+	const int32 NumCells = GetNumCells();
+	int32 NumBricks = 0;
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		NumBricks += HitPoints[Cell] > 0 ? 1 : 0;
+	}
+	return NumBricks;
+}
+
+FString BBCLevel::GetSourcePath(const FString& Name)
+{
+	return FPaths::ProjectContentDir() / TEXT("Levels") / Name + TEXT(".csv");
+}
+
+FString BBCLevel::GetCookedPath(const FString& Name)
+{
+	return FPaths::ProjectContentDir() / TEXT("Levels") / Name + TEXT(".bbclevel");
+}
+
+/**
+ * @brief Converts a CSV grid into a level blob.
+ *
+ * Rows shorter than the widest row are padded with empty cells. The kind plane is only written when the
+ * level has explosive or regenerating bricks.
+ *
+ * @param Csv The source text.
+ * @param OutBlob The cooked level.
+ * @param OutError Why cooking failed.
+ *
+ * @return true if the source held at least one cell and every value fits in a byte.
+ */
+bool BBCLevel::CookFromCsv(const FString& Csv, TArray<uint8>& OutBlob, FString& OutError)
+{
+	FBBCLevelHeader Header;
+	Header.FileMagic = FBBCLevelHeader::Magic;
+	Header.FileVersion = FBBCLevelHeader::Version;
+	Header.Flags = 0;
+	Header.BrickWidth = DefaultBrickWidth;
+	Header.BrickHeight = DefaultBrickHeight;
+
+	TArray<FString> Lines;
+	Csv.ParseIntoArrayLines(Lines);
+
+	TArray<TArray<uint8>> Rows;
+	TArray<TArray<uint8>> RowKinds;
+	int32 Columns = 0;
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		const FString Line = Lines[LineIndex].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		TArray<FString> Values;
+		Line.ParseIntoArray(Values, TEXT(","), false);
+		if (Values[0].TrimStartAndEnd() == TEXT("size"))
+		{
+			if (Values.Num() != 3)
+			{
+				OutError = FString::Printf(TEXT("Line %d: expected size,<Width>,<Height>"), LineIndex + 1);
+				return false;
+			}
+			Header.BrickWidth = FCString::Atof(*Values[1]);
+			Header.BrickHeight = FCString::Atof(*Values[2]);
+			continue;
+		}
+
+		TArray<uint8>& Row = Rows.AddDefaulted_GetRef();
+		TArray<uint8>& Kinds = RowKinds.AddDefaulted_GetRef();
+		Row.Reserve(Values.Num());
+		Kinds.Reserve(Values.Num());
+		for (const FString& Value : Values)
+		{
+			FString Trimmed = Value.TrimStartAndEnd();
+			EBBCBrickKind Kind = EBBCBrickKind::Normal;
+			if (Trimmed.EndsWith(TEXT("x")))
+			{
+				Kind = EBBCBrickKind::Explosive;
+			}
+			else if (Trimmed.EndsWith(TEXT("r")))
+			{
+				Kind = EBBCBrickKind::Regenerating;
+			}
+			if (Kind != EBBCBrickKind::Normal)
+			{
+				Trimmed.LeftChopInline(1);
+				Header.Flags |= FBBCLevelHeader::FlagHasKinds;
+			}
+			Kinds.Add(static_cast<uint8>(Kind));
+
+			const int32 HitPoints = Trimmed.IsEmpty() || Trimmed == TEXT(".") ? 0 : FCString::Atoi(*Trimmed);
+			if (HitPoints < 0 || HitPoints > MAX_uint8)
+			{
+				OutError = FString::Printf(TEXT("Line %d: hit points %d out of range"), LineIndex + 1, HitPoints);
+				return false;
+			}
+			Row.Add(static_cast<uint8>(HitPoints));
+		}
+		Columns = FMath::Max(Columns, Row.Num());
+	}
+
+	if (Columns == 0 || Rows.Num() == 0 || Header.BrickWidth <= 0.f || Header.BrickHeight <= 0.f)
+	{
+		OutError = TEXT("Level has no cells or an invalid brick size");
+		return false;
+	}
+	Header.Columns = Columns;
+	Header.Rows = Rows.Num();
+
+	const int32 NumCells = Columns * Rows.Num();
+	const bool bHasKinds = (Header.Flags & FBBCLevelHeader::FlagHasKinds) != 0;
+	OutBlob.SetNumZeroed(sizeof(FBBCLevelHeader) + NumCells * (bHasKinds ? 2 : 1));
+	FMemory::Memcpy(OutBlob.GetData(), &Header, sizeof(FBBCLevelHeader));
+	uint8* Cells = OutBlob.GetData() + sizeof(FBBCLevelHeader);
+	for (int32 Row = 0; Row < Rows.Num(); ++Row)
+	{
+		FMemory::Memcpy(Cells + Row * Columns, Rows[Row].GetData(), Rows[Row].Num());
+		if (bHasKinds)
+		{
+			FMemory::Memcpy(Cells + NumCells + Row * Columns, RowKinds[Row].GetData(), RowKinds[Row].Num());
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Cooks Content/Levels/<Name>.csv into Content/Levels/<Name>.bbclevel.
+ *
+ * @param Name Level name, without directory or extension.
+ * @param OutError Why cooking failed.
+ *
+ * @return true if the cooked file was written.
+ *
+ * @note Writes into the content directory, so only tools call it; the game never does.
+ */
+bool BBCLevel::CookLevel(const FString& Name, FString& OutError)
+{
+	FString Csv;
+	if (!FFileHelper::LoadFileToString(Csv, *GetSourcePath(Name)))
+	{
+		OutError = FString::Printf(TEXT("Failed to read %s"), *GetSourcePath(Name));
+		return false;
+	}
+
+	TArray<uint8> Blob;
+	if (!CookFromCsv(Csv, Blob, OutError))
+	{
+		return false;
+	}
+	if (!FFileHelper::SaveArrayToFile(Blob, *GetCookedPath(Name)))
+	{
+		OutError = FString::Printf(TEXT("Failed to write %s"), *GetCookedPath(Name));
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Builds a level blob holding NumBricks normal bricks.
+ *
+ * The grid has about twice as many columns as rows; the last row is only partly filled when NumBricks is not
+ * a multiple of the column count.
+ *
+ * @param NumBricks Number of bricks, at least one.
+ * @param FieldSize Size of the whole grid.
+ * @param OutBlob The cooked level.
+ */
+void BBCLevel::CookUniform(int32 NumBricks, const FVector2D& FieldSize, TArray<uint8>& OutBlob)
+{
+	NumBricks = FMath::Max(NumBricks, 1);
+
+	FBBCLevelHeader Header;
+	Header.FileMagic = FBBCLevelHeader::Magic;
+	Header.FileVersion = FBBCLevelHeader::Version;
+	Header.Flags = 0;
+	Header.Columns = FMath::Clamp(FMath::CeilToInt32(FMath::Sqrt(2.0 * NumBricks)), 1, NumBricks);
+	Header.Rows = FMath::DivideAndRoundUp(NumBricks, Header.Columns);
+	Header.BrickWidth = static_cast<float>(FieldSize.X / Header.Columns);
+	Header.BrickHeight = FMath::Min(DefaultBrickHeight, static_cast<float>(FieldSize.Y / Header.Rows));
+
+	const int32 NumCells = Header.Columns * Header.Rows;
+	OutBlob.SetNumZeroed(sizeof(FBBCLevelHeader) + NumCells);
+	FMemory::Memcpy(OutBlob.GetData(), &Header, sizeof(FBBCLevelHeader));
+	FMemory::Memset(OutBlob.GetData() + sizeof(FBBCLevelHeader), 1, NumBricks);
+}
+
+/**
+ * @brief Loads a cooked level with a single read.
+ *
+ * @param Name Level name, without directory or extension.
+ * @param OutLayout The loaded layout.
+ *
+ * @return true if the level was found and is valid.
+ *
+ * @note Safe to call from a worker thread. Only reads; a source newer than its cooked file is reported, not
+ * cooked, since concurrent loads of the same level would race on the write.
+ */
+bool BBCLevel::LoadLevel(const FString& Name, FBBCLevelLayout& OutLayout)
+{
+	const FString CookedPath = GetCookedPath(Name);
+
+#if !UE_BUILD_SHIPPING
+	const FDateTime SourceTime = IFileManager::Get().GetTimeStamp(*GetSourcePath(Name));
+	const FDateTime CookedTime = IFileManager::Get().GetTimeStamp(*CookedPath);
+	if (SourceTime != FDateTime::MinValue() && CookedTime != FDateTime::MinValue() && CookedTime < SourceTime)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is older than its source, run the BBCCookLevels commandlet"), *CookedPath);
+	}
+#endif
+
+	TArray<uint8> Blob;
+	if (!FFileHelper::LoadFileToArray(Blob, *CookedPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read level %s"), *CookedPath);
+		return false;
+	}
+	if (!OutLayout.Initialize(MoveTemp(Blob)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a valid level"), *CookedPath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Level/BBCLevelSubsystem.h"
+
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Level/BBCLevelLayout.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "TimerManager.h"
+
+/**
+ * @brief Starts reading the first level and listens for level completion.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ */
+void UBBCLevelSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UBBCGameEventSubsystem* GameEvents = Collection.InitializeDependency<UBBCGameEventSubsystem>())
+	{
+		LevelCompletedHandle = GameEvents->OnLevelCompleted().AddUObject(this, &UBBCLevelSubsystem::HandleLevelCompleted);
+	}
+	StartLoading(0);
+}
+
+void UBBCLevelSubsystem::Deinitialize()
+{
+	if (UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnLevelCompleted().Remove(LevelCompletedHandle);
+	}
+	if (LoadTask.IsValid())
+	{
+		LoadTask.Wait();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UBBCLevelSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Applies the first level and starts reading the second.
+ *
+ * @param InBrickField The brick field that will show every level.
+ *
+ * @return true if a level was applied.
+ *
+ * @note Blocks only if the first level has not finished loading since the world was created.
+ */
+bool UBBCLevelSubsystem::StartFirstLevel(UBBCBrickFieldComponent* InBrickField)
+{
+	BrickField = InBrickField;
+	return ApplyLevel(0);
+}
+
+/**
+ * @brief Reads a level on a worker thread.
+ *
+ * @param LevelIndex Index in Levels.
+ */
+void UBBCLevelSubsystem::StartLoading(int32 LevelIndex)
+{
+	if (!Levels.IsValidIndex(LevelIndex))
+	{
+		return;
+	}
+
+	LoadingLevel = LevelIndex;
+	LoadTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Name = Levels[LevelIndex]]()
+	{
+		TSharedPtr<FBBCLevelLayout> Layout = MakeShared<FBBCLevelLayout>();
+		if (!BBCLevel::LoadLevel(Name, *Layout))
+		{
+			Layout.Reset();
+		}
+		return Layout;
+	});
+}
+
+TSharedPtr<FBBCLevelLayout> UBBCLevelSubsystem::FinishLoading()
+{
+	if (!LoadTask.IsValid())
+	{
+		return nullptr;
+	}
+	if (!LoadTask.IsCompleted())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Level %d was not streamed in yet, waiting for it"), LoadingLevel);
+	}
+	TSharedPtr<FBBCLevelLayout> Layout = LoadTask.GetResult();
+	LoadTask = {};
+	return Layout;
+}
+
+/**
+ * @brief Copies a loaded level into the brick field and prefetches the next one.
+ *
+ * @param LevelIndex Index in Levels. Usually the level being loaded; any other level is read here, blocking.
+ *
+ * @return true if the level was applied.
+ */
+bool UBBCLevelSubsystem::ApplyLevel(int32 LevelIndex)
+{
+	UBBCBrickFieldComponent* Bricks = BrickField.Get();
+	if (!Levels.IsValidIndex(LevelIndex) || Bricks == nullptr)
+	{
+		return false;
+	}
+	if (LevelIndex != LoadingLevel || !LoadTask.IsValid())
+	{
+		FinishLoading();
+		StartLoading(LevelIndex);
+	}
+	const TSharedPtr<FBBCLevelLayout> Layout = FinishLoading();
+	if (!Layout.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to load level %d (%s)"), LevelIndex, *Levels[LevelIndex]);
+		return false;
+	}
+
+	Bricks->ApplyLayout(*Layout);
+	CurrentLevel = LevelIndex;
+	CurrentLayout = Layout;
+	StartLoading((LevelIndex + 1) % Levels.Num());
+	return true;
+}
+
+/**
+ * @brief Advances on the next frame, so the wall is not rebuilt in the middle of the ball step that broke
+ * the last brick.
+ */
+void UBBCLevelSubsystem::HandleLevelCompleted(const FBBCLevelCompletedEvent& Event)
+{
+	if (CurrentLevel != INDEX_NONE)
+	{
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UBBCLevelSubsystem::AdvanceLevel);
+	}
+}
+
+/**
+ * @brief Applies the next level and publishes its start.
+ *
+ * A level that fails to load is read once more, in case the failure was transient. If it fails again the
+ * current level is replayed from the layout kept in memory, so the game never stays on a completed level
+ * with an empty wall; the next completion tries the failed level again.
+ */
+void UBBCLevelSubsystem::AdvanceLevel()
+{
+	UBBCBrickFieldComponent* Bricks = BrickField.Get();
+	if (Bricks == nullptr)
+	{
+		return;
+	}
+
+	int32 NextLevel = (CurrentLevel + 1) % Levels.Num();
+	if (!ApplyLevel(NextLevel) && !ApplyLevel(NextLevel))
+	{
+		if (!ensureMsgf(CurrentLayout.IsValid(), TEXT("No level to fall back to")))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Level %d failed to load and there is no level to replay"), NextLevel);
+			return;
+		}
+		UE_LOG(LogTemp, Error, TEXT("Level %d failed to load, replaying level %d"), NextLevel, CurrentLevel);
+		Bricks->ApplyLayout(*CurrentLayout);
+		StartLoading(NextLevel);
+		NextLevel = CurrentLevel;
+	}
+
+	const UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>();
+	if (GameEvents != nullptr)
+	{
+		GameEvents->Publish(FBBCLevelStartedEvent{NextLevel, Bricks->GetNumAlive()});
+	}
+}
@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+
+#include "Camera/CameraComponent.h"
+#include "Cameras/BBCCamera.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "UnrealClient.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorld DumpPlayfieldCommand(
+		TEXT("BBC.Playfield.Dump"),
+		TEXT("Logs the current arena, walls, paddle range and ball spawn."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(World);
+			UE_LOG(LogTemp, Display, TEXT("Playfield revision %d: arena %s, kill zone %s, bricks %s"),
+				Layout.Revision, *Layout.Arena.ToString(), *Layout.KillZone.ToString(), *Layout.BrickArea.ToString());
+			UE_LOG(LogTemp, Display, TEXT("Paddle X in [%.1f, %.1f] on Y %.1f, ball spawn %s"),
+				Layout.PaddleMinX, Layout.PaddleMaxX, Layout.PaddleLaneY, *Layout.BallSpawn.ToString());
+		}));
+}
+
+void UBBCPlayfieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ViewportResizedHandle = FViewport::ViewportResizedEvent.AddUObject(this, &UBBCPlayfieldSubsystem::HandleViewportResized);
+}
+
+void UBBCPlayfieldSubsystem::Deinitialize()
+{
+	FViewport::ViewportResizedEvent.Remove(ViewportResizedHandle);
+	ViewportResizedHandle.Reset();
+	Camera = nullptr;
+	Paddle = nullptr;
+
+	Super::Deinitialize();
+}
+
+/**
+ * @brief Takes the camera and paddle the layout is derived from, and computes it.
+ *
+ * @param InCamera The orthographic camera the player looks through.
+ * @param InPaddle The paddle; its mesh extent places the paddle range, and it is moved to the middle of the lane.
+ */
+void UBBCPlayfieldSubsystem::SetSources(ABBCCamera* InCamera, ABBCPaddle* InPaddle)
+{
+	Camera = InCamera;
+	Paddle = InPaddle;
+	bCentrePaddle = true;
+	Recompute();
+}
+
+/**
+ * @brief Replaces the camera's view with a fixed arena and recomputes the layout.
+ *
+ * @param InArena The arena to lay out; walls and kill zone are placed around it.
+ *
+ * @note Used by the headless harness, which has no viewport and wants the same arena on every machine.
+ */
+void UBBCPlayfieldSubsystem::SetArenaOverride(const FBox2D& InArena)
+{
+	ArenaOverride = InArena;
+	Recompute();
+}
+
+const FBBCPlayfieldLayout& UBBCPlayfieldSubsystem::GetLayout(const UObject* WorldContextObject)
+{
+	static const FBBCPlayfieldLayout DefaultLayout;
+	const UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	const UBBCPlayfieldSubsystem* Playfield = World != nullptr ? World->GetSubsystem<UBBCPlayfieldSubsystem>() : nullptr;
+	return Playfield != nullptr ? Playfield->GetLayout() : DefaultLayout;
+}
+
+bool UBBCPlayfieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Derives every rectangle and point of the layout and publishes the change.
+ *
+ * The arena is OrthoWidth wide and OrthoWidth / aspect high, centred under the camera. The aspect ratio is the
+ * game viewport's, or the camera's own when there is no viewport yet. The paddle range keeps the paddle mesh
+ * inside the arena, measured from the actor location so an off-centre mesh is handled. The paddle is then put
+ * on the lane, in the middle when it was just handed over and otherwise at its X clamped to the new range.
+ *
+ * @note Without a camera or override the arena stays as it was.
+ * @note A lane outside the arena, from a PaddleLaneOffset larger than the arena is high, raises an ensure and
+ * is clamped into the arena.
+ */
+void UBBCPlayfieldSubsystem::Recompute()
+{
+	FBox2D Arena = Layout.Arena;
+	if (ArenaOverride.IsSet())
+	{
+		Arena = ArenaOverride.GetValue();
+	}
+	else if (const ABBCCamera* ViewCamera = Camera.Get())
+	{
+		const UCameraComponent* CameraComponent = ViewCamera->GetCameraComponent();
+		double AspectRatio = CameraComponent->AspectRatio;
+		const UGameViewportClient* GameViewport = GetWorld()->GetGameViewport();
+		if (GameViewport != nullptr && GameViewport->Viewport != nullptr)
+		{
+			const FIntPoint ViewportSize = GameViewport->Viewport->GetSizeXY();
+			if (ViewportSize.X > 0 && ViewportSize.Y > 0)
+			{
+				AspectRatio = static_cast<double>(ViewportSize.X) / ViewportSize.Y;
+			}
+		}
+		const FVector Location = ViewCamera->GetActorLocation();
+		const FVector2D HalfExtent(CameraComponent->OrthoWidth * 0.5, CameraComponent->OrthoWidth * 0.5 / FMath::Max(AspectRatio, UE_KINDA_SMALL_NUMBER));
+		Arena = FBox2D(FVector2D(Location.X, Location.Y) - HalfExtent, FVector2D(Location.X, Location.Y) + HalfExtent);
+	}
+
+	Layout.Arena = Arena;
+	Layout.LeftWall = FBox2D(FVector2D(Arena.Min.X - WallThickness, Arena.Min.Y - WallThickness), FVector2D(Arena.Min.X, Arena.Max.Y));
+	Layout.RightWall = FBox2D(FVector2D(Arena.Max.X, Arena.Min.Y - WallThickness), FVector2D(Arena.Max.X + WallThickness, Arena.Max.Y));
+	Layout.TopWall = FBox2D(FVector2D(Arena.Min.X - WallThickness, Arena.Min.Y - WallThickness), FVector2D(Arena.Max.X + WallThickness, Arena.Min.Y));
+	Layout.KillZone = FBox2D(FVector2D(Arena.Min.X - WallThickness, Arena.Max.Y), FVector2D(Arena.Max.X + WallThickness, Arena.Max.Y + WallThickness));
+
+	double ExtentLeft = 0.0;
+	double ExtentRight = 0.0;
+	if (const ABBCPaddle* PlayerPaddle = Paddle.Get())
+	{
+		const FVector Location = PlayerPaddle->GetActorLocation();
+		const FBox Bounds = PlayerPaddle->GetPaddleBounds();
+		if (Bounds.IsValid)
+		{
+			// The range is for the tuned width; a widened paddle narrows it itself.
+			ExtentLeft = Location.X - Bounds.Min.X - PlayerPaddle->GetExtraHalfWidth();
+			ExtentRight = Bounds.Max.X - Location.X - PlayerPaddle->GetExtraHalfWidth();
+		}
+	}
+	Layout.PaddleMinX = Arena.Min.X + ExtentLeft;
+	Layout.PaddleMaxX = Arena.Max.X - ExtentRight;
+	if (Layout.PaddleMinX > Layout.PaddleMaxX)
+	{
+		Layout.PaddleMinX = Layout.PaddleMaxX = Arena.GetCenter().X;
+	}
+
+	Layout.PaddleLaneY = Arena.Max.Y - PaddleLaneOffset;
+	if (!ensureMsgf(Layout.PaddleLaneY > Arena.Min.Y && Layout.PaddleLaneY < Arena.Max.Y,
+		TEXT("Paddle lane %.1f is outside the arena %s"), Layout.PaddleLaneY, *Arena.ToString()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PaddleLaneOffset %.1f does not fit the arena"), PaddleLaneOffset);
+		Layout.PaddleLaneY = FMath::Clamp(Layout.PaddleLaneY, Arena.Min.Y, Arena.Max.Y);
+	}
+	if (ABBCPaddle* PlayerPaddle = Paddle.Get())
+	{
+		const double PaddleX = bCentrePaddle ? Arena.GetCenter().X : PlayerPaddle->GetActorLocation().X;
+		PlayerPaddle->SetActorLocation(FVector(FMath::Clamp(PaddleX, Layout.PaddleMinX, Layout.PaddleMaxX), Layout.PaddleLaneY, 0.0));
+		bCentrePaddle = false;
+	}
+
+	Layout.BallSpawn = FVector2D(Arena.GetCenter().X, Layout.PaddleLaneY - BallSpawnAboveLane);
+	const double BrickBottom = Arena.Min.Y + (Layout.BallSpawn.Y - Arena.Min.Y) * FMath::Clamp(BrickAreaFraction, 0.0, 1.0);
+	Layout.BrickArea = FBox2D(Arena.Min, FVector2D(Arena.Max.X, BrickBottom));
+	++Layout.Revision;
+
+	UE_LOG(LogTemp, Display, TEXT("Playfield laid out: arena %s, paddle X in [%.1f, %.1f]"), *Arena.ToString(), Layout.PaddleMinX, Layout.PaddleMaxX);
+
+	if (const UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->Publish(FBBCPlayfieldChangedEvent{Layout.Revision});
+	}
+}
+
+/**
+ * @brief Lays the arena out again when this world's game viewport changes size.
+ *
+ * @param Viewport The viewport that was resized; viewports of other worlds and editor views are ignored.
+ * @param Unused Unused.
+ */
+void UBBCPlayfieldSubsystem::HandleViewportResized(FViewport* Viewport, uint32 Unused)
+{
+	const UGameViewportClient* GameViewport = GetWorld()->GetGameViewport();
+	if (GameViewport == nullptr || GameViewport->Viewport != Viewport || !Camera.IsValid() || ArenaOverride.IsSet())
+	{
+		return;
+	}
+	Recompute();
+}
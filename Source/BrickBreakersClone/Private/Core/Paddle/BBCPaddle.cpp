@@ -8,15 +8,61 @@
 #include "EnhancedInput/Public/InputAction.h"
 #include "EnhancedInput/Public/InputMappingContext.h"
 #include "InputActionValue.h"
+#include "Headless/BBCSimProfiler.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Input/BBCInputReplaySubsystem.h"
+#include "Stats/BBCStats.h"
+#include "Tuning/BBCTuning.h"
+
+namespace
+{
+	/**
+	 * @brief Prints the input latency of the local player's paddle, or clears it.
+	 *
+	 * Usage: BBC.Input.Latency [reset]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs InputLatencyCommand(
+		TEXT("BBC.Input.Latency"),
+		TEXT("Prints input to paddle motion and estimated input to photon latency in frames. Usage: BBC.Input.Latency [reset]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const APlayerController* PlayerController = World != nullptr ? World->GetFirstPlayerController() : nullptr;
+			ABBCPaddle* Paddle = PlayerController != nullptr ? Cast<ABBCPaddle>(PlayerController->GetPawn()) : nullptr;
+			if (Paddle == nullptr)
+			{
+				return;
+			}
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				Paddle->GetInputLatency().Reset();
+				return;
+			}
+
+			int32 NumEdges = 0;
+			double SimFrames = 0.0;
+			double PhotonFrames = 0.0;
+			double MaxPhotonFrames = 0.0;
+			if (!Paddle->GetInputLatency().GetAverages(NumEdges, SimFrames, PhotonFrames, MaxPhotonFrames))
+			{
+				UE_LOG(LogTemp, Display, TEXT("No input edge measured yet"));
+				return;
+			}
+			UE_LOG(LogTemp, Display, TEXT("Input latency over %d edges: paddle moves after %.2f frames, photon after ~%.2f frames (max %.2f)"),
+				NumEdges, SimFrames, PhotonFrames, MaxPhotonFrames);
+		}));
+}
 
 /**
  * @brief Constructor for the ABBCPaddle class, initializing paddle properties and components.
  *
- * Sets up the paddle's default movement speed, creates scene and mesh components,
- * and configures collision settings for the paddle mesh.
+ * Creates scene and mesh components and configures collision settings for the paddle mesh.
  *
  * @details
- * - Enables actor tick for per-frame updates
+ * - Disables actor tick, the paddle is moved by the Paddle phase of UBBCTickManagerSubsystem
  * - Creates a root scene component and a static mesh component
  * - Configures paddle mesh collision:
  *   - Enables query and physics collision
@@ -24,15 +70,14 @@
  *   - Sets collision response to overlap with world static objects
  *   - Disables physics simulation
  *
- * @note Default movement speed is set to 350 units per second
- * @note Maximum boundary length is initially set to 0
+ * @note The movement speed is PaddleMovementSpeed of BBCTuning, 350 units per second by default
  */
 ABBCPaddle::ABBCPaddle():
-MovementSpeed(350.f),
-MaxBoundaryLength(0.f)
+InputDirection(0.f),
+PendingInputDirection(0.f),
+Velocity(0.f)
 {
- 	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	PaddleSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("PaddleSceneComponent"));
 	SetRootComponent(PaddleSceneComponent);
@@ -48,14 +93,15 @@ MaxBoundaryLength(0.f)
 /**
  * @brief Initializes the paddle actor when the game starts or when spawned.
  *
- * This method sets up the initial position, rotation, and scale of the paddle, 
+ * This method sets up the initial rotation and scale of the paddle, 
  * adds a "Paddle" tag, and configures input mapping for the player controller.
  *
  * @details The method performs the following key actions:
- * - Sets the actor's location to (0, 400, 0)
+ * - Leaves the actor's location to UBBCPlayfieldSubsystem, which puts the paddle on the lane of the arena
  * - Resets the actor's rotation to zero
- * - Scales the actor to (2, 1, 1)
+ * - Scales the actor to (PaddleWidthScale, 1, 1) of BBCTuning, (2, 1, 1) by default
  * - Adds a "Paddle" tag to the actor
+ * - Registers the paddle with the gameplay tick manager and looks up the ball subsystem it steps with
  * - Validates the controller and player controller
  * - Sets up enhanced input mapping context
  *
@@ -70,11 +116,16 @@ void ABBCPaddle::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	SetActorLocation(FVector(0.f,400.f,0.f));
 	SetActorRotation(FRotator::ZeroRotator);
-	SetActorScale3D(FVector(2.f,1.f,1.f));
+	SetActorScale3D(FVector(BBCTuning::Get().PaddleWidthScale,1.f,1.f));
 
 	this->Tags.Add("Paddle");
+
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterPaddle(this);
+	}
+	BallSubsystem = GetWorld()->GetSubsystem<UBBCBallSubsystem>();
 	
 	if(Controller == nullptr)
 	{
@@ -100,19 +151,14 @@ void ABBCPaddle::BeginPlay()
 	Subsystem->AddMappingContext(PlayerInputMappingContext, 0);
 }
 
-/**
- * @brief Updates the paddle's state every frame.
- *
- * @param DeltaTime The time elapsed since the last frame.
- *
- * @details Currently calls the parent class's Tick method without additional logic.
- * This method is called automatically by the game engine for each frame.
- *
- * @note Override of the base class Tick method to maintain the default frame update behavior.
- */
-void ABBCPaddle::Tick(float DeltaTime)
+void ABBCPaddle::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterPaddle(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -140,26 +186,141 @@ void ABBCPaddle::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent
 }
 
 /**
- * @brief Sets the maximum boundary length for the paddle's movement.
- * 
- * @param Value The maximum distance the paddle can move from its initial position.
- * 
- * @note This method allows dynamic adjustment of the paddle's movement constraints.
+ * @brief Returns the world space bounds of the paddle mesh.
+ *
+ * @return Axis aligned bounds used by the ball subsystem as the paddle collider.
+ */
+FBox ABBCPaddle::GetPaddleBounds() const
+{
+	return PaddleMesh->Bounds.GetBox();
+}
+
+/**
+ * @brief Takes the move samples received since the last frame.
+ *
+ * @note Move input only arrives while the action is triggered, so a frame without samples leaves the paddle still.
  */
-void ABBCPaddle::SetMaxBoundaryLength(float Value)
+void ABBCPaddle::LatchInput()
 {
-	MaxBoundaryLength = Value;
+	InputDirection = PendingInputDirection;
+	PendingInputDirection = 0.f;
+	if (PendingSamples.IsEmpty())
+	{
+		InputLatency.OnInput(0.f);
+	}
+	InputSamples.Append(PendingSamples);
+	PendingSamples.Reset();
+}
+
+/**
+ * @brief Moves the paddle through the fixed steps the balls will run this frame, clamped to the playfield layout's paddle range.
+ *
+ * The frame's samples are spread over its steps in arrival order, so a direction change received mid-frame
+ * takes effect mid-frame, and a single sample drives the whole frame with no smoothing. The actor is moved once,
+ * to the end of the last step.
+ *
+ * @param DeltaTime The time elapsed since the last frame.
+ *
+ * @note The ball subsystem sweeps its paddle collider along the recorded step positions and reads the step
+ * velocities on paddle contacts. Velocity stays the average over the frame.
+ * @note A frame that runs no step keeps its samples for the next one.
+ */
+void ABBCPaddle::TickMovement(float DeltaTime)
+{
+	BBC_SIM_SCOPE("ABBCPaddle");
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_PaddleMovement);
+	StepPositions.Reset();
+	StepVelocities.Reset();
+
+	const int32 NumSteps = BallSubsystem != nullptr ? BallSubsystem->GetNumStepsFor(DeltaTime) : (DeltaTime > 0.f ? 1 : 0);
+	const double StepSeconds = BallSubsystem != nullptr ? UBBCBallSubsystem::FixedStepSeconds : DeltaTime;
+	if(NumSteps == 0)
+	{
+		Velocity = 0.f;
+		return;
+	}
+
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	const double MinX = FMath::Min(Layout.PaddleMinX + ExtraHalfWidth, Layout.PaddleMaxX);
+	const double MaxX = FMath::Max(Layout.PaddleMaxX - ExtraHalfWidth, MinX);
+	FVector Location = GetActorLocation();
+	const double StartX = Location.X;
+	const int32 NumSamples = InputSamples.Num();
+	const double MovementSpeed = BBCTuning::Get().PaddleMovementSpeed;
+	StepPositions.Add(StartX);
+	for(int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		const float Axis = NumSamples > 0 ? InputSamples[Step * NumSamples / NumSteps].Axis : 0.f;
+		const double PreviousX = StepPositions.Last();
+		const double X = FMath::Clamp(PreviousX + Axis * MovementSpeed * StepSeconds, MinX, MaxX);
+		StepVelocities.Add(static_cast<float>((X - PreviousX) / StepSeconds));
+		StepPositions.Add(X);
+	}
+	InputSamples.Reset();
+
+	const double Displacement = StepPositions.Last() - StartX;
+	Velocity = static_cast<float>(Displacement / (NumSteps * StepSeconds));
+	InputLatency.OnPaddleMoved(Displacement);
+	if(Displacement != 0.0)
+	{
+		Location.X = StepPositions.Last();
+		SetActorLocation(Location);
+	}
+}
+
+/**
+ * @brief Scales the paddle's width, as the wide paddle power-up does.
+ *
+ * The playfield layout's paddle range was computed for the tuned width, so the extra half width is kept apart
+ * and taken off both ends of that range by TickMovement. A paddle widened against a wall is pushed back in.
+ *
+ * @param Multiplier Width relative to the tuned width; 1 restores it.
+ *
+ * @note The ball subsystem reads the paddle collider from the mesh bounds every frame, so it follows the new width.
+ */
+void ABBCPaddle::SetWidthMultiplier(double Multiplier)
+{
+	Multiplier = FMath::Max(Multiplier, 0.1);
+	if (Multiplier == WidthMultiplier)
+	{
+		return;
+	}
+
+	const double BaseHalfWidth = GetPaddleBounds().GetExtent().X / WidthMultiplier;
+	WidthMultiplier = Multiplier;
+	ExtraHalfWidth = BaseHalfWidth * (WidthMultiplier - 1.0);
+	SetActorScale3D(FVector(BBCTuning::Get().PaddleWidthScale * WidthMultiplier, 1.f, 1.f));
+
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	const double MinX = FMath::Min(Layout.PaddleMinX + ExtraHalfWidth, Layout.PaddleMaxX);
+	const double MaxX = FMath::Max(Layout.PaddleMaxX - ExtraHalfWidth, MinX);
+	FVector Location = GetActorLocation();
+	const double ClampedX = FMath::Clamp(Location.X, MinX, MaxX);
+	if (ClampedX != Location.X)
+	{
+		Location.X = ClampedX;
+		SetActorLocation(Location);
+	}
+}
+
+/**
+ * @brief Stores a timestamped move sample until the next Input phase latches it.
+ *
+ * @param Axis Move direction, clamped to [-1, 1].
+ */
+void ABBCPaddle::AddMoveInput(float Axis)
+{
+	PendingInputDirection = FMath::Clamp(Axis, -1.f,1.f);
+	PendingSamples.Add(FBBCPaddleInputSample{FPlatformTime::Seconds(), PendingInputDirection});
+	InputLatency.OnInput(PendingInputDirection);
 }
 
 void ABBCPaddle::MoveLeftOrRight(const FInputActionValue& Value)
 {
-	InputDirection = Value.Get<float>();
-	InputDirection = FMath::Clamp(InputDirection, -1.f,1.f);
-	const float DeltaTime = GetWorld()->GetDeltaSeconds();
-	const FVector TargetMovement = FVector::ForwardVector * InputDirection * MovementSpeed * DeltaTime;
-	const FVector CurrentLocation = GetActorLocation();
-	FVector NewLocation = FMath::VInterpTo(CurrentLocation, CurrentLocation + TargetMovement, DeltaTime,100.0f);
-	NewLocation.X = FMath::Clamp(NewLocation.X, -MaxBoundaryLength, MaxBoundaryLength);
-	SetActorLocation(NewLocation);
+	AddMoveInput(Value.Get<float>());
+	if(UBBCInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UBBCInputReplaySubsystem>())
+	{
+		InputReplay->RecordMove(PendingInputDirection);
+	}
 }
 
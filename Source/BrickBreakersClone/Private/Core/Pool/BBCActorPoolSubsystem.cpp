@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Pool/BBCActorPoolSubsystem.h"
+
+#include "Core/Pool/BBCPoolable.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Where inactive actors are parked, far outside the playfield. */
+	const FVector PoolParkingLocation(0.0, 0.0, -100000.0);
+
+	FAutoConsoleCommandWithWorld PoolStatsCommand(
+		TEXT("BBC.Pool.Stats"),
+		TEXT("Logs the free, active, hit and miss counts of every actor pool."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCActorPoolSubsystem* Pool = World != nullptr ? World->GetSubsystem<UBBCActorPoolSubsystem>() : nullptr)
+			{
+				Pool->LogStats();
+			}
+		}));
+}
+
+void UBBCActorPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UBBCActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Fills the pool for a class with inactive actors.
+ *
+ * The free list is reserved for the whole pool up front, so returning actors later never grows it.
+ *
+ * @param Class Class of the actors to pool.
+ * @param Count Number of actors the pool should hold.
+ *
+ * @note Meant to run at level load, where spawning cost is hidden.
+ */
+void UBBCActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if (Class == nullptr)
+	{
+		return;
+	}
+
+	FBBCActorPool& Pool = Pools.FindOrAdd(Class.Get());
+	Pool.Free.Reserve(Count);
+	while (Pool.Free.Num() + Pool.NumActive < Count)
+	{
+		AActor* Actor = SpawnPooledActor(Class);
+		if (Actor == nullptr)
+		{
+			return;
+		}
+		Deactivate(Actor);
+		Pool.Free.Add(Actor);
+		Pool.FreeSet.Add(Actor);
+	}
+}
+
+/**
+ * @brief Hands out an actor of the given class at the given location.
+ *
+ * - Takes the most recently returned actor, or spawns one and counts a miss when the pool is empty
+ * - Moves it into place, shows it and turns its collision and tick back on
+ * - Calls IBBCPoolable::OnAcquiredFromPool
+ *
+ * @param Class Class of the actor to hand out.
+ * @param Location Where to place the actor.
+ * @param Rotation How to orient the actor. The actor keeps its own scale.
+ *
+ * @return The actor, or nullptr if spawning failed.
+ */
+AActor* UBBCActorPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation)
+{
+	if (Class == nullptr)
+	{
+		return nullptr;
+	}
+
+	FBBCActorPool& Pool = Pools.FindOrAdd(Class.Get());
+	AActor* Actor = nullptr;
+	while (Actor == nullptr && Pool.Free.Num() > 0)
+	{
+		AActor* Candidate = Pool.Free.Pop(EAllowShrinking::No);
+		Pool.FreeSet.Remove(Candidate);
+		Actor = IsValid(Candidate) ? Candidate : nullptr;
+	}
+
+	if (Actor != nullptr)
+	{
+		++Pool.Hits;
+		BBC_INC_DWORD_STAT(STAT_BBC_PoolHits);
+	}
+	else
+	{
+		Actor = SpawnPooledActor(Class);
+		if (Actor == nullptr)
+		{
+			return nullptr;
+		}
+		++Pool.Misses;
+		BBC_INC_DWORD_STAT(STAT_BBC_PoolMisses);
+	}
+	++Pool.NumActive;
+
+	Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	if (IBBCPoolable* Poolable = Cast<IBBCPoolable>(Actor))
+	{
+		Poolable->OnAcquiredFromPool();
+	}
+	return Actor;
+}
+
+/**
+ * @brief Puts an actor handed out by Acquire back in its pool.
+ *
+ * @param Actor The actor to return. Actors of a class that was never pooled are destroyed instead.
+ *
+ * @note Releasing an actor that is already in its pool trips an ensure and is ignored, so the actor is never
+ * handed out to two owners.
+ */
+void UBBCActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FBBCActorPool* Pool = Pools.Find(Actor->GetClass());
+	if (Pool == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s was not acquired from a pool, destroying it"), *Actor->GetName());
+		Actor->Destroy();
+		return;
+	}
+
+	bool bAlreadyFree = false;
+	Pool->FreeSet.Add(Actor, &bAlreadyFree);
+	if (!ensureMsgf(!bAlreadyFree, TEXT("%s was released to its pool twice"), *Actor->GetName()))
+	{
+		return;
+	}
+
+	Deactivate(Actor);
+	Pool->NumActive = FMath::Max(Pool->NumActive - 1, 0);
+	Pool->Free.Add(Actor);
+}
+
+void UBBCActorPoolSubsystem::LogStats() const
+{
+	for (const TPair<TObjectPtr<UClass>, FBBCActorPool>& Pair : Pools)
+	{
+		const FBBCActorPool& Pool = Pair.Value;
+		UE_LOG(LogTemp, Display, TEXT("Pool %s: %d free, %d active, %lld hits, %lld misses"),
+			*GetNameSafe(Pair.Key), Pool.Free.Num(), Pool.NumActive, Pool.Hits, Pool.Misses);
+	}
+}
+
+AActor* UBBCActorPoolSubsystem::SpawnPooledActor(UClass* Class)
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(Class, FTransform(PoolParkingLocation), SpawnParameters);
+	if (Actor == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn pooled %s"), *GetNameSafe(Class));
+	}
+	return Actor;
+}
+
+/**
+ * @brief Takes an actor out of play without destroying it.
+ *
+ * @param Actor The actor to park.
+ */
+void UBBCActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	if (IBBCPoolable* Poolable = Cast<IBBCPoolable>(Actor))
+	{
+		Poolable->OnReturnedToPool();
+	}
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetActorLocation(PoolParkingLocation);
+}
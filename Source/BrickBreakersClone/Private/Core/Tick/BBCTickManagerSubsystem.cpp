@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+
+#include "AI/BBCAutopilotController.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "GameState/BBCGameState.h"
+#include "HAL/IConsoleManager.h"
+#include "Headless/BBCSimProfiler.h"
+#include "Replay/BBCStateReplaySubsystem.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorld TickStatsCommand(
+		TEXT("BBC.Tick.Stats"),
+		TEXT("Logs the time spent in each gameplay tick phase during the last frame."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UBBCTickManagerSubsystem* TickManager = World != nullptr ? World->GetSubsystem<UBBCTickManagerSubsystem>() : nullptr;
+			if (TickManager == nullptr)
+			{
+				return;
+			}
+			for (int32 Phase = 0; Phase < static_cast<int32>(EBBCTickPhase::Num); ++Phase)
+			{
+				UE_LOG(LogTemp, Display, TEXT("%s: %.3f ms"), UBBCTickManagerSubsystem::GetPhaseName(static_cast<EBBCTickPhase>(Phase)),
+					TickManager->GetLastPhaseSeconds(static_cast<EBBCTickPhase>(Phase)) * 1000.0);
+			}
+		}));
+
+	/**
+	 * Writes the time spent in the enclosing scope to one entry of LastPhaseSeconds.
+	 */
+	class FBBCPhaseTimer
+	{
+	public:
+
+		explicit FBBCPhaseTimer(double& InOutSeconds)
+			: OutSeconds(InOutSeconds)
+			, StartSeconds(FPlatformTime::Seconds())
+		{
+		}
+
+		~FBBCPhaseTimer()
+		{
+			OutSeconds = FPlatformTime::Seconds() - StartSeconds;
+		}
+
+	private:
+
+		double& OutSeconds;
+		double StartSeconds;
+	};
+
+	/** Calls Function on every live entry in registration order and drops the stale ones in the same pass. */
+	template <typename T, typename FunctionType>
+	void ForEachRegistered(TArray<TWeakObjectPtr<T>>& Registered, FunctionType Function)
+	{
+		for (int32 Index = 0; Index < Registered.Num();)
+		{
+			if (T* Object = Registered[Index].Get())
+			{
+				Function(*Object);
+				++Index;
+			}
+			else
+			{
+				Registered.RemoveAt(Index, 1, EAllowShrinking::No);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Finds the state replay, whose viewer replaces the phases while a replay is watched.
+ *
+ * @param InWorld The world that just started play.
+ */
+void UBBCTickManagerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	StateReplaySubsystem = InWorld.GetSubsystem<UBBCStateReplaySubsystem>();
+}
+
+/**
+ * @brief Runs the gameplay phases in order.
+ *
+ * Within each phase, the subsystem updates registered before the actors run first, then the actors, then the
+ * updates registered after them. With the subsystems of this module, a frame runs:
+ *
+ * - Input: autopilots push their move input, then paddles latch the input received since the last frame
+ * - Paddle: paddles move and compute their velocity
+ * - Balls: the ball subsystem advances its fixed steps against the moved paddle, the trajectory overlay is
+ *   drawn, and a versus match, if one is running, advances its frames
+ * - Bricks: power-up pickups fall, laser bolts fly and expired power-ups end; brick fields run explosions and
+ *   regeneration, then apply the instance removals queued this frame, and the endless ring, if one is running,
+ *   scrolls and streams its chunks; then the break effects requested by this frame's destroyed bricks play
+ *   within the effects budget
+ * - GameState: game states publish the counters changed by this frame's events, then the state replay, if
+ *   one is being recorded, captures the frame
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ */
+void UBBCTickManagerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (StateReplaySubsystem != nullptr && StateReplaySubsystem->IsViewing())
+	{
+		StateReplaySubsystem->AdvanceViewer(DeltaTime);
+		return;
+	}
+
+	{
+		BBC_SIM_SCOPE("Phase.Input");
+		FBBCPhaseTimer Timer(LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::Input)]);
+		RunUpdates(EBBCTickPhase::Input, EBBCTickOrder::BeforeActors, DeltaTime);
+		TickInput();
+		RunUpdates(EBBCTickPhase::Input, EBBCTickOrder::AfterActors, DeltaTime);
+	}
+	{
+		BBC_SIM_SCOPE("Phase.Paddle");
+		FBBCPhaseTimer Timer(LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::Paddle)]);
+		RunUpdates(EBBCTickPhase::Paddle, EBBCTickOrder::BeforeActors, DeltaTime);
+		TickPaddles(DeltaTime);
+		RunUpdates(EBBCTickPhase::Paddle, EBBCTickOrder::AfterActors, DeltaTime);
+	}
+	{
+		BBC_SIM_SCOPE("Phase.Balls");
+		FBBCPhaseTimer Timer(LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::Balls)]);
+		RunUpdates(EBBCTickPhase::Balls, EBBCTickOrder::BeforeActors, DeltaTime);
+		RunUpdates(EBBCTickPhase::Balls, EBBCTickOrder::AfterActors, DeltaTime);
+	}
+	{
+		BBC_SIM_SCOPE("Phase.Bricks");
+		FBBCPhaseTimer Timer(LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::Bricks)]);
+		RunUpdates(EBBCTickPhase::Bricks, EBBCTickOrder::BeforeActors, DeltaTime);
+		TickBricks(DeltaTime);
+		RunUpdates(EBBCTickPhase::Bricks, EBBCTickOrder::AfterActors, DeltaTime);
+	}
+	{
+		BBC_SIM_SCOPE("Phase.GameState");
+		FBBCPhaseTimer Timer(LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::GameState)]);
+		RunUpdates(EBBCTickPhase::GameState, EBBCTickOrder::BeforeActors, DeltaTime);
+		TickGameStates();
+		RunUpdates(EBBCTickPhase::GameState, EBBCTickOrder::AfterActors, DeltaTime);
+	}
+}
+
+TStatId UBBCTickManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBBCTickManagerSubsystem, STATGROUP_Tickables);
+}
+
+bool UBBCTickManagerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBBCTickManagerSubsystem::RegisterUpdate(EBBCTickPhase Phase, EBBCTickOrder Order, FBBCTickUpdate Update)
+{
+	if (ensure(Update.IsBound()))
+	{
+		Updates[static_cast<int32>(Phase)][static_cast<int32>(Order)].Add(MoveTemp(Update));
+	}
+}
+
+void UBBCTickManagerSubsystem::UnregisterUpdates(const UObject* Object)
+{
+	for (auto& PhaseUpdates : Updates)
+	{
+		for (TArray<FBBCTickUpdate>& OrderUpdates : PhaseUpdates)
+		{
+			OrderUpdates.RemoveAll([Object](const FBBCTickUpdate& Update) { return Update.IsBoundToObject(Object); });
+		}
+	}
+}
+
+void UBBCTickManagerSubsystem::RegisterAutopilot(ABBCAutopilotController* Autopilot)
+{
+	Autopilots.AddUnique(Autopilot);
+}
+
+void UBBCTickManagerSubsystem::UnregisterAutopilot(ABBCAutopilotController* Autopilot)
+{
+	Autopilots.RemoveSingle(Autopilot);
+}
+
+void UBBCTickManagerSubsystem::RegisterPaddle(ABBCPaddle* Paddle)
+{
+	Paddles.AddUnique(Paddle);
+}
+
+void UBBCTickManagerSubsystem::UnregisterPaddle(ABBCPaddle* Paddle)
+{
+	Paddles.RemoveSingle(Paddle);
+}
+
+void UBBCTickManagerSubsystem::RegisterBrickField(UBBCBrickFieldComponent* BrickField)
+{
+	BrickFields.AddUnique(BrickField);
+}
+
+void UBBCTickManagerSubsystem::UnregisterBrickField(UBBCBrickFieldComponent* BrickField)
+{
+	BrickFields.RemoveSingle(BrickField);
+}
+
+void UBBCTickManagerSubsystem::RegisterGameState(ABBCGameState* GameState)
+{
+	GameStates.AddUnique(GameState);
+}
+
+void UBBCTickManagerSubsystem::UnregisterGameState(ABBCGameState* GameState)
+{
+	GameStates.RemoveSingle(GameState);
+}
+
+const TCHAR* UBBCTickManagerSubsystem::GetPhaseName(EBBCTickPhase Phase)
+{
+	switch (Phase)
+	{
+	case EBBCTickPhase::Input: return TEXT("Input");
+	case EBBCTickPhase::Paddle: return TEXT("Paddle");
+	case EBBCTickPhase::Balls: return TEXT("Balls");
+	case EBBCTickPhase::Bricks: return TEXT("Bricks");
+	case EBBCTickPhase::GameState: return TEXT("GameState");
+	default: return TEXT("Unknown");
+	}
+}
+
+void UBBCTickManagerSubsystem::TickInput()
+{
+	ForEachRegistered(Autopilots, [](ABBCAutopilotController& Autopilot) { Autopilot.UpdateInput(); });
+	ForEachRegistered(Paddles, [](ABBCPaddle& Paddle) { Paddle.LatchInput(); });
+}
+
+void UBBCTickManagerSubsystem::TickPaddles(float DeltaTime)
+{
+	ForEachRegistered(Paddles, [DeltaTime](ABBCPaddle& Paddle) { Paddle.TickMovement(DeltaTime); });
+}
+
+void UBBCTickManagerSubsystem::TickBricks(float DeltaTime)
+{
+	ForEachRegistered(BrickFields, [DeltaTime](UBBCBrickFieldComponent& BrickField) { BrickField.UpdateField(DeltaTime); });
+}
+
+void UBBCTickManagerSubsystem::TickGameStates()
+{
+	ForEachRegistered(GameStates, [](ABBCGameState& GameState) { GameState.FlushScoreboard(); });
+}
+
+/**
+ * @brief Calls the updates of one slot in registration order, dropping those whose object was destroyed.
+ */
+void UBBCTickManagerSubsystem::RunUpdates(EBBCTickPhase Phase, EBBCTickOrder Order, float DeltaTime)
+{
+	TArray<FBBCTickUpdate>& OrderUpdates = Updates[static_cast<int32>(Phase)][static_cast<int32>(Order)];
+	for (int32 Index = 0; Index < OrderUpdates.Num();)
+	{
+		if (OrderUpdates[Index].ExecuteIfBound(DeltaTime))
+		{
+			++Index;
+		}
+		else
+		{
+			OrderUpdates.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+}
@@ -0,0 +1,332 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Effects/BBCEffectsSubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundBase.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Volume gained per extra brick a sound stands for, and the most it can reach. */
+	constexpr float MergedVolumeStep = 0.25f;
+	constexpr float MaxMergedVolume = 2.f;
+
+	FAutoConsoleCommandWithWorld EffectsStatsCommand(
+		TEXT("BBC.Fx.Stats"),
+		TEXT("Logs how many break effects were requested, merged, spawned, reduced and culled."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCEffectsSubsystem* Effects = World != nullptr ? World->GetSubsystem<UBBCEffectsSubsystem>() : nullptr)
+			{
+				Effects->LogStats();
+			}
+		}));
+
+	/**
+	 * @brief Requests break effects at random points of the brick area, as a chain reaction would.
+	 *
+	 * Usage: BBC.Fx.Burst [Count]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs EffectsBurstCommand(
+		TEXT("BBC.Fx.Burst"),
+		TEXT("Requests break effects at random points of the brick area in one frame. Usage: BBC.Fx.Burst [Count]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCEffectsSubsystem* Effects = World != nullptr ? World->GetSubsystem<UBBCEffectsSubsystem>() : nullptr;
+			if (Effects == nullptr)
+			{
+				return;
+			}
+			const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+			const FBox2D BrickArea = UBBCPlayfieldSubsystem::GetLayout(World).BrickArea;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Effects->RequestBreak(FVector2D(FMath::FRandRange(BrickArea.Min.X, BrickArea.Max.X), FMath::FRandRange(BrickArea.Min.Y, BrickArea.Max.Y)));
+			}
+		}));
+}
+
+void UBBCEffectsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bStubbed = FParse::Param(FCommandLine::Get(), TEXT("BBCFxStub")) || !FApp::CanEverRender();
+	Pending.Reserve(MaxPendingRequests);
+	Bursts.Reserve(EffectsPerFrame);
+	if (UBBCGameEventSubsystem* GameEvents = Collection.InitializeDependency<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnBrickDestroyed().AddUObject(this, &UBBCEffectsSubsystem::HandleBrickDestroyed);
+	}
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Bricks, EBBCTickOrder::AfterActors, FBBCTickUpdate::CreateWeakLambda(this, [this](float) { Flush(); }));
+	}
+}
+
+void UBBCEffectsSubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	if (UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnBrickDestroyed().RemoveAll(this);
+	}
+	if (IsValid(PoolActor))
+	{
+		PoolActor->Destroy();
+	}
+	PoolActor = nullptr;
+	ParticleComponents.Empty();
+	AudioComponents.Empty();
+
+	Super::Deinitialize();
+}
+
+void UBBCEffectsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CreatePool();
+}
+
+bool UBBCEffectsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Queues a break effect for the next Flush.
+ *
+ * @param Location Where the brick broke, on the gameplay plane.
+ *
+ * @note Requests beyond MaxPendingRequests in one frame are culled without being looked at.
+ */
+void UBBCEffectsSubsystem::RequestBreak(const FVector2D& Location)
+{
+	++Counters.Requested;
+	++NumRequestedThisFrame;
+	if (Pending.Num() >= MaxPendingRequests)
+	{
+		++Counters.Culled;
+		return;
+	}
+	Pending.Add(Location);
+}
+
+/**
+ * @brief Plays the requests of this frame within the budget.
+ *
+ * - Merges each request into the first burst within MergeRadius, or starts a burst while fewer than
+ *   EffectsPerFrame exist; anything else is culled
+ * - Under pressure (more than PressureRequests requests, or over half the particle pool still playing) plays the
+ *   reduced break effect and a single sound
+ * - Plays the largest bursts first, so a burst that culls for want of a free component is the smallest one
+ * - Scales each sound's volume with the number of bricks its burst stands for
+ *
+ * @note While the Effects bundle is loading, bursts without an asset are culled.
+ */
+void UBBCEffectsSubsystem::Flush()
+{
+	if (NumRequestedThisFrame == 0)
+	{
+		return;
+	}
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_EffectsFlush);
+
+	const int64 CulledBefore = Counters.Culled;
+	const int64 SpawnedBefore = Counters.Spawned;
+	const double MergeRadiusSquared = MergeRadius * MergeRadius;
+	Bursts.Reset();
+	for (const FVector2D& Location : Pending)
+	{
+		FBurst* Burst = Bursts.FindByPredicate([&Location, MergeRadiusSquared](const FBurst& Candidate)
+		{
+			return FVector2D::DistSquared(Candidate.Location, Location) <= MergeRadiusSquared;
+		});
+		if (Burst != nullptr)
+		{
+			++Burst->Count;
+			++Counters.Merged;
+		}
+		else if (Bursts.Num() < EffectsPerFrame)
+		{
+			Bursts.Add(FBurst{Location, 1});
+		}
+		else
+		{
+			++Counters.Culled;
+		}
+	}
+	Bursts.Sort([](const FBurst& A, const FBurst& B) { return A.Count > B.Count; });
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const bool bUnderPressure = NumRequestedThisFrame > PressureRequests || GetNumBusy(ParticleFreeSeconds, Now) * 2 > ParticleFreeSeconds.Num();
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	UParticleSystem* Template = Assets == nullptr ? nullptr : bUnderPressure ? Assets->GetReducedBreakEffect() : Assets->GetBreakEffect();
+	USoundBase* Sound = Assets != nullptr ? Assets->GetBreakSound() : nullptr;
+	const int32 MaxSounds = bUnderPressure ? 1 : SoundsPerFrame;
+	int32 NumSounds = 0;
+
+	for (const FBurst& Burst : Bursts)
+	{
+		const int32 Slot = bStubbed || Template != nullptr ? AcquireSlot(ParticleFreeSeconds, Now, EffectLifetime) : INDEX_NONE;
+		if (Slot == INDEX_NONE)
+		{
+			Counters.Culled += Burst.Count;
+			continue;
+		}
+		const FVector Location(Burst.Location, 0.0);
+		if (!bStubbed)
+		{
+			UParticleSystemComponent* Component = ParticleComponents[Slot];
+			if (Component->Template != Template)
+			{
+				Component->SetTemplate(Template);
+			}
+			Component->SetWorldLocation(Location);
+			Component->ActivateSystem(true);
+		}
+		++Counters.Spawned;
+		Counters.Reduced += bUnderPressure ? 1 : 0;
+
+		if (NumSounds >= MaxSounds || (!bStubbed && Sound == nullptr))
+		{
+			continue;
+		}
+		const int32 AudioSlot = AcquireSlot(AudioFreeSeconds, Now, SoundLifetime);
+		if (AudioSlot == INDEX_NONE)
+		{
+			continue;
+		}
+		if (!bStubbed)
+		{
+			UAudioComponent* Component = AudioComponents[AudioSlot];
+			if (Component->Sound != Sound)
+			{
+				Component->SetSound(Sound);
+			}
+			Component->SetWorldLocation(Location);
+			Component->SetVolumeMultiplier(FMath::Min(1.f + MergedVolumeStep * (Burst.Count - 1), MaxMergedVolume));
+			Component->Play();
+		}
+		++NumSounds;
+		++Counters.Sounds;
+	}
+
+	BBC_SET_DWORD_STAT(STAT_BBC_EffectsRequested, NumRequestedThisFrame);
+	BBC_SET_DWORD_STAT(STAT_BBC_EffectsSpawned, static_cast<uint32>(Counters.Spawned - SpawnedBefore));
+	BBC_SET_DWORD_STAT(STAT_BBC_EffectsCulled, static_cast<uint32>(Counters.Culled - CulledBefore));
+	Pending.Reset();
+	NumRequestedThisFrame = 0;
+}
+
+void UBBCEffectsSubsystem::LogStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("Effects%s: %lld requested, %lld merged, %lld spawned (%lld reduced), %lld culled, %lld sounds"),
+		bStubbed ? TEXT(" (stubbed)") : TEXT(""), Counters.Requested, Counters.Merged, Counters.Spawned, Counters.Reduced,
+		Counters.Culled, Counters.Sounds);
+}
+
+/**
+ * @brief Creates every pooled component up front, inactive, on an actor owning them.
+ *
+ * @note A stubbed pool only sizes its slots; no actor or component is created.
+ */
+void UBBCEffectsSubsystem::CreatePool()
+{
+	ParticleFreeSeconds.Init(0.0, FMath::Max(ParticlePoolSize, 1));
+	AudioFreeSeconds.Init(0.0, FMath::Max(AudioPoolSize, 0));
+	if (bStubbed)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("EffectsPool");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	PoolActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(PoolActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn effects pool actor. "));
+		ParticleFreeSeconds.Reset();
+		AudioFreeSeconds.Reset();
+		return;
+	}
+	USceneComponent* Root = NewObject<USceneComponent>(PoolActor, TEXT("EffectsRoot"));
+	PoolActor->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	ParticleComponents.Reserve(ParticleFreeSeconds.Num());
+	for (int32 Slot = 0; Slot < ParticleFreeSeconds.Num(); ++Slot)
+	{
+		UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(PoolActor);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetupAttachment(Root);
+		Component->RegisterComponent();
+		ParticleComponents.Add(Component);
+	}
+	AudioComponents.Reserve(AudioFreeSeconds.Num());
+	for (int32 Slot = 0; Slot < AudioFreeSeconds.Num(); ++Slot)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(PoolActor);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetupAttachment(Root);
+		Component->RegisterComponent();
+		AudioComponents.Add(Component);
+	}
+}
+
+/**
+ * @brief Reserves the first pooled slot that finished playing.
+ *
+ * @param FreeSeconds World time at which each slot of the pool is free again.
+ * @param Now Current world time.
+ * @param Lifetime How long the slot stays reserved.
+ *
+ * @return The reserved slot, or INDEX_NONE if every slot is still playing.
+ */
+int32 UBBCEffectsSubsystem::AcquireSlot(TArray<double>& FreeSeconds, double Now, double Lifetime) const
+{
+	for (int32 Slot = 0; Slot < FreeSeconds.Num(); ++Slot)
+	{
+		if (FreeSeconds[Slot] <= Now)
+		{
+			FreeSeconds[Slot] = Now + Lifetime;
+			return Slot;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 UBBCEffectsSubsystem::GetNumBusy(const TArray<double>& FreeSeconds, double Now) const
+{
+	int32 NumBusy = 0;
+	for (const double Seconds : FreeSeconds)
+	{
+		NumBusy += Seconds > Now ? 1 : 0;
+	}
+	return NumBusy;
+}
+
+void UBBCEffectsSubsystem::HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event)
+{
+	RequestBreak(Event.Location);
+}
@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Endless/BBCEndlessRing.h"
+
+/**
+ * @brief Allocates every chunk once and fills the ring with its first chunks.
+ *
+ * @param InSettings Ring size and generation settings.
+ * @param InLeft Left edge of the bricks.
+ * @param BottomY Bottom edge of chunk 0, the lowest one; the others are stacked above it.
+ */
+void FBBCEndlessRing::Init(const FBBCEndlessSettings& InSettings, double InLeft, double BottomY)
+{
+	Settings = InSettings;
+	Settings.NumChunks = FMath::Max(Settings.NumChunks, 2);
+	Settings.ChunkRows = FMath::Max(Settings.ChunkRows, 1);
+	Settings.Columns = FMath::Max(Settings.Columns, 1);
+	Settings.MaxHitPoints = FMath::Max<uint8>(Settings.MaxHitPoints, 1);
+	Settings.ChunksPerHitPoint = FMath::Max(Settings.ChunksPerHitPoint, 1);
+
+	const int32 NumCells = Settings.NumChunks * GetCellsPerChunk();
+	HitPoints.SetNumZeroed(NumCells);
+	SlotSequences.SetNumZeroed(Settings.NumChunks);
+	DestroyedCells.Reset();
+	DestroyedCells.Reserve(NumCells);
+	FirstSequence = 0;
+	Left = InLeft;
+	BaseY = BottomY - GetChunkHeight();
+	NumAlive = 0;
+	for (int32 Slot = 0; Slot < Settings.NumChunks; ++Slot)
+	{
+		NumAlive += Generate(Slot, Slot);
+	}
+}
+
+/**
+ * @brief Scrolls the ring down and recycles the chunks that left through the bottom.
+ *
+ * @param Distance How far the bricks move down.
+ * @param RecycleY A chunk whose top edge is below this line is recycled.
+ * @param OutSlots Slots regenerated by this call are appended.
+ * @param OutNumAdded Bricks generated by this call.
+ * @param OutNumRemoved Live bricks of the recycled chunks.
+ *
+ * @return Number of chunks recycled.
+ */
+int32 FBBCEndlessRing::Scroll(double Distance, double RecycleY, TArray<int32>& OutSlots, int32& OutNumAdded, int32& OutNumRemoved)
+{
+	OutNumAdded = 0;
+	OutNumRemoved = 0;
+	if (HitPoints.IsEmpty())
+	{
+		return 0;
+	}
+
+	BaseY += Distance;
+	int32 NumRecycled = 0;
+	while (BaseY - FirstSequence * GetChunkHeight() > RecycleY && NumRecycled < Settings.NumChunks)
+	{
+		const int32 Slot = static_cast<int32>(FirstSequence % Settings.NumChunks);
+		const int32 FirstCell = Slot * GetCellsPerChunk();
+		for (int32 Cell = FirstCell; Cell < FirstCell + GetCellsPerChunk(); ++Cell)
+		{
+			OutNumRemoved += HitPoints[Cell] > 0 ? 1 : 0;
+		}
+		OutNumAdded += Generate(Slot, FirstSequence + Settings.NumChunks);
+		OutSlots.Add(Slot);
+		++FirstSequence;
+		++NumRecycled;
+	}
+	NumAlive += OutNumAdded - OutNumRemoved;
+	return NumRecycled;
+}
+
+/**
+ * @brief Sweeps a ball against the live bricks of the chunks under its swept bounds.
+ *
+ * Only the cells overlapped by the sweep are visited, chunk by chunk, and tested with the batched kernel of the
+ * brick field.
+ */
+bool FBBCEndlessRing::SweepBall(const FVector2D& Start, const FVector2D& Delta, double Radius, double& OutTime,
+	FVector2D& OutNormal, int32& OutCell) const
+{
+	if (NumAlive == 0)
+	{
+		return false;
+	}
+
+	const FVector2D End = Start + Delta;
+	const FVector2D SweepMin = FVector2D(FMath::Min(Start.X, End.X), FMath::Min(Start.Y, End.Y)) - FVector2D(Radius, Radius);
+	const FVector2D SweepMax = FVector2D(FMath::Max(Start.X, End.X), FMath::Max(Start.Y, End.Y)) + FVector2D(Radius, Radius);
+	const FVector2D& BrickSize = Settings.BrickSize;
+	if (SweepMax.X < Left || SweepMin.X >= Left + Settings.Columns * BrickSize.X)
+	{
+		return false;
+	}
+	const int32 FirstColumn = FMath::Max(FMath::FloorToInt32((SweepMin.X - Left) / BrickSize.X), 0);
+	const int32 LastColumn = FMath::Min(FMath::FloorToInt32((SweepMax.X - Left) / BrickSize.X), Settings.Columns - 1);
+
+	SweepCandidates.Reset();
+	for (int32 Slot = 0; Slot < Settings.NumChunks; ++Slot)
+	{
+		const double Top = GetChunkTop(Slot);
+		if (SweepMax.Y < Top || SweepMin.Y >= Top + GetChunkHeight())
+		{
+			continue;
+		}
+		const int32 FirstRow = FMath::Max(FMath::FloorToInt32((SweepMin.Y - Top) / BrickSize.Y), 0);
+		const int32 LastRow = FMath::Min(FMath::FloorToInt32((SweepMax.Y - Top) / BrickSize.Y), Settings.ChunkRows - 1);
+		for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+		{
+			for (int32 Column = FirstColumn; Column <= LastColumn; ++Column)
+			{
+				const int32 Cell = Slot * GetCellsPerChunk() + Row * Settings.Columns + Column;
+				if (HitPoints[Cell] > 0)
+				{
+					SweepCandidates.Add(GetCellBox(Cell), Start, Cell);
+				}
+			}
+		}
+	}
+	if (SweepCandidates.Num() == 0)
+	{
+		return false;
+	}
+	SweepCandidates.Finalize();
+
+	FBBCBatchHit Hit;
+	if (!BBCCollision::SweepCircleBoxBatch(FVector2f(Delta), static_cast<float>(Radius), SweepCandidates, Hit))
+	{
+		return false;
+	}
+	OutTime = Hit.Time;
+	OutNormal = FVector2D(Hit.Normal).GetSafeNormal();
+	OutCell = Hit.Id;
+	return true;
+}
+
+/**
+ * @brief Removes hit points from a brick and records it for the view once it runs out.
+ *
+ * @param Cell Cell of a live brick.
+ * @param Damage Hit points to remove.
+ *
+ * @return true if the brick was destroyed.
+ */
+bool FBBCEndlessRing::DamageCell(int32 Cell, uint8 Damage)
+{
+	if (!IsCellAlive(Cell))
+	{
+		return false;
+	}
+	uint8& CellHitPoints = HitPoints[Cell];
+	CellHitPoints = CellHitPoints > Damage ? CellHitPoints - Damage : 0;
+	if (CellHitPoints > 0)
+	{
+		return false;
+	}
+	--NumAlive;
+	DestroyedCells.Add(Cell);
+	return true;
+}
+
+FBox2D FBBCEndlessRing::GetCellBox(int32 Cell) const
+{
+	const int32 CellsPerChunk = GetCellsPerChunk();
+	const int32 Slot = Cell / CellsPerChunk;
+	const int32 Local = Cell % CellsPerChunk;
+	const FVector2D Min(Left + (Local % Settings.Columns) * Settings.BrickSize.X, GetChunkTop(Slot) + (Local / Settings.Columns) * Settings.BrickSize.Y);
+	return FBox2D(Min, Min + Settings.BrickSize);
+}
+
+FBox2D FBBCEndlessRing::GetBounds() const
+{
+	const double Bottom = BaseY - (FirstSequence - 1) * GetChunkHeight();
+	const double Top = Bottom - Settings.NumChunks * GetChunkHeight();
+	return FBox2D(FVector2D(Left, Top), FVector2D(Left + Settings.Columns * Settings.BrickSize.X, Bottom));
+}
+
+SIZE_T FBBCEndlessRing::GetAllocatedSize() const
+{
+	return HitPoints.GetAllocatedSize() + SlotSequences.GetAllocatedSize() + DestroyedCells.GetAllocatedSize()
+		+ SweepCandidates.MinX.GetAllocatedSize() * 4 + SweepCandidates.Ids.GetAllocatedSize();
+}
+
+/**
+ * @brief Fills a slot with the bricks of one chunk.
+ *
+ * Each cell holds a brick with FillChance, of 1 up to a maximum number of hit points that grows by one every
+ * ChunksPerHitPoint chunks. A chunk that rolled no brick at all gets one in its bottom row, so every chunk
+ * gives the ball something to hit.
+ *
+ * @param Slot Slot of the arena to overwrite.
+ * @param Sequence Number of the chunk, counted from the first one of the session.
+ *
+ * @return Number of bricks generated.
+ */
+int32 FBBCEndlessRing::Generate(int32 Slot, int64 Sequence)
+{
+	SlotSequences[Slot] = Sequence;
+	FRandomStream Stream(static_cast<int32>(HashCombineFast(GetTypeHash(Settings.Seed), GetTypeHash(Sequence))));
+	const int32 StrongestHitPoints = 1 + static_cast<int32>(FMath::Min<int64>(Sequence / Settings.ChunksPerHitPoint, Settings.MaxHitPoints - 1));
+
+	const int32 FirstCell = Slot * GetCellsPerChunk();
+	int32 NumBricks = 0;
+	for (int32 Cell = FirstCell; Cell < FirstCell + GetCellsPerChunk(); ++Cell)
+	{
+		const bool bBrick = Stream.FRand() < Settings.FillChance;
+		HitPoints[Cell] = bBrick ? static_cast<uint8>(Stream.RandRange(1, StrongestHitPoints)) : 0;
+		NumBricks += bBrick ? 1 : 0;
+	}
+	if (NumBricks == 0)
+	{
+		HitPoints[FirstCell + (Settings.ChunkRows - 1) * Settings.Columns + Settings.Columns / 2] = 1;
+		NumBricks = 1;
+	}
+	return NumBricks;
+}
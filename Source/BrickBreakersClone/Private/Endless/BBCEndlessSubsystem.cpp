@@ -0,0 +1,330 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Endless/BBCEndlessSubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Ball/BBCTrajectorySubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Scale of the instance of an empty cell; the instance stays so no buffer is reallocated. */
+	const FVector HiddenScale = FVector::ZeroVector;
+
+	FAutoConsoleCommandWithWorld EndlessStatsCommand(
+		TEXT("BBC.Endless.Stats"),
+		TEXT("Logs the size, scroll position and memory of the endless brick ring."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UBBCEndlessSubsystem* Endless = World != nullptr ? World->GetSubsystem<UBBCEndlessSubsystem>() : nullptr;
+			if (Endless != nullptr && Endless->IsActive())
+			{
+				Endless->LogStats();
+			}
+		}));
+}
+
+bool UBBCEndlessSubsystem::IsRequestedOnCommandLine()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("BBCEndless"));
+}
+
+void UBBCEndlessSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	BallSubsystem = Collection.InitializeDependency<UBBCBallSubsystem>();
+	if (UBBCGameEventSubsystem* GameEvents = Collection.InitializeDependency<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnPlayfieldChanged().AddUObject(this, &UBBCEndlessSubsystem::HandlePlayfieldChanged);
+	}
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Bricks, EBBCTickOrder::AfterActors, FBBCTickUpdate::CreateUObject(this, &UBBCEndlessSubsystem::Advance));
+	}
+}
+
+void UBBCEndlessSubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	Stop();
+	if (UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnPlayfieldChanged().RemoveAll(this);
+	}
+	BallSubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UBBCEndlessSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Sizes the ring from the brick area, fills it and hands it to the ball subsystem.
+ *
+ * The ring gets as many columns as fit the brick area, centred in it, and enough chunks to cover the brick area
+ * from the top of the arena plus one spare that scrolls in from above. Chunk 0 starts flush with the bottom of
+ * the brick area.
+ *
+ * @param Seed Seed of the chunk stream; the same seed gives the same bricks.
+ */
+void UBBCEndlessSubsystem::Start(int32 Seed)
+{
+	Stop();
+
+	if (BallSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BallSubsystem is Invalid"));
+		return;
+	}
+
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	FBBCEndlessSettings Settings;
+	Settings.ChunkRows = FMath::Max(ChunkRows, 1);
+	Settings.BrickSize = FVector2D(FMath::Max(BrickSize.X, 1.0), FMath::Max(BrickSize.Y, 1.0));
+	Settings.Columns = FMath::Max(FMath::FloorToInt32(Layout.BrickArea.GetSize().X / Settings.BrickSize.X), 1);
+	const double ChunkHeight = Settings.ChunkRows * Settings.BrickSize.Y;
+	const double CoveredHeight = Layout.BrickArea.Max.Y - Layout.Arena.Min.Y;
+	Settings.NumChunks = FMath::Clamp(FMath::CeilToInt32(CoveredHeight / ChunkHeight) + 1, 2, FMath::Max(MaxChunks, 2));
+	Settings.Seed = Seed;
+	Settings.FillChance = FillChance;
+	Settings.MaxHitPoints = static_cast<uint8>(FMath::Clamp(MaxHitPoints, 1, 255));
+	Settings.ChunksPerHitPoint = ChunksPerHitPoint;
+	Ring.Init(Settings, 0.0, Layout.BrickArea.Max.Y);
+	Ring.SetLeft(GetCentredLeft());
+	ScrollSinceInvalidate = 0.0;
+	InvalidatedBounds = Ring.GetBounds();
+
+	RecycledSlots.Reset();
+	RecycledSlots.Reserve(Ring.GetSettings().NumChunks);
+	SlotTransforms.Reset();
+	SlotTransforms.Reserve(Ring.GetCellsPerChunk());
+
+	CreateView();
+	BallSubsystem->SetBrickSource(&Ring);
+	bActive = true;
+
+	UE_LOG(LogTemp, Display, TEXT("Endless mode started: %d chunks of %d x %d bricks, seed %d"),
+		Ring.GetSettings().NumChunks, Ring.GetSettings().ChunkRows, Ring.GetSettings().Columns, Seed);
+}
+
+void UBBCEndlessSubsystem::Stop()
+{
+	if (bActive && BallSubsystem != nullptr)
+	{
+		BallSubsystem->SetBrickSource(nullptr);
+	}
+	if (IsValid(ViewActor))
+	{
+		ViewActor->Destroy();
+	}
+	ViewActor = nullptr;
+	BrickInstances = nullptr;
+	bActive = false;
+}
+
+/**
+ * @brief Scrolls the ring and keeps its view and the game state in step.
+ *
+ * Bricks destroyed since the last call are hidden first, then the ring scrolls and the instances of every slot
+ * it regenerated are rewritten. The view actor follows the ring, so scrolling itself moves no instance.
+ *
+ * Cached trajectories only go stale where they cross the ring. Those parts are dropped once the ring has
+ * scrolled TrajectoryTolerance or a chunk entered or left it, over the area the ring covered then and now.
+ * Paths that stay below the bricks, and most of the frames, keep their cache.
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ */
+void UBBCEndlessSubsystem::Advance(float DeltaTime)
+{
+	if (!bActive)
+	{
+		return;
+	}
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_EndlessScroll);
+
+	const TConstArrayView<int32> DestroyedCells = Ring.GetDestroyedCells();
+	if (BrickInstances != nullptr)
+	{
+		for (const int32 Cell : DestroyedCells)
+		{
+			BrickInstances->UpdateInstanceTransform(Cell, FTransform(FQuat::Identity, FVector::ZeroVector, HiddenScale), false, false, true);
+		}
+	}
+	const bool bDestroyed = DestroyedCells.Num() > 0;
+	Ring.ResetDestroyedCells();
+
+	RecycledSlots.Reset();
+	int32 NumAdded = 0;
+	int32 NumRemoved = 0;
+	Ring.Scroll(ScrollSpeed * DeltaTime, GetRecycleY(), RecycledSlots, NumAdded, NumRemoved);
+	for (const int32 Slot : RecycledSlots)
+	{
+		WriteSlotTransforms(Slot);
+	}
+	if (BrickInstances != nullptr && bDestroyed && RecycledSlots.IsEmpty())
+	{
+		BrickInstances->MarkRenderStateDirty();
+	}
+	UpdateViewLocation();
+	BBC_SET_DWORD_STAT(STAT_BBC_LiveBricks, Ring.GetNumAlive());
+	BBC_SET_DWORD_STAT(STAT_BBC_EndlessChunksRecycled, static_cast<uint32>(Ring.GetNumRecycled()));
+
+	if (!RecycledSlots.IsEmpty())
+	{
+		if (const UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+		{
+			GameEvents->Publish(FBBCBricksStreamedEvent{NumAdded, NumRemoved});
+		}
+	}
+	ScrollSinceInvalidate += ScrollSpeed * DeltaTime;
+	if (ScrollSinceInvalidate >= TrajectoryTolerance || !RecycledSlots.IsEmpty())
+	{
+		const FBox2D Bounds = Ring.GetBounds();
+		if (UBBCTrajectorySubsystem* Trajectories = GetWorld()->GetSubsystem<UBBCTrajectorySubsystem>())
+		{
+			Trajectories->InvalidateArea(InvalidatedBounds + Bounds);
+		}
+		InvalidatedBounds = Bounds;
+		ScrollSinceInvalidate = 0.0;
+	}
+}
+
+SIZE_T UBBCEndlessSubsystem::GetAllocatedSize() const
+{
+	return Ring.GetAllocatedSize() + RecycledSlots.GetAllocatedSize() + SlotTransforms.GetAllocatedSize();
+}
+
+void UBBCEndlessSubsystem::LogStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("Endless ring: %d chunks, %d / %d bricks alive, %lld chunks recycled, bottom chunk top at %.1f, %llu bytes"),
+		Ring.GetSettings().NumChunks, Ring.GetNumAlive(), Ring.GetNumCells(), Ring.GetNumRecycled(),
+		Ring.GetBaseY() - Ring.GetNumRecycled() * Ring.GetChunkHeight(), static_cast<uint64>(GetAllocatedSize()));
+}
+
+/**
+ * @brief Spawns the actor drawing the ring, with one instance per cell of the ring.
+ *
+ * Instances are placed relative to the actor, which sits on the ring's origin, and are never added or removed:
+ * an empty cell keeps a zero scale instance.
+ */
+void UBBCEndlessSubsystem::CreateView()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("EndlessView");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ViewActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(ViewActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn endless view actor. "));
+		return;
+	}
+
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	BrickInstances = NewObject<UInstancedStaticMeshComponent>(ViewActor, TEXT("EndlessBricks"));
+	BrickInstances->SetMobility(EComponentMobility::Movable);
+	BrickInstances->SetStaticMesh(Assets != nullptr ? Assets->GetBrickMesh() : nullptr);
+	BrickInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BrickInstances->SetCastShadow(false);
+	ViewActor->SetRootComponent(BrickInstances);
+	BrickInstances->RegisterComponent();
+
+	TArray<FTransform> Transforms;
+	Transforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, HiddenScale), Ring.GetNumCells());
+	BrickInstances->AddInstances(Transforms, false, false);
+	for (int32 Slot = 0; Slot < Ring.GetSettings().NumChunks; ++Slot)
+	{
+		WriteSlotTransforms(Slot);
+	}
+	UpdateViewLocation();
+}
+
+/**
+ * @brief Rewrites the instances of one slot from the chunk now held there.
+ *
+ * @param Slot Slot of the ring, which is also the block of instances drawing it.
+ */
+void UBBCEndlessSubsystem::WriteSlotTransforms(int32 Slot)
+{
+	if (BrickInstances == nullptr)
+	{
+		return;
+	}
+
+	FVector Scale = FVector::OneVector;
+	if (const UStaticMesh* Mesh = BrickInstances->GetStaticMesh())
+	{
+		const FVector MeshSize = Mesh->GetBounds().BoxExtent * 2.0;
+		const FVector2D& CellSize = Ring.GetSettings().BrickSize;
+		Scale.X = MeshSize.X > 0.0 ? CellSize.X / MeshSize.X : 1.0;
+		Scale.Y = MeshSize.Y > 0.0 ? CellSize.Y / MeshSize.Y : 1.0;
+		Scale.Z = FMath::Min(Scale.X, Scale.Y);
+	}
+
+	const FVector2D Origin(Ring.GetLeft(), Ring.GetBaseY());
+	const int32 FirstCell = Slot * Ring.GetCellsPerChunk();
+	SlotTransforms.Reset();
+	for (int32 Cell = FirstCell; Cell < FirstCell + Ring.GetCellsPerChunk(); ++Cell)
+	{
+		const FVector2D Center = Ring.GetCellBox(Cell).GetCenter() - Origin;
+		SlotTransforms.Add(FTransform(FQuat::Identity, FVector(Center, 0.0), Ring.IsCellAlive(Cell) ? Scale : HiddenScale));
+	}
+	BrickInstances->BatchUpdateInstancesTransforms(FirstCell, SlotTransforms, false, true, true);
+}
+
+void UBBCEndlessSubsystem::UpdateViewLocation()
+{
+	if (IsValid(ViewActor))
+	{
+		ViewActor->SetActorLocation(FVector(Ring.GetLeft(), Ring.GetBaseY(), 0.0));
+	}
+}
+
+/**
+ * @brief Line a chunk's top edge has to pass before it is recycled: the bottom of the brick area.
+ */
+double UBBCEndlessSubsystem::GetRecycleY() const
+{
+	return UBBCPlayfieldSubsystem::GetLayout(this).BrickArea.Max.Y;
+}
+
+double UBBCEndlessSubsystem::GetCentredLeft() const
+{
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(this);
+	return Layout.BrickArea.GetCenter().X - Ring.GetSettings().Columns * Ring.GetSettings().BrickSize.X * 0.5;
+}
+
+/**
+ * @brief Recentres the ring in a new layout. Its size stays the one chosen by Start, so nothing is reallocated.
+ */
+void UBBCEndlessSubsystem::HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event)
+{
+	if (!bActive)
+	{
+		return;
+	}
+	Ring.SetLeft(GetCentredLeft());
+	UpdateViewLocation();
+}
@@ -3,33 +3,56 @@
 
 #include "GameMode/BBCGameMode.h"
 
+#include "Assets/BBCAssetSubsystem.h"
 #include "Camera/CameraComponent.h"
 #include "GameState/BBCGameState.h"
+#include "GameState/BBCGameEventSubsystem.h"
 #include "Cameras/BBCCamera.h"
 #include "Core/Paddle/BBCPaddle.h"
 #include "Core/Ball/BBCBall.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Brick/BBCBrickField.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Level/BBCLevelSubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Pool/BBCActorPoolSubsystem.h"
+#include "Endless/BBCEndlessSubsystem.h"
+#include "EngineUtils.h"
+#include "Input/BBCInputReplaySubsystem.h"
 #include "PlayerController/BBCPlayerController.h"
+#include "Stats/BBCStats.h"
+#include "Versus/BBCVersusSubsystem.h"
 
 /**
- * @brief Initializes the game state and spawns essential game actors.
+ * @brief Constructor for the ABBCGameMode class.
  *
- * This method is responsible for setting up the game environment by:
+ * @note The brick field is spawned with its top left corner at (-300, -300, 0) unless one is placed in the level
+ * @note 16 balls are pre-warmed in the actor pool
+ */
+ABBCGameMode::ABBCGameMode() :
+BBCBrickField(nullptr),
+BrickFieldLocation(-300.f,-300.f,0.f),
+BallPoolSize(16),
+StartPlaySeconds(0.0)
+{
+}
+
+/**
+ * @brief Spawns the camera, sets up the paddle and starts the level once its assets are in.
+ *
+ * This method is responsible for:
  * - Spawning the game camera
  * - Setting up the player controller
- * - Configuring the paddle's movement boundaries
- * - Spawning and resetting the game ball
- * - Updating the game state with player and ball references
+ * - Laying out the playfield from the camera and paddle, which sets the paddle range, walls and ball spawn
+ * - Waiting, without blocking, for the Gameplay bundle of the asset manifest; the level starts as soon as it
+ *   is in, which at this point is usually immediately
  *
  * @note Performs multiple error checks to ensure critical components are properly initialized
- * @note Logs error messages if any critical initialization steps fail
- *
- * @throws No exceptions are thrown, but error conditions are logged
- *
- * @pre Requires a valid game world and properly configured game mode settings
- * @post Game camera, player controller, paddle, and ball are initialized
  */
 void ABBCGameMode::StartPlay()
 {
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_GameState);
+	StartPlaySeconds = FPlatformTime::Seconds();
 	Super::StartPlay();
 	UWorld* World = GetWorld();
 	
@@ -59,18 +82,108 @@ void ABBCGameMode::StartPlay()
 		UE_LOG(LogTemp, Error, TEXT("Failed to get BBCPaddle. "));
 		return;
 	}
-	float MaxBoundaryLength = BBCCamera->GetCameraComponent()->OrthoWidth;
-	MaxBoundaryLength/=2;
-	MaxBoundaryLength-=98.f;
-	BBCPaddle->SetMaxBoundaryLength(MaxBoundaryLength);
+	UBBCPlayfieldSubsystem* Playfield = World->GetSubsystem<UBBCPlayfieldSubsystem>();
+	if((!ensure(Playfield)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Playfield is Invalid"));
+		return;
+	}
+	Playfield->SetSources(BBCCamera, BBCPaddle);
+
+	if(UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this))
+	{
+		Assets->WhenLoaded(EBBCAssetBundle::Gameplay, FSimpleDelegate::CreateUObject(this, &ABBCGameMode::StartLevel));
+		return;
+	}
+	StartLevel();
+}
+
+/**
+ * @brief Spawns the level's actors and starts it.
+ *
+ * This method is responsible for setting up the level by:
+ * - Starting a versus match instead of the single player game when -BBCVersus is on the command line
+ * - Handing the paddle to the ball subsystem as a moving collider
+ * - Spawning the brick field, unless the level already contains one, and applying the first cooked level to it
+ * - Centring a spawned brick field in the playfield's brick area, now and whenever the playfield is laid out again
+ * - Starting the endless brick ring instead of the brick field and levels when -BBCEndless is on the command line
+ * - Pre-warming the ball pool and taking the game ball from it, then resetting it and seeding its launch direction from the session seed
+ * - Updating the game state with player and ball references
+ * - Publishing the level start with the number of bricks to clear
+ * - Logging the time from StartPlay, and from process start, until the ball can be launched
+ *
+ * @note Performs multiple error checks to ensure critical components are properly initialized
+ * @note Logs error messages if any critical initialization steps fail
+ *
+ * @pre StartPlay has set up the camera, player controller and paddle
+ * @post Brick field and ball are initialized
+ */
+void ABBCGameMode::StartLevel()
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_GameState);
+	UWorld* World = GetWorld();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	if(UBBCVersusSubsystem::IsRequestedOnCommandLine())
+	{
+		StartVersus();
+		return;
+	}
+
+	UBBCBallSubsystem* BallSubsystem = World->GetSubsystem<UBBCBallSubsystem>();
+	if((!ensure(BallSubsystem)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to get BallSubsystem. "));
+		return;
+	}
+	BallSubsystem->SetPaddle(BBCPaddle);
+
+	const bool bEndless = UBBCEndlessSubsystem::IsRequestedOnCommandLine();
+	TActorIterator<ABBCBrickField> BrickFieldIt(World);
+	const bool bSpawnBrickField = !BrickFieldIt && !bEndless;
+	BBCBrickField = BrickFieldIt ? *BrickFieldIt : bEndless ? nullptr : World->SpawnActor<ABBCBrickField>(ABBCBrickField::StaticClass(), BrickFieldLocation, FRotator::ZeroRotator, SpawnParameters);
+	if((!ensure(BBCBrickField || bEndless)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn Brick Field. "));
+		return;
+	}
+	UBBCLevelSubsystem* LevelSubsystem = World->GetSubsystem<UBBCLevelSubsystem>();
+	if(LevelSubsystem != nullptr && !bEndless)
+	{
+		LevelSubsystem->StartFirstLevel(BBCBrickField->GetBrickField());
+	}
+	if(bSpawnBrickField)
+	{
+		PlaceBrickField();
+		if(UBBCGameEventSubsystem* PlayfieldEvents = World->GetSubsystem<UBBCGameEventSubsystem>())
+		{
+			PlayfieldEvents->OnPlayfieldChanged().AddUObject(this, &ABBCGameMode::HandlePlayfieldChanged);
+		}
+	}
 
-	BBCBall = World->SpawnActor<ABBCBall>(ABBCBall::StaticClass(), SpawnParameters);
+	UBBCActorPoolSubsystem* ActorPool = World->GetSubsystem<UBBCActorPoolSubsystem>();
+	if((!ensure(ActorPool)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to get ActorPool. "));
+		return;
+	}
+	ActorPool->Prewarm(ABBCBall::StaticClass(), BallPoolSize);
+
+	BBCBall = ActorPool->Acquire<ABBCBall>(FVector::ZeroVector);
 	if((!ensure(BBCBall)))
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to spawn Ball. "));
 		return;
 	}
 	BBCBall->ResetBall();
+	int32 SessionSeed = 0;
+	if(const UBBCInputReplaySubsystem* InputReplay = World->GetSubsystem<UBBCInputReplaySubsystem>())
+	{
+		SessionSeed = InputReplay->GetSessionSeed();
+		BBCBall->SetLaunchSeed(SessionSeed);
+	}
 
 	BBCGameState = GetGameState<ABBCGameState>();
 	if((!ensure(BBCGameState)))
@@ -79,4 +192,75 @@ void ABBCGameMode::StartPlay()
 		return;
 	}
 	BBCGameState->SetPlayerControllerAndBall(BBCPlayerController, BBCBall);
+
+	UBBCEndlessSubsystem* EndlessSubsystem = bEndless ? World->GetSubsystem<UBBCEndlessSubsystem>() : nullptr;
+	if(EndlessSubsystem != nullptr)
+	{
+		EndlessSubsystem->Start(SessionSeed);
+	}
+
+	const UBBCGameEventSubsystem* GameEvents = World->GetSubsystem<UBBCGameEventSubsystem>();
+	if((!ensure(GameEvents)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to get GameEvents. "));
+		return;
+	}
+	const UBBCBrickFieldComponent* BrickField = BBCBrickField != nullptr ? BBCBrickField->GetBrickField() : nullptr;
+	const int32 NumBricks = (BrickField != nullptr ? BrickField->GetNumAlive() : 0) + BallSubsystem->GetNumBrickColliders()
+		+ (EndlessSubsystem != nullptr ? EndlessSubsystem->GetRing().GetNumAlive() : 0);
+	GameEvents->Publish(FBBCLevelStartedEvent{0, NumBricks, bEndless});
+
+	UE_LOG(LogTemp, Display, TEXT("Level ready to launch %.3f ms after StartPlay (%.3f s after process start), %d bricks"),
+		(FPlatformTime::Seconds() - StartPlaySeconds) * 1000.0, FPlatformTime::Seconds() - GStartTime, NumBricks);
+}
+
+/**
+ * @brief Centres the spawned brick field in the playfield's brick area.
+ *
+ * The field keeps the height of BrickFieldLocation unless that would take it out of the brick area, so the same
+ * wall sits in the same place relative to the walls at any aspect ratio.
+ *
+ * @note A brick field placed in the level stays where the level put it.
+ */
+void ABBCGameMode::PlaceBrickField()
+{
+	UBBCBrickFieldComponent* BrickField = BBCBrickField != nullptr ? BBCBrickField->GetBrickField() : nullptr;
+	if(BrickField == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BrickField is Invalid"));
+		return;
+	}
+	const FBox2D BrickArea = UBBCPlayfieldSubsystem::GetLayout(this).BrickArea;
+	const FVector2D FieldSize = BrickField->GetFieldBox().GetSize();
+	FVector Location = BBCBrickField->GetActorLocation();
+	Location.X = BrickArea.GetCenter().X - FieldSize.X * 0.5;
+	Location.Y = FMath::Max(FMath::Min(BrickFieldLocation.Y, BrickArea.Max.Y - FieldSize.Y), BrickArea.Min.Y);
+	BBCBrickField->SetActorLocation(Location);
+}
+
+void ABBCGameMode::HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event)
+{
+	PlaceBrickField();
+}
+
+/**
+ * @brief Starts a two-paddle versus match driven by the player's paddle input.
+ *
+ * The possessed paddle only provides input; it is hidden along with any brick field placed in the level, since
+ * the match draws its own paddles, balls and bricks.
+ */
+void ABBCGameMode::StartVersus()
+{
+	UBBCVersusSubsystem* VersusSubsystem = GetWorld()->GetSubsystem<UBBCVersusSubsystem>();
+	if((!ensure(VersusSubsystem)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to get VersusSubsystem. "));
+		return;
+	}
+	BBCPaddle->SetActorHiddenInGame(true);
+	for(TActorIterator<ABBCBrickField> It(GetWorld()); It; ++It)
+	{
+		It->SetActorHiddenInGame(true);
+	}
+	VersusSubsystem->Start(BBCPaddle);
 }
@@ -3,7 +3,77 @@
 
 #include "GameState/BBCGameState.h"
 #include "Core/Ball/BBCBall.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
 #include "PlayerController/BBCPlayerController.h"
+#include "Stats/BBCStats.h"
+
+/**
+ * @brief Constructor for the ABBCGameState class, setting the default rules.
+ *
+ * @param ObjectInitializer Reference to object initialization parameters
+ *
+ * @note Defaults to three lives and ten points per brick
+ */
+ABBCGameState::ABBCGameState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer),
+	StartingLives(3),
+	PointsPerBrick(10),
+	Score(0),
+	Lives(3),
+	RemainingBricks(0),
+	LevelIndex(0),
+	Status(EBBCGameStatus::WaitingToLaunch),
+	bScoreboardDirty(false),
+	bEndless(false),
+	GameEvents(nullptr)
+{
+}
+
+/**
+ * @brief Subscribes to the gameplay events that drive the counters and registers with the tick manager.
+ *
+ * @note Runs from the game mode's Super::StartPlay(), before the level and ball are set up.
+ */
+void ABBCGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Lives = StartingLives;
+
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterGameState(this);
+	}
+
+	GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>();
+	if(GameEvents == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GameEvents is Invalid"));
+		return;
+	}
+	GameEvents->OnLevelStarted().AddUObject(this, &ABBCGameState::HandleLevelStarted);
+	GameEvents->OnBrickDestroyed().AddUObject(this, &ABBCGameState::HandleBrickDestroyed);
+	GameEvents->OnBallLost().AddUObject(this, &ABBCGameState::HandleBallLost);
+	GameEvents->OnBricksStreamed().AddUObject(this, &ABBCGameState::HandleBricksStreamed);
+}
+
+void ABBCGameState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterGameState(this);
+	}
+	if(GameEvents != nullptr)
+	{
+		GameEvents->OnLevelStarted().RemoveAll(this);
+		GameEvents->OnBrickDestroyed().RemoveAll(this);
+		GameEvents->OnBallLost().RemoveAll(this);
+		GameEvents->OnBricksStreamed().RemoveAll(this);
+		GameEvents = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
 /**
  * @brief Sets the player controller and ball for the game state.
@@ -20,12 +90,126 @@ void ABBCGameState::SetPlayerControllerAndBall(ABBCPlayerController* BBCControll
 	BBCBall = Ball;
 }
 
+/**
+ * @brief Launches the player's ball if the game is waiting for a launch.
+ *
+ * While in play the same input releases the balls held by the sticky paddle instead of waiting for their hold
+ * to run out.
+ *
+ * @note Does nothing once the level is complete or the game is over.
+ */
 void ABBCGameState::TryStartBall()
 {
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_GameState);
+	if(Status == EBBCGameStatus::InProgress)
+	{
+		if(UBBCBallSubsystem* BallSubsystem = GetWorld()->GetSubsystem<UBBCBallSubsystem>())
+		{
+			BallSubsystem->ReleaseStuckBalls();
+		}
+		return;
+	}
+	if(Status != EBBCGameStatus::WaitingToLaunch)
+	{
+		return;
+	}
 	if(BBCBall != nullptr)
 	{
 		BBCBall->StartMoving();
+		SetStatus(EBBCGameStatus::InProgress);
+	}
+}
+
+void ABBCGameState::RestartGame()
+{
+	Score = 0;
+	Lives = StartingLives;
+	SetStatus(RemainingBricks > 0 || bEndless ? EBBCGameStatus::WaitingToLaunch : EBBCGameStatus::LevelComplete);
+}
+
+/**
+ * @brief Takes the brick count of a new level and puts the player's ball back on the paddle.
+ *
+ * @param Event The level that started.
+ */
+void ABBCGameState::HandleLevelStarted(const FBBCLevelStartedEvent& Event)
+{
+	if(BBCBall != nullptr)
+	{
+		BBCBall->ResetBall();
 	}
+	LevelIndex = Event.LevelIndex;
+	RemainingBricks = Event.NumBricks;
+	bEndless = Event.bEndless;
+	SetStatus(EBBCGameStatus::WaitingToLaunch);
 }
 
+/**
+ * @brief Scores a destroyed brick and completes the level when the last one goes.
+ *
+ * @param Event The destroyed brick.
+ *
+ * @note An endless level is never completed; new bricks keep streaming in.
+ */
+void ABBCGameState::HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event)
+{
+	Score += PointsPerBrick;
+	RemainingBricks = FMath::Max(RemainingBricks - 1, 0);
+	if(RemainingBricks > 0 || bEndless)
+	{
+		MarkScoreboardDirty();
+		return;
+	}
+
+	SetStatus(EBBCGameStatus::LevelComplete);
+	if(GameEvents != nullptr)
+	{
+		GameEvents->Publish(FBBCLevelCompletedEvent{LevelIndex, Score});
+	}
+}
 
+/**
+ * @brief Takes a life when the last ball in play reaches the kill zone.
+ *
+ * Extra balls are simply gone, and the player's ball lost while extra balls remain takes one of them over;
+ * only losing the last ball costs a life.
+ *
+ * @param Event The lost ball.
+ */
+void ABBCGameState::HandleBallLost(const FBBCBallLostEvent& Event)
+{
+	if(!Event.bLastBall || Status != EBBCGameStatus::InProgress)
+	{
+		return;
+	}
+
+	Lives = FMath::Max(Lives - 1, 0);
+	SetStatus(Lives > 0 ? EBBCGameStatus::WaitingToLaunch : EBBCGameStatus::GameOver);
+}
+
+/**
+ * @brief Follows the bricks on screen of an endless level as chunks scroll in and out.
+ *
+ * @param Event The bricks generated and the unbroken bricks that left.
+ */
+void ABBCGameState::HandleBricksStreamed(const FBBCBricksStreamedEvent& Event)
+{
+	RemainingBricks = FMath::Max(RemainingBricks + Event.NumAdded - Event.NumRemoved, 0);
+	MarkScoreboardDirty();
+}
+
+void ABBCGameState::SetStatus(EBBCGameStatus NewStatus)
+{
+	Status = NewStatus;
+	MarkScoreboardDirty();
+}
+
+void ABBCGameState::FlushScoreboard()
+{
+	if(!bScoreboardDirty || GameEvents == nullptr)
+	{
+		return;
+	}
+	bScoreboardDirty = false;
+	GameEvents->Publish(FBBCScoreboardEvent{Score, Lives, RemainingBricks, Status});
+}
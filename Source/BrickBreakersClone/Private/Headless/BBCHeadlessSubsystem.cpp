@@ -0,0 +1,754 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Headless/BBCHeadlessSubsystem.h"
+
+#include "EngineUtils.h"
+#include "AI/BBCAutopilotController.h"
+#include "Assets/BBCAssetSubsystem.h"
+#include "Core/Ball/BBCBall.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Brick/BBCBrickField.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Level/BBCLevelLayout.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Effects/BBCEffectsSubsystem.h"
+#include "Endless/BBCEndlessSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "GameState/BBCGameState.h"
+#include "Headless/BBCSimProfiler.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "PowerUps/BBCPowerUpSubsystem.h"
+#include "Serialization/JsonWriter.h"
+#include "Tuning/BBCTuning.h"
+#include "UObject/UObjectArray.h"
+
+namespace
+{
+	constexpr int32 SyntheticBallSeed = 1337;
+	/** Object and actor growth over a soak run beyond which a leak is reported. */
+	constexpr int32 LeakObjectTolerance = 32;
+	constexpr int32 LeakActorTolerance = 16;
+	/** Memory growth per round beyond which a leak is reported. */
+	constexpr double LeakBytesPerRoundTolerance = 4096.0;
+	/** Fraction the last sample window's mean frame time may exceed the baseline window's by before a slowdown is reported. */
+	constexpr double FrameDriftTolerance = 0.25;
+	/** Area covered by the uniform wall of a performance scenario, matching the default brick field. */
+	const FVector2D ScenarioFieldSize(600.0, 240.0);
+
+	constexpr double BytesPerMb = 1024.0 * 1024.0;
+
+	double Percentile(const TArray<double>& SortedValues, double Fraction)
+	{
+		if (SortedValues.Num() == 0)
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+
+	const TCHAR* GetColliderTypeName(EBBCColliderType Type)
+	{
+		switch (Type)
+		{
+		case EBBCColliderType::Wall: return TEXT("wall");
+		case EBBCColliderType::KillZone: return TEXT("kill_zone");
+		case EBBCColliderType::Paddle: return TEXT("paddle");
+		case EBBCColliderType::Brick: return TEXT("brick");
+		default: return TEXT("unknown");
+		}
+	}
+}
+
+/**
+ * @brief Only creates the harness when -BBCSimFrames or -BBCSimScenario is on the command line.
+ */
+bool UBBCHeadlessSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	int32 Frames = 0;
+	FString ScenarioName;
+	return (FParse::Value(FCommandLine::Get(), TEXT("BBCSimFrames="), Frames) && Frames > 0)
+		|| FParse::Value(FCommandLine::Get(), TEXT("BBCSimScenario="), ScenarioName);
+}
+
+/**
+ * @brief Reads the harness options and switches the engine to a fixed frame delta.
+ *
+ * The fixed delta makes the engine skip frame rate smoothing and idle time, so N frames always simulate
+ * N * Delta seconds of gameplay, as fast as the machine can run them.
+ *
+ * @param Collection The subsystem collection this harness belongs to.
+ */
+void UBBCHeadlessSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("BBCSimFrames="), FramesToSimulate);
+	FParse::Value(CommandLine, TEXT("BBCSimBalls="), ExtraBalls);
+	FParse::Value(CommandLine, TEXT("BBCSimPowerUps="), PowerUpsToKeep);
+	bSyntheticBounds = FParse::Param(CommandLine, TEXT("BBCSimSynthetic"));
+	bAutopilot = FParse::Param(CommandLine, TEXT("BBCSimAutopilot"));
+	FParse::Value(CommandLine, TEXT("BBCSoakRounds="), SoakRounds);
+	FParse::Value(CommandLine, TEXT("BBCSoakSampleFrames="), SoakSampleFrames);
+
+	FString ScenarioName;
+	if (FParse::Value(CommandLine, TEXT("BBCSimScenario="), ScenarioName))
+	{
+		const FBBCPerfScenario* Found = Scenarios.FindByPredicate([&ScenarioName](const FBBCPerfScenario& Entry) { return Entry.Name == ScenarioName; });
+		if (Found == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Unknown performance scenario %s"), *ScenarioName);
+			FPlatformMisc::RequestExitWithStatus(false, 1);
+			return;
+		}
+		Scenario = *Found;
+		bScenario = true;
+		bLaunchBall = Scenario.Balls > 0;
+		ExtraBalls = FMath::Max(Scenario.Balls - 1, 0);
+		if (FramesToSimulate <= 0)
+		{
+			FramesToSimulate = Scenario.Frames;
+		}
+	}
+
+	double Delta = 1.0 / 60.0;
+	FParse::Value(CommandLine, TEXT("BBCSimDelta="), Delta);
+	if (!FParse::Value(CommandLine, TEXT("BBCSimReport="), ReportPath))
+	{
+		ReportPath = FPaths::ProfilingDir() / TEXT("BBCSim.json");
+	}
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Delta);
+
+	FrameSeconds.Reserve(FramesToSimulate);
+	if (SoakSampleFrames > 0)
+	{
+		SoakSamples.Reserve(FramesToSimulate / SoakSampleFrames + 2);
+	}
+	FBBCSimProfiler::Reset();
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &UBBCHeadlessSubsystem::OnBeginFrame);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UBBCHeadlessSubsystem::OnEndFrame);
+
+	UE_LOG(LogTemp, Display, TEXT("Headless simulation: %d frames at %.5f s%s%s"), FramesToSimulate, Delta,
+		bScenario ? TEXT(", scenario ") : TEXT(""), bScenario ? *Scenario.Name : TEXT(""));
+}
+
+void UBBCHeadlessSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FBBCSimProfiler::SetEnabled(false);
+	if (UBBCGameEventSubsystem* Events = GameEvents.Get())
+	{
+		Events->OnBallLost().RemoveAll(this);
+		Events->OnLevelCompleted().RemoveAll(this);
+	}
+
+	Super::Deinitialize();
+}
+
+/**
+ * @brief Starts timing a frame once the game world is playing.
+ */
+void UBBCHeadlessSubsystem::OnBeginFrame()
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World == nullptr || !World->HasBegunPlay())
+	{
+		return;
+	}
+	// The game mode starts the level once the gameplay assets are in.
+	const UBBCAssetSubsystem* Assets = GetGameInstance()->GetSubsystem<UBBCAssetSubsystem>();
+	if (Assets != nullptr && !Assets->IsBundleLoaded(EBBCAssetBundle::Gameplay))
+	{
+		return;
+	}
+
+	if (!bWorldSetUp)
+	{
+		SetUpWorld(*World);
+	}
+	if (bLaunchBall)
+	{
+		KeepBallInPlay(*World);
+	}
+	if (bRunning)
+	{
+		// Counted before the refill, so a ball that left play without reaching the kill zone shows up as missing.
+		MinBallsSinceSample = FMath::Min(MinBallsSinceSample, CountBallsInPlay(*World) + ExtraBallsLostSinceRefill);
+	}
+	if (ExtraBalls > 0)
+	{
+		KeepExtraBallsInPlay(*World);
+	}
+	ExtraBallsLostSinceRefill = 0;
+	if (PowerUpsToKeep > 0)
+	{
+		KeepPowerUpsActive(*World);
+	}
+	FrameStartSeconds = FPlatformTime::Seconds();
+}
+
+/**
+ * @brief Records the frame's game thread time and finishes the run after the requested number of frames, or
+ * rounds for a soak run.
+ */
+void UBBCHeadlessSubsystem::OnEndFrame()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	FrameSeconds.Add(FPlatformTime::Seconds() - FrameStartSeconds);
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World != nullptr && SoakSampleFrames > 0 && FrameSeconds.Num() % SoakSampleFrames == 0)
+	{
+		TakeSoakSample(*World);
+	}
+	if (FrameSeconds.Num() < FramesToSimulate && (SoakRounds <= 0 || Rounds < SoakRounds))
+	{
+		return;
+	}
+
+	bRunning = false;
+	FBBCSimProfiler::SetEnabled(false);
+	if (World != nullptr)
+	{
+		TakeSoakSample(*World);
+	}
+	bScenarioPassed = !bScenario || CheckScenario();
+	if (World != nullptr)
+	{
+		WriteReport(*World);
+	}
+	if (!bScenarioPassed)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+		return;
+	}
+	FPlatformMisc::RequestExit(false);
+}
+
+/**
+ * @brief Prepares the world on the first played frame.
+ *
+ * - Fixes the playfield arena when running a synthetic level, so the walls do not depend on the window
+ * - Replaces the first level with the scenario's wall, if any
+ * - Enables the tick cost profiler
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::SetUpWorld(UWorld& World)
+{
+	bWorldSetUp = true;
+	SetUpUsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+
+	UBBCBallSubsystem* BallSubsystem = World.GetSubsystem<UBBCBallSubsystem>();
+	if (BallSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BallSubsystem is Invalid"));
+		return;
+	}
+
+	UBBCPlayfieldSubsystem* Playfield = World.GetSubsystem<UBBCPlayfieldSubsystem>();
+	if (bSyntheticBounds && Playfield != nullptr)
+	{
+		Playfield->SetArenaOverride(FBox2D(FVector2D(-500.0, -500.0), FVector2D(500.0, 500.0)));
+	}
+
+	if (bScenario && Scenario.Bricks > 0)
+	{
+		ApplyScenarioBricks(World);
+	}
+
+	ExtraBallStream.Initialize(SyntheticBallSeed);
+	KeepExtraBallsInPlay(World);
+
+	if (bAutopilot)
+	{
+		SpawnAutopilot(World);
+	}
+	if (UBBCGameEventSubsystem* Events = World.GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		Events->OnBallLost().AddUObject(this, &UBBCHeadlessSubsystem::HandleBallLost);
+		Events->OnLevelCompleted().AddUObject(this, &UBBCHeadlessSubsystem::HandleLevelCompleted);
+		GameEvents = Events;
+	}
+
+	FBBCSimProfiler::SetEnabled(true);
+	RunStartSeconds = FPlatformTime::Seconds();
+	TakeSoakSample(World);
+	bRunning = true;
+}
+
+/**
+ * @brief Replaces the wall of the first level with a uniform wall of the scenario's brick count.
+ *
+ * The level is announced again so the game state counts the new bricks and waits for a launch.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::ApplyScenarioBricks(UWorld& World) const
+{
+	TActorIterator<ABBCBrickField> BrickFieldIt(&World);
+	UBBCBrickFieldComponent* BrickField = BrickFieldIt ? BrickFieldIt->GetBrickField() : nullptr;
+	if (BrickField == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BrickField is Invalid"));
+		return;
+	}
+
+	TArray<uint8> Blob;
+	BBCLevel::CookUniform(Scenario.Bricks, ScenarioFieldSize, Blob);
+	FBBCLevelLayout Layout;
+	if (!Layout.Initialize(MoveTemp(Blob)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Scenario %s has an invalid wall"), *Scenario.Name);
+		return;
+	}
+	BrickField->ApplyLayout(Layout);
+
+	if (const UBBCGameEventSubsystem* Events = World.GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		const UBBCBallSubsystem* BallSubsystem = World.GetSubsystem<UBBCBallSubsystem>();
+		const int32 NumBrickColliders = BallSubsystem != nullptr ? BallSubsystem->GetNumBrickColliders() : 0;
+		Events->Publish(FBBCLevelStartedEvent{0, BrickField->GetNumAlive() + NumBrickColliders});
+	}
+}
+
+/**
+ * @brief Spawns an autopilot and gives it the player's paddle.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::SpawnAutopilot(UWorld& World)
+{
+	const APlayerController* PlayerController = World.GetFirstPlayerController();
+	APawn* Paddle = PlayerController != nullptr ? PlayerController->GetPawn() : nullptr;
+	if (Paddle == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Paddle is Invalid"));
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ABBCAutopilotController* Controller = World.SpawnActor<ABBCAutopilotController>(ABBCAutopilotController::StaticClass(), SpawnParameters);
+	if (Controller == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Autopilot is Invalid"));
+		return;
+	}
+	Controller->Possess(Paddle);
+	Autopilot = Controller;
+}
+
+/**
+ * @brief Records memory use, the live object and actor counts and the mean frame time since the last sample.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::TakeSoakSample(UWorld& World)
+{
+	const int32 WindowStart = SoakSamples.Num() > 0 ? SoakSamples.Last().Frame : 0;
+	FBBCSoakSample& Sample = SoakSamples.AddDefaulted_GetRef();
+	Sample.Frame = FrameSeconds.Num();
+	for (int32 Frame = WindowStart; Frame < Sample.Frame; ++Frame)
+	{
+		Sample.MeanFrameMs += FrameSeconds[Frame] * 1000.0;
+	}
+	Sample.MeanFrameMs /= FMath::Max(Sample.Frame - WindowStart, 1);
+	Sample.MinBalls = MinBallsSinceSample != MAX_int32 ? MinBallsSinceSample : CountBallsInPlay(World);
+	MinBallsSinceSample = MAX_int32;
+	Sample.Rounds = Rounds;
+	Sample.UsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+	Sample.NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	for (TActorIterator<AActor> It(&World); It; ++It)
+	{
+		++Sample.NumActors;
+	}
+}
+
+void UBBCHeadlessSubsystem::HandleBallLost(const FBBCBallLostEvent& Event)
+{
+	// A player ball that took over an extra ball still used one up.
+	Rounds += Event.bLastBall ? 1 : 0;
+	ExtraBallsLostSinceRefill += Event.bLastBall ? 0 : 1;
+}
+
+void UBBCHeadlessSubsystem::HandleLevelCompleted(const FBBCLevelCompletedEvent& Event)
+{
+	++Rounds;
+}
+
+/**
+ * @brief Relaunches the player ball whenever it is at rest, so the run never stalls waiting for input.
+ *
+ * A game over is restarted straight away for the same reason. Balls held by the sticky paddle are left to run
+ * out their hold, as launching while in play would release them early.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::KeepBallInPlay(UWorld& World)
+{
+	ABBCGameState* GameState = World.GetGameState<ABBCGameState>();
+	if (GameState == nullptr)
+	{
+		return;
+	}
+	if (GameState->GetStatus() == EBBCGameStatus::GameOver)
+	{
+		GameState->RestartGame();
+	}
+	if (GameState->GetStatus() != EBBCGameStatus::WaitingToLaunch)
+	{
+		return;
+	}
+	for (TActorIterator<ABBCBall> It(&World); It; ++It)
+	{
+		if (!It->IsMoving())
+		{
+			GameState->TryStartBall();
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Spawns instanced balls until ExtraBalls are in play, replacing the ones lost to the kill zone.
+ *
+ * Without this a stress scenario would measure fewer and fewer balls as the run went on.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::KeepExtraBallsInPlay(UWorld& World)
+{
+	UBBCBallSubsystem* BallSubsystem = World.GetSubsystem<UBBCBallSubsystem>();
+	if (BallSubsystem == nullptr)
+	{
+		return;
+	}
+	const FVector2D BallSpawn = UBBCPlayfieldSubsystem::GetLayout(&World).BallSpawn;
+	for (int32 Missing = ExtraBalls - BallSubsystem->GetNumSpawnedBalls(); Missing > 0; --Missing)
+	{
+		BallSubsystem->SpawnBall(BallSpawn, FVector2D(ExtraBallStream.FRandRange(-1.0, 1.0), -1.0),
+			BBCTuning::Get().SpawnedBallSpeed, BBCTuning::Get().SpawnedBallRadius);
+	}
+}
+
+/**
+ * @brief Counts the balls inside the playfield's walls and kill zone, moving or not.
+ *
+ * @param World The game world.
+ */
+int32 UBBCHeadlessSubsystem::CountBallsInPlay(UWorld& World) const
+{
+	const UBBCBallSubsystem* BallSubsystem = World.GetSubsystem<UBBCBallSubsystem>();
+	if (BallSubsystem == nullptr)
+	{
+		return 0;
+	}
+	const FBBCPlayfieldLayout& Layout = UBBCPlayfieldSubsystem::GetLayout(&World);
+	const FBox2D Bounds = Layout.Arena + Layout.LeftWall + Layout.RightWall + Layout.TopWall + Layout.KillZone;
+	int32 NumInPlay = 0;
+	FBBCBallState State;
+	for (int32 Index = 0; Index < BallSubsystem->GetNumBalls(); ++Index)
+	{
+		if (BallSubsystem->GetBallState(BallSubsystem->GetBallHandle(Index), State) && Bounds.IsInsideOrOn(State.Position))
+		{
+			++NumInPlay;
+		}
+	}
+	return NumInPlay;
+}
+
+/**
+ * @brief Activates lasting power-ups, every kind in turn, until PowerUpsToKeep are in effect.
+ *
+ * Effects expire and a lost ball ends them all, so they are topped up every frame to keep the load steady.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::KeepPowerUpsActive(UWorld& World)
+{
+	UBBCPowerUpSubsystem* PowerUps = World.GetSubsystem<UBBCPowerUpSubsystem>();
+	if (PowerUps == nullptr)
+	{
+		return;
+	}
+	static constexpr EBBCPowerUp LastingKinds[] = {EBBCPowerUp::WidePaddle, EBBCPowerUp::SlowBall, EBBCPowerUp::Laser, EBBCPowerUp::StickyPaddle};
+	for (int32 Attempt = 0; Attempt < PowerUpsToKeep && PowerUps->GetNumActive() < PowerUpsToKeep; ++Attempt)
+	{
+		PowerUps->Activate(LastingKinds[(PowerUps->GetNumActivated() + Attempt) % UE_ARRAY_COUNT(LastingKinds)]);
+	}
+}
+
+/**
+ * @brief Writes the JSON report.
+ *
+ * The report contains the run settings, game thread frame time percentiles in milliseconds, the tick cost
+ * of every profiled class, the number of ball collisions by collider type, the effects budget counters, the
+ * power-up counters and the soak samples.
+ *
+ * Soak growth is measured from the second sample, once pools and caches have warmed up, to the last one. Frame
+ * time growth compares the mean frame time of the same two sample windows.
+ *
+ * @param World The game world.
+ */
+void UBBCHeadlessSubsystem::WriteReport(UWorld& World) const
+{
+	TArray<double> SortedMs;
+	double MeanMs = 0.0;
+	GetFrameMs(SortedMs, MeanMs);
+	const int32 NumFrames = FMath::Max(SortedMs.Num(), 1);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("map"), World.GetMapName());
+	Writer->WriteValue(TEXT("frames"), SortedMs.Num());
+	Writer->WriteValue(TEXT("fixed_delta"), FApp::GetFixedDeltaTime());
+	Writer->WriteValue(TEXT("wall_seconds"), FPlatformTime::Seconds() - RunStartSeconds);
+	Writer->WriteValue(TEXT("rounds"), Rounds);
+	Writer->WriteValue(TEXT("autopilot"), Autopilot.IsValid());
+
+	Writer->WriteObjectStart(TEXT("frame_ms"));
+	Writer->WriteValue(TEXT("mean"), MeanMs);
+	Writer->WriteValue(TEXT("p50"), Percentile(SortedMs, 0.50));
+	Writer->WriteValue(TEXT("p90"), Percentile(SortedMs, 0.90));
+	Writer->WriteValue(TEXT("p99"), Percentile(SortedMs, 0.99));
+	Writer->WriteValue(TEXT("max"), SortedMs.Num() > 0 ? SortedMs.Last() : 0.0);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("tick_cost"));
+	for (const TPair<FName, FBBCSimCost>& Cost : FBBCSimProfiler::GetCosts())
+	{
+		const double CostMs = FPlatformTime::ToMilliseconds64(Cost.Value.Cycles);
+		Writer->WriteObjectStart(Cost.Key.ToString());
+		Writer->WriteValue(TEXT("total_ms"), CostMs);
+		Writer->WriteValue(TEXT("ms_per_frame"), CostMs / NumFrames);
+		Writer->WriteValue(TEXT("calls"), Cost.Value.Calls);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("collisions"));
+	if (const UBBCBallSubsystem* BallSubsystem = World.GetSubsystem<UBBCBallSubsystem>())
+	{
+		for (int32 Type = 0; Type < static_cast<int32>(EBBCColliderType::Num); ++Type)
+		{
+			Writer->WriteValue(GetColliderTypeName(static_cast<EBBCColliderType>(Type)), BallSubsystem->GetCollisionCount(static_cast<EBBCColliderType>(Type)));
+		}
+		Writer->WriteValue(TEXT("balls"), BallSubsystem->GetNumBalls());
+		Writer->WriteValue(TEXT("fixed_steps"), static_cast<int64>(BallSubsystem->GetStepCount()));
+	}
+	Writer->WriteObjectEnd();
+
+	if (const UBBCEffectsSubsystem* Effects = World.GetSubsystem<UBBCEffectsSubsystem>())
+	{
+		const FBBCEffectCounters& Counters = Effects->GetCounters();
+		Writer->WriteObjectStart(TEXT("effects"));
+		Writer->WriteValue(TEXT("stubbed"), Effects->IsStubbed());
+		Writer->WriteValue(TEXT("requested"), Counters.Requested);
+		Writer->WriteValue(TEXT("merged"), Counters.Merged);
+		Writer->WriteValue(TEXT("spawned"), Counters.Spawned);
+		Writer->WriteValue(TEXT("reduced"), Counters.Reduced);
+		Writer->WriteValue(TEXT("culled"), Counters.Culled);
+		Writer->WriteValue(TEXT("sounds"), Counters.Sounds);
+		Writer->WriteObjectEnd();
+	}
+
+	if (const UBBCPowerUpSubsystem* PowerUps = World.GetSubsystem<UBBCPowerUpSubsystem>())
+	{
+		Writer->WriteObjectStart(TEXT("power_ups"));
+		Writer->WriteValue(TEXT("activated"), PowerUps->GetNumActivated());
+		Writer->WriteValue(TEXT("active"), PowerUps->GetNumActive());
+		Writer->WriteValue(TEXT("pickups"), PowerUps->GetNumPickups());
+		Writer->WriteValue(TEXT("bolts"), PowerUps->GetNumBolts());
+		Writer->WriteObjectEnd();
+	}
+
+	if (bScenario)
+	{
+		Writer->WriteObjectStart(TEXT("scenario"));
+		Writer->WriteValue(TEXT("name"), Scenario.Name);
+		Writer->WriteValue(TEXT("balls"), Scenario.Balls);
+		Writer->WriteValue(TEXT("bricks"), Scenario.Bricks);
+		Writer->WriteValue(TEXT("mean_ms"), MeanMs);
+		Writer->WriteValue(TEXT("p99_ms"), Percentile(SortedMs, 0.99));
+		Writer->WriteValue(TEXT("memory_mb"), GetMemoryGrowthMb());
+		Writer->WriteValue(TEXT("passed"), bScenarioPassed);
+		Writer->WriteObjectEnd();
+	}
+
+	const UBBCEndlessSubsystem* Endless = World.GetSubsystem<UBBCEndlessSubsystem>();
+	if (Endless != nullptr && Endless->IsActive())
+	{
+		const FBBCEndlessRing& Ring = Endless->GetRing();
+		Writer->WriteObjectStart(TEXT("endless"));
+		Writer->WriteValue(TEXT("chunks"), Ring.GetSettings().NumChunks);
+		Writer->WriteValue(TEXT("chunks_recycled"), Ring.GetNumRecycled());
+		Writer->WriteValue(TEXT("bricks_alive"), Ring.GetNumAlive());
+		Writer->WriteValue(TEXT("ring_bytes"), static_cast<int64>(Endless->GetAllocatedSize()));
+		Writer->WriteObjectEnd();
+	}
+
+	if (SoakSamples.Num() > 0)
+	{
+		const FBBCSoakSample& Baseline = SoakSamples[SoakSamples.Num() > 2 ? 1 : 0];
+		const FBBCSoakSample& Last = SoakSamples.Last();
+		uint64 PeakBytes = 0;
+		for (const FBBCSoakSample& Sample : SoakSamples)
+		{
+			PeakBytes = FMath::Max(PeakBytes, Sample.UsedPhysicalBytes);
+		}
+		const double GrowthBytes = static_cast<double>(Last.UsedPhysicalBytes) - static_cast<double>(Baseline.UsedPhysicalBytes);
+		const int32 SoakRoundsPlayed = FMath::Max(Last.Rounds - Baseline.Rounds, 1);
+		const int32 ObjectGrowth = Last.NumObjects - Baseline.NumObjects;
+		const int32 ActorGrowth = Last.NumActors - Baseline.NumActors;
+		const double FrameMsGrowth = Last.MeanFrameMs - Baseline.MeanFrameMs;
+
+		Writer->WriteObjectStart(TEXT("soak"));
+		Writer->WriteObjectStart(TEXT("memory_mb"));
+		Writer->WriteValue(TEXT("baseline"), Baseline.UsedPhysicalBytes / BytesPerMb);
+		Writer->WriteValue(TEXT("end"), Last.UsedPhysicalBytes / BytesPerMb);
+		Writer->WriteValue(TEXT("peak"), PeakBytes / BytesPerMb);
+		Writer->WriteValue(TEXT("growth"), GrowthBytes / BytesPerMb);
+		Writer->WriteValue(TEXT("growth_kb_per_round"), GrowthBytes / 1024.0 / SoakRoundsPlayed);
+		Writer->WriteObjectEnd();
+		Writer->WriteValue(TEXT("object_growth"), ObjectGrowth);
+		Writer->WriteValue(TEXT("actor_growth"), ActorGrowth);
+		Writer->WriteValue(TEXT("leak_suspected"), ObjectGrowth > LeakObjectTolerance || ActorGrowth > LeakActorTolerance
+			|| GrowthBytes / SoakRoundsPlayed > LeakBytesPerRoundTolerance);
+		Writer->WriteValue(TEXT("frame_ms_growth"), FrameMsGrowth);
+		Writer->WriteValue(TEXT("slowdown_suspected"), FrameMsGrowth > Baseline.MeanFrameMs * FrameDriftTolerance);
+
+		Writer->WriteArrayStart(TEXT("samples"));
+		for (const FBBCSoakSample& Sample : SoakSamples)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("frame"), Sample.Frame);
+			Writer->WriteValue(TEXT("rounds"), Sample.Rounds);
+			Writer->WriteValue(TEXT("memory_mb"), Sample.UsedPhysicalBytes / BytesPerMb);
+			Writer->WriteValue(TEXT("objects"), Sample.NumObjects);
+			Writer->WriteValue(TEXT("actors"), Sample.NumActors);
+			Writer->WriteValue(TEXT("frame_ms"), Sample.MeanFrameMs);
+			Writer->WriteValue(TEXT("min_balls"), Sample.MinBalls);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+	}
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	if (!FFileHelper::SaveStringToFile(Json, *ReportPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write headless report to %s"), *ReportPath);
+		return;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Headless report written to %s"), *ReportPath);
+}
+
+/**
+ * @brief Sorts the recorded frame times in milliseconds and averages them.
+ *
+ * @param OutSortedMs Frame times in milliseconds, ascending.
+ * @param OutMeanMs Mean frame time in milliseconds, 0 without frames.
+ */
+void UBBCHeadlessSubsystem::GetFrameMs(TArray<double>& OutSortedMs, double& OutMeanMs) const
+{
+	OutSortedMs.Reset(FrameSeconds.Num());
+	double TotalMs = 0.0;
+	for (const double Seconds : FrameSeconds)
+	{
+		OutSortedMs.Add(Seconds * 1000.0);
+		TotalMs += Seconds * 1000.0;
+	}
+	OutSortedMs.Sort();
+	OutMeanMs = TotalMs / FMath::Max(OutSortedMs.Num(), 1);
+}
+
+/**
+ * @brief Peak memory in use during the run above what was in use before the world was set up.
+ */
+double UBBCHeadlessSubsystem::GetMemoryGrowthMb() const
+{
+	uint64 PeakBytes = SetUpUsedPhysicalBytes;
+	for (const FBBCSoakSample& Sample : SoakSamples)
+	{
+		PeakBytes = FMath::Max(PeakBytes, Sample.UsedPhysicalBytes);
+	}
+	return (PeakBytes - SetUpUsedPhysicalBytes) / BytesPerMb;
+}
+
+/**
+ * @brief Checks a scenario run against its budgets and baselines.
+ *
+ * Each measurement must stay under its budget and, once a baseline is recorded, under the baseline plus
+ * RegressionTolerance. A missing baseline is only warned about, so a fresh checkout still checks the budgets.
+ * Every soak sample after the one taken at set up must also account for all of the scenario's balls. Every
+ * failed check is logged as an error.
+ *
+ * @return true if every check passed.
+ */
+bool UBBCHeadlessSubsystem::CheckScenario() const
+{
+	TArray<double> SortedMs;
+	double MeanMs = 0.0;
+	GetFrameMs(SortedMs, MeanMs);
+	const double P99Ms = Percentile(SortedMs, 0.99);
+	const double MemoryMb = GetMemoryGrowthMb();
+
+	bool bPassed = true;
+	const auto Check = [this, &bPassed](const TCHAR* Metric, double Value, double Budget, double Baseline)
+	{
+		if (Value > Budget)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Scenario %s: %s %.3f over budget %.3f"), *Scenario.Name, Metric, Value, Budget);
+			bPassed = false;
+		}
+		if (Baseline <= 0.0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Scenario %s: %s has no recorded baseline, checked against its budget only"), *Scenario.Name, Metric);
+			return;
+		}
+		const double Limit = Baseline * (1.0 + RegressionTolerance);
+		if (Value > Limit)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Scenario %s: %s %.3f regressed past baseline %.3f (limit %.3f)"), *Scenario.Name, Metric, Value, Baseline, Limit);
+			bPassed = false;
+		}
+	};
+	Check(TEXT("mean frame ms"), MeanMs, Scenario.BudgetMeanMs, Scenario.BaselineMeanMs);
+	Check(TEXT("p99 frame ms"), P99Ms, Scenario.BudgetP99Ms, Scenario.BaselineP99Ms);
+	Check(TEXT("memory mb"), MemoryMb, Scenario.BudgetMemoryMb, Scenario.BaselineMemoryMb);
+
+	for (int32 Index = 1; Index < SoakSamples.Num(); ++Index)
+	{
+		if (SoakSamples[Index].MinBalls < Scenario.Balls)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Scenario %s: only %d balls accounted for by frame %d, expected %d"),
+				*Scenario.Name, SoakSamples[Index].MinBalls, SoakSamples[Index].Frame, Scenario.Balls);
+			bPassed = false;
+			break;
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Scenario %s %s. To record this run as the baseline:"), *Scenario.Name, bPassed ? TEXT("passed") : TEXT("failed"));
+	UE_LOG(LogTemp, Display, TEXT("+Scenarios=(Name=\"%s\",Balls=%d,Bricks=%d,Frames=%d,BudgetMeanMs=%.2f,BudgetP99Ms=%.2f,BudgetMemoryMb=%.1f,BaselineMeanMs=%.3f,BaselineP99Ms=%.3f,BaselineMemoryMb=%.1f)"),
+		*Scenario.Name, Scenario.Balls, Scenario.Bricks, Scenario.Frames, Scenario.BudgetMeanMs, Scenario.BudgetP99Ms, Scenario.BudgetMemoryMb, MeanMs, P99Ms, MemoryMb);
+	return bPassed;
+}
@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Headless/BBCSimProfiler.h"
+
+bool FBBCSimProfiler::bEnabled = false;
+TMap<FName, FBBCSimCost> FBBCSimProfiler::Costs;
+
+void FBBCSimProfiler::AddCost(FName Category, uint64 Cycles)
+{
+	FBBCSimCost& Cost = Costs.FindOrAdd(Category);
+	Cost.Cycles += Cycles;
+	++Cost.Calls;
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Input/BBCInputLatency.h"
+
+#include "Misc/App.h"
+#include "RenderingThread.h"
+
+FBBCInputLatency::FBBCInputLatency() :
+	Totals(MakeShared<FBBCInputLatencyTotals, ESPMode::ThreadSafe>())
+{
+}
+
+/**
+ * @brief Starts timing when the axis leaves rest or reverses.
+ *
+ * @param Axis Move axis of the sample.
+ *
+ * @note A release is not an edge: the paddle stopping is not measured.
+ */
+void FBBCInputLatency::OnInput(float Axis)
+{
+	const int32 Sign = FMath::Sign(Axis);
+	if (Sign != 0 && Sign != LastSign)
+	{
+		PendingSign = Sign;
+		PendingSeconds = FPlatformTime::Seconds();
+		PendingFrame = GFrameCounter;
+	}
+	LastSign = Sign;
+}
+
+/**
+ * @brief Resolves the pending edge once the paddle moves its way, and follows it onto the render thread.
+ *
+ * @param Delta Paddle displacement over the frame.
+ */
+void FBBCInputLatency::OnPaddleMoved(double Delta)
+{
+	if (PendingSign == 0 || FMath::Sign(Delta) != PendingSign)
+	{
+		return;
+	}
+	PendingSign = 0;
+
+	const double SimFrames = static_cast<double>(GFrameCounter - PendingFrame);
+	const double FrameSeconds = FMath::Max(FApp::GetDeltaTime(), UE_SMALL_NUMBER);
+	ENQUEUE_RENDER_COMMAND(BBCInputLatency)([Totals = Totals, InputSeconds = PendingSeconds, SimFrames, FrameSeconds](FRHICommandListImmediate&)
+	{
+		const double PhotonFrames = (FPlatformTime::Seconds() - InputSeconds) / FrameSeconds + 1.0;
+		FScopeLock ScopeLock(&Totals->Lock);
+		++Totals->NumEdges;
+		Totals->SimFrames += SimFrames;
+		Totals->PhotonFrames += PhotonFrames;
+		Totals->MaxPhotonFrames = FMath::Max(Totals->MaxPhotonFrames, PhotonFrames);
+	});
+}
+
+void FBBCInputLatency::Reset()
+{
+	FScopeLock ScopeLock(&Totals->Lock);
+	Totals->NumEdges = 0;
+	Totals->SimFrames = 0.0;
+	Totals->PhotonFrames = 0.0;
+	Totals->MaxPhotonFrames = 0.0;
+}
+
+bool FBBCInputLatency::GetAverages(int32& OutNumEdges, double& OutSimFrames, double& OutPhotonFrames, double& OutMaxPhotonFrames) const
+{
+	FScopeLock ScopeLock(&Totals->Lock);
+	OutNumEdges = Totals->NumEdges;
+	if (OutNumEdges == 0)
+	{
+		return false;
+	}
+	OutSimFrames = Totals->SimFrames / OutNumEdges;
+	OutPhotonFrames = Totals->PhotonFrames / OutNumEdges;
+	OutMaxPhotonFrames = Totals->MaxPhotonFrames;
+	return true;
+}
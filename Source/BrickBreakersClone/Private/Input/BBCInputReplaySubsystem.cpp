@@ -0,0 +1,267 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Input/BBCInputReplaySubsystem.h"
+
+#include "EnhancedInputSubsystems.h"
+#include "InputActionValue.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "PlayerController/BBCPlayerController.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/**
+ * @brief Reads the record/replay options and hooks the frame delegates.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ *
+ * @note Without either option the subsystem only hands out a fresh random seed.
+ */
+void UBBCInputReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	SessionSeed = FMath::Rand();
+	FParse::Value(CommandLine, TEXT("BBCSeed="), SessionSeed);
+
+	if (FParse::Value(CommandLine, TEXT("BBCReplayInput="), FilePath))
+	{
+		bReplaying = LoadRecording();
+		bExitWhenDone = FParse::Param(CommandLine, TEXT("BBCReplayExit"));
+	}
+	else if (FParse::Value(CommandLine, TEXT("BBCRecordInput="), FilePath))
+	{
+		bRecording = true;
+	}
+
+	if (bRecording || bReplaying)
+	{
+		TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UBBCInputReplaySubsystem::OnWorldTickStart);
+	}
+	if (bReplaying)
+	{
+		BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &UBBCInputReplaySubsystem::OnBeginFrame);
+	}
+}
+
+/**
+ * @brief Unhooks the frame delegates and writes the recording, if one was being made.
+ */
+void UBBCInputReplaySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+
+	if (bRecording)
+	{
+		SaveRecording();
+		bRecording = false;
+	}
+
+	Super::Deinitialize();
+}
+
+bool UBBCInputReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Stores the paddle's move axis for the current frame.
+ *
+ * @param Axis The clamped axis value passed to the paddle.
+ */
+void UBBCInputReplaySubsystem::RecordMove(float Axis)
+{
+	if (bRecording && Frames.Num() > 0)
+	{
+		Frames.Last().MoveAxis = Axis;
+		Frames.Last().Flags |= FBBCInputFrame::Move;
+	}
+}
+
+/**
+ * @brief Marks the current frame as having triggered the start action.
+ */
+void UBBCInputReplaySubsystem::RecordStart()
+{
+	if (bRecording && Frames.Num() > 0)
+	{
+		Frames.Last().Flags |= FBBCInputFrame::Start;
+	}
+}
+
+/**
+ * @brief Opens a new frame record, or injects the recorded frame, before any actor of the world ticks.
+ *
+ * @param World The world about to tick.
+ * @param TickType Kind of tick.
+ * @param DeltaSeconds Frame delta.
+ */
+void UBBCInputReplaySubsystem::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || !World->HasBegunPlay())
+	{
+		return;
+	}
+
+	if (bRecording)
+	{
+		FBBCInputFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.DeltaSeconds = DeltaSeconds;
+		return;
+	}
+
+	if (!Frames.IsValidIndex(ReplayFrame))
+	{
+		bReplaying = false;
+		FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+		FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+		FApp::SetUseFixedTimeStep(false);
+		UE_LOG(LogTemp, Display, TEXT("Input replay finished after %d frames"), ReplayFrame);
+		if (bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+		return;
+	}
+	InjectFrame(Frames[ReplayFrame++]);
+}
+
+/**
+ * @brief Forces the next frame to use the recorded delta, so replayed frames advance time exactly as recorded.
+ */
+void UBBCInputReplaySubsystem::OnBeginFrame()
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr || !World->HasBegunPlay() || !Frames.IsValidIndex(ReplayFrame))
+	{
+		return;
+	}
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Frames[ReplayFrame].DeltaSeconds);
+}
+
+/**
+ * @brief Feeds a recorded frame through Enhanced Input.
+ *
+ * Injected values go through the same mapping and trigger evaluation as device input, so the bound
+ * callbacks on the paddle and player controller run exactly as they did while recording.
+ *
+ * @param Frame The frame to inject.
+ */
+void UBBCInputReplaySubsystem::InjectFrame(const FBBCInputFrame& Frame)
+{
+	const ABBCPlayerController* PlayerController = Cast<ABBCPlayerController>(GetWorld()->GetFirstPlayerController());
+	if (PlayerController == nullptr)
+	{
+		return;
+	}
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer());
+	if (InputSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Subsystem is Invalid"));
+		return;
+	}
+
+	const ABBCPaddle* Paddle = Cast<ABBCPaddle>(PlayerController->GetPawn());
+	if ((Frame.Flags & FBBCInputFrame::Move) != 0 && Paddle != nullptr)
+	{
+		InputSubsystem->InjectInputForAction(Paddle->GetMoveInputAction(), FInputActionValue(Frame.MoveAxis));
+	}
+	if ((Frame.Flags & FBBCInputFrame::Start) != 0 && PlayerController->GetStartInputAction() != nullptr)
+	{
+		InputSubsystem->InjectInputForAction(PlayerController->GetStartInputAction(), FInputActionValue(true));
+	}
+}
+
+/**
+ * @brief Reads a recording made with -BBCRecordInput.
+ *
+ * Layout: magic, version, seed, frame count, then per frame a flag byte, the frame delta and, for frames
+ * with movement, the move axis.
+ *
+ * @return true if the file was read and its header is valid.
+ *
+ * @note The seed and frames are only taken once the whole file has been read and checked, so a bad file
+ * leaves the session's own seed in place.
+ */
+bool UBBCInputReplaySubsystem::LoadRecording()
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read input recording %s"), *FilePath);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	int32 Seed = 0;
+	int32 NumFrames = 0;
+	Reader << Magic << Version << Seed << NumFrames;
+	// Every frame takes at least its flag byte and its delta.
+	constexpr int64 MinFrameBytes = sizeof(uint8) + sizeof(float);
+	if (Reader.IsError() || Magic != FileMagic || Version != FileVersion || NumFrames < 0
+		|| NumFrames > (Reader.TotalSize() - Reader.Tell()) / MinFrameBytes)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a valid input recording"), *FilePath);
+		return false;
+	}
+
+	TArray<FBBCInputFrame> LoadedFrames;
+	LoadedFrames.SetNum(NumFrames);
+	for (FBBCInputFrame& Frame : LoadedFrames)
+	{
+		Reader << Frame.Flags << Frame.DeltaSeconds;
+		if ((Frame.Flags & FBBCInputFrame::Move) != 0)
+		{
+			Reader << Frame.MoveAxis;
+		}
+	}
+	if (Reader.IsError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Input recording %s is truncated"), *FilePath);
+		return false;
+	}
+
+	SessionSeed = Seed;
+	Frames = MoveTemp(LoadedFrames);
+
+	UE_LOG(LogTemp, Display, TEXT("Replaying %d input frames from %s (seed %d)"), NumFrames, *FilePath, SessionSeed);
+	return true;
+}
+
+void UBBCInputReplaySubsystem::SaveRecording() const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	uint32 Magic = FileMagic;
+	uint16 Version = FileVersion;
+	int32 Seed = SessionSeed;
+	int32 NumFrames = Frames.Num();
+	Writer << Magic << Version << Seed << NumFrames;
+	for (FBBCInputFrame Frame : Frames)
+	{
+		Writer << Frame.Flags << Frame.DeltaSeconds;
+		if ((Frame.Flags & FBBCInputFrame::Move) != 0)
+		{
+			Writer << Frame.MoveAxis;
+		}
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write input recording %s"), *FilePath);
+		return;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Recorded %d input frames to %s"), NumFrames, *FilePath);
+}
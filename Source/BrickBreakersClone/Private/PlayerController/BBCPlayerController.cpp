@@ -2,26 +2,57 @@
 
 
 #include "PlayerController/BBCPlayerController.h"
+#include "Assets/BBCAssetSubsystem.h"
 #include "Components/InputComponent.h"
 #include "InputMappingContext.h"
 #include "InputAction.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "GameState/BBCGameState.h"
+#include "Input/BBCInputReplaySubsystem.h"
 
-ABBCPlayerController::ABBCPlayerController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+ABBCPlayerController::ABBCPlayerController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer),
+	PlayerInputMappingContext(nullptr),
+	StartInputAction(nullptr)
 {
-	ConstructorHelpers::FObjectFinder<UInputMappingContext> InputMapContRef(TEXT("InputMappingContext'/Game/Inputs/IMC_Player.IMC_Player'"));
-	ConstructorHelpers::FObjectFinder<UInputAction> InputActionRef(TEXT("InputAction'/Game/Inputs/InputActions/IA_Start.IA_Start'"));
-
-	PlayerInputMappingContext = InputMapContRef.Object;
-	StartInputAction = InputActionRef.Object;
 }
 
+/**
+ * @brief Sets up the player's input once the Input bundle of the asset manifest is loaded.
+ *
+ * The bundle is requested when the game instance starts, so it is normally in by now and the setup runs
+ * immediately; otherwise it runs when the bundle arrives, without blocking the game thread.
+ */
 void ABBCPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if(UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this))
+	{
+		Assets->WhenLoaded(EBBCAssetBundle::Input, FSimpleDelegate::CreateUObject(this, &ABBCPlayerController::SetupPlayerInput));
+		return;
+	}
+	SetupPlayerInput();
+}
+
+/**
+ * @brief Adds the player mapping context and binds the start action, taking both from the asset manifest
+ * unless a subclass set them.
+ */
+void ABBCPlayerController::SetupPlayerInput()
+{
+	if(const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this))
+	{
+		if(PlayerInputMappingContext == nullptr)
+		{
+			PlayerInputMappingContext = Assets->GetPlayerMappingContext();
+		}
+		if(StartInputAction == nullptr)
+		{
+			StartInputAction = Assets->GetStartAction();
+		}
+	}
+
 	UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer());
 	if(Subsystem == nullptr)
 	{
@@ -29,11 +60,7 @@ void ABBCPlayerController::BeginPlay()
 		return;
 	}
 	Subsystem->AddMappingContext(PlayerInputMappingContext, 0);
-}
 
-void ABBCPlayerController::SetupInputComponent()
-{
-	Super::SetupInputComponent();
 	UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
 	if(EnhancedInputComponent == nullptr)
 	{
@@ -46,6 +73,10 @@ void ABBCPlayerController::SetupInputComponent()
 
 void ABBCPlayerController::OnStartBall()
 {
+	if(UBBCInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UBBCInputReplaySubsystem>())
+	{
+		InputReplay->RecordStart();
+	}
 	if(ABBCGameState* GameState = GetWorld()->GetGameState<ABBCGameState>())
 	{
 		GameState->TryStartBall();
@@ -0,0 +1,604 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PowerUps/BBCPowerUpSubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Level/BBCPlayfieldSubsystem.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameState/BBCGameEventSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Input/BBCInputReplaySubsystem.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Scale of the instance of an unused pickup or bolt; the instance stays so no buffer is reallocated. */
+	const FVector HiddenScale = FVector::ZeroVector;
+
+	/** Distance between the paddle's top and a bolt it fires, so the bolt never starts inside the paddle. */
+	constexpr double BoltClearance = 1.0;
+
+	FAutoConsoleCommandWithWorld PowerUpStatsCommand(
+		TEXT("BBC.PowerUps.Stats"),
+		TEXT("Logs the power-ups in effect, the pickups falling and the laser bolts in flight."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCPowerUpSubsystem* PowerUps = World != nullptr ? World->GetSubsystem<UBBCPowerUpSubsystem>() : nullptr)
+			{
+				PowerUps->LogStats();
+			}
+		}));
+
+	/**
+	 * @brief Activates power-ups as if their pickups had been caught.
+	 *
+	 * Usage: BBC.PowerUps.Grant <Kind|All> [Count]
+	 */
+	FAutoConsoleCommandWithWorldAndArgs PowerUpGrantCommand(
+		TEXT("BBC.PowerUps.Grant"),
+		TEXT("Activates power-ups of a kind, or of every kind in turn. Usage: BBC.PowerUps.Grant <Multiball|WidePaddle|SlowBall|Laser|StickyPaddle|All> [Count]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCPowerUpSubsystem* PowerUps = World != nullptr ? World->GetSubsystem<UBBCPowerUpSubsystem>() : nullptr;
+			if (PowerUps == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+			const bool bAll = Args[0] == TEXT("All");
+			const int64 KindValue = bAll ? 0 : StaticEnum<EBBCPowerUp>()->GetValueByNameString(Args[0]);
+			if (KindValue == INDEX_NONE || KindValue >= static_cast<int64>(EBBCPowerUp::Num))
+			{
+				UE_LOG(LogTemp, Error, TEXT("Unknown power-up %s"), *Args[0]);
+				return;
+			}
+			const int32 Count = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const int32 Kind = bAll ? Index % static_cast<int32>(EBBCPowerUp::Num) : static_cast<int32>(KindValue);
+				PowerUps->Activate(static_cast<EBBCPowerUp>(Kind));
+			}
+		}));
+}
+
+const UBBCPowerUpSubsystem::FHandler UBBCPowerUpSubsystem::Handlers[] =
+{
+	&UBBCPowerUpSubsystem::ApplyMultiball,
+	&UBBCPowerUpSubsystem::ApplyWidePaddle,
+	&UBBCPowerUpSubsystem::ApplySlowBall,
+	&UBBCPowerUpSubsystem::ApplyLaser,
+	&UBBCPowerUpSubsystem::ApplyStickyPaddle,
+};
+
+/**
+ * @brief Indexes the configured effect records by kind and sizes every buffer once.
+ */
+void UBBCPowerUpSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	static_assert(UE_ARRAY_COUNT(Handlers) == static_cast<int32>(EBBCPowerUp::Num), "Every power-up kind needs a handler");
+
+	for (const FBBCPowerUpEffect& Effect : PowerUps)
+	{
+		if (Effect.Kind >= EBBCPowerUp::Num)
+		{
+			UE_LOG(LogTemp, Error, TEXT("PowerUp Kind is Invalid"));
+			continue;
+		}
+		FBBCPowerUpEffect& Slot = Effects[static_cast<int32>(Effect.Kind)];
+		Slot = Effect;
+		Slot.MaxStacks = FMath::Max(Slot.MaxStacks, 1);
+		Slot.DropWeight = FMath::Max(Slot.DropWeight, 0.f);
+	}
+
+	Timers.Init(TimerWheelSlots, TimerWheelTickSeconds, MaxActive);
+	PickupPositions.Reserve(MaxPickups);
+	PickupKinds.Reserve(MaxPickups);
+	BoltPositions.Reserve(MaxBolts);
+	ViewTransforms.Reserve(FMath::Max(MaxPickups, MaxBolts));
+
+	BallSubsystem = Collection.InitializeDependency<UBBCBallSubsystem>();
+	if (UBBCGameEventSubsystem* GameEvents = Collection.InitializeDependency<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnBrickDestroyed().AddUObject(this, &UBBCPowerUpSubsystem::HandleBrickDestroyed);
+		GameEvents->OnBallLost().AddUObject(this, &UBBCPowerUpSubsystem::HandleBallLost);
+		GameEvents->OnLevelStarted().AddUObject(this, &UBBCPowerUpSubsystem::HandleLevelStarted);
+	}
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Bricks, EBBCTickOrder::BeforeActors, FBBCTickUpdate::CreateUObject(this, &UBBCPowerUpSubsystem::Advance));
+	}
+}
+
+void UBBCPowerUpSubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	if (UBBCGameEventSubsystem* GameEvents = GetWorld()->GetSubsystem<UBBCGameEventSubsystem>())
+	{
+		GameEvents->OnBrickDestroyed().RemoveAll(this);
+		GameEvents->OnBallLost().RemoveAll(this);
+		GameEvents->OnLevelStarted().RemoveAll(this);
+	}
+	if (IsValid(ViewActor))
+	{
+		ViewActor->Destroy();
+	}
+	ViewActor = nullptr;
+	PickupInstances = nullptr;
+	BoltInstances = nullptr;
+	BallSubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UBBCPowerUpSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this))
+	{
+		Assets->WhenLoaded(EBBCAssetBundle::Gameplay, FSimpleDelegate::CreateUObject(this, &UBBCPowerUpSubsystem::CreateView));
+	}
+}
+
+bool UBBCPowerUpSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Runs one frame of power-ups, from the Bricks phase of UBBCTickManagerSubsystem.
+ *
+ * - Moves every pickup down, applies those the paddle caught and drops those past the arena
+ * - Fires the laser while it is in effect and moves its bolts, damaging the bricks they hit
+ * - Advances the timer wheel, taking a stack off the kind of every effect that expires
+ * - Writes the pickups and bolts to their instanced meshes
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ */
+void UBBCPowerUpSubsystem::Advance(float DeltaTime)
+{
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_PowerUps);
+
+	UpdatePickups(DeltaTime);
+	UpdateLaser(DeltaTime);
+	Timers.Advance(DeltaTime, [this](uint32 Payload)
+	{
+		const EBBCPowerUp Kind = static_cast<EBBCPowerUp>(Payload);
+		SetLiveCount(Kind, LiveCounts[Payload] - 1);
+	});
+	UpdateView();
+
+	BBC_SET_DWORD_STAT(STAT_BBC_PowerUpsActive, Timers.Num());
+	BBC_SET_DWORD_STAT(STAT_BBC_PowerUpPickups, PickupPositions.Num());
+}
+
+/**
+ * @brief Applies a power-up.
+ *
+ * An effect that acts once goes straight to its handler. A lasting effect schedules its expiry on the timer
+ * wheel and adds a stack, which reaches the handler only while the kind is below MaxStacks.
+ *
+ * @param Kind Kind of the power-up.
+ *
+ * @return false if the kind has no effect record, or the timer wheel is full.
+ */
+bool UBBCPowerUpSubsystem::Activate(EBBCPowerUp Kind)
+{
+	if (Kind >= EBBCPowerUp::Num)
+	{
+		return false;
+	}
+	const int32 KindIndex = static_cast<int32>(Kind);
+	const FBBCPowerUpEffect& Effect = Effects[KindIndex];
+	if (Effect.Kind != Kind)
+	{
+		return false;
+	}
+
+	if (Effect.DurationSeconds <= 0.f)
+	{
+		(this->*Handlers[KindIndex])(Effect, 1);
+	}
+	else
+	{
+		if (Timers.Schedule(Effect.DurationSeconds, static_cast<uint32>(KindIndex)) == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Power-up %s dropped: %d effects already active"), *StaticEnum<EBBCPowerUp>()->GetNameStringByValue(KindIndex), Timers.Num());
+			return false;
+		}
+		SetLiveCount(Kind, LiveCounts[KindIndex] + 1);
+	}
+	++NumActivated;
+	return true;
+}
+
+void UBBCPowerUpSubsystem::DropPickup(EBBCPowerUp Kind, const FVector2D& Location)
+{
+	if (Kind >= EBBCPowerUp::Num || PickupPositions.Num() >= MaxPickups)
+	{
+		return;
+	}
+	PickupPositions.Add(Location);
+	PickupKinds.Add(Kind);
+	++NumDropped;
+}
+
+/**
+ * @brief Ends every effect at once, as when the player's ball is lost or a level starts.
+ *
+ * @param bPickups Also removes the falling pickups and the laser bolts.
+ */
+void UBBCPowerUpSubsystem::Clear(bool bPickups)
+{
+	Timers.Reset();
+	for (int32 KindIndex = 0; KindIndex < static_cast<int32>(EBBCPowerUp::Num); ++KindIndex)
+	{
+		SetLiveCount(static_cast<EBBCPowerUp>(KindIndex), 0);
+	}
+	if (bPickups)
+	{
+		PickupPositions.Reset();
+		PickupKinds.Reset();
+		BoltPositions.Reset();
+		LaserCooldown = 0.0;
+	}
+}
+
+int32 UBBCPowerUpSubsystem::GetNumStacks(EBBCPowerUp Kind) const
+{
+	if (Kind >= EBBCPowerUp::Num)
+	{
+		return 0;
+	}
+	const int32 KindIndex = static_cast<int32>(Kind);
+	return FMath::Min(LiveCounts[KindIndex], Effects[KindIndex].MaxStacks);
+}
+
+void UBBCPowerUpSubsystem::LogStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("Power-ups: %d active, %lld activated, %lld dropped, %lld caught, %d pickups falling, %d bolts in flight, %llu timer bytes"),
+		Timers.Num(), NumActivated, NumDropped, NumCaught, PickupPositions.Num(), BoltPositions.Num(), static_cast<uint64>(Timers.GetAllocatedSize()));
+	for (int32 KindIndex = 0; KindIndex < static_cast<int32>(EBBCPowerUp::Num); ++KindIndex)
+	{
+		const EBBCPowerUp Kind = static_cast<EBBCPowerUp>(KindIndex);
+		UE_LOG(LogTemp, Display, TEXT("  %s: %d live, %d / %d stacks"), *StaticEnum<EBBCPowerUp>()->GetNameStringByValue(KindIndex),
+			LiveCounts[KindIndex], GetNumStacks(Kind), Effects[KindIndex].MaxStacks);
+	}
+}
+
+/**
+ * @brief Splits every ball in play into Magnitude more balls, fanned out by MultiballSpreadDegrees.
+ */
+void UBBCPowerUpSubsystem::ApplyMultiball(const FBBCPowerUpEffect& Effect, int32 Stacks)
+{
+	if (BallSubsystem == nullptr || Stacks <= 0)
+	{
+		return;
+	}
+	const int32 NumSplits = FMath::Max(FMath::RoundToInt32(Effect.Magnitude), 1);
+	const int32 NumBalls = BallSubsystem->GetNumBalls();
+	for (int32 Index = 0; Index < NumBalls && BallSubsystem->GetNumBalls() < MaxBalls; ++Index)
+	{
+		FBBCBallState State;
+		if (!BallSubsystem->GetBallState(BallSubsystem->GetBallHandle(Index), State) || State.Speed <= 0.0)
+		{
+			continue;
+		}
+		for (int32 Split = 1; Split <= NumSplits && BallSubsystem->GetNumBalls() < MaxBalls; ++Split)
+		{
+			const float Degrees = MultiballSpreadDegrees * ((Split + 1) / 2) * (Split % 2 == 1 ? 1.f : -1.f);
+			const FVector2D Direction = State.Direction.GetRotated(Degrees);
+			BallSubsystem->SpawnBall(State.Position, Direction, State.Speed, State.Radius);
+		}
+	}
+}
+
+void UBBCPowerUpSubsystem::ApplyWidePaddle(const FBBCPowerUpEffect& Effect, int32 Stacks)
+{
+	if (ABBCPaddle* Paddle = GetPaddle())
+	{
+		Paddle->SetWidthMultiplier(FMath::Pow(static_cast<double>(Effect.Magnitude), Stacks));
+	}
+}
+
+void UBBCPowerUpSubsystem::ApplySlowBall(const FBBCPowerUpEffect& Effect, int32 Stacks)
+{
+	if (BallSubsystem != nullptr)
+	{
+		BallSubsystem->SetSpeedScale(FMath::Pow(static_cast<double>(Effect.Magnitude), Stacks));
+	}
+}
+
+void UBBCPowerUpSubsystem::ApplyLaser(const FBBCPowerUpEffect& Effect, int32 Stacks)
+{
+	LaserShotsPerSecond = static_cast<double>(Effect.Magnitude) * Stacks;
+}
+
+void UBBCPowerUpSubsystem::ApplyStickyPaddle(const FBBCPowerUpEffect& Effect, int32 Stacks)
+{
+	if (BallSubsystem != nullptr)
+	{
+		BallSubsystem->SetStickyPaddle(Stacks > 0 ? Effect.Magnitude : 0.0);
+	}
+}
+
+/**
+ * @brief Changes the live timer count of a kind and calls its handler if the stacks in effect changed.
+ *
+ * @param Kind Kind whose count changes.
+ * @param LiveCount Lasting effects of the kind picked up and not expired.
+ */
+void UBBCPowerUpSubsystem::SetLiveCount(EBBCPowerUp Kind, int32 LiveCount)
+{
+	const int32 KindIndex = static_cast<int32>(Kind);
+	const int32 OldStacks = GetNumStacks(Kind);
+	LiveCounts[KindIndex] = FMath::Max(LiveCount, 0);
+	const int32 NewStacks = GetNumStacks(Kind);
+	if (NewStacks != OldStacks && Effects[KindIndex].Kind == Kind)
+	{
+		(this->*Handlers[KindIndex])(Effects[KindIndex], NewStacks);
+	}
+}
+
+/**
+ * @brief Draws the kind of a dropped pickup from the configured drop weights.
+ *
+ * @return The kind, or EBBCPowerUp::Num if no kind can drop.
+ */
+EBBCPowerUp UBBCPowerUpSubsystem::PickDropKind()
+{
+	float TotalWeight = 0.f;
+	for (const FBBCPowerUpEffect& Effect : Effects)
+	{
+		TotalWeight += Effect.Kind != EBBCPowerUp::Num ? Effect.DropWeight : 0.f;
+	}
+	if (TotalWeight <= 0.f)
+	{
+		return EBBCPowerUp::Num;
+	}
+
+	float Pick = DropRandom.FRandRange(0.f, TotalWeight);
+	for (const FBBCPowerUpEffect& Effect : Effects)
+	{
+		if (Effect.Kind == EBBCPowerUp::Num || Effect.DropWeight <= 0.f)
+		{
+			continue;
+		}
+		Pick -= Effect.DropWeight;
+		if (Pick <= 0.f)
+		{
+			return Effect.Kind;
+		}
+	}
+	return EBBCPowerUp::Num;
+}
+
+/**
+ * @brief Moves every pickup down in one pass and applies those that touch the paddle collider.
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ *
+ * @note A pickup that is caught or falls past the arena is swapped out, so the buffers stay packed.
+ * @note Pickups only collide with the paddle, a single box, so they are tested against it directly. Going
+ * through the ball subsystem's spatial hash would cost a cell lookup per pickup only to find that same box.
+ */
+void UBBCPowerUpSubsystem::UpdatePickups(float DeltaTime)
+{
+	if (PickupPositions.Num() == 0)
+	{
+		return;
+	}
+
+	const FBBCCollider* PaddleCollider = BallSubsystem != nullptr ? BallSubsystem->GetPaddleCollider() : nullptr;
+	const FVector2D HalfSize = PickupSize * 0.5;
+	const FBox2D CatchBox = PaddleCollider != nullptr ? FBox2D(PaddleCollider->Box.Min - HalfSize, PaddleCollider->Box.Max + HalfSize) : FBox2D(ForceInit);
+	const double BottomY = UBBCPlayfieldSubsystem::GetLayout(this).Arena.Max.Y;
+	const double Fall = PickupFallSpeed * DeltaTime;
+	for (int32 Index = PickupPositions.Num() - 1; Index >= 0; --Index)
+	{
+		FVector2D& Position = PickupPositions[Index];
+		Position.Y += Fall;
+		const bool bCaught = CatchBox.bIsValid && CatchBox.IsInside(Position);
+		if (!bCaught && Position.Y <= BottomY)
+		{
+			continue;
+		}
+		if (bCaught)
+		{
+			++NumCaught;
+			Activate(PickupKinds[Index]);
+		}
+		PickupPositions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		PickupKinds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
+
+/**
+ * @brief Fires a bolt from each end of the paddle at the laser's rate, and sweeps every bolt up through the
+ * ball subsystem's colliders, bricks and brick source.
+ *
+ * @param DeltaTime Time elapsed since the last frame.
+ *
+ * @note A bolt ends at the first thing it touches, damaging it if it is a brick.
+ */
+void UBBCPowerUpSubsystem::UpdateLaser(float DeltaTime)
+{
+	if (BallSubsystem == nullptr)
+	{
+		return;
+	}
+
+	const FBBCCollider* PaddleCollider = BallSubsystem->GetPaddleCollider();
+	LaserCooldown = FMath::Max(LaserCooldown - DeltaTime, 0.0);
+	if (LaserShotsPerSecond > 0.0 && LaserCooldown <= 0.0 && PaddleCollider != nullptr)
+	{
+		const FBox2D& PaddleBox = PaddleCollider->Box;
+		const double Y = PaddleBox.Min.Y - BoltRadius - BoltClearance;
+		for (const double X : {PaddleBox.Min.X + BoltRadius, PaddleBox.Max.X - BoltRadius})
+		{
+			if (BoltPositions.Num() < MaxBolts)
+			{
+				BoltPositions.Add(FVector2D(X, Y));
+			}
+		}
+		LaserCooldown = 1.0 / LaserShotsPerSecond;
+	}
+
+	const FVector2D Delta(0.0, -BoltSpeed * DeltaTime);
+	for (int32 Index = BoltPositions.Num() - 1; Index >= 0; --Index)
+	{
+		FBBCSweepHit Hit;
+		if (!BallSubsystem->TraceBall(BoltPositions[Index], Delta, BoltRadius, Hit))
+		{
+			BoltPositions[Index] += Delta;
+			continue;
+		}
+		BallSubsystem->DamageBrick(Hit);
+		BoltPositions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
+
+/**
+ * @brief Spawns the actor drawing the pickups and bolts, with MaxPickups and MaxBolts hidden instances.
+ *
+ * Instances are never added or removed: the first GetNumPickups() instances draw the pickups and the rest stay
+ * at a zero scale, and likewise for the bolts.
+ */
+void UBBCPowerUpSubsystem::CreateView()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || ViewActor != nullptr)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("PowerUpView");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ViewActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(ViewActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn power-up view actor. "));
+		return;
+	}
+
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	PickupInstances = NewObject<UInstancedStaticMeshComponent>(ViewActor, TEXT("PowerUpPickups"));
+	PickupInstances->SetMobility(EComponentMobility::Movable);
+	PickupInstances->SetStaticMesh(Assets != nullptr ? Assets->GetBrickMesh() : nullptr);
+	PickupInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PickupInstances->SetCastShadow(false);
+	ViewActor->SetRootComponent(PickupInstances);
+	PickupInstances->RegisterComponent();
+
+	BoltInstances = NewObject<UInstancedStaticMeshComponent>(ViewActor, TEXT("PowerUpBolts"));
+	BoltInstances->SetMobility(EComponentMobility::Movable);
+	BoltInstances->SetStaticMesh(Assets != nullptr ? Assets->GetBallMesh() : nullptr);
+	BoltInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BoltInstances->SetCastShadow(false);
+	BoltInstances->SetupAttachment(PickupInstances);
+	BoltInstances->RegisterComponent();
+
+	ViewTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, HiddenScale), MaxPickups);
+	PickupInstances->AddInstances(ViewTransforms, false, false);
+	ViewTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, HiddenScale), MaxBolts);
+	BoltInstances->AddInstances(ViewTransforms, false, false);
+	NumDrawnPickups = 0;
+	NumDrawnBolts = 0;
+}
+
+/**
+ * @brief Rewrites the instances in use now or last frame, in one batched update per mesh.
+ */
+void UBBCPowerUpSubsystem::UpdateView()
+{
+	if (PickupInstances == nullptr || BoltInstances == nullptr)
+	{
+		return;
+	}
+
+	const int32 NumPickupInstances = FMath::Max(PickupPositions.Num(), NumDrawnPickups);
+	if (NumPickupInstances > 0)
+	{
+		FVector Scale = FVector::OneVector;
+		if (const UStaticMesh* Mesh = PickupInstances->GetStaticMesh())
+		{
+			const FVector MeshSize = Mesh->GetBounds().BoxExtent * 2.0;
+			Scale.X = MeshSize.X > 0.0 ? PickupSize.X / MeshSize.X : 1.0;
+			Scale.Y = MeshSize.Y > 0.0 ? PickupSize.Y / MeshSize.Y : 1.0;
+			Scale.Z = FMath::Min(Scale.X, Scale.Y);
+		}
+		ViewTransforms.Reset();
+		for (int32 Index = 0; Index < NumPickupInstances; ++Index)
+		{
+			const bool bUsed = PickupPositions.IsValidIndex(Index);
+			ViewTransforms.Emplace(FQuat::Identity, FVector(bUsed ? PickupPositions[Index] : FVector2D::ZeroVector, 0.0), bUsed ? Scale : HiddenScale);
+		}
+		PickupInstances->BatchUpdateInstancesTransforms(0, ViewTransforms, false, true, true);
+		NumDrawnPickups = PickupPositions.Num();
+	}
+
+	const int32 NumBoltInstances = FMath::Max(BoltPositions.Num(), NumDrawnBolts);
+	if (NumBoltInstances > 0)
+	{
+		const UStaticMesh* Mesh = BoltInstances->GetStaticMesh();
+		const double MeshRadius = Mesh != nullptr ? Mesh->GetBounds().BoxExtent.X : 50.0;
+		const FVector Scale(BoltRadius / MeshRadius);
+		ViewTransforms.Reset();
+		for (int32 Index = 0; Index < NumBoltInstances; ++Index)
+		{
+			const bool bUsed = BoltPositions.IsValidIndex(Index);
+			ViewTransforms.Emplace(FQuat::Identity, FVector(bUsed ? BoltPositions[Index] : FVector2D::ZeroVector, 0.0), bUsed ? Scale : HiddenScale);
+		}
+		BoltInstances->BatchUpdateInstancesTransforms(0, ViewTransforms, false, true, true);
+		NumDrawnBolts = BoltPositions.Num();
+	}
+}
+
+ABBCPaddle* UBBCPowerUpSubsystem::GetPaddle() const
+{
+	return BallSubsystem != nullptr ? BallSubsystem->GetPaddle() : nullptr;
+}
+
+/**
+ * @brief Drops a pickup from a destroyed brick with DropChance, of a kind drawn from the drop weights.
+ */
+void UBBCPowerUpSubsystem::HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event)
+{
+	if (PickupPositions.Num() >= MaxPickups || DropRandom.FRand() >= DropChance)
+	{
+		return;
+	}
+	DropPickup(PickDropKind(), Event.Location);
+}
+
+/**
+ * @brief Ends every effect when the last ball in play is lost; losing any other ball changes nothing.
+ */
+void UBBCPowerUpSubsystem::HandleBallLost(const FBBCBallLostEvent& Event)
+{
+	if (Event.bLastBall)
+	{
+		Clear(true);
+	}
+}
+
+/**
+ * @brief Starts the level without effects or pickups, and reseeds the drops from the session seed and the level.
+ */
+void UBBCPowerUpSubsystem::HandleLevelStarted(const FBBCLevelStartedEvent& Event)
+{
+	Clear(true);
+	const UBBCInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UBBCInputReplaySubsystem>();
+	const uint32 SessionSeed = InputReplay != nullptr ? static_cast<uint32>(InputReplay->GetSessionSeed()) : 0;
+	DropRandom.Initialize(static_cast<int32>(HashCombineFast(SessionSeed, static_cast<uint32>(Event.LevelIndex))));
+}
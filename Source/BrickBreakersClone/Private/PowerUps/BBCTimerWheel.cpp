@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PowerUps/BBCTimerWheel.h"
+
+/**
+ * @brief Allocates the slots and the timer pool.
+ *
+ * @param NumSlots Slots of the wheel, rounded up to a power of two. One turn of the wheel covers
+ * NumSlots * InTickSeconds; longer timers are still correct, they are just looked at once per turn.
+ * @param InTickSeconds Resolution of the wheel.
+ * @param Capacity Timers active at once at most.
+ */
+void FBBCTimerWheel::Init(int32 NumSlots, double InTickSeconds, int32 Capacity)
+{
+	const uint32 RoundedSlots = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(NumSlots, 1)));
+	SlotMask = RoundedSlots - 1;
+	TickSeconds = FMath::Max(InTickSeconds, UE_KINDA_SMALL_NUMBER);
+	SlotHeads.Init(INDEX_NONE, RoundedSlots);
+	Timers.SetNum(FMath::Max(Capacity, 0));
+	FreeTimers.Reserve(Timers.Num());
+	Reset();
+}
+
+void FBBCTimerWheel::Reset()
+{
+	for (int32& Head : SlotHeads)
+	{
+		Head = INDEX_NONE;
+	}
+	FreeTimers.Reset();
+	for (int32 TimerId = Timers.Num() - 1; TimerId >= 0; --TimerId)
+	{
+		Timers[TimerId] = FTimer();
+		FreeTimers.Add(TimerId);
+	}
+	Accumulator = 0.0;
+	CurrentTick = 0;
+	NumActive = 0;
+}
+
+/**
+ * @brief Takes a timer from the pool and links it into the slot of its expiry tick.
+ *
+ * @param DelaySeconds Time until expiry, rounded up to whole ticks.
+ * @param Payload Handed back to the Advance callback on expiry.
+ *
+ * @return Id of the timer, for Cancel, or INDEX_NONE if every timer is in use.
+ */
+int32 FBBCTimerWheel::Schedule(double DelaySeconds, uint32 Payload)
+{
+	if (FreeTimers.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 TimerId = FreeTimers.Pop(EAllowShrinking::No);
+	FTimer& Timer = Timers[TimerId];
+	Timer.ExpireTick = CurrentTick + FMath::Max<uint64>(FMath::CeilToInt64(DelaySeconds / TickSeconds), 1);
+	Timer.Payload = Payload;
+	Timer.bActive = true;
+	Link(TimerId);
+	++NumActive;
+	return TimerId;
+}
+
+void FBBCTimerWheel::Cancel(int32 TimerId)
+{
+	if (!IsActive(TimerId))
+	{
+		return;
+	}
+	Unlink(TimerId);
+	Timers[TimerId].bActive = false;
+	FreeTimers.Add(TimerId);
+	--NumActive;
+}
+
+double FBBCTimerWheel::GetRemainingSeconds(int32 TimerId) const
+{
+	if (!IsActive(TimerId))
+	{
+		return 0.0;
+	}
+	return (Timers[TimerId].ExpireTick - CurrentTick) * TickSeconds - Accumulator;
+}
+
+void FBBCTimerWheel::Link(int32 TimerId)
+{
+	FTimer& Timer = Timers[TimerId];
+	int32& Head = SlotHeads[Timer.ExpireTick & SlotMask];
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Timers[Head].Prev = TimerId;
+	}
+	Head = TimerId;
+}
+
+void FBBCTimerWheel::Unlink(int32 TimerId)
+{
+	FTimer& Timer = Timers[TimerId];
+	if (Timer.Prev != INDEX_NONE)
+	{
+		Timers[Timer.Prev].Next = Timer.Next;
+	}
+	else
+	{
+		SlotHeads[Timer.ExpireTick & SlotMask] = Timer.Next;
+	}
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = Timer.Prev;
+	}
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+}
@@ -0,0 +1,396 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/BBCReplayCodec.h"
+
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace
+{
+	constexpr double PositionScale = 16.0;
+	constexpr double AngleScale = 65536.0 / UE_TWO_PI;
+	/** Upper bounds on counts read from a file, so a corrupt frame fails instead of allocating. */
+	constexpr uint32 MaxBalls = 1 << 20;
+	constexpr uint32 MaxCells = 1 << 20;
+
+	int32 QuantizePosition(double Value)
+	{
+		return static_cast<int32>(FMath::Clamp(FMath::RoundToDouble(Value * PositionScale), static_cast<double>(MIN_int32 / 2), static_cast<double>(MAX_int32 / 2)));
+	}
+
+	uint16 QuantizeAngle(const FVector2D& Direction)
+	{
+		const double Angle = FMath::Atan2(Direction.Y, Direction.X);
+		return static_cast<uint16>(static_cast<int32>(FMath::RoundToDouble(Angle * AngleScale)) & 0xFFFF);
+	}
+
+	FVector2D DequantizeAngle(uint16 Angle)
+	{
+		double Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, static_cast<double>(Angle) / AngleScale);
+		return FVector2D(Cos, Sin);
+	}
+
+	uint32 ZigZag(int32 Value)
+	{
+		return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+	}
+
+	int32 UnZigZag(uint32 Value)
+	{
+		return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+	}
+
+	void WriteBits(FBitWriter& Writer, uint64 Value, int32 NumBits)
+	{
+		for (int32 Bit = NumBits - 1; Bit >= 0; --Bit)
+		{
+			Writer.WriteBit(static_cast<uint8>((Value >> Bit) & 1));
+		}
+	}
+
+	uint64 ReadBits(FBitReader& Reader, int32 NumBits)
+	{
+		uint64 Value = 0;
+		for (int32 Bit = 0; Bit < NumBits; ++Bit)
+		{
+			Value = (Value << 1) | Reader.ReadBit();
+		}
+		return Value;
+	}
+
+	/** Elias gamma code of Value + 1: 2 * floor(log2(Value + 1)) + 1 bits, one bit for zero. */
+	void WriteGamma(FBitWriter& Writer, uint32 Value)
+	{
+		const uint64 Coded = static_cast<uint64>(Value) + 1;
+		const int32 NumBits = 64 - FMath::CountLeadingZeros64(Coded);
+		WriteBits(Writer, 0, NumBits - 1);
+		WriteBits(Writer, Coded, NumBits);
+	}
+
+	uint32 ReadGamma(FBitReader& Reader)
+	{
+		int32 NumZeros = 0;
+		while (!Reader.IsError() && Reader.ReadBit() == 0)
+		{
+			if (++NumZeros > 32)
+			{
+				Reader.SetError();
+				return 0;
+			}
+		}
+		const uint64 Coded = (uint64(1) << NumZeros) | ReadBits(Reader, NumZeros);
+		return static_cast<uint32>(Coded - 1);
+	}
+
+	void WriteSigned(FBitWriter& Writer, int32 Value)
+	{
+		WriteGamma(Writer, ZigZag(Value));
+	}
+
+	int32 ReadSigned(FBitReader& Reader)
+	{
+		return UnZigZag(ReadGamma(Reader));
+	}
+
+	/** Index of the previous frame's ball with Handle, trying the same slot first since the order rarely changes. */
+	int32 FindPreviousBall(const FBBCReplayQuantizedState& State, int32 Handle, int32 Slot)
+	{
+		if (State.Balls.IsValidIndex(Slot) && State.Balls[Slot].Handle == Handle)
+		{
+			return Slot;
+		}
+		return State.Balls.IndexOfByPredicate([Handle](const FBBCReplayQuantizedState::FBall& Ball)
+		{
+			return Ball.Handle == Handle;
+		});
+	}
+}
+
+/**
+ * @brief Quantizes a frame and writes it as a keyframe or as the difference to the previous one.
+ *
+ * @param Frame State to record.
+ * @param bKeyframe Whether the caller wants a keyframe.
+ * @param Writer Stream to append to.
+ *
+ * @note Velocities are the quantized displacement since the previous frame, so they stay exact on both sides.
+ * @note Bricks are diffed against the state and updated in it cell by cell; only the balls need the previous
+ * frame while the new one is built, so they alone go through the scratch array.
+ */
+void FBBCReplayEncoder::Encode(const FBBCReplayFrame& Frame, bool bKeyframe, FBitWriter& Writer)
+{
+	const TBitArray<>& AliveBits = Frame.GetAliveBits();
+	const int32 NumCells = Frame.Columns * Frame.Rows;
+	check(AliveBits.Num() == NumCells);
+	bKeyframe |= !bHasState || Frame.Columns != State.Columns || Frame.Rows != State.Rows;
+
+	const uint32 DeltaMs = static_cast<uint32>(FMath::Max(FMath::RoundToInt(Frame.DeltaSeconds * 1000.f), 0));
+	const int32 PaddleX = QuantizePosition(Frame.PaddleX);
+
+	if (bKeyframe)
+	{
+		WriteGamma(Writer, DeltaMs);
+		WriteSigned(Writer, Frame.Score);
+		WriteSigned(Writer, PaddleX);
+		WriteGamma(Writer, Frame.Columns);
+		WriteGamma(Writer, Frame.Rows);
+		for (int32 Cell = 0; Cell < NumCells; ++Cell)
+		{
+			Writer.WriteBit(AliveBits[Cell] ? 1 : 0);
+		}
+		State.AliveBits = AliveBits;
+	}
+	else
+	{
+		Writer.WriteBit(DeltaMs == State.DeltaMs ? 1 : 0);
+		if (DeltaMs != State.DeltaMs)
+		{
+			WriteGamma(Writer, DeltaMs);
+		}
+		Writer.WriteBit(Frame.Score != State.Score ? 1 : 0);
+		if (Frame.Score != State.Score)
+		{
+			WriteSigned(Writer, Frame.Score - State.Score);
+		}
+		Writer.WriteBit(PaddleX != State.PaddleX ? 1 : 0);
+		if (PaddleX != State.PaddleX)
+		{
+			WriteSigned(Writer, PaddleX - State.PaddleX);
+		}
+
+		// Changed cells as gaps between consecutive indices.
+		TArray<int32, TInlineAllocator<16>> Changed;
+		for (int32 Cell = 0; Cell < NumCells; ++Cell)
+		{
+			const bool bAlive = AliveBits[Cell];
+			if (bAlive != static_cast<bool>(State.AliveBits[Cell]))
+			{
+				Changed.Add(Cell);
+				State.AliveBits[Cell] = bAlive;
+			}
+		}
+		WriteGamma(Writer, Changed.Num());
+		int32 PreviousCell = -1;
+		for (const int32 Cell : Changed)
+		{
+			WriteGamma(Writer, Cell - PreviousCell - 1);
+			PreviousCell = Cell;
+		}
+	}
+	State.DeltaMs = DeltaMs;
+	State.Score = Frame.Score;
+	State.PaddleX = PaddleX;
+	State.Columns = Frame.Columns;
+	State.Rows = Frame.Rows;
+
+	NextBalls.SetNum(Frame.Balls.Num(), EAllowShrinking::No);
+	WriteGamma(Writer, Frame.Balls.Num());
+	for (int32 Index = 0; Index < Frame.Balls.Num(); ++Index)
+	{
+		const FBBCReplayBall& Ball = Frame.Balls[Index];
+		FBBCReplayQuantizedState::FBall& Quantized = NextBalls[Index];
+		Quantized = FBBCReplayQuantizedState::FBall();
+		Quantized.Handle = Ball.Handle;
+		Quantized.X = QuantizePosition(Ball.Position.X);
+		Quantized.Y = QuantizePosition(Ball.Position.Y);
+		Quantized.Angle = QuantizeAngle(Ball.Direction);
+
+		const int32 PreviousIndex = bKeyframe ? INDEX_NONE : FindPreviousBall(State, Ball.Handle, Index);
+		if (!bKeyframe)
+		{
+			const bool bSameHandle = State.Balls.IsValidIndex(Index) && State.Balls[Index].Handle == Ball.Handle;
+			Writer.WriteBit(bSameHandle ? 1 : 0);
+			if (!bSameHandle)
+			{
+				WriteGamma(Writer, static_cast<uint32>(Ball.Handle));
+			}
+		}
+		else
+		{
+			WriteGamma(Writer, static_cast<uint32>(Ball.Handle));
+		}
+
+		if (PreviousIndex != INDEX_NONE)
+		{
+			const FBBCReplayQuantizedState::FBall& Previous = State.Balls[PreviousIndex];
+			WriteSigned(Writer, Quantized.X - (Previous.X + Previous.VelocityX));
+			WriteSigned(Writer, Quantized.Y - (Previous.Y + Previous.VelocityY));
+			Writer.WriteBit(Quantized.Angle != Previous.Angle ? 1 : 0);
+			if (Quantized.Angle != Previous.Angle)
+			{
+				WriteBits(Writer, Quantized.Angle, 16);
+			}
+			Quantized.VelocityX = Quantized.X - Previous.X;
+			Quantized.VelocityY = Quantized.Y - Previous.Y;
+		}
+		else
+		{
+			// A keyframe carries velocities so the deltas after it predict from the first frame on.
+			const int32 StateIndex = bHasState ? FindPreviousBall(State, Ball.Handle, Index) : INDEX_NONE;
+			if (StateIndex != INDEX_NONE)
+			{
+				Quantized.VelocityX = Quantized.X - State.Balls[StateIndex].X;
+				Quantized.VelocityY = Quantized.Y - State.Balls[StateIndex].Y;
+			}
+			WriteSigned(Writer, Quantized.X);
+			WriteSigned(Writer, Quantized.Y);
+			if (bKeyframe)
+			{
+				WriteSigned(Writer, Quantized.VelocityX);
+				WriteSigned(Writer, Quantized.VelocityY);
+			}
+			WriteBits(Writer, Quantized.Angle, 16);
+		}
+	}
+
+	Swap(State.Balls, NextBalls);
+	bHasState = true;
+	bLastKeyframe = bKeyframe;
+}
+
+/**
+ * @brief Reads one frame and updates the decoder state to it.
+ *
+ * @param Reader Stream positioned at the frame.
+ * @param bKeyframe Whether the frame was written as a keyframe.
+ * @param OutFrame Decoded state. Its arrays are reused, so decoding into the same frame allocates nothing once
+ * the sizes settle.
+ *
+ * @return False if the frame is malformed or is a delta without a keyframe before it.
+ *
+ * @note Bricks are updated in the state as they are read, so a malformed frame drops the state and the next
+ * frame decoded has to be a keyframe.
+ */
+bool FBBCReplayDecoder::Decode(FBitReader& Reader, bool bKeyframe, FBBCReplayFrame& OutFrame)
+{
+	if (!bKeyframe && !bHasState)
+	{
+		return false;
+	}
+	bHasState = false;
+
+	uint32 DeltaMs = 0;
+	int32 Score = 0;
+	int32 PaddleX = 0;
+	if (bKeyframe)
+	{
+		DeltaMs = ReadGamma(Reader);
+		Score = ReadSigned(Reader);
+		PaddleX = ReadSigned(Reader);
+		const uint32 Columns = ReadGamma(Reader);
+		const uint32 Rows = ReadGamma(Reader);
+		if (Reader.IsError() || static_cast<uint64>(Columns) * Rows > MaxCells)
+		{
+			return false;
+		}
+		State.Columns = Columns;
+		State.Rows = Rows;
+		const int32 NumCells = State.Columns * State.Rows;
+		State.AliveBits.Init(false, NumCells);
+		for (int32 Cell = 0; Cell < NumCells; ++Cell)
+		{
+			State.AliveBits[Cell] = Reader.ReadBit() != 0;
+		}
+	}
+	else
+	{
+		DeltaMs = Reader.ReadBit() ? State.DeltaMs : ReadGamma(Reader);
+		Score = Reader.ReadBit() ? State.Score + ReadSigned(Reader) : State.Score;
+		PaddleX = Reader.ReadBit() ? State.PaddleX + ReadSigned(Reader) : State.PaddleX;
+
+		const int32 NumCells = State.Columns * State.Rows;
+		const uint32 NumChanged = ReadGamma(Reader);
+		if (NumChanged > static_cast<uint32>(NumCells))
+		{
+			return false;
+		}
+		int64 Cell = -1;
+		for (uint32 Change = 0; Change < NumChanged; ++Change)
+		{
+			Cell += static_cast<int64>(ReadGamma(Reader)) + 1;
+			if (Reader.IsError() || Cell >= NumCells)
+			{
+				return false;
+			}
+			const int32 CellIndex = static_cast<int32>(Cell);
+			State.AliveBits[CellIndex] = !State.AliveBits[CellIndex];
+		}
+	}
+
+	const uint32 NumBalls = ReadGamma(Reader);
+	if (Reader.IsError() || NumBalls > MaxBalls)
+	{
+		return false;
+	}
+	NextBalls.SetNum(NumBalls, EAllowShrinking::No);
+	for (int32 Index = 0; Index < static_cast<int32>(NumBalls); ++Index)
+	{
+		FBBCReplayQuantizedState::FBall& Quantized = NextBalls[Index];
+		Quantized = FBBCReplayQuantizedState::FBall();
+		if (!bKeyframe && Reader.ReadBit())
+		{
+			if (!State.Balls.IsValidIndex(Index))
+			{
+				return false;
+			}
+			Quantized.Handle = State.Balls[Index].Handle;
+		}
+		else
+		{
+			Quantized.Handle = static_cast<int32>(ReadGamma(Reader));
+		}
+
+		const int32 PreviousIndex = bKeyframe ? INDEX_NONE : FindPreviousBall(State, Quantized.Handle, Index);
+		if (PreviousIndex != INDEX_NONE)
+		{
+			const FBBCReplayQuantizedState::FBall& Previous = State.Balls[PreviousIndex];
+			Quantized.X = Previous.X + Previous.VelocityX + ReadSigned(Reader);
+			Quantized.Y = Previous.Y + Previous.VelocityY + ReadSigned(Reader);
+			Quantized.Angle = Reader.ReadBit() ? static_cast<uint16>(ReadBits(Reader, 16)) : Previous.Angle;
+			Quantized.VelocityX = Quantized.X - Previous.X;
+			Quantized.VelocityY = Quantized.Y - Previous.Y;
+		}
+		else
+		{
+			Quantized.X = ReadSigned(Reader);
+			Quantized.Y = ReadSigned(Reader);
+			if (bKeyframe)
+			{
+				Quantized.VelocityX = ReadSigned(Reader);
+				Quantized.VelocityY = ReadSigned(Reader);
+			}
+			Quantized.Angle = static_cast<uint16>(ReadBits(Reader, 16));
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	State.DeltaMs = DeltaMs;
+	State.Score = Score;
+	State.PaddleX = PaddleX;
+	Swap(State.Balls, NextBalls);
+	bHasState = true;
+
+	OutFrame.DeltaSeconds = State.DeltaMs / 1000.f;
+	OutFrame.Score = State.Score;
+	OutFrame.PaddleX = State.PaddleX / PositionScale;
+	OutFrame.Columns = State.Columns;
+	OutFrame.Rows = State.Rows;
+	OutFrame.AliveBits = State.AliveBits;
+	OutFrame.SourceAliveBits = nullptr;
+	OutFrame.Balls.SetNum(State.Balls.Num(), EAllowShrinking::No);
+	for (int32 Index = 0; Index < State.Balls.Num(); ++Index)
+	{
+		const FBBCReplayQuantizedState::FBall& Quantized = State.Balls[Index];
+		FBBCReplayBall& Ball = OutFrame.Balls[Index];
+		Ball.Handle = Quantized.Handle;
+		Ball.Position = FVector2D(Quantized.X, Quantized.Y) / PositionScale;
+		Ball.Direction = DequantizeAngle(Quantized.Angle);
+	}
+	return true;
+}
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/BBCReplayFile.h"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	void WriteVarInt(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add(static_cast<uint8>(Value));
+	}
+
+	bool ReadVarInt(const TArray<uint8>& In, int64& Offset, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 32; Shift += 7)
+		{
+			if (!In.IsValidIndex(Offset))
+			{
+				return false;
+			}
+			const uint8 Byte = In[Offset++];
+			OutValue |= static_cast<uint32>(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+FBBCReplayWriter::FBBCReplayWriter() :
+	Pipe(TEXT("BBCReplayWriter")),
+	Bits(1024 * 8, true)
+{
+}
+
+FBBCReplayWriter::~FBBCReplayWriter()
+{
+	Close();
+}
+
+/**
+ * @brief Creates the file and queues its header.
+ *
+ * @param Path File to write, replaced if it exists.
+ * @param InKeyframeInterval Frames from one keyframe to the next.
+ *
+ * @return False if the file could not be created.
+ */
+bool FBBCReplayWriter::Open(const FString& Path, int32 InKeyframeInterval)
+{
+	Close();
+	IFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path);
+	if (Handle == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open state replay %s"), *Path);
+		return false;
+	}
+	File = MakeShareable(Handle);
+	FilePath = Path;
+	bWriteFailed = false;
+	Encoder = FBBCReplayEncoder();
+	KeyframeInterval = FMath::Clamp(InKeyframeInterval, 1, static_cast<int32>(MAX_uint16));
+	NumFrames = 0;
+	NumKeyframes = 0;
+
+	FMemoryWriter Writer(Pending);
+	uint32 Magic = BBCReplayFile::FileMagic;
+	uint16 Version = BBCReplayFile::FileVersion;
+	uint16 Interval = static_cast<uint16>(KeyframeInterval);
+	Writer << Magic << Version << Interval;
+	NumBytes = Pending.Num();
+	return true;
+}
+
+/**
+ * @brief Encodes one frame and appends its record to the buffer.
+ *
+ * @param Frame State at the end of the frame.
+ *
+ * @note A keyframe hands the buffered interval to the background pipe before it is appended.
+ * @note Closes the writer instead once a background write has failed.
+ */
+void FBBCReplayWriter::WriteFrame(const FBBCReplayFrame& Frame)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+	if (bWriteFailed)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Stopped recording state replay %s after %lld frames"), *FilePath, NumFrames);
+		Close();
+		return;
+	}
+
+	Bits.Reset();
+	Encoder.Encode(Frame, NumFrames % KeyframeInterval == 0, Bits);
+	const bool bKeyframe = Encoder.WasKeyframe();
+	if (bKeyframe)
+	{
+		Flush();
+		++NumKeyframes;
+	}
+
+	const int32 Start = Pending.Num();
+	Pending.Add(static_cast<uint8>(bKeyframe ? BBCReplayFile::ERecord::Keyframe : BBCReplayFile::ERecord::Delta));
+	WriteVarInt(Pending, static_cast<uint32>(Bits.GetNumBytes()));
+	Pending.Append(Bits.GetData(), Bits.GetNumBytes());
+	NumBytes += Pending.Num() - Start;
+	++NumFrames;
+}
+
+void FBBCReplayWriter::Close()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+	Flush();
+	Pipe.WaitUntilEmpty();
+	File.Reset();
+}
+
+/**
+ * @brief Queues the buffered records on the background pipe.
+ *
+ * @note Once a write has failed nothing more is queued, so the file keeps only whole intervals written before
+ * the failure.
+ */
+void FBBCReplayWriter::Flush()
+{
+	if (Pending.Num() == 0 || bWriteFailed)
+	{
+		Pending.Reset();
+		return;
+	}
+	Pipe.Launch(UE_SOURCE_LOCATION, [this, File = File, Buffer = MoveTemp(Pending)]()
+	{
+		if (bWriteFailed)
+		{
+			return;
+		}
+		if (!File->Write(Buffer.GetData(), Buffer.Num()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write %d bytes to state replay %s"), Buffer.Num(), *FilePath);
+			bWriteFailed = true;
+		}
+	});
+	Pending.Reset();
+}
+
+/**
+ * @brief Reads a state replay and indexes its records.
+ *
+ * @param Path File written by FBBCReplayWriter.
+ *
+ * @return False if the file is missing or its header is invalid. A truncated last record is dropped.
+ */
+bool FBBCReplayReader::Load(const FString& Path)
+{
+	Records.Reset();
+	Keyframes.Reset();
+	CurrentFrame = INDEX_NONE;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read state replay %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	uint16 Interval = 0;
+	Reader << Magic << Version << Interval;
+	if (Reader.IsError() || Magic != BBCReplayFile::FileMagic || Version != BBCReplayFile::FileVersion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a valid state replay"), *Path);
+		return false;
+	}
+	KeyframeInterval = Interval;
+
+	int64 Offset = Reader.Tell();
+	while (Offset < Bytes.Num())
+	{
+		const uint8 Type = Bytes[Offset++];
+		uint32 Size = 0;
+		if (!ReadVarInt(Bytes, Offset, Size) || Offset + Size > Bytes.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("State replay %s is truncated after %d frames"), *Path, Records.Num());
+			break;
+		}
+		FRecord& Record = Records.AddDefaulted_GetRef();
+		Record.Offset = Offset;
+		Record.Size = Size;
+		Record.bKeyframe = Type == static_cast<uint8>(BBCReplayFile::ERecord::Keyframe);
+		if (Record.bKeyframe)
+		{
+			Keyframes.Add(Records.Num() - 1);
+		}
+		Offset += Size;
+	}
+
+	if (Keyframes.Num() == 0 || Keyframes[0] != 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("State replay %s does not start with a keyframe"), *Path);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Decodes any frame of the replay.
+ *
+ * @param Frame Frame to decode.
+ * @param OutFrame Decoded state.
+ *
+ * @note Decoding continues from the current frame when it lies between the closest keyframe and Frame, and
+ * restarts from that keyframe otherwise.
+ */
+bool FBBCReplayReader::Seek(int32 Frame, FBBCReplayFrame& OutFrame)
+{
+	if (!Records.IsValidIndex(Frame))
+	{
+		return false;
+	}
+
+	int32 Record = Keyframes[Algo::UpperBound(Keyframes, Frame) - 1];
+	if (CurrentFrame >= Record && CurrentFrame < Frame)
+	{
+		Record = CurrentFrame + 1;
+	}
+
+	for (; Record <= Frame; ++Record)
+	{
+		if (!DecodeRecord(Record, OutFrame))
+		{
+			UE_LOG(LogTemp, Error, TEXT("State replay frame %d is corrupt"), Record);
+			CurrentFrame = INDEX_NONE;
+			return false;
+		}
+		CurrentFrame = Record;
+	}
+	return true;
+}
+
+bool FBBCReplayReader::DecodeRecord(int32 Record, FBBCReplayFrame& OutFrame)
+{
+	const FRecord& Entry = Records[Record];
+	FBitReader Reader(Bytes.GetData() + Entry.Offset, static_cast<int64>(Entry.Size) * 8);
+	return Decoder.Decode(Reader, Entry.bKeyframe, OutFrame);
+}
@@ -0,0 +1,400 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/BBCStateReplaySubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Core/Ball/BBCBall.h"
+#include "Core/Ball/BBCBallSubsystem.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameState/BBCGameState.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Stats/BBCStats.h"
+
+namespace
+{
+	/** Shortest recorded frame the viewer waits for, so frames recorded with a zero delta still advance. */
+	constexpr double MinViewerFrameSeconds = 0.001;
+
+	UBBCStateReplaySubsystem* GetReplaySubsystem(UWorld* World)
+	{
+		return World != nullptr ? World->GetSubsystem<UBBCStateReplaySubsystem>() : nullptr;
+	}
+
+	FAutoConsoleCommandWithWorld ReplayStatsCommand(
+		TEXT("BBC.Replay.Stats"),
+		TEXT("Logs the size and capture cost of the state replay being recorded, or the position of the one being viewed."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UBBCStateReplaySubsystem* Replay = GetReplaySubsystem(World))
+			{
+				Replay->LogStats();
+			}
+		}));
+
+	/**
+	 * Jumps the state replay viewer to a frame.
+	 * Usage: BBC.Replay.Seek <Frame>
+	 */
+	FAutoConsoleCommandWithWorldAndArgs ReplaySeekCommand(
+		TEXT("BBC.Replay.Seek"),
+		TEXT("Shows a frame of the state replay being viewed. Usage: BBC.Replay.Seek <Frame>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCStateReplaySubsystem* Replay = GetReplaySubsystem(World);
+			if (Replay == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+			Replay->SeekViewer(FCString::Atoi(*Args[0]));
+		}));
+
+	FAutoConsoleCommandWithWorld ReplayPauseCommand(
+		TEXT("BBC.Replay.Pause"),
+		TEXT("Pauses or resumes the state replay being viewed."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UBBCStateReplaySubsystem* Replay = GetReplaySubsystem(World))
+			{
+				Replay->SetViewerPaused(!Replay->IsViewerPaused());
+			}
+		}));
+
+	/**
+	 * Sets the playback speed of the state replay viewer.
+	 * Usage: BBC.Replay.Speed <Multiplier>
+	 */
+	FAutoConsoleCommandWithWorldAndArgs ReplaySpeedCommand(
+		TEXT("BBC.Replay.Speed"),
+		TEXT("Sets the playback speed of the state replay being viewed. Usage: BBC.Replay.Speed <Multiplier>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UBBCStateReplaySubsystem* Replay = GetReplaySubsystem(World);
+			if (Replay == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+			Replay->SetViewerSpeed(FCString::Atof(*Args[0]));
+		}));
+}
+
+/**
+ * @brief Opens the recording or the replay named on the command line.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ *
+ * @note Viewing takes precedence: a session that views a replay records nothing. Viewing is a development
+ * tool and -BBCViewReplay is ignored in shipping builds; recording works in every build.
+ */
+void UBBCStateReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	BallSubsystem = Collection.InitializeDependency<UBBCBallSubsystem>();
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::GameState, EBBCTickOrder::AfterActors, FBBCTickUpdate::CreateUObject(this, &UBBCStateReplaySubsystem::CaptureFrame));
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+#if !UE_BUILD_SHIPPING
+	if (FParse::Value(CommandLine, TEXT("BBCViewReplay="), FilePath))
+	{
+		Reader = MakeUnique<FBBCReplayReader>();
+		if (!Reader->Load(FilePath))
+		{
+			Reader.Reset();
+			return;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Viewing %d frames of state replay %s"), Reader->GetNumFrames(), *FilePath);
+		return;
+	}
+#endif
+	if (FParse::Value(CommandLine, TEXT("BBCRecordState="), FilePath))
+	{
+		int32 KeyframeInterval = DefaultKeyframeInterval;
+		FParse::Value(CommandLine, TEXT("BBCReplayKeyframes="), KeyframeInterval);
+		Writer = MakeUnique<FBBCReplayWriter>();
+		if (!Writer->Open(FilePath, KeyframeInterval))
+		{
+			Writer.Reset();
+		}
+	}
+}
+
+/**
+ * @brief Finishes the recording and removes the viewer's ball view.
+ */
+void UBBCStateReplaySubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	if (IsRecording())
+	{
+		Writer->Close();
+		LogStats();
+	}
+	Writer.Reset();
+	Reader.Reset();
+
+	if (IsValid(ViewActor))
+	{
+		ViewActor->Destroy();
+	}
+	ViewActor = nullptr;
+	BallInstances = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UBBCStateReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Copies this frame's gameplay state into the reused frame and hands it to the writer.
+ *
+ * The brick field's bits are lent to the frame rather than copied, since the writer encodes it before returning.
+ *
+ * @param DeltaTime Frame delta, stored so the viewer plays at the recorded pace.
+ */
+void UBBCStateReplaySubsystem::CaptureFrame(float DeltaTime)
+{
+	if (!IsRecording() || BallSubsystem == nullptr)
+	{
+		return;
+	}
+	BBC_SCOPE_CYCLE_COUNTER(STAT_BBC_ReplayCapture);
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	Frame.DeltaSeconds = DeltaTime;
+	const int32 NumBalls = BallSubsystem->GetNumBalls();
+	Frame.Balls.SetNum(NumBalls, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumBalls; ++Index)
+	{
+		FBBCReplayBall& Ball = Frame.Balls[Index];
+		FBBCBallState State;
+		Ball.Handle = BallSubsystem->GetBallHandle(Index);
+		BallSubsystem->GetBallState(Ball.Handle, State);
+		Ball.Position = State.Position;
+		Ball.Direction = State.Direction;
+	}
+
+	const ABBCPaddle* Paddle = BallSubsystem->GetPaddle();
+	Frame.PaddleX = Paddle != nullptr ? Paddle->GetActorLocation().X : 0.0;
+
+	if (const UBBCBrickFieldComponent* BrickField = BallSubsystem->GetBrickField())
+	{
+		Frame.Columns = BrickField->GetColumns();
+		Frame.Rows = BrickField->GetRows();
+		Frame.SourceAliveBits = &BrickField->GetAliveBits();
+	}
+	else
+	{
+		Frame.Columns = 0;
+		Frame.Rows = 0;
+		Frame.AliveBits.Reset();
+		Frame.SourceAliveBits = nullptr;
+	}
+
+	const ABBCGameState* GameState = GetWorld()->GetGameState<ABBCGameState>();
+	Frame.Score = GameState != nullptr ? GameState->GetScore() : 0;
+
+	Writer->WriteFrame(Frame);
+	Frame.SourceAliveBits = nullptr;
+	RecordedSeconds += DeltaTime;
+	CaptureSeconds += FPlatformTime::Seconds() - StartSeconds;
+}
+
+/**
+ * @brief Steps through the recorded frames whose time has come and shows the last one.
+ *
+ * @param DeltaTime Real time elapsed since the last frame.
+ *
+ * @note Called by the tick manager in place of the gameplay phases. The first call shows frame 0.
+ */
+void UBBCStateReplaySubsystem::AdvanceViewer(float DeltaTime)
+{
+	if (!IsViewing())
+	{
+		return;
+	}
+	if (ViewerFrame == INDEX_NONE)
+	{
+		SeekViewer(0);
+		return;
+	}
+	if (bViewerPaused)
+	{
+		return;
+	}
+
+	ViewerSeconds += DeltaTime * ViewerSpeed;
+	bool bAdvanced = false;
+	while (ViewerFrame + 1 < Reader->GetNumFrames())
+	{
+		const double FrameSeconds = FMath::Max(static_cast<double>(Frame.DeltaSeconds), MinViewerFrameSeconds);
+		if (ViewerSeconds < FrameSeconds)
+		{
+			break;
+		}
+		if (!Reader->Seek(ViewerFrame + 1, Frame))
+		{
+			bViewerPaused = true;
+			return;
+		}
+		ViewerSeconds -= FrameSeconds;
+		++ViewerFrame;
+		bAdvanced = true;
+	}
+
+	if (ViewerFrame + 1 >= Reader->GetNumFrames())
+	{
+		bViewerPaused = true;
+		UE_LOG(LogTemp, Display, TEXT("State replay finished after %d frames"), Reader->GetNumFrames());
+	}
+	if (bAdvanced)
+	{
+		ShowFrame();
+	}
+}
+
+/**
+ * @brief Shows any frame of the replay being viewed.
+ *
+ * @param InFrame Frame to show, clamped to the recording.
+ *
+ * @note Decodes from the closest keyframe, so a seek costs at most one keyframe interval of frames.
+ */
+void UBBCStateReplaySubsystem::SeekViewer(int32 InFrame)
+{
+	if (!IsViewing())
+	{
+		return;
+	}
+	const int32 Target = FMath::Clamp(InFrame, 0, Reader->GetNumFrames() - 1);
+	if (!Reader->Seek(Target, Frame))
+	{
+		return;
+	}
+	ViewerFrame = Target;
+	ViewerSeconds = 0.0;
+	ShowFrame();
+}
+
+void UBBCStateReplaySubsystem::LogStats() const
+{
+	if (Writer.IsValid())
+	{
+		const int64 NumFrames = Writer->GetNumFrames();
+		UE_LOG(LogTemp, Display, TEXT("State replay %s: %lld frames (%lld keyframes), %lld bytes, %.0f bytes/s, capture %.3f us/frame"),
+			*FilePath, NumFrames, Writer->GetNumKeyframes(), Writer->GetNumBytes(),
+			RecordedSeconds > 0.0 ? Writer->GetNumBytes() / RecordedSeconds : 0.0,
+			NumFrames > 0 ? CaptureSeconds / NumFrames * 1.0e6 : 0.0);
+	}
+	if (Reader.IsValid())
+	{
+		UE_LOG(LogTemp, Display, TEXT("State replay %s: frame %d of %d, keyframe every %d frames, speed %.2f%s"),
+			*FilePath, ViewerFrame, Reader->GetNumFrames(), Reader->GetKeyframeInterval(), ViewerSpeed, bViewerPaused ? TEXT(" (paused)") : TEXT(""));
+	}
+}
+
+/**
+ * @brief Moves the paddle, the brick field and the ball view to the current frame.
+ *
+ * The wall is only shown when the recorded one has the size of the loaded field, since bricks are drawn with
+ * the field's own brick size. Ball actors are hidden; every ball is drawn by the instanced view at the size of
+ * an unscaled ball actor.
+ */
+void UBBCStateReplaySubsystem::ShowFrame()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || BallSubsystem == nullptr)
+	{
+		return;
+	}
+
+	if (ABBCPaddle* Paddle = BallSubsystem->GetPaddle())
+	{
+		FVector Location = Paddle->GetActorLocation();
+		Location.X = Frame.PaddleX;
+		Paddle->SetActorLocation(Location);
+	}
+
+	UBBCBrickFieldComponent* BrickField = BallSubsystem->GetBrickField();
+	if (BrickField != nullptr && BrickField->GetColumns() == Frame.Columns && BrickField->GetRows() == Frame.Rows)
+	{
+		BrickField->ShowCells(Frame.AliveBits);
+	}
+
+	for (TActorIterator<ABBCBall> It(World); It; ++It)
+	{
+		It->SetActorHiddenInGame(true);
+	}
+	if (BallInstances == nullptr)
+	{
+		CreateView();
+	}
+	if (BallInstances != nullptr)
+	{
+		TArray<FTransform> Transforms;
+		Transforms.Reserve(Frame.Balls.Num());
+		for (const FBBCReplayBall& Ball : Frame.Balls)
+		{
+			Transforms.Add(FTransform(FVector(Ball.Position, 0.0)));
+		}
+		if (BallInstances->GetInstanceCount() != Transforms.Num())
+		{
+			BallInstances->ClearInstances();
+			BallInstances->AddInstances(Transforms, false, true);
+		}
+		else
+		{
+			BallInstances->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+		}
+	}
+
+	if (GEngine != nullptr)
+	{
+		GEngine->AddOnScreenDebugMessage(static_cast<uint64>(GetUniqueID()), 1.f, FColor::White,
+			FString::Printf(TEXT("Replay frame %d / %d  score %d%s"), ViewerFrame, Reader->GetNumFrames(), Frame.Score, bViewerPaused ? TEXT("  (paused)") : TEXT("")));
+	}
+}
+
+void UBBCStateReplaySubsystem::CreateView()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("StateReplayView");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ViewActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(ViewActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn state replay view actor. "));
+		return;
+	}
+
+	BallInstances = NewObject<UInstancedStaticMeshComponent>(ViewActor, TEXT("StateReplayBalls"));
+	BallInstances->SetMobility(EComponentMobility::Movable);
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	BallInstances->SetStaticMesh(Assets != nullptr ? Assets->GetBallMesh() : nullptr);
+	BallInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BallInstances->SetCastShadow(false);
+	ViewActor->SetRootComponent(BallInstances);
+	BallInstances->RegisterComponent();
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Stats/BBCStats.h"
+
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_BBC_BallMovement);
+DEFINE_STAT(STAT_BBC_PaddleMovement);
+DEFINE_STAT(STAT_BBC_CollisionResponse);
+DEFINE_STAT(STAT_BBC_BrickUpdate);
+DEFINE_STAT(STAT_BBC_RenderSync);
+DEFINE_STAT(STAT_BBC_GameState);
+DEFINE_STAT(STAT_BBC_TrajectoryQuery);
+DEFINE_STAT(STAT_BBC_ReplayCapture);
+DEFINE_STAT(STAT_BBC_EndlessScroll);
+DEFINE_STAT(STAT_BBC_EffectsFlush);
+DEFINE_STAT(STAT_BBC_PowerUps);
+
+DEFINE_STAT(STAT_BBC_ActiveBalls);
+DEFINE_STAT(STAT_BBC_LiveBricks);
+DEFINE_STAT(STAT_BBC_Collisions);
+DEFINE_STAT(STAT_BBC_EffectsRequested);
+DEFINE_STAT(STAT_BBC_EffectsSpawned);
+DEFINE_STAT(STAT_BBC_EffectsCulled);
+DEFINE_STAT(STAT_BBC_PoolHits);
+DEFINE_STAT(STAT_BBC_PoolMisses);
+DEFINE_STAT(STAT_BBC_EndlessChunksRecycled);
+DEFINE_STAT(STAT_BBC_PowerUpsActive);
+DEFINE_STAT(STAT_BBC_PowerUpPickups);
+DEFINE_STAT(STAT_BBC_AssetLoadMs);
+DEFINE_STAT(STAT_BBC_AssetLoadStalls);
+
+UE_TRACE_CHANNEL_DEFINE(BBCChannel);
+
+bool GBBCStatsEnabled = false;
+
+namespace
+{
+	/** True while the BBC trace channel is on because BBC.Stats.Enable turned it on. */
+	bool bChannelEnabledByStats = false;
+
+	/**
+	 * @brief Turns the BBC trace channel on when BBC.Stats.Enable is set from the console or code, so the
+	 * Insights scopes of a running trace start too.
+	 *
+	 * Values from ini files or device profiles leave the channel alone, and turning the variable off only turns
+	 * the channel off if this turned it on, so the state set by -trace on the command line is kept.
+	 */
+	void OnStatsEnabledChanged(IConsoleVariable* Variable)
+	{
+		const uint32 SetBy = Variable->GetFlags() & ECVF_SetByMask;
+		if (SetBy != ECVF_SetByConsole && SetBy != ECVF_SetByCode)
+		{
+			return;
+		}
+		if (Variable->GetBool() && !BBCChannel.IsEnabled())
+		{
+			BBCChannel.Toggle(true);
+			bChannelEnabledByStats = true;
+		}
+		else if (!Variable->GetBool() && bChannelEnabledByStats)
+		{
+			BBCChannel.Toggle(false);
+			bChannelEnabledByStats = false;
+		}
+	}
+
+	FAutoConsoleVariableRef CVarBBCStatsEnable(
+		TEXT("BBC.Stats.Enable"),
+		GBBCStatsEnabled,
+		TEXT("Enables the BBC stat group counters and the BBC trace channel scopes."),
+		FConsoleVariableDelegate::CreateStatic(&OnStatsEnabledChanged));
+}
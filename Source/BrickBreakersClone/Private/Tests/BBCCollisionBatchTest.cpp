@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Collision/BBCCollisionBatch.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCCollisionBatchKernelTest, "BrickBreakersClone.Collision.BatchKernelMatchesScalar",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Fails if the vector brick kernel disagrees with the scalar reference on any of a fixed set of sweeps.
+ */
+bool FBBCCollisionBatchKernelTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Iterations = 20000;
+	for (const int32 Seed : {0, 1, 1234})
+	{
+		int32 Hits = 0;
+		const int32 Mismatches = BBCCollision::VerifyBoxBatchKernel(Iterations, Seed, Hits);
+		TestEqual(FString::Printf(TEXT("Kernel mismatches with seed %d"), Seed), Mismatches, 0);
+		TestTrue(FString::Printf(TEXT("Sweeps with seed %d hit some boxes"), Seed), Hits > 0);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Headless/BBCHeadlessSubsystem.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FBBCPerfScenarioTest, "BrickBreakersClone.Perf.Scenario",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * @brief Lists one test per entry of the headless harness's Scenarios config array.
+ */
+void FBBCPerfScenarioTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const FBBCPerfScenario& Scenario : GetDefault<UBBCHeadlessSubsystem>()->GetScenarios())
+	{
+		OutBeautifiedNames.Add(Scenario.Name);
+		OutTestCommands.Add(Scenario.Name);
+	}
+}
+
+/**
+ * @brief Runs a scenario in a headless child process and fails if it missed a budget or baseline.
+ *
+ * The scenario needs a world of its own with a fixed frame delta, which the running process cannot provide,
+ * so it is started the same way a CI job would start it and judged by its exit code and report.
+ *
+ * @param Parameters Name of the scenario.
+ */
+bool FBBCPerfScenarioTest::RunTest(const FString& Parameters)
+{
+	const FString ReportPath = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / FString::Printf(TEXT("BBCScenario_%s.json"), *Parameters));
+	IFileManager::Get().Delete(*ReportPath);
+
+	FString Arguments;
+#if WITH_EDITOR
+	Arguments = FString::Printf(TEXT("\"%s\" -game "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+#endif
+	Arguments += FString::Printf(TEXT("-nullrhi -nosound -unattended -nosplash -BBCSimScenario=%s -BBCSimReport=\"%s\""), *Parameters, *ReportPath);
+
+	FProcHandle Process = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Arguments, true, true, true, nullptr, 0, nullptr, nullptr);
+	if (!Process.IsValid())
+	{
+		AddError(FString::Printf(TEXT("Failed to start scenario %s"), *Parameters));
+		return false;
+	}
+	FPlatformProcess::WaitForProc(Process);
+	int32 ReturnCode = -1;
+	FPlatformProcess::GetProcReturnCode(Process, &ReturnCode);
+	FPlatformProcess::CloseProc(Process);
+	TestEqual(FString::Printf(TEXT("Scenario %s exit code"), *Parameters), ReturnCode, 0);
+
+	FString Json;
+	TSharedPtr<FJsonObject> Report;
+	if (!FFileHelper::LoadFileToString(Json, *ReportPath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Report) || !Report.IsValid())
+	{
+		AddError(FString::Printf(TEXT("Scenario %s wrote no report to %s"), *Parameters, *ReportPath));
+		return false;
+	}
+	const TSharedPtr<FJsonObject>* Result = nullptr;
+	bool bPassed = false;
+	TestTrue(FString::Printf(TEXT("Scenario %s passed"), *Parameters),
+		Report->TryGetObjectField(TEXT("scenario"), Result) && (*Result)->TryGetBoolField(TEXT("passed"), bPassed) && bPassed);
+	return true;
+}
+
+#endif
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/BBCReplayCodec.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "Replay/BBCReplayFile.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Half a quantization step of positions, plus rounding. */
+	constexpr double PositionTolerance = 1.0 / 32.0 + UE_KINDA_SMALL_NUMBER;
+	/** Two 16 bit angle steps. */
+	constexpr double DirectionTolerance = 2.0 * UE_TWO_PI / 65536.0;
+
+	/**
+	 * @brief Builds a run of frames with moving, bouncing, appearing and vanishing balls and a wall that loses
+	 * and regains bricks, and changes size once.
+	 */
+	void MakeFrames(int32 Seed, int32 NumFrames, TArray<FBBCReplayFrame>& OutFrames)
+	{
+		FRandomStream Stream(Seed);
+		FBBCReplayFrame Frame;
+		Frame.Columns = 12;
+		Frame.Rows = 6;
+		Frame.AliveBits.Init(true, Frame.Columns * Frame.Rows);
+		TArray<FVector2D> Velocities;
+		int32 NextHandle = 0;
+		for (; NextHandle < 3; ++NextHandle)
+		{
+			Frame.Balls.Add(FBBCReplayBall{NextHandle, FVector2D(Stream.FRandRange(-400.0, 400.0), Stream.FRandRange(-400.0, 400.0)), FVector2D(1.0, 0.0)});
+			Velocities.Add(FVector2D(Stream.FRandRange(-300.0, 300.0), Stream.FRandRange(-300.0, 300.0)));
+		}
+
+		OutFrames.Reset(NumFrames);
+		for (int32 Index = 0; Index < NumFrames; ++Index)
+		{
+			Frame.DeltaSeconds = Stream.FRand() < 0.9f ? 1.f / 60.f : Stream.FRandRange(0.005f, 0.05f);
+			Frame.PaddleX += Stream.FRandRange(-6.0, 6.0);
+			Frame.Score += Stream.FRand() < 0.1f ? Stream.RandRange(1, 50) : 0;
+
+			if (Index == NumFrames / 2 + 1)
+			{
+				Frame.Columns = 16;
+				Frame.Rows = 4;
+				Frame.AliveBits.Init(true, Frame.Columns * Frame.Rows);
+			}
+			const int32 NumCells = Frame.AliveBits.Num();
+			for (int32 Change = Stream.RandRange(0, 2); Change > 0; --Change)
+			{
+				const int32 Cell = Stream.RandRange(0, NumCells - 1);
+				Frame.AliveBits[Cell] = !Frame.AliveBits[Cell];
+			}
+
+			if (Stream.FRand() < 0.03f)
+			{
+				Frame.Balls.Add(FBBCReplayBall{NextHandle++, FVector2D(Stream.FRandRange(-400.0, 400.0), 370.0), FVector2D(0.0, -1.0)});
+				Velocities.Add(FVector2D(Stream.FRandRange(-300.0, 300.0), -300.0));
+			}
+			if (Frame.Balls.Num() > 1 && Stream.FRand() < 0.03f)
+			{
+				const int32 Removed = Stream.RandRange(0, Frame.Balls.Num() - 1);
+				Frame.Balls.RemoveAt(Removed);
+				Velocities.RemoveAt(Removed);
+			}
+			for (int32 Ball = 0; Ball < Frame.Balls.Num(); ++Ball)
+			{
+				if (Stream.FRand() < 0.05f)
+				{
+					Velocities[Ball] = Velocities[Ball].GetRotated(Stream.FRandRange(-180.0, 180.0));
+				}
+				Frame.Balls[Ball].Position += Velocities[Ball] * Frame.DeltaSeconds;
+				Frame.Balls[Ball].Direction = Velocities[Ball].GetSafeNormal();
+			}
+			OutFrames.Add(Frame);
+		}
+	}
+
+	void TestFramesMatch(FAutomationTestBase& Test, const FString& What, const FBBCReplayFrame& Expected, const FBBCReplayFrame& Actual)
+	{
+		Test.TestEqual(What + TEXT(" delta"), Actual.DeltaSeconds, FMath::RoundToFloat(Expected.DeltaSeconds * 1000.f) / 1000.f, 1.e-6f);
+		Test.TestEqual(What + TEXT(" score"), Actual.Score, Expected.Score);
+		Test.TestEqual(What + TEXT(" paddle"), Actual.PaddleX, Expected.PaddleX, PositionTolerance);
+		Test.TestEqual(What + TEXT(" columns"), Actual.Columns, Expected.Columns);
+		Test.TestEqual(What + TEXT(" rows"), Actual.Rows, Expected.Rows);
+		Test.TestTrue(What + TEXT(" bricks"), Actual.AliveBits == Expected.GetAliveBits());
+		if (!Test.TestEqual(What + TEXT(" balls"), Actual.Balls.Num(), Expected.Balls.Num()))
+		{
+			return;
+		}
+		for (int32 Index = 0; Index < Expected.Balls.Num(); ++Index)
+		{
+			const FBBCReplayBall& ExpectedBall = Expected.Balls[Index];
+			const FBBCReplayBall& ActualBall = Actual.Balls[Index];
+			Test.TestEqual(What + TEXT(" ball handle"), ActualBall.Handle, ExpectedBall.Handle);
+			Test.TestEqual(What + TEXT(" ball X"), ActualBall.Position.X, ExpectedBall.Position.X, PositionTolerance);
+			Test.TestEqual(What + TEXT(" ball Y"), ActualBall.Position.Y, ExpectedBall.Position.Y, PositionTolerance);
+			Test.TestTrue(What + TEXT(" ball direction"), FMath::Acos(FMath::Clamp(ActualBall.Direction | ExpectedBall.Direction, -1.0, 1.0)) <= DirectionTolerance);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCReplayCodecRoundTripTest, "BrickBreakersClone.Replay.CodecRoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Encodes random frames, a keyframe every 30 and one forced by the wall changing size, and checks every
+ * decoded frame against its source to within quantization.
+ *
+ * Half the frames lend their bricks through SourceAliveBits, the way a capture does.
+ */
+bool FBBCReplayCodecRoundTripTest::RunTest(const FString& Parameters)
+{
+	TArray<FBBCReplayFrame> Frames;
+	MakeFrames(11, 600, Frames);
+
+	FBBCReplayEncoder Encoder;
+	FBBCReplayDecoder Decoder;
+	FBitWriter Bits(1024 * 8, true);
+	FBBCReplayFrame Decoded;
+	TBitArray<> LentBits;
+	int32 NumKeyframes = 0;
+	for (int32 Index = 0; Index < Frames.Num(); ++Index)
+	{
+		FBBCReplayFrame& Frame = Frames[Index];
+		if (Index % 2 == 1)
+		{
+			LentBits = Frame.AliveBits;
+			Frame.AliveBits.Reset();
+			Frame.SourceAliveBits = &LentBits;
+		}
+
+		Bits.Reset();
+		Encoder.Encode(Frame, Index % 30 == 0, Bits);
+		NumKeyframes += Encoder.WasKeyframe() ? 1 : 0;
+		if (Index == Frames.Num() / 2 + 1)
+		{
+			TestTrue(TEXT("Frame with a resized wall is a keyframe"), Encoder.WasKeyframe());
+		}
+
+		FBitReader Reader(Bits.GetData(), Bits.GetNumBits());
+		if (!TestTrue(FString::Printf(TEXT("Frame %d decodes"), Index), Decoder.Decode(Reader, Encoder.WasKeyframe(), Decoded)))
+		{
+			return false;
+		}
+		TestFramesMatch(*this, FString::Printf(TEXT("Frame %d"), Index), Frame, Decoded);
+
+		if (Frame.SourceAliveBits != nullptr)
+		{
+			Frame.AliveBits = LentBits;
+			Frame.SourceAliveBits = nullptr;
+		}
+	}
+	TestEqual(TEXT("Keyframes"), NumKeyframes, Frames.Num() / 30 + 1);
+
+	FBBCReplayDecoder FreshDecoder;
+	FBitReader Delta(Bits.GetData(), Bits.GetNumBits());
+	TestFalse(TEXT("A delta frame without a keyframe is rejected"), FreshDecoder.Decode(Delta, false, Decoded));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCReplayFileSeekTest, "BrickBreakersClone.Replay.FileSeek",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Writes a replay file, then seeks it backwards, forwards, across keyframes and onto the same frame,
+ * checking each decoded frame against the one recorded.
+ */
+bool FBBCReplayFileSeekTest::RunTest(const FString& Parameters)
+{
+	TArray<FBBCReplayFrame> Frames;
+	MakeFrames(5, 250, Frames);
+
+	const FString Path = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("BBCReplaySeek.bbcstate"));
+	{
+		FBBCReplayWriter Writer;
+		if (!TestTrue(TEXT("Replay opens for writing"), Writer.Open(Path, 20)))
+		{
+			return false;
+		}
+		for (const FBBCReplayFrame& Frame : Frames)
+		{
+			Writer.WriteFrame(Frame);
+		}
+		Writer.Close();
+		TestFalse(TEXT("Replay written without errors"), Writer.HasFailed());
+	}
+
+	FBBCReplayReader Reader;
+	if (!TestTrue(TEXT("Replay loads"), Reader.Load(Path)) || !TestEqual(TEXT("Frames in the replay"), Reader.GetNumFrames(), Frames.Num()))
+	{
+		return false;
+	}
+
+	FBBCReplayFrame Decoded;
+	FRandomStream Stream(3);
+	TArray<int32> Targets = {0, 1, 2, 19, 20, 21, 249, 125, 124, 124, 60, 59, 200, 201, 0};
+	for (int32 Extra = 0; Extra < 40; ++Extra)
+	{
+		Targets.Add(Stream.RandRange(0, Frames.Num() - 1));
+	}
+	for (const int32 Target : Targets)
+	{
+		if (!TestTrue(FString::Printf(TEXT("Seek to %d"), Target), Reader.Seek(Target, Decoded)))
+		{
+			return false;
+		}
+		TestEqual(TEXT("Current frame after seek"), Reader.GetCurrentFrame(), Target);
+		TestFramesMatch(*this, FString::Printf(TEXT("Seek to %d"), Target), Frames[Target], Decoded);
+	}
+	TestFalse(TEXT("Seek past the end fails"), Reader.Seek(Frames.Num(), Decoded));
+
+	IFileManager::Get().Delete(*Path);
+	return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/Collision/BBCSpatialHash.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCSpatialHashTest, "BrickBreakersClone.Collision.SpatialHashMatchesBruteForce",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Inserts, moves and removes boxes of mixed sizes at random and checks every query and the occupied
+ * cell count against a brute force pass over the live boxes.
+ */
+bool FBBCSpatialHashTest::RunTest(const FString& Parameters)
+{
+	constexpr double CellSize = 32.0;
+	constexpr double FieldSize = 512.0;
+	FBBCSpatialHash Hash(CellSize);
+	FRandomStream Stream(17);
+
+	const auto RandomBox = [&Stream]()
+	{
+		const FVector2D Min(Stream.FRandRange(-FieldSize, FieldSize), Stream.FRandRange(-FieldSize, FieldSize));
+		return FBox2D(Min, Min + FVector2D(Stream.FRandRange(1.0, 100.0), Stream.FRandRange(1.0, 100.0)));
+	};
+
+	TMap<int32, FBox2D> Live;
+	TArray<int32> Found;
+	int32 Mismatches = 0;
+	for (int32 Iteration = 0; Iteration < 2000; ++Iteration)
+	{
+		const float Action = Stream.FRand();
+		TArray<int32> Handles;
+		Live.GenerateKeyArray(Handles);
+		if (Action < 0.3f || Handles.Num() == 0)
+		{
+			const FBox2D Box = RandomBox();
+			Live.Add(Hash.Insert(Box, Iteration), Box);
+		}
+		else if (Action < 0.9f)
+		{
+			// Mostly small steps, like the paddle, and sometimes a jump to anywhere.
+			const int32 Handle = Handles[Stream.RandRange(0, Handles.Num() - 1)];
+			FBox2D& Box = Live[Handle];
+			Box = Stream.FRand() < 0.8f ? Box.ShiftBy(FVector2D(Stream.FRandRange(-20.0, 20.0), Stream.FRandRange(-20.0, 20.0))) : RandomBox();
+			Hash.Move(Handle, Box);
+		}
+		else
+		{
+			const int32 Handle = Handles[Stream.RandRange(0, Handles.Num() - 1)];
+			Hash.Remove(Handle);
+			Live.Remove(Handle);
+		}
+
+		const FBox2D Query = RandomBox();
+		Found.Reset();
+		Hash.Query(Query, Found);
+		TArray<int32> Expected;
+		TSet<FIntPoint> Cells;
+		for (const TPair<int32, FBox2D>& Pair : Live)
+		{
+			if (Pair.Value.Intersect(Query))
+			{
+				Expected.Add(Pair.Key);
+			}
+			for (int32 Y = FMath::FloorToInt32(Pair.Value.Min.Y / CellSize); Y <= FMath::FloorToInt32(Pair.Value.Max.Y / CellSize); ++Y)
+			{
+				for (int32 X = FMath::FloorToInt32(Pair.Value.Min.X / CellSize); X <= FMath::FloorToInt32(Pair.Value.Max.X / CellSize); ++X)
+				{
+					Cells.Add(FIntPoint(X, Y));
+				}
+			}
+		}
+		Found.Sort();
+		Expected.Sort();
+		if (Found != Expected || Hash.GetNumOccupiedCells() != Cells.Num() || Hash.Num() != Live.Num())
+		{
+			++Mismatches;
+		}
+	}
+	TestEqual(TEXT("Iterations where the hash disagreed with brute force"), Mismatches, 0);
+	return true;
+}
+
+#endif
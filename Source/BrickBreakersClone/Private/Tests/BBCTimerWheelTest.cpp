@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PowerUps/BBCTimerWheel.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCTimerWheelTest, "BrickBreakersClone.PowerUps.TimerWheel",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Checks expiry ticks of timers that wrap the wheel's slots and rounds, cancellation, timers re-armed
+ * from their own callback, expiry order across a long advance and the capacity limit.
+ */
+bool FBBCTimerWheelTest::RunTest(const FString& Parameters)
+{
+	constexpr double Tick = 0.125;
+	constexpr int32 NumSlots = 8;
+	FBBCTimerWheel Wheel;
+	Wheel.Init(NumSlots, Tick, 8);
+
+	enum EPayload : uint32 { Short, WrapsOnce, WrapsRounds, FullTurn, Cancelled, Rearmed, MinimumDelay, NumPayloads };
+	const int32 ExpectedTicks[NumPayloads] = {4, 11, 35, 8, INDEX_NONE, 2, 1};
+	TArray<int32> FiredTicks[NumPayloads];
+
+	Wheel.Schedule(4 * Tick, Short);
+	Wheel.Schedule(11 * Tick, WrapsOnce);
+	const int32 WrapsRoundsId = Wheel.Schedule(35 * Tick, WrapsRounds);
+	Wheel.Schedule(NumSlots * Tick, FullTurn);
+	const int32 CancelledId = Wheel.Schedule(3 * Tick, Cancelled);
+	Wheel.Schedule(2 * Tick, Rearmed);
+	Wheel.Schedule(0.0, MinimumDelay);
+	TestEqual(TEXT("Active timers"), Wheel.Num(), 7);
+
+	Wheel.Cancel(CancelledId);
+	TestFalse(TEXT("Cancelled timer is inactive"), Wheel.IsActive(CancelledId));
+	TestEqual(TEXT("Cancelled timer has no time left"), Wheel.GetRemainingSeconds(CancelledId), 0.0);
+	Wheel.Cancel(CancelledId);
+	TestEqual(TEXT("Cancelling twice frees the timer once"), Wheel.Num(), 6);
+
+	// The re-armed timer comes back a whole turn later, into the slot being walked.
+	constexpr int32 NumRearms = 3;
+	int32 CurrentTick = 0;
+	while (CurrentTick < 40)
+	{
+		++CurrentTick;
+		Wheel.Advance(Tick, [&](uint32 Payload)
+		{
+			FiredTicks[Payload].Add(CurrentTick);
+			if (Payload == Rearmed && FiredTicks[Rearmed].Num() <= NumRearms)
+			{
+				TestTrue(TEXT("Re-armed from its callback"), Wheel.Schedule(NumSlots * Tick, Rearmed) != INDEX_NONE);
+			}
+		});
+		if (CurrentTick == 3)
+		{
+			TestEqual(TEXT("Remaining time of a timer several turns away"), Wheel.GetRemainingSeconds(WrapsRoundsId), 32 * Tick);
+		}
+	}
+
+	for (uint32 Payload = 0; Payload < NumPayloads; ++Payload)
+	{
+		if (Payload == Rearmed)
+		{
+			continue;
+		}
+		if (ExpectedTicks[Payload] == INDEX_NONE)
+		{
+			TestEqual(FString::Printf(TEXT("Timer %u never fires"), Payload), FiredTicks[Payload].Num(), 0);
+		}
+		else if (TestEqual(FString::Printf(TEXT("Timer %u fires once"), Payload), FiredTicks[Payload].Num(), 1))
+		{
+			TestEqual(FString::Printf(TEXT("Timer %u expiry tick"), Payload), FiredTicks[Payload][0], ExpectedTicks[Payload]);
+		}
+	}
+	const TArray<int32> ExpectedRearmTicks = {2, 2 + NumSlots, 2 + 2 * NumSlots, 2 + 3 * NumSlots};
+	TestEqual(TEXT("Re-armed timer expiry ticks"), FiredTicks[Rearmed], ExpectedRearmTicks);
+	TestEqual(TEXT("No timer left"), Wheel.Num(), 0);
+
+	// One long advance still expires timers in tick order, across turns.
+	Wheel.Reset();
+	TArray<uint32> Order;
+	Wheel.Schedule(20 * Tick, 20);
+	Wheel.Schedule(3 * Tick, 3);
+	Wheel.Schedule(11 * Tick, 11);
+	Wheel.Schedule(5 * Tick, 5);
+	Wheel.Advance(24 * Tick, [&Order](uint32 Payload) { Order.Add(Payload); });
+	TestEqual(TEXT("Expiry order of one long advance"), Order, TArray<uint32>{3, 5, 11, 20});
+
+	for (int32 Index = 0; Index < Wheel.GetCapacity(); ++Index)
+	{
+		Wheel.Schedule(Tick, Index);
+	}
+	TestEqual(TEXT("Scheduling past capacity fails"), Wheel.Schedule(Tick, 0), static_cast<int32>(INDEX_NONE));
+	return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Versus/BBCRollbackSession.h"
+
+#include "Misc/AutomationTest.h"
+#include "Versus/BBCVersusTransport.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBBCVersusRollbackTest, "BrickBreakersClone.Versus.RollbackOverLossyLink",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * @brief Plays two peers over a lossy, jittery loopback link and checks every confirmed frame of both against
+ * a reference run that knew all inputs up front.
+ *
+ * Inputs are scripted per frame they apply to and change often, so remote predictions miss and both peers
+ * have to roll back. A confirmed frame that differs from the reference means a rollback re-simulated from the
+ * wrong snapshot or with the wrong inputs.
+ */
+bool FBBCVersusRollbackTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumFrames = 1800;
+	constexpr int32 InputDelay = 2;
+	constexpr int32 NumPlayers = FBBCVersusState::NumPlayers;
+
+	// Frames can only advance MaxRollbackFrames past the confirmed remote input, so the script covers every
+	// frame a peer may simulate.
+	constexpr int32 NumScriptFrames = NumFrames + InputDelay + FBBCRollbackSession::MaxRollbackFrames + 1;
+	TArray<FBBCVersusInput> Script[NumPlayers];
+	FRandomStream Stream(7);
+	for (int32 Player = 0; Player < NumPlayers; ++Player)
+	{
+		Script[Player].SetNum(NumScriptFrames);
+		int8 Move = 0;
+		for (int32 Frame = InputDelay; Frame < NumScriptFrames; ++Frame)
+		{
+			if (Stream.FRand() < 0.1f)
+			{
+				Move = static_cast<int8>(Stream.RandRange(-1, 1));
+			}
+			Script[Player][Frame].Move = Move;
+		}
+	}
+
+	TArray<uint32> Reference;
+	Reference.SetNum(NumScriptFrames);
+	FBBCVersusState ReferenceState;
+	BBCVersus::ResetState(ReferenceState);
+	for (int32 Frame = 0; Frame < NumScriptFrames; ++Frame)
+	{
+		Reference[Frame] = ReferenceState.GetChecksum();
+		const FBBCVersusInput Inputs[NumPlayers] = {Script[0][Frame], Script[1][Frame]};
+		BBCVersus::Step(ReferenceState, Inputs);
+	}
+
+	FBBCLoopbackSettings Settings;
+	Settings.LatencySeconds = 0.05;
+	Settings.JitterSeconds = 0.04;
+	Settings.LossFraction = 0.2f;
+	Settings.Seed = 3;
+	TSharedPtr<FBBCLoopbackTransport> Transports[NumPlayers];
+	FBBCLoopbackTransport::CreatePair(Settings, Transports[0], Transports[1]);
+	FBBCRollbackSession Sessions[NumPlayers] = {FBBCRollbackSession(0, InputDelay), FBBCRollbackSession(1, InputDelay)};
+
+	int32 NextUnchecked[NumPlayers] = {};
+	int32 Mismatches = 0;
+	FBBCVersusPacket Packet;
+	for (int32 Tick = 0; Tick < NumFrames; ++Tick)
+	{
+		Transports[0]->AdvanceTime(BBCVersus::StepSeconds);
+		for (int32 Peer = 0; Peer < NumPlayers; ++Peer)
+		{
+			while (Transports[Peer]->Receive(Packet))
+			{
+				Sessions[Peer].ReceivePacket(Packet);
+			}
+		}
+		for (int32 Peer = 0; Peer < NumPlayers; ++Peer)
+		{
+			FBBCRollbackSession& Session = Sessions[Peer];
+			Session.AdvanceFrame(Script[Peer][Session.GetCurrentFrame() + InputDelay]);
+			Session.BuildPacket(Packet);
+			Transports[Peer]->Send(Packet);
+
+			uint32 Checksum = 0;
+			while (Session.GetConfirmedChecksum(NextUnchecked[Peer], Checksum))
+			{
+				if (Checksum != Reference[NextUnchecked[Peer]])
+				{
+					++Mismatches;
+					AddError(FString::Printf(TEXT("Peer %d confirmed frame %d as %08x, the reference is %08x"), Peer, NextUnchecked[Peer], Checksum, Reference[NextUnchecked[Peer]]));
+				}
+				++NextUnchecked[Peer];
+			}
+		}
+	}
+
+	TestEqual(TEXT("Checksum mismatches"), Mismatches, 0);
+	for (int32 Peer = 0; Peer < NumPlayers; ++Peer)
+	{
+		const FBBCRollbackStats& Stats = Sessions[Peer].GetStats();
+		TestTrue(FString::Printf(TEXT("Peer %d rolled back"), Peer), Stats.Rollbacks > 0 && Stats.ResimulatedFrames > 0);
+		TestTrue(FString::Printf(TEXT("Peer %d kept up with the link"), Peer), Sessions[Peer].GetCurrentFrame() > NumFrames / 2);
+		TestTrue(FString::Printf(TEXT("Peer %d checked every confirmed frame"), Peer), NextUnchecked[Peer] > Sessions[Peer].GetConfirmedFrame());
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tuning/BBCTuning.h"
+
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	FAutoConsoleCommand DumpTuningCommand(
+		TEXT("BBC.Tuning.Dump"),
+		TEXT("Logs every gameplay tuning value in effect."),
+		FConsoleCommandDelegate::CreateStatic(&BBCTuning::Dump));
+
+#if BBC_TUNING_HOT_RELOAD
+	/**
+	 * @brief Sets tuning values while the game runs.
+	 *
+	 * Usage: BBC.Tuning.Set <Name> <Value> [<Name> <Value> ...]
+	 */
+	FAutoConsoleCommand SetTuningCommand(
+		TEXT("BBC.Tuning.Set"),
+		TEXT("Sets gameplay tuning values by name. Usage: BBC.Tuning.Set <Name> <Value> [<Name> <Value> ...]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			for (int32 Index = 0; Index + 1 < Args.Num(); Index += 2)
+			{
+				BBCTuning::SetValue(Args[Index], Args[Index + 1]);
+			}
+		}));
+
+	FAutoConsoleCommand ResetTuningCommand(
+		TEXT("BBC.Tuning.Reset"),
+		TEXT("Puts every gameplay tuning value back to its shipping value."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			BBCTuning::Apply(BBCTuning::Defaults);
+		}));
+#endif
+}
+
+#if BBC_TUNING_HOT_RELOAD
+FBBCTuningValues BBCTuning::GActive;
+
+void BBCTuning::Apply(const FBBCTuningValues& Values)
+{
+	GActive = Values;
+	UE_LOG(LogTemp, Display, TEXT("Gameplay tuning applied"));
+}
+
+/**
+ * @brief Sets one tuning value by the name of its property.
+ *
+ * @param Name Property name in FBBCTuningValues, for example BallLaunchSpeed.
+ * @param Value The value as text.
+ *
+ * @return true if the value was set.
+ */
+bool BBCTuning::SetValue(const FString& Name, const FString& Value)
+{
+	const FProperty* Property = FBBCTuningValues::StaticStruct()->FindPropertyByName(FName(*Name));
+	if (Property == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unknown tuning value %s"), *Name);
+		return false;
+	}
+	if (Property->ImportText_InContainer(*Value, &GActive, nullptr, PPF_None) == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid value %s for tuning value %s"), *Value, *Name);
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Tuning %s = %s"), *Name, *Value);
+	return true;
+}
+
+/**
+ * @brief Applies Name=Value pairs, so a run can A/B test values without a rebuild.
+ *
+ * @param Overrides Comma separated pairs, for example "BallLaunchSpeed=350,PaddleMovementSpeed=420".
+ */
+void BBCTuning::ApplyOverrides(const FString& Overrides)
+{
+	TArray<FString> Pairs;
+	Overrides.ParseIntoArray(Pairs, TEXT(","));
+	for (const FString& Pair : Pairs)
+	{
+		FString Name;
+		FString Value;
+		if (!Pair.Split(TEXT("="), &Name, &Value))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Invalid tuning override %s"), *Pair);
+			continue;
+		}
+		SetValue(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+	}
+}
+#endif
+
+void BBCTuning::Dump()
+{
+	const UScriptStruct* Struct = FBBCTuningValues::StaticStruct();
+	const FBBCTuningValues& Active = Get();
+	UE_LOG(LogTemp, Display, TEXT("Gameplay tuning (%s):"), BBC_TUNING_HOT_RELOAD ? TEXT("hot reload") : TEXT("compile time"));
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		FString Value;
+		It->ExportText_InContainer(0, Value, &Active, nullptr, nullptr, PPF_None);
+		FString DefaultValue;
+		It->ExportText_InContainer(0, DefaultValue, &Defaults, nullptr, nullptr, PPF_None);
+		const bool bChanged = !It->Identical_InContainer(&Active, &Defaults);
+		UE_LOG(LogTemp, Display, TEXT("  %s = %s%s"), *It->GetName(), *Value, bChanged ? *FString::Printf(TEXT(" (default %s)"), *DefaultValue) : TEXT(""));
+	}
+}
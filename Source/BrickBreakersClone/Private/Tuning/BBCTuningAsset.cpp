@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tuning/BBCTuningAsset.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_EDITOR
+/**
+ * @brief Applies the edited values while a game world plays with this asset as its tuning.
+ *
+ * @param PropertyChangedEvent The edited property.
+ */
+void UBBCTuningAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+#if BBC_TUNING_HOT_RELOAD
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(Context.World());
+		if (Assets != nullptr && Assets->GetTuningAsset() == this)
+		{
+			BBCTuning::Apply(Values);
+			return;
+		}
+	}
+#endif
+}
+#endif
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Versus/BBCRollbackSession.h"
+
+#include "Versus/BBCVersusTransport.h"
+
+/**
+ * @brief Starts a match at frame 0.
+ *
+ * @param InLocalPlayer Player controlled on this peer, 0 or 1.
+ * @param InInputDelay Frames between sampling a local input and applying it. The first InInputDelay frames
+ * use no local input.
+ */
+FBBCRollbackSession::FBBCRollbackSession(int32 InLocalPlayer, int32 InInputDelay) :
+	LocalPlayer(InLocalPlayer),
+	InputDelay(FMath::Clamp(InInputDelay, 0, MaxRollbackFrames))
+{
+	BBCVersus::ResetState(State);
+	for (int32 Frame = 0; Frame < InputDelay; ++Frame)
+	{
+		LocalInputs[Frame % InputRingSize] = FInputSlot{Frame, FBBCVersusInput()};
+	}
+	NewestLocalFrame = InputDelay - 1;
+}
+
+/**
+ * @brief Confirms the remote inputs carried by a packet.
+ *
+ * Inputs are only accepted in frame order, so a late or reordered packet never leaves a hole; the inputs it
+ * misses are repeated by the remote until they are acknowledged. A confirmed input that differs from the
+ * prediction a past frame was simulated with marks that frame for rollback.
+ *
+ * @param Packet The received packet.
+ */
+void FBBCRollbackSession::ReceivePacket(const FBBCVersusPacket& Packet)
+{
+	RemoteAckFrame = FMath::Max(RemoteAckFrame, Packet.AckFrame);
+
+	for (int32 Index = 0; Index < Packet.NumInputs; ++Index)
+	{
+		const int32 Frame = Packet.FirstFrame + Index;
+		if (Frame != ConfirmedRemoteFrame + 1)
+		{
+			continue;
+		}
+
+		const FBBCVersusInput Input = Packet.Inputs[Index];
+		RemoteInputs[Frame % InputRingSize] = FInputSlot{Frame, Input};
+		ConfirmedRemoteFrame = Frame;
+		if (Frame < State.Frame && Snapshots[Frame % SnapshotRingSize].RemoteInput != Input)
+		{
+			RollbackFrame = RollbackFrame == INDEX_NONE ? Frame : FMath::Min(RollbackFrame, Frame);
+		}
+	}
+}
+
+/**
+ * @brief Writes the oldest local inputs the remote has not acknowledged, up to FBBCVersusPacket::MaxInputs.
+ *
+ * @param OutPacket The packet to fill.
+ */
+void FBBCRollbackSession::BuildPacket(FBBCVersusPacket& OutPacket) const
+{
+	OutPacket.AckFrame = ConfirmedRemoteFrame;
+	OutPacket.FirstFrame = RemoteAckFrame + 1;
+	OutPacket.NumInputs = FMath::Clamp(NewestLocalFrame - RemoteAckFrame, 0, FBBCVersusPacket::MaxInputs);
+	for (int32 Index = 0; Index < OutPacket.NumInputs; ++Index)
+	{
+		OutPacket.Inputs[Index] = GetLocalInput(OutPacket.FirstFrame + Index);
+	}
+}
+
+/**
+ * @brief Advances the match by one frame.
+ *
+ * @param LocalInput Input sampled this frame, applied InputDelay frames from now.
+ * @return false if the peer is stalled waiting for remote inputs.
+ */
+bool FBBCRollbackSession::AdvanceFrame(FBBCVersusInput LocalInput)
+{
+	if (State.Frame - (ConfirmedRemoteFrame + 1) >= MaxRollbackFrames)
+	{
+		++Stats.Stalls;
+		return false;
+	}
+
+	const int32 InputFrame = State.Frame + InputDelay;
+	LocalInputs[InputFrame % InputRingSize] = FInputSlot{InputFrame, LocalInput};
+	NewestLocalFrame = InputFrame;
+
+	if (RollbackFrame != INDEX_NONE)
+	{
+		Rollback();
+	}
+	SimulateFrame();
+	return true;
+}
+
+bool FBBCRollbackSession::GetConfirmedChecksum(int32 Frame, uint32& OutChecksum) const
+{
+	if (Frame < 0 || Frame > ConfirmedRemoteFrame + 1 || Frame > State.Frame || Frame <= State.Frame - SnapshotRingSize
+		|| (RollbackFrame != INDEX_NONE && Frame > RollbackFrame))
+	{
+		return false;
+	}
+	if (Frame == State.Frame)
+	{
+		OutChecksum = State.GetChecksum();
+		return true;
+	}
+	const FBBCVersusState& Snapshot = Snapshots[Frame % SnapshotRingSize].State;
+	if (Snapshot.Frame != Frame)
+	{
+		return false;
+	}
+	OutChecksum = Snapshot.GetChecksum();
+	return true;
+}
+
+FBBCVersusInput FBBCRollbackSession::GetLocalInput(int32 Frame) const
+{
+	const FInputSlot& Slot = LocalInputs[Frame % InputRingSize];
+	return Slot.Frame == Frame ? Slot.Input : FBBCVersusInput();
+}
+
+/**
+ * @brief Confirmed remote input for a frame, or the prediction: the last confirmed input, held.
+ */
+FBBCVersusInput FBBCRollbackSession::GetRemoteInput(int32 Frame) const
+{
+	const int32 SourceFrame = FMath::Min(Frame, ConfirmedRemoteFrame);
+	if (SourceFrame < 0)
+	{
+		return FBBCVersusInput();
+	}
+	const FInputSlot& Slot = RemoteInputs[SourceFrame % InputRingSize];
+	return Slot.Frame == SourceFrame ? Slot.Input : FBBCVersusInput();
+}
+
+/**
+ * @brief Snapshots the current state with the remote input about to be used, then steps it.
+ */
+void FBBCRollbackSession::SimulateFrame()
+{
+	FSnapshot& Snapshot = Snapshots[State.Frame % SnapshotRingSize];
+	Snapshot.State = State;
+	Snapshot.RemoteInput = GetRemoteInput(State.Frame);
+
+	FBBCVersusInput Inputs[FBBCVersusState::NumPlayers];
+	Inputs[LocalPlayer] = GetLocalInput(State.Frame);
+	Inputs[1 - LocalPlayer] = Snapshot.RemoteInput;
+	BBCVersus::Step(State, Inputs);
+}
+
+/**
+ * @brief Restores the snapshot of the first mispredicted frame and simulates forward to the current frame.
+ *
+ * Frames simulated again take new snapshots, so a later correction restores corrected states.
+ */
+void FBBCRollbackSession::Rollback()
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	const int32 TargetFrame = State.Frame;
+	State = Snapshots[RollbackFrame % SnapshotRingSize].State;
+	while (State.Frame < TargetFrame)
+	{
+		SimulateFrame();
+	}
+
+	const int32 Depth = TargetFrame - RollbackFrame;
+	RollbackFrame = INDEX_NONE;
+	++Stats.Rollbacks;
+	Stats.ResimulatedFrames += Depth;
+	Stats.MaxRollbackFrames = FMath::Max(Stats.MaxRollbackFrames, Depth);
+	Stats.LastRollbackSeconds = FPlatformTime::Seconds() - StartSeconds;
+	Stats.MaxRollbackSeconds = FMath::Max(Stats.MaxRollbackSeconds, Stats.LastRollbackSeconds);
+}
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Versus/BBCVersusSimulation.h"
+
+#include "Core/Collision/BBCCollision.h"
+#include "Misc/Crc.h"
+
+namespace
+{
+	constexpr double ContactOffset = 0.01;
+	constexpr int32 MaxBouncesPerStep = 4;
+	constexpr double MaxPaddleInfluence = 0.75;
+	constexpr double ServeSlope = 0.35;
+	constexpr double WallThickness = 20.0;
+
+	enum class EVersusHit : uint8
+	{
+		None,
+		Wall,
+		Paddle,
+		Brick
+	};
+
+	/** Direction player Player's serves travel in: player 0 serves up the screen (-Y), player 1 down. */
+	double GetServeDirection(int32 Player)
+	{
+		return Player == 0 ? -1.0 : 1.0;
+	}
+
+	double GetPaddleY(int32 Player)
+	{
+		return -GetServeDirection(Player) * BBCVersus::PaddleLineY;
+	}
+
+	void ServeBall(FBBCVersusState& State, int32 Player)
+	{
+		FBBCVersusBall& Ball = State.Balls[Player];
+		Ball.Owner = Player;
+		Ball.ServeFrames = BBCVersus::ServeDelayFrames;
+		Ball.Velocity = FVector2D::ZeroVector;
+		Ball.Position = FVector2D(State.PaddleX[Player], GetPaddleY(Player) + GetServeDirection(Player) * (BBCVersus::PaddleHalfHeight + BBCVersus::BallRadius + 1.0));
+	}
+
+	/**
+	 * Sweeps a ball through one step against the side walls, both paddles and the live bricks, resolving up to
+	 * MaxBouncesPerStep contacts.
+	 */
+	void MoveBall(FBBCVersusState& State, FBBCVersusBall& Ball)
+	{
+		static const FBox2D Walls[] = {
+			FBox2D(FVector2D(-BBCVersus::FieldHalfWidth - WallThickness, -BBCVersus::GoalLineY * 2.0), FVector2D(-BBCVersus::FieldHalfWidth, BBCVersus::GoalLineY * 2.0)),
+			FBox2D(FVector2D(BBCVersus::FieldHalfWidth, -BBCVersus::GoalLineY * 2.0), FVector2D(BBCVersus::FieldHalfWidth + WallThickness, BBCVersus::GoalLineY * 2.0))
+		};
+
+		double Remaining = BBCVersus::StepSeconds;
+		for (int32 Bounce = 0; Bounce < MaxBouncesPerStep && Remaining > 0.0; ++Bounce)
+		{
+			const FVector2D Delta = Ball.Velocity * Remaining;
+			double BestTime = 1.0;
+			FVector2D BestNormal = FVector2D::ZeroVector;
+			EVersusHit HitType = EVersusHit::None;
+			int32 HitIndex = INDEX_NONE;
+
+			const auto TestBox = [&](const FBox2D& Box, EVersusHit Type, int32 Index)
+			{
+				double Time = 0.0;
+				FVector2D Normal;
+				if (BBCCollision::SweepCircleAABB(Ball.Position, Delta, BBCVersus::BallRadius, Box, Time, Normal) && Time < BestTime)
+				{
+					BestTime = Time;
+					BestNormal = Normal;
+					HitType = Type;
+					HitIndex = Index;
+				}
+			};
+
+			for (int32 Wall = 0; Wall < UE_ARRAY_COUNT(Walls); ++Wall)
+			{
+				TestBox(Walls[Wall], EVersusHit::Wall, Wall);
+			}
+			for (int32 Player = 0; Player < FBBCVersusState::NumPlayers; ++Player)
+			{
+				TestBox(BBCVersus::GetPaddleBox(State, Player), EVersusHit::Paddle, Player);
+			}
+			for (uint64 Mask = State.Bricks; Mask != 0; Mask &= Mask - 1)
+			{
+				const int32 Brick = static_cast<int32>(FMath::CountTrailingZeros64(Mask));
+				TestBox(BBCVersus::GetBrickBox(Brick), EVersusHit::Brick, Brick);
+			}
+
+			if (HitType == EVersusHit::None)
+			{
+				Ball.Position += Delta;
+				return;
+			}
+
+			Ball.Position += Delta * BestTime + BestNormal * ContactOffset;
+			Remaining *= 1.0 - BestTime;
+			FVector2D Direction = BBCCollision::Reflect(Ball.Velocity.GetSafeNormal(), BestNormal);
+
+			switch (HitType)
+			{
+			case EVersusHit::Paddle:
+				{
+					Ball.Owner = HitIndex;
+					const double Offset = (Ball.Position.X - State.PaddleX[HitIndex]) / BBCVersus::PaddleHalfWidth;
+					Direction.X += FMath::Clamp(Offset, -1.0, 1.0) * MaxPaddleInfluence;
+					Direction = Direction.GetSafeNormal();
+				}
+				break;
+
+			case EVersusHit::Brick:
+				State.Bricks &= ~(1ull << HitIndex);
+				++State.Scores[Ball.Owner];
+				if (State.Bricks == 0)
+				{
+					State.Bricks = BBCVersus::AllBricks;
+				}
+				break;
+
+			default:
+				break;
+			}
+			Ball.Velocity = Direction * BBCVersus::BallSpeed;
+		}
+	}
+}
+
+uint32 FBBCVersusState::GetChecksum() const
+{
+	uint32 Crc = FCrc::MemCrc32(&Frame, sizeof(Frame));
+	Crc = FCrc::MemCrc32(PaddleX, sizeof(PaddleX), Crc);
+	for (const FBBCVersusBall& Ball : Balls)
+	{
+		Crc = FCrc::MemCrc32(&Ball.Position, sizeof(Ball.Position), Crc);
+		Crc = FCrc::MemCrc32(&Ball.Velocity, sizeof(Ball.Velocity), Crc);
+		Crc = FCrc::MemCrc32(&Ball.Owner, sizeof(Ball.Owner), Crc);
+		Crc = FCrc::MemCrc32(&Ball.ServeFrames, sizeof(Ball.ServeFrames), Crc);
+	}
+	Crc = FCrc::MemCrc32(&Bricks, sizeof(Bricks), Crc);
+	return FCrc::MemCrc32(Scores, sizeof(Scores), Crc);
+}
+
+/**
+ * @brief Puts both paddles in the centre, both balls on their serving paddles and a full brick wall.
+ */
+void BBCVersus::ResetState(FBBCVersusState& State)
+{
+	State = FBBCVersusState();
+	State.Bricks = AllBricks;
+	for (int32 Player = 0; Player < FBBCVersusState::NumPlayers; ++Player)
+	{
+		ServeBall(State, Player);
+	}
+}
+
+/**
+ * @brief Advances a match by one frame.
+ *
+ * Paddles move first, then each ball either counts down its serve or is swept through the step. A ball that
+ * crosses a goal line scores for the other player and is served again by its server.
+ *
+ * @param State The match state, updated in place.
+ * @param Inputs Input of each player for this frame.
+ */
+void BBCVersus::Step(FBBCVersusState& State, const FBBCVersusInput (&Inputs)[FBBCVersusState::NumPlayers])
+{
+	for (int32 Player = 0; Player < FBBCVersusState::NumPlayers; ++Player)
+	{
+		const double Limit = FieldHalfWidth - PaddleHalfWidth;
+		State.PaddleX[Player] = FMath::Clamp(State.PaddleX[Player] + Inputs[Player].Move * PaddleSpeed * StepSeconds, -Limit, Limit);
+	}
+
+	for (int32 Player = 0; Player < FBBCVersusState::NumPlayers; ++Player)
+	{
+		FBBCVersusBall& Ball = State.Balls[Player];
+		if (Ball.ServeFrames > 0)
+		{
+			Ball.Position.X = State.PaddleX[Player];
+			if (--Ball.ServeFrames == 0)
+			{
+				const double Slope = (State.Frame & 1) != 0 ? ServeSlope : -ServeSlope;
+				Ball.Velocity = FVector2D(Slope, GetServeDirection(Player)).GetSafeNormal() * BallSpeed;
+			}
+			continue;
+		}
+
+		MoveBall(State, Ball);
+		if (FMath::Abs(Ball.Position.Y) > GoalLineY)
+		{
+			const int32 Scorer = Ball.Position.Y > 0.0 ? 1 : 0;
+			State.Scores[Scorer] += GoalPoints;
+			ServeBall(State, Player);
+		}
+	}
+	++State.Frame;
+}
+
+FBox2D BBCVersus::GetPaddleBox(const FBBCVersusState& State, int32 Player)
+{
+	const FVector2D Centre(State.PaddleX[Player], GetPaddleY(Player));
+	const FVector2D Extent(PaddleHalfWidth, PaddleHalfHeight);
+	return FBox2D(Centre - Extent, Centre + Extent);
+}
+
+FBox2D BBCVersus::GetBrickBox(int32 Brick)
+{
+	const FVector2D Min(-BrickColumns * BrickWidth * 0.5 + (Brick % BrickColumns) * BrickWidth, -BrickRows * BrickHeight * 0.5 + (Brick / BrickColumns) * BrickHeight);
+	return FBox2D(Min, Min + FVector2D(BrickWidth, BrickHeight));
+}
@@ -0,0 +1,428 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Versus/BBCVersusSubsystem.h"
+
+#include "Assets/BBCAssetSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Core/Ball/BBCBall.h"
+#include "Core/Brick/BBCBrickFieldComponent.h"
+#include "Core/Paddle/BBCPaddle.h"
+#include "Core/Tick/BBCTickManagerSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Headless/BBCSimProfiler.h"
+#include "Misc/CommandLine.h"
+
+namespace
+{
+	/** Most versus frames run in one game frame; time beyond that after a hitch is dropped. */
+	constexpr int32 MaxStepsPerFrame = 4;
+	constexpr double BotDeadZone = 8.0;
+	constexpr double FrameBudgetSeconds = 1.0 / 60.0;
+
+	FAutoConsoleCommandWithWorld VersusStatsCommand(
+		TEXT("BBC.Versus.Stats"),
+		TEXT("Logs the frame, rollback and stall counters of both versus peers."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const UBBCVersusSubsystem* Versus = World != nullptr ? World->GetSubsystem<UBBCVersusSubsystem>() : nullptr;
+			if (Versus == nullptr || !Versus->IsActive())
+			{
+				return;
+			}
+			for (int32 Peer = 0; Peer < FBBCVersusState::NumPlayers; ++Peer)
+			{
+				const FBBCRollbackSession& Session = *Versus->GetSession(Peer);
+				const FBBCRollbackStats& Stats = Session.GetStats();
+				UE_LOG(LogTemp, Display, TEXT("Peer %d: frame %d, confirmed %d, score %d-%d, %d rollbacks (%d frames, deepest %d, last %.3f ms, max %.3f ms), %d stalls"),
+					Peer, Session.GetCurrentFrame(), Session.GetConfirmedFrame(), Session.GetState().Scores[0], Session.GetState().Scores[1],
+					Stats.Rollbacks, Stats.ResimulatedFrames, Stats.MaxRollbackFrames, Stats.LastRollbackSeconds * 1000.0,
+					Stats.MaxRollbackSeconds * 1000.0, Stats.Stalls);
+			}
+			UE_LOG(LogTemp, Display, TEXT("Versus sync checked up to frame %d, %d desyncs"), Versus->GetLastCheckedFrame(), Versus->GetNumDesyncs());
+		}));
+
+	/**
+	 * @brief Times a worst case rollback: restoring a snapshot and simulating MaxRollbackFrames frames again.
+	 *
+	 * Usage: BBC.Versus.BenchRollback [Iterations]
+	 */
+	FAutoConsoleCommand BenchRollbackCommand(
+		TEXT("BBC.Versus.BenchRollback"),
+		TEXT("Times restoring a versus snapshot and re-simulating the deepest rollback. Usage: BBC.Versus.BenchRollback [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+			constexpr int32 Depth = FBBCRollbackSession::MaxRollbackFrames;
+
+			FBBCVersusState Snapshot;
+			BBCVersus::ResetState(Snapshot);
+			FRandomStream Stream(0);
+			FBBCVersusInput Inputs[Depth][FBBCVersusState::NumPlayers];
+			for (int32 Frame = 0; Frame < 120; ++Frame)
+			{
+				const FBBCVersusInput Warmup[FBBCVersusState::NumPlayers] = {FBBCVersusInput{static_cast<int8>(Stream.RandRange(-1, 1))}, FBBCVersusInput{static_cast<int8>(Stream.RandRange(-1, 1))}};
+				BBCVersus::Step(Snapshot, Warmup);
+			}
+			for (int32 Frame = 0; Frame < Depth; ++Frame)
+			{
+				Inputs[Frame][0].Move = static_cast<int8>(Stream.RandRange(-1, 1));
+				Inputs[Frame][1].Move = static_cast<int8>(Stream.RandRange(-1, 1));
+			}
+
+			FBBCVersusState State;
+			uint32 Checksum = 0;
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				State = Snapshot;
+				for (int32 Frame = 0; Frame < Depth; ++Frame)
+				{
+					BBCVersus::Step(State, Inputs[Frame]);
+				}
+				Checksum ^= static_cast<uint32>(State.Bricks) ^ static_cast<uint32>(State.Scores[0]);
+			}
+			const double Seconds = (FPlatformTime::Seconds() - Start) / Iterations;
+
+			UE_LOG(LogTemp, Display, TEXT("Rollback bench: %d frames re-simulated in %.3f us (%.4f%% of a 16.7 ms frame), snapshot %d bytes, checksum %u"),
+				Depth, Seconds * 1.0e6, Seconds / FrameBudgetSeconds * 100.0, static_cast<int32>(sizeof(FBBCVersusState)), Checksum);
+		}));
+
+	/** Transform that stretches Mesh over Box on the gameplay plane. */
+	FTransform GetBoxTransform(const UStaticMesh* Mesh, const FBox2D& Box)
+	{
+		FVector Scale = FVector::OneVector;
+		if (Mesh != nullptr)
+		{
+			const FVector MeshSize = Mesh->GetBounds().BoxExtent * 2.0;
+			const FVector2D BoxSize = Box.GetSize();
+			Scale.X = MeshSize.X > 0.0 ? BoxSize.X / MeshSize.X : 1.0;
+			Scale.Y = MeshSize.Y > 0.0 ? BoxSize.Y / MeshSize.Y : 1.0;
+			Scale.Z = FMath::Min(Scale.X, Scale.Y);
+		}
+		return FTransform(FQuat::Identity, FVector(Box.GetCenter(), 0.0), Scale);
+	}
+}
+
+bool UBBCVersusSubsystem::IsRequestedOnCommandLine()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("BBCVersus"));
+}
+
+/**
+ * @brief Advances a running match in the Balls phase of UBBCTickManagerSubsystem.
+ *
+ * @param Collection The subsystem collection this subsystem belongs to.
+ */
+void UBBCVersusSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UBBCTickManagerSubsystem* TickManager = Collection.InitializeDependency<UBBCTickManagerSubsystem>())
+	{
+		TickManager->RegisterUpdate(EBBCTickPhase::Balls, EBBCTickOrder::BeforeActors, FBBCTickUpdate::CreateUObject(this, &UBBCVersusSubsystem::Advance));
+	}
+}
+
+void UBBCVersusSubsystem::Deinitialize()
+{
+	if (UBBCTickManagerSubsystem* TickManager = GetWorld()->GetSubsystem<UBBCTickManagerSubsystem>())
+	{
+		TickManager->UnregisterUpdates(this);
+	}
+	Stop();
+
+	Super::Deinitialize();
+}
+
+bool UBBCVersusSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+/**
+ * @brief Starts a match with the link read from the command line.
+ *
+ * Options: -BBCVersusLatencyMs= (one way, default 50), -BBCVersusJitterMs= (default 0), -BBCVersusLoss= (fraction
+ * of packets dropped, default 0), -BBCVersusDelay= (local input delay in frames, default 2) and -BBCSeed=.
+ *
+ * @param InLocalPaddle Paddle whose input drives player 0, or null to let the bot play both sides.
+ */
+void UBBCVersusSubsystem::Start(ABBCPaddle* InLocalPaddle)
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FBBCLoopbackSettings Settings;
+	double LatencyMs = Settings.LatencySeconds * 1000.0;
+	double JitterMs = Settings.JitterSeconds * 1000.0;
+	int32 InputDelay = 2;
+	FParse::Value(CommandLine, TEXT("BBCVersusLatencyMs="), LatencyMs);
+	FParse::Value(CommandLine, TEXT("BBCVersusJitterMs="), JitterMs);
+	FParse::Value(CommandLine, TEXT("BBCVersusLoss="), Settings.LossFraction);
+	FParse::Value(CommandLine, TEXT("BBCVersusDelay="), InputDelay);
+	FParse::Value(CommandLine, TEXT("BBCSeed="), Settings.Seed);
+	Settings.LatencySeconds = LatencyMs / 1000.0;
+	Settings.JitterSeconds = JitterMs / 1000.0;
+	Start(InLocalPaddle, Settings, InputDelay);
+}
+
+/**
+ * @brief Creates both peers, links them and spawns the match view.
+ *
+ * @param InLocalPaddle Paddle whose input drives player 0, or null to let the bot play both sides.
+ * @param Settings Latency, jitter and loss of the loopback link.
+ * @param InputDelay Local input delay of both peers, in frames.
+ */
+void UBBCVersusSubsystem::Start(ABBCPaddle* InLocalPaddle, const FBBCLoopbackSettings& Settings, int32 InputDelay)
+{
+	Stop();
+
+	NumDesyncs = 0;
+	LastCheckedFrame = INDEX_NONE;
+	LocalPaddle = InLocalPaddle;
+	FBBCLoopbackTransport::CreatePair(Settings, Transports[0], Transports[1]);
+	for (int32 Peer = 0; Peer < FBBCVersusState::NumPlayers; ++Peer)
+	{
+		Sessions[Peer] = MakeUnique<FBBCRollbackSession>(Peer, InputDelay);
+	}
+	CreateView();
+
+	UE_LOG(LogTemp, Display, TEXT("Versus match started: %.0f ms latency, %.0f ms jitter, %.0f%% loss, %d frames input delay"),
+		Settings.LatencySeconds * 1000.0, Settings.JitterSeconds * 1000.0, Settings.LossFraction * 100.f, InputDelay);
+}
+
+void UBBCVersusSubsystem::Stop()
+{
+	for (int32 Peer = 0; Peer < FBBCVersusState::NumPlayers; ++Peer)
+	{
+		Sessions[Peer].Reset();
+		Transports[Peer].Reset();
+	}
+	if (IsValid(ViewActor))
+	{
+		ViewActor->Destroy();
+	}
+	ViewActor = nullptr;
+	BrickInstances = nullptr;
+	PaddleInstances = nullptr;
+	BallInstances = nullptr;
+	Accumulator = 0.0;
+	ViewBricks = 0;
+}
+
+/**
+ * @brief Runs whole versus frames on both peers, then draws peer 0's state.
+ *
+ * @param DeltaTime Time elapsed since the last game frame.
+ */
+void UBBCVersusSubsystem::Advance(float DeltaTime)
+{
+	if (!IsActive())
+	{
+		return;
+	}
+	BBC_SIM_SCOPE("UBBCVersusSubsystem");
+
+	Accumulator += DeltaTime;
+	int32 NumSteps = FMath::FloorToInt32(Accumulator / BBCVersus::StepSeconds);
+	Accumulator -= NumSteps * BBCVersus::StepSeconds;
+	if (NumSteps > MaxStepsPerFrame)
+	{
+		NumSteps = MaxStepsPerFrame;
+		Accumulator = 0.0;
+	}
+	for (int32 Step = 0; Step < NumSteps && IsActive(); ++Step)
+	{
+		StepPeers();
+	}
+	if (IsActive())
+	{
+		UpdateView();
+	}
+}
+
+/**
+ * @brief Runs one network tick: deliver packets, advance each peer with its own input, send inputs.
+ *
+ * A stalled peer still sends, so acknowledgements keep flowing and the other peer can catch it up.
+ */
+void UBBCVersusSubsystem::StepPeers()
+{
+	Transports[0]->AdvanceTime(BBCVersus::StepSeconds);
+
+	FBBCVersusPacket Packet;
+	for (int32 Peer = 0; Peer < FBBCVersusState::NumPlayers; ++Peer)
+	{
+		while (Transports[Peer]->Receive(Packet))
+		{
+			Sessions[Peer]->ReceivePacket(Packet);
+		}
+	}
+
+	for (int32 Peer = 0; Peer < FBBCVersusState::NumPlayers; ++Peer)
+	{
+		FBBCRollbackSession& Session = *Sessions[Peer];
+		const ABBCPaddle* Paddle = Peer == 0 ? LocalPaddle.Get() : nullptr;
+		const FBBCVersusInput Input = Paddle != nullptr ? FBBCVersusInput::FromAxis(Paddle->GetInputDirection()) : GetBotInput(Session.GetState(), Peer);
+		Session.AdvanceFrame(Input);
+		Session.BuildPacket(Packet);
+		Transports[Peer]->Send(Packet);
+	}
+
+	CheckSync();
+}
+
+/**
+ * @brief Follows the nearest ball heading for the player's goal, or returns to the centre.
+ *
+ * @param State The player's own view of the match.
+ * @param Player The player the bot controls.
+ */
+FBBCVersusInput UBBCVersusSubsystem::GetBotInput(const FBBCVersusState& State, int32 Player) const
+{
+	const double GoalSide = Player == 0 ? 1.0 : -1.0;
+	double TargetX = 0.0;
+	double NearestDistance = TNumericLimits<double>::Max();
+	for (const FBBCVersusBall& Ball : State.Balls)
+	{
+		const double Distance = BBCVersus::GoalLineY - Ball.Position.Y * GoalSide;
+		if (Ball.ServeFrames == 0 && Ball.Velocity.Y * GoalSide > 0.0 && Distance < NearestDistance)
+		{
+			NearestDistance = Distance;
+			TargetX = Ball.Position.X;
+		}
+	}
+
+	const double Offset = TargetX - State.PaddleX[Player];
+	return FBBCVersusInput{static_cast<int8>(Offset > BotDeadZone ? 1 : (Offset < -BotDeadZone ? -1 : 0))};
+}
+
+/**
+ * @brief Compares the peers' checksums on the newest frame both have fully confirmed.
+ *
+ * A mismatch means the peers no longer play the same match and no later input can bring them back together,
+ * so the match is stopped rather than left running on diverged states.
+ */
+void UBBCVersusSubsystem::CheckSync()
+{
+	int32 Frame = TNumericLimits<int32>::Max();
+	for (const TUniquePtr<FBBCRollbackSession>& Session : Sessions)
+	{
+		Frame = FMath::Min(Frame, FMath::Min(Session->GetConfirmedFrame() + 1, Session->GetCurrentFrame()));
+	}
+	uint32 Checksums[FBBCVersusState::NumPlayers] = {};
+	if (Frame <= LastCheckedFrame || !Sessions[0]->GetConfirmedChecksum(Frame, Checksums[0]) || !Sessions[1]->GetConfirmedChecksum(Frame, Checksums[1]))
+	{
+		return;
+	}
+
+	LastCheckedFrame = Frame;
+	if (Checksums[0] != Checksums[1])
+	{
+		++NumDesyncs;
+		UE_LOG(LogTemp, Error, TEXT("Versus desync at frame %d: %08x != %08x, stopping the match"), Frame, Checksums[0], Checksums[1]);
+		ensureMsgf(false, TEXT("Versus peers desynced at frame %d"), Frame);
+		Stop();
+	}
+}
+
+void UBBCVersusSubsystem::CreateView()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = TEXT("VersusView");
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ViewActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!ensure(ViewActor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn versus view actor. "));
+		return;
+	}
+
+	const auto CreateInstances = [this](const TCHAR* Name, UStaticMesh* Mesh)
+	{
+		UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(ViewActor, Name);
+		Instances->SetMobility(EComponentMobility::Movable);
+		Instances->SetStaticMesh(Mesh);
+		Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Instances->SetCastShadow(false);
+		if (ViewActor->GetRootComponent() == nullptr)
+		{
+			ViewActor->SetRootComponent(Instances);
+		}
+		else
+		{
+			Instances->SetupAttachment(ViewActor->GetRootComponent());
+		}
+		Instances->RegisterComponent();
+		return Instances;
+	};
+	const UBBCAssetSubsystem* Assets = UBBCAssetSubsystem::Get(this);
+	UStaticMesh* BrickMesh = Assets != nullptr ? Assets->GetBrickMesh() : nullptr;
+	BrickInstances = CreateInstances(TEXT("VersusBricks"), BrickMesh);
+	PaddleInstances = CreateInstances(TEXT("VersusPaddles"), BrickMesh);
+	BallInstances = CreateInstances(TEXT("VersusBalls"), Assets != nullptr ? Assets->GetBallMesh() : nullptr);
+}
+
+/**
+ * @brief Mirrors peer 0's state to the instanced meshes. The brick instances are only rebuilt when the wall
+ * changed.
+ */
+void UBBCVersusSubsystem::UpdateView()
+{
+	if (BrickInstances == nullptr || PaddleInstances == nullptr || BallInstances == nullptr)
+	{
+		return;
+	}
+	const FBBCVersusState& State = Sessions[0]->GetState();
+
+	if (State.Bricks != ViewBricks)
+	{
+		ViewBricks = State.Bricks;
+		TArray<FTransform> Transforms;
+		for (uint64 Mask = State.Bricks; Mask != 0; Mask &= Mask - 1)
+		{
+			Transforms.Add(GetBoxTransform(BrickInstances->GetStaticMesh(), BBCVersus::GetBrickBox(static_cast<int32>(FMath::CountTrailingZeros64(Mask)))));
+		}
+		BrickInstances->ClearInstances();
+		BrickInstances->AddInstances(Transforms, false, true);
+	}
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(FBBCVersusState::NumPlayers);
+	for (int32 Player = 0; Player < FBBCVersusState::NumPlayers; ++Player)
+	{
+		Transforms.Add(GetBoxTransform(PaddleInstances->GetStaticMesh(), BBCVersus::GetPaddleBox(State, Player)));
+	}
+	if (PaddleInstances->GetInstanceCount() != Transforms.Num())
+	{
+		PaddleInstances->ClearInstances();
+		PaddleInstances->AddInstances(Transforms, false, true);
+	}
+	else
+	{
+		PaddleInstances->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+
+	Transforms.Reset();
+	for (const FBBCVersusBall& Ball : State.Balls)
+	{
+		const FVector2D Extent(BBCVersus::BallRadius, BBCVersus::BallRadius);
+		Transforms.Add(GetBoxTransform(BallInstances->GetStaticMesh(), FBox2D(Ball.Position - Extent, Ball.Position + Extent)));
+	}
+	if (BallInstances->GetInstanceCount() != Transforms.Num())
+	{
+		BallInstances->ClearInstances();
+		BallInstances->AddInstances(Transforms, false, true);
+	}
+	else
+	{
+		BallInstances->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Versus/BBCVersusTransport.h"
+
+void FBBCLoopbackTransport::CreatePair(const FBBCLoopbackSettings& Settings, TSharedPtr<FBBCLoopbackTransport>& OutA, TSharedPtr<FBBCLoopbackTransport>& OutB)
+{
+	const TSharedRef<FLink> Link = MakeShared<FLink>();
+	Link->Settings = Settings;
+	Link->Random.Initialize(Settings.Seed);
+	OutA = TSharedPtr<FBBCLoopbackTransport>(new FBBCLoopbackTransport(Link, 0));
+	OutB = TSharedPtr<FBBCLoopbackTransport>(new FBBCLoopbackTransport(Link, 1));
+}
+
+FBBCLoopbackTransport::FBBCLoopbackTransport(const TSharedRef<FLink>& InLink, int32 InSide) :
+	Link(InLink),
+	Side(InSide)
+{
+}
+
+/**
+ * @brief Puts a packet on the wire to the other end, unless the link drops it.
+ *
+ * @param Packet The packet to send.
+ */
+void FBBCLoopbackTransport::Send(const FBBCVersusPacket& Packet)
+{
+	FLink& LinkRef = Link.Get();
+	if (LinkRef.Random.GetFraction() < LinkRef.Settings.LossFraction)
+	{
+		return;
+	}
+	const double Jitter = LinkRef.Settings.JitterSeconds > 0.0 ? LinkRef.Random.FRandRange(0.0, LinkRef.Settings.JitterSeconds) : 0.0;
+	LinkRef.InFlight[1 - Side].Add(FInFlight{LinkRef.NowSeconds + LinkRef.Settings.LatencySeconds + Jitter, Packet});
+}
+
+/**
+ * @brief Pops the packet with the earliest delivery time that has arrived.
+ *
+ * @param OutPacket Receives the packet.
+ * @return true if a packet was received.
+ */
+bool FBBCLoopbackTransport::Receive(FBBCVersusPacket& OutPacket)
+{
+	TArray<FInFlight>& Incoming = Link->InFlight[Side];
+	int32 Earliest = INDEX_NONE;
+	for (int32 Index = 0; Index < Incoming.Num(); ++Index)
+	{
+		if (Incoming[Index].DeliverSeconds <= Link->NowSeconds
+			&& (Earliest == INDEX_NONE || Incoming[Index].DeliverSeconds < Incoming[Earliest].DeliverSeconds))
+		{
+			Earliest = Index;
+		}
+	}
+	if (Earliest == INDEX_NONE)
+	{
+		return false;
+	}
+	OutPacket = Incoming[Earliest].Packet;
+	Incoming.RemoveAt(Earliest, 1, EAllowShrinking::No);
+	return true;
+}
+
+void FBBCLoopbackTransport::AdvanceTime(double DeltaSeconds)
+{
+	Link->NowSeconds += DeltaSeconds;
+}
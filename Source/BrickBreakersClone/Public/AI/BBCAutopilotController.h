@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "BBCAutopilotController.generated.h"
+
+class ABBCPaddle;
+
+/**
+ * Plays the paddle on its own. Every frame it looks up the predicted path of the ball heading for the paddle
+ * in UBBCTrajectorySubsystem and steers the paddle under the landing point through ABBCPaddle::AddMoveInput,
+ * the same movement path player input takes.
+ *
+ * Like other gameplay actors it does not tick itself: UBBCTickManagerSubsystem updates it at the start of the
+ * Input phase, before paddles latch their input.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API ABBCAutopilotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+
+	ABBCAutopilotController(const FObjectInitializer& ObjectInitializer);
+
+	/** Input phase: predicts where the ball lands and pushes a move input towards it. */
+	void UpdateInput();
+
+	/** Landing point of the nearest ball heading for the paddle, on the paddle's line. */
+	bool PredictLanding(double& OutLandingX) const;
+
+	int32 GetNumPredictions() const { return NumPredictions; }
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+private:
+
+	/** Distance from the landing point under which the paddle stops. */
+	UPROPERTY(EditAnywhere, Category = "Autopilot", meta = (ClampMin = "0.0"))
+	float DeadZone;
+
+	/** Distance from the landing point at which the paddle starts slowing down. */
+	UPROPERTY(EditAnywhere, Category = "Autopilot", meta = (ClampMin = "1.0"))
+	float SlowdownDistance;
+
+	UPROPERTY()
+	TObjectPtr<ABBCPaddle> Paddle;
+
+	mutable int32 NumPredictions = 0;
+};
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BBCAssetSubsystem.generated.h"
+
+class UInputAction;
+class UInputMappingContext;
+class UParticleSystem;
+class USoundBase;
+class UStaticMesh;
+class UBBCTuningAsset;
+
+enum class EBBCAssetBundle : uint8
+{
+	/** Mapping context and actions of the player controller. */
+	Input,
+	/** Meshes of balls and bricks, and the tuning asset outside shipping builds. */
+	Gameplay,
+	/** Brick break effects and sounds; gameplay never waits for these. */
+	Effects,
+	Num
+};
+
+/**
+ * Asset manifest of the gameplay classes and its loader.
+ *
+ * Gameplay classes used to hard-load their assets in their constructors, which tied those loads to class
+ * default object construction at module startup. The manifest lists them as soft references in config
+ * instead, and the subsystem requests every bundle through FStreamableManager as soon as the game instance
+ * starts, so they load in the background while the map loads.
+ *
+ * Consumers never wait: they read the asset if its bundle is in, or register a callback with WhenLoaded.
+ * ABBCGameMode does the latter for the Gameplay bundle before starting the level, which makes the time until
+ * then the loading phase. A consumer reaching a bundle before it is in is counted as a load stall.
+ *
+ * The cooker does not follow soft references held in config, so every directory the manifest points into is
+ * listed under DirectoriesToAlwaysCook in DefaultGame.ini. An asset moved elsewhere needs its new directory
+ * added there, or packaged builds will load nothing for it.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCAssetSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UBBCAssetSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool IsBundleLoaded(EBBCAssetBundle Bundle) const;
+	/** Runs Callback now if Bundle is loaded, otherwise once it is. Never blocks. */
+	void WhenLoaded(EBBCAssetBundle Bundle, FSimpleDelegate Callback);
+
+	/** Loaded assets, or null while their bundle is still loading. */
+	UStaticMesh* GetBallMesh() const { return BallMesh.Get(); }
+	UStaticMesh* GetBrickMesh() const { return BrickMesh.Get(); }
+	UInputMappingContext* GetPlayerMappingContext() const { return PlayerMappingContext.Get(); }
+	UInputAction* GetStartAction() const { return StartAction.Get(); }
+	UParticleSystem* GetBreakEffect() const { return BreakEffect.Get(); }
+	UParticleSystem* GetReducedBreakEffect() const { return ReducedBreakEffect.Get(); }
+	USoundBase* GetBreakSound() const { return BreakSound.Get(); }
+	UBBCTuningAsset* GetTuningAsset() const { return TuningAsset.Get(); }
+
+	/** Applies the tuning asset, then the -BBCTuning= overrides. Does nothing in shipping builds. */
+	void ApplyTuning() const;
+
+	void LogStats() const;
+
+private:
+
+	void GetBundleAssets(EBBCAssetBundle Bundle, TArray<FSoftObjectPath>& OutAssets) const;
+	void HandleBundleLoaded(EBBCAssetBundle Bundle);
+
+private:
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UStaticMesh> BallMesh;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UStaticMesh> BrickMesh;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UInputMappingContext> PlayerMappingContext;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UInputAction> StartAction;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UParticleSystem> BreakEffect;
+
+	/** Cheaper stand-in for BreakEffect, played while the effects budget is under pressure. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UParticleSystem> ReducedBreakEffect;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<USoundBase> BreakSound;
+
+	/** Gameplay tuning applied in development builds; none leaves the compile-time values. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UBBCTuningAsset> TuningAsset;
+
+	FStreamableManager StreamableManager;
+
+	struct FBundleState
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		TArray<FSimpleDelegate> Callbacks;
+		double LoadedSeconds = 0.0;
+		bool bLoaded = false;
+	};
+
+	FBundleState Bundles[static_cast<int32>(EBBCAssetBundle::Num)];
+	double RequestSeconds = 0.0;
+	int32 NumStalls = 0;
+};
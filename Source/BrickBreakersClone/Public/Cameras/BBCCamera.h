@@ -26,6 +26,10 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Camera", meta = (ClampMin = "0.0", ClampMax = "180.0"))
 	float FieldOfView;
 
+	/** Width of the orthographic view, which UBBCPlayfieldSubsystem lays the arena out over. */
+	UPROPERTY(EditDefaultsOnly, Category = "Camera", meta = (ClampMin = "1.0"))
+	float OrthoWidth;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Camera", meta = (MakeEditWidget = true))
 	FVector SpawnLocation;
 
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Core/Pool/BBCPoolable.h"
 #include "BBCBall.generated.h"
 
+class UBBCBallSubsystem;
+
 UCLASS()
-class BRICKBREAKERSCLONE_API ABBCBall : public AActor
+class BRICKBREAKERSCLONE_API ABBCBall : public AActor, public IBBCPoolable
 {
 	GENERATED_BODY()
 	
@@ -18,24 +21,42 @@ protected:
 
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	virtual void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp,
-		bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
+public:
+
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
 
 	void StartMoving();
 	void ResetBall();
 
+	/** Seeds the stream that picks the launch direction, so a replayed session launches identically. */
+	void SetLaunchSeed(int32 Seed);
+
+	bool IsMoving() const;
+
+	/** Extra balls go back to the actor pool when lost; the player's ball is reset instead. */
+	bool ShouldReturnToPoolWhenLost() const { return bReturnToPoolWhenLost; }
+	void SetReturnToPoolWhenLost(bool bValue) { bReturnToPoolWhenLost = bValue; }
+
+	float GetBallRadius() const;
+
+	UStaticMesh* GetBallMesh() const;
+
 private:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Mesh, meta=(AllowPrivateAccess = "true"))
 	UStaticMeshComponent* Mesh;
 
 	UPROPERTY(VisibleAnywhere)
-	FVector Direction;
+	int32 BallHandle;
 
-	UPROPERTY(VisibleAnywhere)
-	float Velocity;
+	bool bReturnToPoolWhenLost;
+
+	FRandomStream LaunchRandom;
+
+private:
+
+	UBBCBallSubsystem* GetBallSubsystem() const;
 };
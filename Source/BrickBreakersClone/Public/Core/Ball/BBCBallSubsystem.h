@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/Collision/BBCCollision.h"
+#include "Core/Collision/BBCSpatialHash.h"
+#include "BBCBallSubsystem.generated.h"
+
+class ABBCBall;
+class ABBCPaddle;
+class UBBCBrickFieldComponent;
+class UBBCGameEventSubsystem;
+struct FBBCPlayfieldChangedEvent;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Snapshot of one ball, returned by value so callers never hold on to the pool buffers.
+ */
+struct FBBCBallState
+{
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Direction = FVector2D::ZeroVector;
+	double Speed = 0.0;
+	double Radius = 0.0;
+};
+
+/**
+ * Structure-of-arrays storage for every simulated ball. Balls are kept densely packed so the step loop
+ * walks contiguous memory; removal swaps the last ball into the freed slot.
+ */
+struct FBBCBallBuffers
+{
+	TArray<FVector2D> Positions;
+	TArray<FVector2D> Directions;
+	TArray<double> Speeds;
+	TArray<double> Radii;
+	/** Dense index to stable handle. */
+	TArray<int32> Handles;
+	/** Actor mirroring the ball, or null for balls drawn through the instanced mesh. */
+	TArray<TWeakObjectPtr<ABBCBall>> Actors;
+
+	int32 Num() const { return Positions.Num(); }
+	int32 Add(int32 Handle, ABBCBall* Actor, const FVector2D& Position, const FVector2D& Direction, double Speed, double Radius);
+	void RemoveAtSwap(int32 Index);
+};
+
+/**
+ * Owns ball motion. Balls are advanced with a fixed timestep accumulator and collide through analytic
+ * swept tests against walls, the paddle and bricks, so the trajectory does not depend on the frame rate.
+ * Balls without an actor are drawn through one instanced static mesh, which lets multiball and stress
+ * modes run thousands of balls in a single batched update. Colliders are indexed by a spatial hash, so a
+ * ball only sweeps against the colliders near its path. The walls and kill zone come from the playfield layout
+ * and follow it when it changes.
+ *
+ * Advanced from the Balls phase of UBBCTickManagerSubsystem, after the paddles have moved.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCBallSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static constexpr double FixedStepSeconds = 1.0 / 240.0;
+	static constexpr int32 MaxStepsPerFrame = 16;
+	static constexpr int32 MaxBouncesPerStep = 4;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Runs the fixed steps covered by DeltaTime and writes the results to actors and instances. */
+	void Advance(float DeltaTime);
+	/** Number of fixed steps the next Advance(DeltaTime) will run. */
+	int32 GetNumStepsFor(float DeltaTime) const;
+
+	/** Adds a ball mirrored by an actor. */
+	int32 RegisterBall(ABBCBall* Ball, const FVector2D& Position, double Radius);
+	/** Adds a ball drawn through the instanced mesh, already in motion. */
+	int32 SpawnBall(const FVector2D& Position, const FVector2D& Direction, double Speed, double Radius);
+	void UnregisterBall(int32 BallHandle);
+	void ClearSpawnedBalls();
+
+	void LaunchBall(int32 BallHandle, const FVector2D& Direction, double Speed);
+	void ResetBall(int32 BallHandle, const FVector2D& Position);
+	/** Changes the collision radius of a ball, for an actor ball whose mesh arrived after it was registered. */
+	void SetBallRadius(int32 BallHandle, double Radius);
+
+	/** Scales how far every ball moves per step, without changing the speeds they were launched with. */
+	void SetSpeedScale(double InSpeedScale) { SpeedScale = FMath::Max(InSpeedScale, 0.0); }
+	double GetSpeedScale() const { return SpeedScale; }
+	/**
+	 * Makes balls stick to the paddle they hit and ride along with it for HoldSeconds before they leave in the
+	 * direction they bounced. Launching a stuck ball releases it early. 0 turns it off and releases every ball.
+	 */
+	void SetStickyPaddle(double HoldSeconds);
+	/** Sends every ball held by the sticky paddle on its way now, as the player's launch input does. */
+	void ReleaseStuckBalls();
+	int32 GetNumStuckBalls() const { return StuckBalls.Num(); }
+
+	int32 AddCollider(const FBBCCollider& Collider);
+	void SetColliderEnabled(int32 ColliderIndex, bool bEnabled);
+	void SetPaddle(ABBCPaddle* Paddle);
+	void SetBrickField(UBBCBrickFieldComponent* InBrickField);
+	/** Adds bricks swept after the brick field; the owner clears it before the source goes away. */
+	void SetBrickSource(IBBCBrickSource* InBrickSource) { BrickSource = InBrickSource; }
+	ABBCPaddle* GetPaddle() const { return Paddle.Get(); }
+	UBBCBrickFieldComponent* GetBrickField() const { return BrickField.Get(); }
+
+	/** Advances every ball by exactly one fixed step. */
+	void StepFixed();
+
+	bool GetBallState(int32 BallHandle, FBBCBallState& OutState) const;
+	int32 GetNumBalls() const { return Buffers.Num(); }
+	/** Balls drawn through the instanced mesh, without the actor balls. */
+	int32 GetNumSpawnedBalls() const { return Buffers.Num() - NumActorBalls; }
+	/** Handle of the ball at a dense index in [0, GetNumBalls()). */
+	int32 GetBallHandle(int32 Index) const { return Buffers.Handles[Index]; }
+
+	/**
+	 * Sweeps a ball shaped probe against the colliders and the brick field without changing anything. Used to
+	 * predict ball paths.
+	 */
+	bool TraceBall(const FVector2D& Start, const FVector2D& Delta, double Radius, FBBCSweepHit& OutHit) const;
+	/** Damages the brick of a brick contact found by TraceBall, as a ball hitting it would. */
+	void DamageBrick(const FBBCSweepHit& Hit);
+	uint64 GetStepCount() const { return StepCount; }
+	const FBBCCollider* GetCollider(int32 ColliderIndex) const { return Colliders.IsValidIndex(ColliderIndex) ? &Colliders[ColliderIndex] : nullptr; }
+	/** Current paddle collider, or null before a paddle is set. */
+	const FBBCCollider* GetPaddleCollider() const { return GetCollider(PaddleColliderIndex); }
+	/** Level-placed bricks that have not been broken yet. */
+	int32 GetNumBrickColliders() const;
+	/** Enabled colliders, keyed by collider index. */
+	const FBBCSpatialHash& GetBroadphase() const { return Broadphase; }
+	int64 GetCollisionCount(EBBCColliderType Type) const { return CollisionCounts[static_cast<int32>(Type)]; }
+	double GetLastSimulationSeconds() const { return LastSimulationSeconds; }
+	double GetLastRenderSyncSeconds() const { return LastRenderSyncSeconds; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	int32 AllocateHandle(int32 DenseIndex);
+	void GatherLevelColliders(UWorld& InWorld);
+	void ApplyPlayfieldLayout();
+	void HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event);
+	void SetColliderBox(int32 ColliderIndex, const FBox2D& Box);
+	void UpdatePaddleCollider(int32 NumSteps);
+	void BeginPaddleStep(int32 Step);
+	void UpdatePaddleBroadphase();
+	void StepBall(int32 Index);
+	bool FindEarliestHit(const FVector2D& Position, double Radius, const FVector2D& Delta, FBBCSweepHit& OutHit) const;
+	void ResolveHit(int32 Index, const FBBCSweepHit& Hit);
+	bool PromoteBall(int32 Index);
+	void StickBall(int32 Index);
+	void UnstickBall(int32 BallHandle);
+	void MoveStuckBalls();
+	void FlushPendingRemovals();
+	void SyncActors();
+	void SyncInstances();
+	UInstancedStaticMeshComponent* GetOrCreateInstances();
+
+private:
+
+	FBBCBallBuffers Buffers;
+	/** Handle to dense index, INDEX_NONE for free handles. */
+	TArray<int32> HandleToIndex;
+	TArray<int32> FreeHandles;
+	/** Instanced balls lost during the current step, removed once the step is done. */
+	TArray<int32> PendingRemovals;
+	int32 NumActorBalls = 0;
+
+	TArray<FBBCCollider> Colliders;
+	/** Broadphase handle of each collider, INDEX_NONE while it is disabled. */
+	TArray<int32> ColliderHandles;
+	FBBCSpatialHash Broadphase;
+	/** Scratch buffer for broadphase candidates. */
+	mutable TArray<int32> BroadphaseCandidates;
+
+	TWeakObjectPtr<UBBCBrickFieldComponent> BrickField;
+	IBBCBrickSource* BrickSource = nullptr;
+
+	TWeakObjectPtr<ABBCPaddle> Paddle;
+	int32 PaddleColliderIndex = INDEX_NONE;
+	/** Left, right and top walls and the kill zone of the playfield layout. */
+	int32 BoundColliderIndices[4] = {INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE};
+	FVector2D PaddleStepDelta = FVector2D::ZeroVector;
+	/** Paddle velocity during the current step, added to balls bouncing off it. */
+	double PaddleStepVelocity = 0.0;
+	double LastPaddleX = 0.0;
+	/** Paddle displacement and velocity of each of this frame's steps. */
+	TArray<double, TInlineAllocator<MaxStepsPerFrame>> PaddleStepDeltas;
+	TArray<double, TInlineAllocator<MaxStepsPerFrame>> PaddleStepVelocities;
+
+	UPROPERTY()
+	TObjectPtr<UBBCGameEventSubsystem> GameEvents;
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BallInstances;
+	TArray<FTransform> InstanceTransforms;
+
+	struct FStuckBall
+	{
+		int32 BallHandle = INDEX_NONE;
+		/** Speed the ball leaves with. */
+		double Speed = 0.0;
+		uint64 ReleaseStep = 0;
+	};
+
+	double SpeedScale = 1.0;
+	double StickyHoldSeconds = 0.0;
+	/** Balls held on the paddle; their speed is 0 until released. */
+	TArray<FStuckBall> StuckBalls;
+
+	double Accumulator = 0.0;
+	uint64 StepCount = 0;
+	int64 CollisionCounts[static_cast<int32>(EBBCColliderType::Num)] = {};
+	double LastSimulationSeconds = 0.0;
+	double LastRenderSyncSeconds = 0.0;
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/Collision/BBCCollision.h"
+#include "BBCTrajectorySubsystem.generated.h"
+
+class UBBCBallSubsystem;
+struct FBBCBallLostEvent;
+struct FBBCBallRemovedEvent;
+struct FBBCBrickDestroyedEvent;
+struct FBBCBricksRestoredEvent;
+struct FBBCLevelStartedEvent;
+struct FBBCPlayfieldChangedEvent;
+
+/**
+ * One straight piece of a predicted ball path, from a bounce (or the ball) to the next contact.
+ */
+struct FBBCTrajectorySegment
+{
+	FVector2D Start = FVector2D::ZeroVector;
+	FVector2D End = FVector2D::ZeroVector;
+	FVector2D Direction = FVector2D::ZeroVector;
+	/** Direction after bouncing at End. */
+	FVector2D ReflectedDirection = FVector2D::ZeroVector;
+	/** Area swept by the ball along the segment. */
+	FBox2D Bounds = FBox2D(ForceInit);
+	/** Contact at End. */
+	FBBCSweepHit Hit;
+};
+
+/**
+ * Predicted path of one ball: up to MaxSegments segments, ending at the paddle or the kill zone when the ball
+ * reaches either within that many bounces.
+ */
+struct FBBCTrajectory
+{
+	TArray<FBBCTrajectorySegment, TInlineAllocator<8>> Segments;
+	double Radius = 0.0;
+	/** True once the path reaches the paddle, the kill zone or leaves every collider. */
+	bool bTerminated = false;
+	/** Set when the brick the first segment ends on was destroyed; the path holds only if the ball bounced off it. */
+	bool bFirstHitRemoved = false;
+
+	/** Where the ball meets the paddle or the kill zone, if the path gets there. */
+	bool GetLanding(FVector2D& OutLocation) const;
+};
+
+/**
+ * Predicts where balls go next, for the autopilot and the aim assist overlay.
+ *
+ * Paths are built by sweeping the ball's shape against the ball subsystem's colliders and brick field, and
+ * cached per ball. A query on a ball still travelling along its first segment only moves the segment start.
+ * When the ball bounced as predicted, the first segment is dropped. Only a deviating ball rebuilds from scratch.
+ *
+ * World changes invalidate the affected part of a path only. A destroyed brick truncates paths at the first
+ * segment that touches that brick, since everything before it is unchanged. A moved paddle truncates paths at the
+ * first segment crossing the area the paddle left or entered, usually only the last one. The dropped tail is rebuilt on the next query.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCTrajectorySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static constexpr int32 MaxSegments = 8;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Returns the cached path of a moving ball, updating it first if needed, or null for a ball at rest. */
+	const FBBCTrajectory* GetTrajectory(int32 BallHandle);
+	void InvalidateAll();
+	/** Truncates every path at its first segment crossing Area, for colliders that moved within it. */
+	void InvalidateArea(const FBox2D& Area);
+
+	/** Draws the cached path of every moving ball when BBC.Trajectory.Draw is set. */
+	void DrawOverlay();
+
+	int64 GetNumCacheHits() const { return NumCacheHits; }
+	int64 GetNumPartialRebuilds() const { return NumPartialRebuilds; }
+	int64 GetNumFullRebuilds() const { return NumFullRebuilds; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void SyncPaddle();
+	void Extend(FBBCTrajectory& Trajectory, FVector2D Position, FVector2D Direction) const;
+	static void Truncate(FBBCTrajectory& Trajectory, int32 FirstStaleSegment);
+	void HandleLevelStarted(const FBBCLevelStartedEvent& Event);
+	void HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event);
+	void HandleBallLost(const FBBCBallLostEvent& Event);
+	void HandleBallRemoved(const FBBCBallRemovedEvent& Event);
+	void HandleBricksRestored(const FBBCBricksRestoredEvent& Event);
+	void HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event);
+
+private:
+
+	UPROPERTY()
+	TObjectPtr<UBBCBallSubsystem> BallSubsystem;
+
+	TMap<int32, FBBCTrajectory> Trajectories;
+	/** Paddle collider the cached paths were built against. */
+	FBox2D PaddleBox = FBox2D(ForceInit);
+
+	int64 NumCacheHits = 0;
+	int64 NumPartialRebuilds = 0;
+	int64 NumFullRebuilds = 0;
+};
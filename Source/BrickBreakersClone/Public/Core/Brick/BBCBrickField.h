@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BBCBrickField.generated.h"
+
+class UBBCBrickFieldComponent;
+
+/**
+ * Places the level's brick wall. The actor location is the top left corner of the grid.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API ABBCBrickField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ABBCBrickField(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	UBBCBrickFieldComponent* GetBrickField() const { return BrickField; }
+
+private:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Bricks, meta=(AllowPrivateAccess = "true"))
+	UBBCBrickFieldComponent* BrickField;
+};
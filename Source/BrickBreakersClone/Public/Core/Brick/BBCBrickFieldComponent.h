@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Core/Brick/BBCBrickGrid.h"
+#include "Core/Collision/BBCCollisionBatch.h"
+#include "BBCBrickFieldComponent.generated.h"
+
+class FBBCLevelLayout;
+
+/**
+ * The whole brick wall of a level as a compact grid. Each cell stores its hit points in a byte and its
+ * alive state in a bitset, and every live brick is one instance of this component. Breaking a brick flips
+ * a bit and removes an instance; no actor is spawned or destroyed.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class BRICKBREAKERSCLONE_API UBBCBrickFieldComponent : public UHierarchicalInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UBBCBrickFieldComponent(const FObjectInitializer& ObjectInitializer);
+
+	/** Fills every cell with a brick of DefaultHitPoints and rebuilds the instances. */
+	void BuildField();
+
+	/** Takes the grid size, brick size and hit points of a cooked level and rebuilds the instances. */
+	void ApplyLayout(const FBBCLevelLayout& Layout);
+
+	/**
+	 * Sweeps a ball against the live bricks under its swept bounds. Only the cells overlapped by the sweep are
+	 * visited, so the cost depends on how far the ball moves, not on the size of the wall.
+	 */
+	bool SweepBall(const FVector2D& Start, const FVector2D& Delta, double Radius, double& OutTime, FVector2D& OutNormal, int32& OutCell) const;
+
+	/** Removes hit points from a brick. Returns true if the brick was destroyed. */
+	bool DamageCell(int32 Cell, uint8 Damage = 1);
+
+	/**
+	 * Bricks phase: runs a wave of explosions and regeneration on the brick grid, destroys the bricks it broke,
+	 * then removes the instances of every brick destroyed since the last call in one batch.
+	 */
+	void UpdateField(float DeltaTime);
+
+	/**
+	 * Shows exactly the given cells, for replay playback. Hit points are left untouched, so the field no longer
+	 * matches its grid until the next BuildField or ApplyLayout. Returns false if the cell count differs.
+	 */
+	bool ShowCells(const TBitArray<>& Cells);
+
+	bool IsCellAlive(int32 Cell) const { return AliveBits.IsValidIndex(Cell) && AliveBits[Cell]; }
+	const TBitArray<>& GetAliveBits() const { return AliveBits; }
+	FBox2D GetCellBox(int32 Cell) const;
+	FBox2D GetFieldBox() const;
+	int32 GetNumCells() const { return Columns * Rows; }
+	int32 GetNumAlive() const { return NumAlive; }
+	int32 GetColumns() const { return Columns; }
+	int32 GetRows() const { return Rows; }
+
+private:
+
+	void RebuildInstances();
+	void PublishRestored(const FBox2D& Area) const;
+	void DestroyCell(int32 Cell);
+	void FlushRemovedInstances();
+	FTransform GetCellTransform(int32 Cell) const;
+
+private:
+
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (ClampMin = "1", AllowPrivateAccess = "true"))
+	int32 Columns;
+
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (ClampMin = "1", AllowPrivateAccess = "true"))
+	int32 Rows;
+
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (AllowPrivateAccess = "true"))
+	FVector2D BrickSize;
+
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (ClampMin = "1", AllowPrivateAccess = "true"))
+	uint8 DefaultHitPoints;
+
+	/** Seconds for a damaged regenerating brick to regain one hit point. */
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (ClampMin = "0.01", AllowPrivateAccess = "true"))
+	float RegenSeconds;
+
+	/** Damage dealt by an exploding brick to each of its neighbours. */
+	UPROPERTY(EditAnywhere, Category = "Bricks", meta = (ClampMin = "1", AllowPrivateAccess = "true"))
+	uint8 ExplosionDamage;
+
+	/** Hit points and behaviour of every cell. */
+	FBBCBrickGrid Grid;
+	TArray<int32> GridDestroyed;
+	TBitArray<> AliveBits;
+	/** Instance drawing each cell, INDEX_NONE once the brick is gone. */
+	TArray<int32> CellToInstance;
+	TArray<int32> InstanceToCell;
+	/** Instances of destroyed bricks, still drawn until FlushRemovedInstances. */
+	TArray<int32> PendingInstanceRemovals;
+	int32 NumAlive;
+
+	/** Scratch batch reused by every sweep so ball queries never allocate once warmed up. */
+	mutable FBBCBoxBatch SweepCandidates;
+};
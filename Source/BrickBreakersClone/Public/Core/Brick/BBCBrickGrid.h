@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBBCBrickKind : uint8
+{
+	Normal,
+	/** Damages its eight neighbours when destroyed, which can chain into other explosive bricks. */
+	Explosive,
+	/** Regains one hit point every RegenSeconds while damaged. */
+	Regenerating
+};
+
+/**
+ * Per-cell brick behaviour of a brick field, kept apart from rendering so it can be updated off the game
+ * thread.
+ *
+ * Update runs one wave of the pipeline: explosions of the previous wave damage their neighbours and
+ * damaged regenerating bricks heal. The grid is split into square tiles processed by worker tasks. Every
+ * cell reads the current hit point and detonation buffers and writes only its own entry in the next
+ * buffers, and destroyed cells are collected per tile and merged in tile order, so the result is identical
+ * whatever the number of workers.
+ */
+class BRICKBREAKERSCLONE_API FBBCBrickGrid
+{
+public:
+
+	static constexpr int32 TileSize = 32;
+
+	/** Sizes the grid and copies the starting hit points and kinds. Kinds may be null for all normal bricks. */
+	void Init(int32 InColumns, int32 InRows, const uint8* InHitPoints, const uint8* InKinds);
+
+	/** Game thread damage, from a ball. Returns true if the brick was destroyed. */
+	bool Damage(int32 Cell, uint8 Amount);
+
+	/** True when an explosion is propagating or a damaged regenerating brick is healing. */
+	bool HasPendingWork() const { return NumDetonating > 0 || NumRegenerating > 0; }
+
+	/**
+	 * Runs one wave and swaps the buffers.
+	 *
+	 * @param DeltaTime Time since the last wave, for regeneration.
+	 * @param NumWorkers Number of tasks sharing the tiles; 1 runs inline.
+	 * @param OutDestroyed Cells destroyed by this wave, in cell order within each tile and tile order overall.
+	 */
+	void Update(float DeltaTime, int32 NumWorkers, TArray<int32>& OutDestroyed);
+
+	uint8 GetHitPoints(int32 Cell) const { return HitPoints[Cell]; }
+	int32 GetNumCells() const { return HitPoints.Num(); }
+	/** Checksum of the hit points, used to check that updates are deterministic. */
+	uint32 GetChecksum() const;
+
+	float RegenSeconds = 2.f;
+	uint8 ExplosionDamage = 1;
+
+private:
+
+	void UpdateTile(int32 Tile, float DeltaTime);
+
+	/** 1 if a regenerating brick with these hit points is alive and below full health, so it still heals. */
+	int32 IsHealing(int32 Cell, uint8 Health) const { return Health > 0 && Health < MaxHitPoints[Cell] ? 1 : 0; }
+
+private:
+
+	int32 Columns = 0;
+	int32 Rows = 0;
+	int32 TilesX = 0;
+	int32 NumTiles = 0;
+
+	TArray<uint8> HitPoints;
+	TArray<uint8> NextHitPoints;
+	TArray<uint8> Detonating;
+	TArray<uint8> NextDetonating;
+	TArray<uint8> MaxHitPoints;
+	TArray<uint8> Kinds;
+	TArray<float> RegenTimers;
+
+	/** Destroyed cells per tile for the running wave, kept allocated between waves. */
+	TArray<TArray<int32>> TileDestroyed;
+	/** Change in NumRegenerating per tile for the running wave, summed after the workers finish. */
+	TArray<int32> TileRegenDelta;
+
+	int32 NumDetonating = 0;
+	/** Regenerating bricks that are alive and damaged. Bricks at full health have nothing to do. */
+	int32 NumRegenerating = 0;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+
+/**
+ * What a ball should do after touching a collider.
+ */
+enum class EBBCColliderType : uint8
+{
+	Wall,
+	KillZone,
+	Paddle,
+	Brick,
+
+	Num
+};
+
+/**
+ * Axis aligned box on the gameplay plane (XY) the ball can bounce off.
+ */
+struct FBBCCollider
+{
+	FBox2D Box = FBox2D(ForceInit);
+	EBBCColliderType Type = EBBCColliderType::Wall;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	bool bEnabled = true;
+};
+
+/**
+ * Bricks kept outside the ball subsystem's colliders and brick field, such as the chunks of the endless mode.
+ * Cells are ids chosen by the source.
+ */
+class IBBCBrickSource
+{
+public:
+	virtual ~IBBCBrickSource() = default;
+
+	/** Earliest contact of a ball swept by Delta from Start with a live brick of the source. */
+	virtual bool SweepBall(const FVector2D& Start, const FVector2D& Delta, double Radius, double& OutTime, FVector2D& OutNormal, int32& OutCell) const = 0;
+	/** Removes hit points from a brick. Returns true if the brick was destroyed. */
+	virtual bool DamageCell(int32 Cell, uint8 Damage = 1) = 0;
+	virtual FBox2D GetCellBox(int32 Cell) const = 0;
+};
+
+/**
+ * Earliest contact found while sweeping a ball over one fixed step.
+ */
+struct FBBCSweepHit
+{
+	/** Fraction of the swept delta at which contact happens, in [0, 1]. */
+	double Time = 1.0;
+	FVector2D Normal = FVector2D::ZeroVector;
+	int32 ColliderIndex = INDEX_NONE;
+	/** Grid cell when the contact is with the brick field or a brick source rather than a collider. */
+	int32 BrickCell = INDEX_NONE;
+	/** Owner of BrickCell when it is not the brick field. */
+	IBBCBrickSource* BrickSource = nullptr;
+	EBBCColliderType Type = EBBCColliderType::Wall;
+};
+
+namespace BBCCollision
+{
+	/**
+	 * Analytic swept circle versus box test. The box is grown by the radius (Minkowski sum) and the
+	 * rounded corners are resolved against a circle so grazing shots at corners are not over-reported.
+	 * Returns false when the circle already overlaps the box at the start of the sweep.
+	 */
+	BRICKBREAKERSCLONE_API bool SweepCircleAABB(const FVector2D& Start, const FVector2D& Delta, double Radius,
+		const FBox2D& Box, double& OutTime, FVector2D& OutNormal);
+
+	/** Mirrors a direction about a surface normal, only when the direction is heading into the surface. */
+	FORCEINLINE FVector2D Reflect(const FVector2D& Direction, const FVector2D& Normal)
+	{
+		const double Dot = FVector2D::DotProduct(Direction, Normal);
+		return Dot < 0.0 ? Direction - Normal * (2.0 * Dot) : Direction;
+	}
+
+	FORCEINLINE FBox2D ToBox2D(const FBox& Box)
+	{
+		return FBox2D(FVector2D(Box.Min.X, Box.Min.Y), FVector2D(Box.Max.X, Box.Max.Y));
+	}
+}
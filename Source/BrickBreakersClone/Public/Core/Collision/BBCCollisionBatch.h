@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Boxes laid out as separate coordinate arrays so four of them can be loaded into one vector register.
+ * The arrays are always padded to a multiple of four with boxes that can never be hit.
+ */
+struct FBBCBoxBatch
+{
+	static constexpr int32 LaneCount = 4;
+
+	TArray<float, TAlignedHeapAllocator<16>> MinX;
+	TArray<float, TAlignedHeapAllocator<16>> MinY;
+	TArray<float, TAlignedHeapAllocator<16>> MaxX;
+	TArray<float, TAlignedHeapAllocator<16>> MaxY;
+	TArray<int32> Ids;
+
+	int32 Num() const { return Ids.Num(); }
+	int32 NumPadded() const { return MinX.Num(); }
+
+	/** Empties the batch without releasing memory. */
+	void Reset();
+	/** Adds a box expressed relative to Origin, which keeps float precision high near the swept ball. */
+	void Add(const FBox2D& Box, const FVector2D& Origin, int32 Id);
+	/** Pads the coordinate arrays up to the next multiple of LaneCount. */
+	void Finalize();
+};
+
+/**
+ * Earliest contact found by a batched sweep.
+ */
+struct FBBCBatchHit
+{
+	float Time = 1.f;
+	FVector2f Normal = FVector2f::ZeroVector;
+	/** Id of the box passed to FBBCBoxBatch::Add. */
+	int32 Id = INDEX_NONE;
+};
+
+namespace BBCCollision
+{
+	/**
+	 * Swept circle versus every box in the batch, four boxes per vector instruction. The circle starts at the
+	 * batch origin. Grown-box slab entry and rounded-corner refinement are both evaluated for all lanes, so the
+	 * result matches SweepCircleAABB without a per-box branch.
+	 */
+	BRICKBREAKERSCLONE_API bool SweepCircleBoxBatch(const FVector2f& Delta, float Radius, const FBBCBoxBatch& Boxes, FBBCBatchHit& OutHit);
+
+	/** Scalar reference for SweepCircleBoxBatch; same math, one box at a time. */
+	BRICKBREAKERSCLONE_API bool SweepCircleBoxBatchScalar(const FVector2f& Delta, float Radius, const FBBCBoxBatch& Boxes, FBBCBatchHit& OutHit);
+
+	/**
+	 * Runs Iterations random sweeps against random walls through both kernels. Returns the number of sweeps
+	 * whose results disagree; OutHits counts the sweeps that hit.
+	 */
+	BRICKBREAKERSCLONE_API int32 VerifyBoxBatchKernel(int32 Iterations, int32 Seed, int32& OutHits);
+}
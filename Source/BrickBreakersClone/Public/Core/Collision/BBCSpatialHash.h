@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid broadphase on the gameplay plane (XY). Every object is stored in each cell its bounds
+ * overlap; cells are hashed by their integer coordinates so the grid is unbounded and only occupied cells
+ * cost memory.
+ *
+ * Objects are addressed by a stable handle. Moving an object only touches the buckets of the cells it
+ * enters or leaves, so objects that stay within their cells cost a bounds copy. A bucket emptied by a move or
+ * removal is kept with its allocation, so an object sweeping back and forth over the same cells, like the
+ * paddle, never reallocates; on a bounded playfield the number of buckets stays bounded too.
+ *
+ * Queries are stateless: an object overlapping several cells of a query is only reported from the first
+ * cell the object and the query share, so no visited marks are kept and const queries can run concurrently.
+ */
+class BRICKBREAKERSCLONE_API FBBCSpatialHash
+{
+public:
+
+	explicit FBBCSpatialHash(double InCellSize = 64.0);
+
+	/** Adds an object and returns its handle. UserData is handed back by GetUserData. */
+	int32 Insert(const FBox2D& Bounds, int32 UserData);
+	void Move(int32 Handle, const FBox2D& Bounds);
+	void Remove(int32 Handle);
+	/** Removes every object and sets a new cell size. */
+	void Reset(double InCellSize);
+
+	/** Appends the handles of the objects whose bounds overlap Box. Each handle is appended once. */
+	void Query(const FBox2D& Box, TArray<int32>& OutHandles) const;
+
+	/**
+	 * Runs one query per box into a single output buffer. The handles of query I are
+	 * OutHandles[OutOffsets[I] .. OutOffsets[I + 1]), so OutOffsets has Boxes.Num() + 1 entries.
+	 */
+	void QueryBatch(TConstArrayView<FBox2D> Boxes, TArray<int32>& OutHandles, TArray<int32>& OutOffsets) const;
+
+	bool IsValidHandle(int32 Handle) const { return Entries.IsValidIndex(Handle) && Entries[Handle].bUsed; }
+	const FBox2D& GetBounds(int32 Handle) const { return Entries[Handle].Bounds; }
+	int32 GetUserData(int32 Handle) const { return Entries[Handle].UserData; }
+	int32 Num() const { return Entries.Num() - FreeHandles.Num(); }
+	int32 GetNumOccupiedCells() const { return NumOccupiedCells; }
+	double GetCellSize() const { return CellSize; }
+
+private:
+
+	struct FEntry
+	{
+		FBox2D Bounds = FBox2D(ForceInit);
+		/** Inclusive range of cells covered by Bounds. */
+		FIntPoint MinCell = FIntPoint::ZeroValue;
+		FIntPoint MaxCell = FIntPoint::ZeroValue;
+		int32 UserData = INDEX_NONE;
+		bool bUsed = false;
+	};
+
+	static uint64 GetCellKey(int32 X, int32 Y) { return (static_cast<uint64>(static_cast<uint32>(X)) << 32) | static_cast<uint32>(Y); }
+	void GetCellRange(const FBox2D& Box, FIntPoint& OutMin, FIntPoint& OutMax) const;
+	/** Adds Handle to the cells of [MinCell, MaxCell], except those inside [SkipMin, SkipMax]. */
+	void AddToCells(int32 Handle, const FIntPoint& MinCell, const FIntPoint& MaxCell, const FIntPoint& SkipMin = FIntPoint(1, 1), const FIntPoint& SkipMax = FIntPoint(0, 0));
+	/** Removes Handle from the cells of [MinCell, MaxCell], except those inside [SkipMin, SkipMax]. */
+	void RemoveFromCells(int32 Handle, const FIntPoint& MinCell, const FIntPoint& MaxCell, const FIntPoint& SkipMin = FIntPoint(1, 1), const FIntPoint& SkipMax = FIntPoint(0, 0));
+
+private:
+
+	double CellSize;
+	double InvCellSize;
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeHandles;
+	/** Handles of the objects overlapping each cell that has been occupied; emptied buckets are kept. */
+	TMap<uint64, TArray<int32>> Buckets;
+	int32 NumOccupiedCells = 0;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BBCCookLevelsCommandlet.generated.h"
+
+/**
+ * Cooks the CSV sources in Content/Levels into the .bbclevel files the game loads. Run it after editing a level
+ * and before packaging, which stages the cooked files as they are:
+ *
+ *     UnrealEditor-Cmd BrickBreakersClone.uproject -run=BBCCookLevels [-Level=<Name>]
+ *
+ * Without -Level every source in the directory is cooked.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCCookLevelsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UBBCCookLevelsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
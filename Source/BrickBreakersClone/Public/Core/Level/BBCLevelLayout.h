@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Header of a cooked level. The file is this header followed by Columns * Rows hit point bytes in row
+ * major order, top row first; a zero cell is empty. With FlagHasKinds a second plane of Columns * Rows
+ * EBBCBrickKind bytes follows.
+ */
+struct FBBCLevelHeader
+{
+	static constexpr uint32 Magic = 0x4C434242; // "BBCL"
+	static constexpr uint16 Version = 1;
+	static constexpr uint16 FlagHasKinds = 1 << 0;
+
+	uint32 FileMagic;
+	uint16 FileVersion;
+	uint16 Flags;
+	int32 Columns;
+	int32 Rows;
+	float BrickWidth;
+	float BrickHeight;
+};
+
+/**
+ * A cooked brick layout kept as the raw file bytes. Accessors read the header and cells in place, so loading
+ * is one file read and a size check, with no parsing.
+ */
+class BRICKBREAKERSCLONE_API FBBCLevelLayout
+{
+public:
+
+	/** Takes ownership of a cooked blob. Returns false, and leaves the layout empty, if the blob is malformed. */
+	bool Initialize(TArray<uint8>&& InBlob);
+
+	bool IsValid() const { return Blob.Num() > 0; }
+	const FBBCLevelHeader& GetHeader() const { return *reinterpret_cast<const FBBCLevelHeader*>(Blob.GetData()); }
+	const uint8* GetHitPoints() const { return Blob.GetData() + sizeof(FBBCLevelHeader); }
+	/** Brick kinds, or null if every brick of the level is a normal one. */
+	const uint8* GetKinds() const { return (GetHeader().Flags & FBBCLevelHeader::FlagHasKinds) != 0 ? GetHitPoints() + GetNumCells() : nullptr; }
+	int32 GetNumCells() const { return GetHeader().Columns * GetHeader().Rows; }
+	FVector2D GetBrickSize() const { return FVector2D(GetHeader().BrickWidth, GetHeader().BrickHeight); }
+	int32 CountBricks() const;
+
+private:
+
+	TArray<uint8> Blob;
+};
+
+namespace BBCLevel
+{
+	/** Content/Levels/<Name>.csv, the editable source of a level. */
+	BRICKBREAKERSCLONE_API FString GetSourcePath(const FString& Name);
+
+	/** Content/Levels/<Name>.bbclevel, the cooked level loaded at runtime. */
+	BRICKBREAKERSCLONE_API FString GetCookedPath(const FString& Name);
+
+	/**
+	 * Cooks a CSV grid into a level blob. Every non-comment line is a row of hit points separated by commas;
+	 * a hit point value may end with 'x' for an explosive brick or 'r' for a regenerating one. An optional
+	 * "size,<Width>,<Height>" line sets the brick size. Lines starting with '#' are ignored.
+	 */
+	BRICKBREAKERSCLONE_API bool CookFromCsv(const FString& Csv, TArray<uint8>& OutBlob, FString& OutError);
+
+	/** Cooks the CSV source of a level into its cooked file. Used by UBBCCookLevelsCommandlet. */
+	BRICKBREAKERSCLONE_API bool CookLevel(const FString& Name, FString& OutError);
+
+	/**
+	 * Cooks a level of NumBricks one hit point bricks packed row by row into a roughly 2:1 grid that covers
+	 * FieldSize. Used by the performance scenarios, which need walls of a given size rather than authored ones.
+	 */
+	BRICKBREAKERSCLONE_API void CookUniform(int32 NumBricks, const FVector2D& FieldSize, TArray<uint8>& OutBlob);
+
+	/**
+	 * Loads a cooked level by name with a single file read. Never writes; cooked files are produced by
+	 * UBBCCookLevelsCommandlet and committed next to their sources.
+	 */
+	BRICKBREAKERSCLONE_API bool LoadLevel(const FString& Name, FBBCLevelLayout& OutLayout);
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "BBCLevelSubsystem.generated.h"
+
+class FBBCLevelLayout;
+class UBBCBrickFieldComponent;
+struct FBBCLevelCompletedEvent;
+
+/**
+ * Plays the brick layouts listed in the Levels config array in order, looping at the end.
+ *
+ * Layouts are read on a worker thread: the first one as soon as the world is created, so it is usually
+ * ready by ABBCGameMode::StartPlay, and each following one while the current level is played, so advancing
+ * only copies the hit points into the brick field. A level that fails to load is logged and the current
+ * level is played again instead.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCLevelSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Applies the first level to the brick field. Returns false if no level is configured or it failed to load. */
+	bool StartFirstLevel(UBBCBrickFieldComponent* BrickField);
+
+	int32 GetCurrentLevel() const { return CurrentLevel; }
+	int32 GetNumLevels() const { return Levels.Num(); }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void StartLoading(int32 LevelIndex);
+	TSharedPtr<FBBCLevelLayout> FinishLoading();
+	bool ApplyLevel(int32 LevelIndex);
+	void HandleLevelCompleted(const FBBCLevelCompletedEvent& Event);
+	void AdvanceLevel();
+
+private:
+
+	/** Level names, loaded from Content/Levels/<Name>.bbclevel. */
+	UPROPERTY(Config)
+	TArray<FString> Levels;
+
+	int32 CurrentLevel = INDEX_NONE;
+	int32 LoadingLevel = INDEX_NONE;
+	/** Layout of the current level, replayed when the next one fails to load. */
+	TSharedPtr<FBBCLevelLayout> CurrentLayout;
+	UE::Tasks::TTask<TSharedPtr<FBBCLevelLayout>> LoadTask;
+
+	TWeakObjectPtr<UBBCBrickFieldComponent> BrickField;
+	FDelegateHandle LevelCompletedHandle;
+};
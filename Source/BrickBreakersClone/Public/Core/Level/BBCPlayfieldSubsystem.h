@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCPlayfieldSubsystem.generated.h"
+
+class ABBCCamera;
+class ABBCPaddle;
+class FViewport;
+
+/**
+ * Arena geometry on the gameplay plane. +Y points down the screen, towards the paddle.
+ *
+ * The defaults describe the arena the game was laid out for, so code that runs before the first layout (class
+ * default objects, a world without a camera) still places things where they used to be.
+ */
+struct FBBCPlayfieldLayout
+{
+	/** Area seen by the camera; all of it is in play. */
+	FBox2D Arena = FBox2D(FVector2D(-500.0, -500.0), FVector2D(500.0, 500.0));
+	/** Walls just outside the left, right and top edges of the arena. */
+	FBox2D LeftWall = FBox2D(FVector2D(-520.0, -520.0), FVector2D(-500.0, 500.0));
+	FBox2D RightWall = FBox2D(FVector2D(500.0, -520.0), FVector2D(520.0, 500.0));
+	FBox2D TopWall = FBox2D(FVector2D(-520.0, -520.0), FVector2D(520.0, -500.0));
+	/** Just outside the bottom edge of the arena. */
+	FBox2D KillZone = FBox2D(FVector2D(-520.0, 500.0), FVector2D(520.0, 520.0));
+	/** Upper part of the arena, where a brick wall leaves the ball room to come back to the paddle. */
+	FBox2D BrickArea = FBox2D(FVector2D(-500.0, -500.0), FVector2D(500.0, -65.0));
+	/** Range of the paddle actor's X; narrower than the arena by the paddle's extent on each side. */
+	double PaddleMinX = -400.0;
+	double PaddleMaxX = 400.0;
+	/** Y of the paddle actor, PaddleLaneOffset above the bottom edge of the arena. */
+	double PaddleLaneY = 400.0;
+	FVector2D BallSpawn = FVector2D(0.0, 370.0);
+	/** Incremented by every recompute. */
+	int32 Revision = 0;
+};
+
+/**
+ * Computes the arena once from the camera and the paddle, places the paddle, and shares the layout as plain data.
+ *
+ * The arena is the rectangle the orthographic camera sees, from its ortho width and the viewport's aspect
+ * ratio. Walls of WallThickness lie just outside its sides and top and the kill zone just outside its bottom,
+ * the paddle lane lies PaddleLaneOffset above the bottom edge and the ball spawns BallSpawnAboveLane above it.
+ * The paddle is moved onto the lane at every recompute. The paddle clamp,
+ * ball spawns and the ball subsystem's wall colliders all read the same layout, so they agree at any resolution.
+ *
+ * The layout is computed when ABBCGameMode hands over the camera and paddle, and again only when the game
+ * viewport is resized. Every recompute publishes FBBCPlayfieldChangedEvent.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCPlayfieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Sets what the layout is computed from and computes it. */
+	void SetSources(ABBCCamera* InCamera, ABBCPaddle* InPaddle);
+	/** Uses a fixed arena instead of the camera's view, for runs without a viewport. */
+	void SetArenaOverride(const FBox2D& InArena);
+
+	const FBBCPlayfieldLayout& GetLayout() const { return Layout; }
+
+	/** Layout of the world of WorldContextObject, or the default layout when there is none. */
+	static const FBBCPlayfieldLayout& GetLayout(const UObject* WorldContextObject);
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void Recompute();
+	void HandleViewportResized(FViewport* Viewport, uint32 Unused);
+
+private:
+
+	UPROPERTY(Config)
+	double WallThickness = 20.0;
+
+	/** Distance from the bottom edge of the arena up to the paddle lane. */
+	UPROPERTY(Config)
+	double PaddleLaneOffset = 100.0;
+
+	/** Distance from the paddle lane up to the centre of a ball waiting to launch. */
+	UPROPERTY(Config)
+	double BallSpawnAboveLane = 30.0;
+
+	/** Fraction of the space between the top of the arena and the ball spawn given to bricks. */
+	UPROPERTY(Config)
+	double BrickAreaFraction = 0.5;
+
+	TWeakObjectPtr<ABBCCamera> Camera;
+	TWeakObjectPtr<ABBCPaddle> Paddle;
+	TOptional<FBox2D> ArenaOverride;
+	/** Set when a new paddle is handed over, which starts in the middle of the lane instead of keeping its X. */
+	bool bCentrePaddle = false;
+	FBBCPlayfieldLayout Layout;
+	FDelegateHandle ViewportResizedHandle;
+};
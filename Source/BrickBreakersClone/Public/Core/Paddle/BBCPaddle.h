@@ -4,13 +4,24 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "Input/BBCInputLatency.h"
 #include "BBCPaddle.generated.h"
 
 class ABBCPlayerController;
+class UBBCBallSubsystem;
 struct FInputActionValue;
 class UInputAction;
 class UInputMappingContext;
 
+/**
+ * A move axis sample, stamped with the time it arrived.
+ */
+struct FBBCPaddleInputSample
+{
+	double Seconds = 0.0;
+	float Axis = 0.f;
+};
+
 UCLASS()
 class BRICKBREAKERSCLONE_API ABBCPaddle : public APawn
 {
@@ -24,17 +35,45 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
 
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
-	void SetMaxBoundaryLength(float Value);
-	
 	float GetPaddleVelocity() const {return Velocity; }
 
+	FBox GetPaddleBounds() const;
+
+	/** Adds a timestamped move sample for the next Input phase. Used by player input and by the autopilot alike. */
+	void AddMoveInput(float Axis);
+	/** Input phase: takes the move samples received since the last frame. */
+	void LatchInput();
+	/**
+	 * Paddle phase: integrates the paddle over the fixed steps the ball subsystem is about to run this frame,
+	 * applying each latched sample to its share of the steps, and records the position and velocity of every step.
+	 */
+	void TickMovement(float DeltaTime);
+
+	/** Paddle X at the start of each of this frame's steps, plus the end of the last one. Empty if it did not step. */
+	TConstArrayView<double> GetStepPositions() const { return StepPositions; }
+	/** Paddle velocity during each of this frame's steps. */
+	TConstArrayView<float> GetStepVelocities() const { return StepVelocities; }
+
+	const FBBCInputLatency& GetInputLatency() const { return InputLatency; }
+	FBBCInputLatency& GetInputLatency() { return InputLatency; }
+
+	const UInputAction* GetMoveInputAction() const { return MoveInputAction; }
+	/** Move input latched by the last Input phase, in [-1, 1]. */
+	float GetInputDirection() const { return InputDirection; }
+
+	/** Widens the paddle by Multiplier around its centre, keeping it inside the arena. 1 is the tuned width. */
+	void SetWidthMultiplier(double Multiplier);
+	double GetWidthMultiplier() const { return WidthMultiplier; }
+	/** Half width the paddle has beyond its tuned width. */
+	double GetExtraHalfWidth() const { return ExtraHalfWidth; }
+
 private:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite,Category = Input ,meta=(AllowPrivateAccess = "true"))
@@ -49,17 +88,26 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Scene, meta=(AllowPrivateAccess = "true"))
 	USceneComponent* PaddleSceneComponent;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Movement", meta = (ClampMin = "0.0", AllowPrivateAccess = "true"))
-	float MovementSpeed;
-	
 	UPROPERTY()
 	ABBCPlayerController* BBCPlayerController;
 	UPROPERTY()
 	float InputDirection;
 	UPROPERTY()
+	float PendingInputDirection;
+	UPROPERTY()
 	float Velocity;
-	UPROPERTY(VisibleAnywhere)
-	float MaxBoundaryLength;
+	UPROPERTY()
+	TObjectPtr<UBBCBallSubsystem> BallSubsystem;
+
+	TArray<FBBCPaddleInputSample, TInlineAllocator<4>> PendingSamples;
+	/** Samples not consumed by a step yet; kept across frames that run no step. */
+	TArray<FBBCPaddleInputSample, TInlineAllocator<4>> InputSamples;
+	TArray<double, TInlineAllocator<17>> StepPositions;
+	TArray<float, TInlineAllocator<16>> StepVelocities;
+	FBBCInputLatency InputLatency;
+	double WidthMultiplier = 1.0;
+	/** Half width added by WidthMultiplier, taken off both ends of the playfield layout's paddle range. */
+	double ExtraHalfWidth = 0.0;
 
 private:
 	
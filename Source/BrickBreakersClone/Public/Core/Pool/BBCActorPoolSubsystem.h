@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "BBCActorPoolSubsystem.generated.h"
+
+/**
+ * Inactive actors of one class and the pool's hit and miss counts.
+ */
+USTRUCT()
+struct FBBCActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Free;
+
+	/** The actors in Free, so releasing an actor that is already parked is caught without a linear scan. */
+	TSet<TObjectKey<AActor>> FreeSet;
+
+	int32 NumActive = 0;
+	int64 Hits = 0;
+	int64 Misses = 0;
+};
+
+/**
+ * Recycles gameplay actors instead of spawning and destroying them. Pools are filled at level load with
+ * Prewarm; Acquire then hands out a pooled actor and Release hides it and puts it back, so bursts such as
+ * multiball never go through SpawnActor, Destroy or the garbage collector. An empty pool falls back to
+ * spawning and counts a miss, which the stats report so pool sizes can be tuned.
+ *
+ * Actors implementing IBBCPoolable are told when they are handed out and returned.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Spawns inactive actors until the pool for Class holds at least Count of them. */
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	AActor* Acquire(TSubclassOf<AActor> Class, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	template <typename T>
+	T* Acquire(const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator)
+	{
+		return Cast<T>(Acquire(T::StaticClass(), Location, Rotation));
+	}
+
+	void Release(AActor* Actor);
+
+	const FBBCActorPool* FindPool(TSubclassOf<AActor> Class) const { return Pools.Find(Class.Get()); }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	AActor* SpawnPooledActor(UClass* Class);
+	static void Deactivate(AActor* Actor);
+
+private:
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FBBCActorPool> Pools;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "BBCPoolable.generated.h"
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UBBCPoolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Hooks for actors handed out by UBBCActorPoolSubsystem. The pool already hides the actor and turns off its
+ * collision and tick; these hooks reset gameplay state on top of that.
+ */
+class BRICKBREAKERSCLONE_API IBBCPoolable
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Called after the actor has been placed and shown, before it is returned to the caller. */
+	virtual void OnAcquiredFromPool() {}
+
+	/** Called before the actor is hidden and put back in the pool. */
+	virtual void OnReturnedToPool() {}
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCTickManagerSubsystem.generated.h"
+
+class ABBCAutopilotController;
+class ABBCGameState;
+class ABBCPaddle;
+class UBBCBrickFieldComponent;
+class UBBCStateReplaySubsystem;
+
+enum class EBBCTickPhase : uint8
+{
+	Input,
+	Paddle,
+	Balls,
+	Bricks,
+	GameState,
+	Num
+};
+
+/** Where a subsystem update runs within its phase, relative to the registered actors of that phase. */
+enum class EBBCTickOrder : uint8
+{
+	BeforeActors,
+	AfterActors,
+	Num
+};
+
+/** Per-frame update of a subsystem, called with the frame's delta time. */
+DECLARE_DELEGATE_OneParam(FBBCTickUpdate, float);
+
+/**
+ * Runs all gameplay updates from a single tick in a fixed order: input, paddle, balls, bricks, then game
+ * state. Gameplay actors do not tick themselves; they register here and each phase is a plain loop over
+ * the registered objects of one type, which replaces one tick function dispatch per actor with one per
+ * frame and makes the update order explicit.
+ *
+ * Subsystems register their own update under a phase from Initialize, before or after the actors of that
+ * phase. Updates in the same slot run in registration order, so a subsystem that must run after another
+ * takes it as an initialization dependency before registering.
+ *
+ * While a state replay is being viewed the phases do not run; the replay viewer advances instead.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCTickManagerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Runs Update every frame in the given phase. The update is dropped once its object is destroyed. */
+	void RegisterUpdate(EBBCTickPhase Phase, EBBCTickOrder Order, FBBCTickUpdate Update);
+	/** Removes every update bound to Object, keeping the order of the others. */
+	void UnregisterUpdates(const UObject* Object);
+
+	void RegisterAutopilot(ABBCAutopilotController* Autopilot);
+	void UnregisterAutopilot(ABBCAutopilotController* Autopilot);
+	void RegisterPaddle(ABBCPaddle* Paddle);
+	void UnregisterPaddle(ABBCPaddle* Paddle);
+	void RegisterBrickField(UBBCBrickFieldComponent* BrickField);
+	void UnregisterBrickField(UBBCBrickFieldComponent* BrickField);
+	void RegisterGameState(ABBCGameState* GameState);
+	void UnregisterGameState(ABBCGameState* GameState);
+
+	/** Time spent in a phase during the last frame. */
+	double GetLastPhaseSeconds(EBBCTickPhase Phase) const { return LastPhaseSeconds[static_cast<int32>(Phase)]; }
+	static const TCHAR* GetPhaseName(EBBCTickPhase Phase);
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void TickInput();
+	void TickPaddles(float DeltaTime);
+	void TickBricks(float DeltaTime);
+	void TickGameStates();
+	void RunUpdates(EBBCTickPhase Phase, EBBCTickOrder Order, float DeltaTime);
+
+private:
+
+	UPROPERTY()
+	TObjectPtr<UBBCStateReplaySubsystem> StateReplaySubsystem;
+
+	TArray<FBBCTickUpdate> Updates[static_cast<int32>(EBBCTickPhase::Num)][static_cast<int32>(EBBCTickOrder::Num)];
+
+	TArray<TWeakObjectPtr<ABBCAutopilotController>> Autopilots;
+	TArray<TWeakObjectPtr<ABBCPaddle>> Paddles;
+	TArray<TWeakObjectPtr<UBBCBrickFieldComponent>> BrickFields;
+	TArray<TWeakObjectPtr<ABBCGameState>> GameStates;
+
+	double LastPhaseSeconds[static_cast<int32>(EBBCTickPhase::Num)] = {};
+};
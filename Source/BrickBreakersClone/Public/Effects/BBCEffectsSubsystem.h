@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCEffectsSubsystem.generated.h"
+
+class UAudioComponent;
+class UParticleSystemComponent;
+struct FBBCBrickDestroyedEvent;
+
+/**
+ * Running totals of the effects subsystem since the world started.
+ */
+struct FBBCEffectCounters
+{
+	/** Brick breaks that asked for an effect. */
+	int64 Requested = 0;
+	/** Effects played; one effect may stand for several merged requests. */
+	int64 Spawned = 0;
+	/** Requests folded into a nearby effect of the same frame. */
+	int64 Merged = 0;
+	/** Effects played with the reduced effect because the budget was under pressure. */
+	int64 Reduced = 0;
+	/** Requests dropped: over the frame budget, or no free pooled component. */
+	int64 Culled = 0;
+	int64 Sounds = 0;
+};
+
+/**
+ * Plays the brick break effects and sounds within a per-frame budget, from pools of components created once.
+ *
+ * Every FBBCBrickDestroyedEvent queues a request. Once per frame, from the Bricks phase of
+ * UBBCTickManagerSubsystem, the queued requests are merged into bursts: a request within MergeRadius of a burst
+ * of the same frame joins it. At most EffectsPerFrame bursts play and the rest are culled, so a chain reaction
+ * breaking hundreds of bricks in one frame costs the same as a dozen breaks. When the frame asked for more than
+ * PressureRequests or most of the pool is still playing, bursts use the reduced break effect and only one sound
+ * plays, louder for the bricks it stands for.
+ *
+ * With -BBCFxStub, or without a renderer (-nullrhi), no component is created and the budget, merging and pool
+ * occupancy run exactly as they would with components, so the headless harness measures the same counters.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Queues a break effect at Location, played by the next Flush. */
+	void RequestBreak(const FVector2D& Location);
+
+	/** Merges, budgets and plays the requests queued since the last call. */
+	void Flush();
+
+	bool IsStubbed() const { return bStubbed; }
+	const FBBCEffectCounters& GetCounters() const { return Counters; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FBurst
+	{
+		FVector2D Location = FVector2D::ZeroVector;
+		int32 Count = 0;
+	};
+
+	void CreatePool();
+	int32 AcquireSlot(TArray<double>& FreeSeconds, double Now, double Lifetime) const;
+	int32 GetNumBusy(const TArray<double>& FreeSeconds, double Now) const;
+	void HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event);
+
+private:
+
+	/** Bursts played per frame at most. */
+	UPROPERTY(Config)
+	int32 EffectsPerFrame = 12;
+
+	/** Sounds started per frame at most, while not under pressure. */
+	UPROPERTY(Config)
+	int32 SoundsPerFrame = 4;
+
+	/** Requests in one frame above which the budget is under pressure. */
+	UPROPERTY(Config)
+	int32 PressureRequests = 6;
+
+	/** Distance within which requests of one frame merge into a single burst. */
+	UPROPERTY(Config)
+	double MergeRadius = 60.0;
+
+	/** Requests queued per frame at most; requests beyond it are culled straight away. */
+	UPROPERTY(Config)
+	int32 MaxPendingRequests = 256;
+
+	UPROPERTY(Config)
+	int32 ParticlePoolSize = 32;
+
+	UPROPERTY(Config)
+	int32 AudioPoolSize = 8;
+
+	/** Time a pooled component stays reserved after it started playing. */
+	UPROPERTY(Config)
+	double EffectLifetime = 1.0;
+
+	UPROPERTY(Config)
+	double SoundLifetime = 1.5;
+
+	bool bStubbed = false;
+	FBBCEffectCounters Counters;
+
+	/** Request locations queued this frame, and the bursts they merge into; both reserved once. */
+	TArray<FVector2D> Pending;
+	TArray<FBurst> Bursts;
+	int32 NumRequestedThisFrame = 0;
+
+	/** World time at which each pooled slot is free again; the pools' components share their indices. */
+	TArray<double> ParticleFreeSeconds;
+	TArray<double> AudioFreeSeconds;
+
+	UPROPERTY()
+	TObjectPtr<AActor> PoolActor;
+	UPROPERTY()
+	TArray<TObjectPtr<UParticleSystemComponent>> ParticleComponents;
+	UPROPERTY()
+	TArray<TObjectPtr<UAudioComponent>> AudioComponents;
+};
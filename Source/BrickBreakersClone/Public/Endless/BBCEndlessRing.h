@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Collision/BBCCollision.h"
+#include "Core/Collision/BBCCollisionBatch.h"
+
+/**
+ * Generation settings of the endless ring, fixed for a session.
+ */
+struct FBBCEndlessSettings
+{
+	int32 NumChunks = 4;
+	int32 ChunkRows = 6;
+	int32 Columns = 10;
+	FVector2D BrickSize = FVector2D(60.0, 24.0);
+	int32 Seed = 0;
+	/** Chance of each cell holding a brick. */
+	float FillChance = 0.6f;
+	uint8 MaxHitPoints = 3;
+	/** Chunks generated before the strongest brick gains a hit point. */
+	int32 ChunksPerHitPoint = 8;
+};
+
+/**
+ * Bricks of the endless mode, held in a fixed ring of chunks of ChunkRows x Columns cells.
+ *
+ * The hit points of every chunk live in one arena allocated by Init, and a chunk is addressed by its slot in
+ * that arena. Chunk number Sequence is generated from the seed and its number alone, so the stream of rows is
+ * the same on every run with the same seed. The ring scrolls down; once the bottom chunk has left, its slot is
+ * generated again as the next chunk above the top one. Nothing is allocated after Init, so memory stays flat
+ * however long the session runs.
+ *
+ * Cells are ids Slot * CellsPerChunk + Row * Columns + Column, with row 0 at the top of the chunk.
+ */
+class BRICKBREAKERSCLONE_API FBBCEndlessRing final : public IBBCBrickSource
+{
+public:
+
+	/** Allocates the arena and generates chunks 0 to NumChunks - 1, chunk 0 ending at BottomY. */
+	void Init(const FBBCEndlessSettings& InSettings, double InLeft, double BottomY);
+
+	/**
+	 * Moves every chunk down by Distance and regenerates the slots of the chunks whose top edge passed RecycleY.
+	 * Returns the number of slots regenerated; their slots are appended to OutSlots.
+	 */
+	int32 Scroll(double Distance, double RecycleY, TArray<int32>& OutSlots, int32& OutNumAdded, int32& OutNumRemoved);
+
+	/** Moves the ring sideways, for a new playfield layout. */
+	void SetLeft(double InLeft) { Left = InLeft; }
+
+	//~ IBBCBrickSource
+	virtual bool SweepBall(const FVector2D& Start, const FVector2D& Delta, double Radius, double& OutTime, FVector2D& OutNormal, int32& OutCell) const override;
+	virtual bool DamageCell(int32 Cell, uint8 Damage = 1) override;
+	virtual FBox2D GetCellBox(int32 Cell) const override;
+
+	/** Area covered by the chunks currently in the ring, empty cells included. */
+	FBox2D GetBounds() const;
+
+	/** Cells destroyed since the last call of ResetDestroyedCells. */
+	TConstArrayView<int32> GetDestroyedCells() const { return DestroyedCells; }
+	void ResetDestroyedCells() { DestroyedCells.Reset(); }
+
+	bool IsCellAlive(int32 Cell) const { return HitPoints.IsValidIndex(Cell) && HitPoints[Cell] > 0; }
+	const FBBCEndlessSettings& GetSettings() const { return Settings; }
+	int32 GetCellsPerChunk() const { return Settings.ChunkRows * Settings.Columns; }
+	int32 GetNumCells() const { return HitPoints.Num(); }
+	int32 GetNumAlive() const { return NumAlive; }
+	double GetChunkHeight() const { return Settings.ChunkRows * Settings.BrickSize.Y; }
+	double GetLeft() const { return Left; }
+	/** Top edge of chunk 0; chunk Sequence starts Sequence chunk heights above it. */
+	double GetBaseY() const { return BaseY; }
+	int64 GetSlotSequence(int32 Slot) const { return SlotSequences[Slot]; }
+	int64 GetNumRecycled() const { return FirstSequence; }
+	/** Bytes held by the ring, constant after Init. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	int32 Generate(int32 Slot, int64 Sequence);
+	double GetChunkTop(int32 Slot) const { return BaseY - SlotSequences[Slot] * GetChunkHeight(); }
+
+private:
+
+	FBBCEndlessSettings Settings;
+	/** Hit points of every cell of every chunk; 0 for an empty cell. */
+	TArray<uint8> HitPoints;
+	TArray<int64> SlotSequences;
+	TArray<int32> DestroyedCells;
+	/** Sequence of the bottom chunk, which is also the number of chunks recycled so far. */
+	int64 FirstSequence = 0;
+	double Left = 0.0;
+	double BaseY = 0.0;
+	int32 NumAlive = 0;
+
+	/** Scratch buffer for the bricks under a sweep. */
+	mutable FBBCBoxBatch SweepCandidates;
+};
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Endless/BBCEndlessRing.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCEndlessSubsystem.generated.h"
+
+class UBBCBallSubsystem;
+class UInstancedStaticMeshComponent;
+struct FBBCPlayfieldChangedEvent;
+
+/**
+ * Endless arena mode: instead of a level, a ring of brick chunks scrolls down the brick area forever.
+ *
+ * The ring (FBBCEndlessRing) is sized once at Start from the playfield layout: as many columns as fit the brick
+ * area and enough chunks to cover it from the top of the arena plus one spare. When the bottom chunk has scrolled
+ * past the brick area its slot is generated again above the top chunk, and the instances drawing that slot are
+ * rewritten in place. The ring, the instance buffer and the scratch transforms are all allocated by Start, so
+ * resident memory and frame time stay flat however long the session runs.
+ *
+ * Balls hit the ring through the IBBCBrickSource of UBBCBallSubsystem. Started by the game mode when -BBCEndless
+ * is on the command line, and advanced from the Bricks phase of UBBCTickManagerSubsystem. An hour of unattended
+ * play, with the soak samples of the headless harness proving flat memory and frame time:
+ *
+ *   BrickBreakersClone PlayGround -nullrhi -nosound -unattended -BBCEndless -BBCSimAutopilot -BBCSimFrames=216000 -BBCSoakSampleFrames=3600
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCEndlessSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** True when the command line asks for the endless mode instead of the configured levels. */
+	static bool IsRequestedOnCommandLine();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Sizes and fills the ring from the current playfield layout, hands it to the balls and spawns its view. */
+	void Start(int32 Seed);
+	void Stop();
+	bool IsActive() const { return bActive; }
+
+	/** Scrolls the ring by DeltaTime, streams recycled chunks and draws the bricks destroyed since the last call. */
+	void Advance(float DeltaTime);
+
+	const FBBCEndlessRing& GetRing() const { return Ring; }
+	/** Bytes held by the ring and its view buffers; constant while the mode runs. */
+	SIZE_T GetAllocatedSize() const;
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void CreateView();
+	void WriteSlotTransforms(int32 Slot);
+	void UpdateViewLocation();
+	double GetRecycleY() const;
+	double GetCentredLeft() const;
+	void HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event);
+
+private:
+
+	/** Speed the bricks move down at, in units per second. */
+	UPROPERTY(Config)
+	double ScrollSpeed = 20.0;
+
+	UPROPERTY(Config)
+	int32 ChunkRows = 6;
+
+	UPROPERTY(Config)
+	FVector2D BrickSize = FVector2D(60.0, 24.0);
+
+	UPROPERTY(Config)
+	float FillChance = 0.6f;
+
+	UPROPERTY(Config)
+	int32 MaxHitPoints = 3;
+
+	UPROPERTY(Config)
+	int32 ChunksPerHitPoint = 8;
+
+	/** Upper bound of the ring, whatever the arena height. */
+	UPROPERTY(Config)
+	int32 MaxChunks = 16;
+
+	/** Distance the ring may scroll before cached ball trajectories through it are dropped. */
+	UPROPERTY(Config)
+	double TrajectoryTolerance = 2.0;
+
+	FBBCEndlessRing Ring;
+	bool bActive = false;
+	/** Scroll since cached trajectories were last dropped, and the ring's area at that time. */
+	double ScrollSinceInvalidate = 0.0;
+	FBox2D InvalidatedBounds = FBox2D(ForceInit);
+
+	/** Scratch buffers sized by Start and reused every frame. */
+	TArray<int32> RecycledSlots;
+	TArray<FTransform> SlotTransforms;
+
+	UPROPERTY()
+	TObjectPtr<UBBCBallSubsystem> BallSubsystem;
+	UPROPERTY()
+	TObjectPtr<AActor> ViewActor;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BrickInstances;
+};
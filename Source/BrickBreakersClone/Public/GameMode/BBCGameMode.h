@@ -11,6 +11,8 @@ class ABBCBall;
 class ABBCPaddle;
 class ABBCPlayerController;
 class ABBCCamera;
+class ABBCBrickField;
+struct FBBCPlayfieldChangedEvent;
 /**
  * 
  */
@@ -21,8 +23,17 @@ class BRICKBREAKERSCLONE_API ABBCGameMode : public AGameModeBase
 
 public:
 
+	ABBCGameMode();
+
 	virtual void StartPlay() override;
 
+private:
+
+	void StartLevel();
+	void StartVersus();
+	void PlaceBrickField();
+	void HandlePlayfieldChanged(const FBBCPlayfieldChangedEvent& Event);
+
 private:
 
 	UPROPERTY()
@@ -35,5 +46,17 @@ private:
 	ABBCBall* BBCBall;
 	UPROPERTY()
 	ABBCGameState* BBCGameState;
+	UPROPERTY()
+	ABBCBrickField* BBCBrickField;
+
+	/** Where a spawned brick field starts; it is then centred in the playfield's brick area. */
+	UPROPERTY(EditDefaultsOnly, Category = "Bricks", meta = (MakeEditWidget = true))
+	FVector BrickFieldLocation;
+
+	/** Balls spawned into the actor pool at level load, the player's ball included. */
+	UPROPERTY(EditDefaultsOnly, Category = "Balls", meta = (ClampMin = "1"))
+	int32 BallPoolSize;
+
+	double StartPlaySeconds;
 	
 };
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCGameEventSubsystem.generated.h"
+
+enum class EBBCGameStatus : uint8
+{
+	WaitingToLaunch,
+	InProgress,
+	LevelComplete,
+	GameOver
+};
+
+struct FBBCLevelStartedEvent
+{
+	int32 LevelIndex = 0;
+	int32 NumBricks = 0;
+	/** Endless levels never complete; their brick count follows FBBCBricksStreamedEvent. */
+	bool bEndless = false;
+};
+
+struct FBBCBrickDestroyedEvent
+{
+	/** Cell in the brick field, or INDEX_NONE for a brick placed in the level or streamed by the endless mode. */
+	int32 Cell = INDEX_NONE;
+	FVector2D Location = FVector2D::ZeroVector;
+	/** Area the brick covered. */
+	FBox2D Box = FBox2D(ForceInit);
+};
+
+struct FBBCBallLostEvent
+{
+	int32 BallHandle = INDEX_NONE;
+	/** True for the player's ball, false for extra instanced balls. */
+	bool bPlayerBall = false;
+	/**
+	 * True when no other ball was left in play, so the player's ball went back to the paddle and the loss costs
+	 * a life. A player ball lost while extra balls remain takes over one of them instead.
+	 */
+	bool bLastBall = false;
+};
+
+struct FBBCLevelCompletedEvent
+{
+	int32 LevelIndex = 0;
+	int32 Score = 0;
+};
+
+/** Published by ABBCGameState whenever one of its counters changes. */
+struct FBBCScoreboardEvent
+{
+	int32 Score = 0;
+	int32 Lives = 0;
+	int32 RemainingBricks = 0;
+	EBBCGameStatus Status = EBBCGameStatus::WaitingToLaunch;
+};
+
+/** Published by UBBCEndlessSubsystem when chunks scroll out and new ones are generated above the arena. */
+struct FBBCBricksStreamedEvent
+{
+	int32 NumAdded = 0;
+	/** Live bricks that scrolled out without being broken. */
+	int32 NumRemoved = 0;
+};
+
+/** Published by UBBCPlayfieldSubsystem after it recomputed the arena. Listeners read the new layout from it. */
+struct FBBCPlayfieldChangedEvent
+{
+	int32 Revision = 0;
+};
+
+/**
+ * Published by UBBCBrickFieldComponent when bricks appear in cells that may have been empty: the wall was
+ * rebuilt or a replay frame was shown. Regeneration only heals bricks that are still standing, so it never
+ * publishes this.
+ */
+struct FBBCBricksRestoredEvent
+{
+	/** Area covered by the restored bricks. */
+	FBox2D Area = FBox2D(ForceInit);
+};
+
+/** Published by UBBCBallSubsystem when a ball is unregistered. Its handle may go to the next ball registered. */
+struct FBBCBallRemovedEvent
+{
+	int32 BallHandle = INDEX_NONE;
+};
+
+/**
+ * Typed gameplay event dispatcher. Simulation code publishes what happened, and the game state, UI and audio
+ * subscribe to the events they care about instead of polling actors.
+ *
+ * Every event type has its own native multicast delegate and events are passed by const reference, so
+ * publishing is a direct call on each listener and never allocates.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCGameEventSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnLevelStarted, const FBBCLevelStartedEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBrickDestroyed, const FBBCBrickDestroyedEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBallLost, const FBBCBallLostEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnLevelCompleted, const FBBCLevelCompletedEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnScoreboardChanged, const FBBCScoreboardEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBricksStreamed, const FBBCBricksStreamedEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayfieldChanged, const FBBCPlayfieldChangedEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBricksRestored, const FBBCBricksRestoredEvent&);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBallRemoved, const FBBCBallRemovedEvent&);
+
+	void Publish(const FBBCLevelStartedEvent& Event) const { LevelStarted.Broadcast(Event); }
+	void Publish(const FBBCBrickDestroyedEvent& Event) const { BrickDestroyed.Broadcast(Event); }
+	void Publish(const FBBCBallLostEvent& Event) const { BallLost.Broadcast(Event); }
+	void Publish(const FBBCLevelCompletedEvent& Event) const { LevelCompleted.Broadcast(Event); }
+	void Publish(const FBBCScoreboardEvent& Event) const { ScoreboardChanged.Broadcast(Event); }
+	void Publish(const FBBCBricksStreamedEvent& Event) const { BricksStreamed.Broadcast(Event); }
+	void Publish(const FBBCPlayfieldChangedEvent& Event) const { PlayfieldChanged.Broadcast(Event); }
+	void Publish(const FBBCBricksRestoredEvent& Event) const { BricksRestored.Broadcast(Event); }
+	void Publish(const FBBCBallRemovedEvent& Event) const { BallRemoved.Broadcast(Event); }
+
+	FOnLevelStarted& OnLevelStarted() { return LevelStarted; }
+	FOnBrickDestroyed& OnBrickDestroyed() { return BrickDestroyed; }
+	FOnBallLost& OnBallLost() { return BallLost; }
+	FOnLevelCompleted& OnLevelCompleted() { return LevelCompleted; }
+	FOnScoreboardChanged& OnScoreboardChanged() { return ScoreboardChanged; }
+	FOnBricksStreamed& OnBricksStreamed() { return BricksStreamed; }
+	FOnPlayfieldChanged& OnPlayfieldChanged() { return PlayfieldChanged; }
+	FOnBricksRestored& OnBricksRestored() { return BricksRestored; }
+	FOnBallRemoved& OnBallRemoved() { return BallRemoved; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	FOnLevelStarted LevelStarted;
+	FOnBrickDestroyed BrickDestroyed;
+	FOnBallLost BallLost;
+	FOnLevelCompleted LevelCompleted;
+	FOnScoreboardChanged ScoreboardChanged;
+	FOnBricksStreamed BricksStreamed;
+	FOnPlayfieldChanged PlayfieldChanged;
+	FOnBricksRestored BricksRestored;
+	FOnBallRemoved BallRemoved;
+};
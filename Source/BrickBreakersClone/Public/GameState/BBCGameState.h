@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameStateBase.h"
+#include "GameState/BBCGameEventSubsystem.h"
 #include "BBCGameState.generated.h"
 
 class ABBCBall;
@@ -13,6 +14,10 @@ class ABBCPlayerController;
  * Number of remaining bricks
  * Game status (in progress, paused, game over)
  * Current level information
+ *
+ * Counters are driven by the events of UBBCGameEventSubsystem and updated in constant time per event.
+ * Changes are published back as one FBBCScoreboardEvent per frame for UI and audio, from the GameState
+ * phase of UBBCTickManagerSubsystem.
  */
 UCLASS()
 class BRICKBREAKERSCLONE_API ABBCGameState : public AGameStateBase
@@ -21,16 +26,63 @@ class BRICKBREAKERSCLONE_API ABBCGameState : public AGameStateBase
 
 public:
 
+	ABBCGameState(const FObjectInitializer& ObjectInitializer);
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	void SetPlayerControllerAndBall(ABBCPlayerController* BBCController, ABBCBall* Ball);
 
 	void TryStartBall();
 
+	/** Restores score and lives after a game over and waits for a new launch. */
+	void RestartGame();
+
+	/** GameState phase: publishes the scoreboard if a counter changed this frame. */
+	void FlushScoreboard();
+
+	int32 GetScore() const { return Score; }
+	int32 GetLives() const { return Lives; }
+	int32 GetRemainingBricks() const { return RemainingBricks; }
+	int32 GetLevelIndex() const { return LevelIndex; }
+	EBBCGameStatus GetStatus() const { return Status; }
+
+private:
+
+	void HandleLevelStarted(const FBBCLevelStartedEvent& Event);
+	void HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event);
+	void HandleBallLost(const FBBCBallLostEvent& Event);
+	void HandleBricksStreamed(const FBBCBricksStreamedEvent& Event);
+	void SetStatus(EBBCGameStatus NewStatus);
+	void MarkScoreboardDirty() { bScoreboardDirty = true; }
+
 private:
 
 	UPROPERTY()
 	TWeakObjectPtr<ABBCPlayerController> BBCPlayerController;
 	UPROPERTY()
 	TWeakObjectPtr<ABBCBall> BBCBall;
-	
-};
 
+	UPROPERTY(EditDefaultsOnly, Category = "Rules", meta = (ClampMin = "1", AllowPrivateAccess = "true"))
+	int32 StartingLives;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Rules", meta = (ClampMin = "0", AllowPrivateAccess = "true"))
+	int32 PointsPerBrick;
+
+	UPROPERTY(VisibleAnywhere)
+	int32 Score;
+	UPROPERTY(VisibleAnywhere)
+	int32 Lives;
+	UPROPERTY(VisibleAnywhere)
+	int32 RemainingBricks;
+	UPROPERTY(VisibleAnywhere)
+	int32 LevelIndex;
+
+	EBBCGameStatus Status;
+	bool bScoreboardDirty;
+	/** The current level is endless: breaking every brick on screen does not complete it. */
+	bool bEndless;
+
+	UPROPERTY()
+	TObjectPtr<UBBCGameEventSubsystem> GameEvents;
+};
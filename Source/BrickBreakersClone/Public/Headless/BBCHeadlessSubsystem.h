@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BBCHeadlessSubsystem.generated.h"
+
+class ABBCAutopilotController;
+class UBBCGameEventSubsystem;
+struct FBBCBallLostEvent;
+struct FBBCLevelCompletedEvent;
+
+/**
+ * Memory, object counts and frame time taken at one point of a soak run.
+ */
+struct FBBCSoakSample
+{
+	int32 Frame = 0;
+	int32 Rounds = 0;
+	uint64 UsedPhysicalBytes = 0;
+	int32 NumObjects = 0;
+	int32 NumActors = 0;
+	/** Mean frame time of the frames since the previous sample. */
+	double MeanFrameMs = 0.0;
+	/**
+	 * Fewest balls accounted for at the start of any frame since the previous sample: balls inside the playfield
+	 * plus extra balls lost to the kill zone that are about to be replaced. Taken before lost balls are respawned.
+	 */
+	int32 MinBalls = 0;
+};
+
+/**
+ * A fixed performance scenario of the headless harness, with its budgets and recorded baselines. Scenarios
+ * are listed in the Scenarios config array of DefaultGame.ini.
+ */
+USTRUCT()
+struct FBBCPerfScenario
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	FString Name;
+
+	/** Moving balls: the player ball plus Balls - 1 instanced balls. 0 leaves the ball on the paddle. */
+	UPROPERTY(Config)
+	int32 Balls = 1;
+
+	/** Bricks of a uniform wall replacing the first level. 0 keeps the configured level. */
+	UPROPERTY(Config)
+	int32 Bricks = 0;
+
+	UPROPERTY(Config)
+	int32 Frames = 600;
+
+	/** Hard budgets, failed whatever the baseline says. */
+	UPROPERTY(Config)
+	double BudgetMeanMs = 16.67;
+
+	UPROPERTY(Config)
+	double BudgetP99Ms = 33.33;
+
+	UPROPERTY(Config)
+	double BudgetMemoryMb = 512.0;
+
+	/** Recorded results; 0 until a baseline has been recorded for the machine class, which checks only the budgets. */
+	UPROPERTY(Config)
+	double BaselineMeanMs = 0.0;
+
+	UPROPERTY(Config)
+	double BaselineP99Ms = 0.0;
+
+	UPROPERTY(Config)
+	double BaselineMemoryMb = 0.0;
+};
+
+/**
+ * Headless simulation harness. Started from the command line, for example
+ *
+ *   BrickBreakersClone PlayGround -nullrhi -nosound -unattended -BBCSimFrames=3600 -BBCSimDelta=0.0166667
+ *
+ * it runs the normal game flow (ABBCGameMode::StartPlay included) with a fixed delta, keeps the ball in play,
+ * and after the requested number of frames writes a JSON report with frame time percentiles, tick cost per
+ * class and collision counts, then exits.
+ *
+ * Options:
+ *   -BBCSimFrames=N      Frames to simulate after the world has begun play. Enables the harness.
+ *   -BBCSimDelta=S       Fixed frame delta in seconds (default 1/60).
+ *   -BBCSimReport=Path   Report path (default Saved/Profiling/BBCSim.json).
+ *   -BBCSimBalls=N       Extra instanced balls kept in play; lost ones are respawned at the start of the next frame.
+ *   -BBCSimPowerUps=N    Keeps N lasting power-ups in effect, topped up every frame, to measure their cost.
+ *   -BBCSimSynthetic     Fixes the playfield arena at 1000 x 1000 instead of deriving it from the camera.
+ *   -BBCSimAutopilot     Hands the paddle to ABBCAutopilotController.
+ *   -BBCFxStub           Runs the effects budget without creating effect components (implied by -nullrhi).
+ *
+ * Soak options, for unattended runs of thousands of rounds (a round ends when the player loses the last ball in
+ * play or clears a level). -BBCSimFrames stays the upper bound of the run:
+ *   -BBCSoakRounds=N         Ends the run after N rounds.
+ *   -BBCSoakSampleFrames=N   Frames between memory and object count samples (default 600).
+ *
+ * Soak reports add the samples, memory growth per round, object and actor growth and the growth of the mean
+ * frame time between sample windows, so slow leaks and slowdowns show up as a trend across the run rather than
+ * as a single bad frame. Every report has an "effects" object with the break effects requested, merged,
+ * spawned, reduced and culled by UBBCEffectsSubsystem, and a "power_ups" object with the power-ups activated and in
+ * effect and the pickups and bolts of UBBCPowerUpSubsystem. With -BBCEndless the report also gains an "endless" object with the chunks streamed
+ * and the bytes held by the brick ring; see UBBCEndlessSubsystem for an hour long run.
+ *
+ * Performance scenarios replace the frame and ball options with a named entry of the Scenarios config array:
+ *   -BBCSimScenario=Name     Runs the scenario, enabling the harness without -BBCSimFrames.
+ *
+ *   BrickBreakersClone PlayGround -nullrhi -nosound -unattended -BBCSimScenario=Balls100
+ *
+ * The report gains a "scenario" object with the measured mean and p99 frame time and memory growth, checked
+ * against the scenario's budgets and against its baselines plus RegressionTolerance. A scenario without a
+ * recorded baseline is checked against its budgets only, with a warning. A scenario also fails when balls leave
+ * play other than through the kill zone, so fewer than Balls are accounted for. A failed check is
+ * logged as an error and the process exits with a non-zero code, so a CI job running each scenario catches the
+ * regression. The log also prints the config line recording the run as the new baseline. Every scenario is
+ * also an automation test, BrickBreakersClone.Perf.Scenario, which runs it in a child process.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCHeadlessSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool IsRunning() const { return bRunning; }
+	const TArray<FBBCPerfScenario>& GetScenarios() const { return Scenarios; }
+
+private:
+
+	void OnBeginFrame();
+	void OnEndFrame();
+	void SetUpWorld(UWorld& World);
+	void KeepBallInPlay(UWorld& World);
+	void KeepExtraBallsInPlay(UWorld& World);
+	int32 CountBallsInPlay(UWorld& World) const;
+	void KeepPowerUpsActive(UWorld& World);
+	void SpawnAutopilot(UWorld& World);
+	void TakeSoakSample(UWorld& World);
+	void HandleBallLost(const FBBCBallLostEvent& Event);
+	void HandleLevelCompleted(const FBBCLevelCompletedEvent& Event);
+	void WriteReport(UWorld& World) const;
+	void ApplyScenarioBricks(UWorld& World) const;
+	void GetFrameMs(TArray<double>& OutSortedMs, double& OutMeanMs) const;
+	double GetMemoryGrowthMb() const;
+	bool CheckScenario() const;
+
+private:
+
+	UPROPERTY(Config)
+	TArray<FBBCPerfScenario> Scenarios;
+
+	/** Fraction a measurement may exceed its baseline by before the scenario fails. */
+	UPROPERTY(Config)
+	double RegressionTolerance = 0.2;
+
+	/** Entry of Scenarios being run, if any. */
+	FBBCPerfScenario Scenario;
+	bool bScenario = false;
+	bool bScenarioPassed = true;
+	bool bLaunchBall = true;
+
+	int32 FramesToSimulate = 0;
+	int32 ExtraBalls = 0;
+	FRandomStream ExtraBallStream;
+	/** Fewest balls accounted for at the start of a frame since the last soak sample; see FBBCSoakSample::MinBalls. */
+	int32 MinBallsSinceSample = MAX_int32;
+	/** Extra balls lost to the kill zone since KeepExtraBallsInPlay last ran. */
+	int32 ExtraBallsLostSinceRefill = 0;
+	int32 PowerUpsToKeep = 0;
+	bool bSyntheticBounds = false;
+	bool bAutopilot = false;
+	int32 SoakRounds = 0;
+	int32 SoakSampleFrames = 600;
+	FString ReportPath;
+
+	bool bRunning = false;
+	bool bWorldSetUp = false;
+	double FrameStartSeconds = 0.0;
+	double RunStartSeconds = 0.0;
+	TArray<double> FrameSeconds;
+	uint64 SetUpUsedPhysicalBytes = 0;
+	int32 Rounds = 0;
+	TArray<FBBCSoakSample> SoakSamples;
+	TWeakObjectPtr<ABBCAutopilotController> Autopilot;
+	TWeakObjectPtr<UBBCGameEventSubsystem> GameEvents;
+
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle EndFrameHandle;
+};
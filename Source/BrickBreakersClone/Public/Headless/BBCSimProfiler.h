@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Accumulated cost of one profiled category during a headless run.
+ */
+struct FBBCSimCost
+{
+	uint64 Cycles = 0;
+	int64 Calls = 0;
+};
+
+/**
+ * Minimal tick cost accumulator used by the headless simulation harness. Scopes are a single branch when
+ * the harness is not running.
+ */
+class BRICKBREAKERSCLONE_API FBBCSimProfiler
+{
+public:
+
+	static bool IsEnabled() { return bEnabled; }
+	static void SetEnabled(bool bInEnabled) { bEnabled = bInEnabled; }
+
+	static void AddCost(FName Category, uint64 Cycles);
+	static const TMap<FName, FBBCSimCost>& GetCosts() { return Costs; }
+	static void Reset() { Costs.Reset(); }
+
+private:
+
+	static bool bEnabled;
+	static TMap<FName, FBBCSimCost> Costs;
+};
+
+/**
+ * Adds the time spent in the enclosing scope to a profiler category. The category name is built once by
+ * BBC_SIM_SCOPE, so a scope costs no name lookup.
+ */
+class FBBCSimScope
+{
+public:
+
+	explicit FBBCSimScope(FName InCategory)
+		: Category(InCategory)
+		, StartCycles(FBBCSimProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FBBCSimScope()
+	{
+		if (StartCycles != 0)
+		{
+			FBBCSimProfiler::AddCost(Category, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+
+	FName Category;
+	uint64 StartCycles;
+};
+
+#define BBC_SIM_SCOPE(Category) \
+	static const FName PREPROCESSOR_JOIN(BBCSimScopeName_, __LINE__)(TEXT(Category)); \
+	const FBBCSimScope PREPROCESSOR_JOIN(BBCSimScope_, __LINE__)(PREPROCESSOR_JOIN(BBCSimScopeName_, __LINE__))
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Latency totals of one input source. Written on the render thread, read on the game thread.
+ */
+struct FBBCInputLatencyTotals
+{
+	FCriticalSection Lock;
+	int32 NumEdges = 0;
+	double SimFrames = 0.0;
+	double PhotonFrames = 0.0;
+	double MaxPhotonFrames = 0.0;
+};
+
+/**
+ * Measures how long a change of input takes to show on screen.
+ *
+ * An edge is a move axis that starts from rest or reverses. The edge is timestamped when the sample arrives,
+ * resolved on the game thread when the paddle first moves in the new direction (the simulation latency), then
+ * followed onto the render thread with a render command. The photon latency is the time until that command
+ * runs plus one frame for the GPU and present, in frames of the current frame time. It is an estimate: the
+ * engine does not report when a frame actually reaches the display.
+ */
+class BRICKBREAKERSCLONE_API FBBCInputLatency
+{
+public:
+
+	FBBCInputLatency();
+
+	/** Game thread: a move sample arrived. */
+	void OnInput(float Axis);
+	/** Game thread: the paddle moved by Delta this frame. */
+	void OnPaddleMoved(double Delta);
+
+	void Reset();
+	/** Averages over the edges measured so far. Returns false before the first one. */
+	bool GetAverages(int32& OutNumEdges, double& OutSimFrames, double& OutPhotonFrames, double& OutMaxPhotonFrames) const;
+
+private:
+
+	TSharedRef<FBBCInputLatencyTotals, ESPMode::ThreadSafe> Totals;
+	int32 LastSign = 0;
+	/** Direction of the edge waiting for the paddle to move, 0 if none. */
+	int32 PendingSign = 0;
+	double PendingSeconds = 0.0;
+	uint64 PendingFrame = 0;
+};
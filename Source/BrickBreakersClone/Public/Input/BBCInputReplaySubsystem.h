@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCInputReplaySubsystem.generated.h"
+
+/**
+ * Input captured for one frame.
+ */
+struct FBBCInputFrame
+{
+	enum EFlags : uint8
+	{
+		None = 0,
+		Move = 1 << 0,
+		Start = 1 << 1
+	};
+
+	float DeltaSeconds = 0.f;
+	float MoveAxis = 0.f;
+	uint8 Flags = None;
+};
+
+/**
+ * Records the per-frame input stream of a session and plays it back.
+ *
+ * -BBCRecordInput=Path captures the paddle move axis, start triggers and frame delta of every played frame,
+ * together with the random seed used to launch the ball, and writes them to a compact binary file when the
+ * world is torn down. -BBCReplayInput=Path reads such a file, reuses its seed and frame deltas and injects
+ * the inputs through Enhanced Input, so they reach ABBCPaddle::MoveLeftOrRight and
+ * ABBCPlayerController::OnStartBall exactly like live input. -BBCReplayExit quits when playback ends.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCInputReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static constexpr uint32 FileMagic = 0x49434242; // "BBCI"
+	static constexpr uint16 FileVersion = 1;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Seed for gameplay randomness; recorded with the input and restored on playback. */
+	int32 GetSessionSeed() const { return SessionSeed; }
+
+	bool IsRecording() const { return bRecording; }
+	bool IsReplaying() const { return bReplaying; }
+
+	void RecordMove(float Axis);
+	void RecordStart();
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnBeginFrame();
+	void InjectFrame(const FBBCInputFrame& Frame);
+	bool LoadRecording();
+	void SaveRecording() const;
+
+private:
+
+	FString FilePath;
+	bool bRecording = false;
+	bool bReplaying = false;
+	bool bExitWhenDone = false;
+	int32 SessionSeed = 0;
+
+	TArray<FBBCInputFrame> Frames;
+	int32 ReplayFrame = 0;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle BeginFrameHandle;
+};
@@ -21,11 +21,12 @@ public:
 	ABBCPlayerController(const FObjectInitializer& ObjectInitializer);
 
 	virtual void BeginPlay() override;
-	
-	virtual void SetupInputComponent() override;
+
+	const UInputAction* GetStartInputAction() const { return StartInputAction; }
 
 private:
 
+	void SetupPlayerInput();
 	void OnStartBall();
 
 private:
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PowerUps/BBCTimerWheel.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BBCPowerUpSubsystem.generated.h"
+
+class ABBCPaddle;
+class UBBCBallSubsystem;
+class UInstancedStaticMeshComponent;
+struct FBBCBallLostEvent;
+struct FBBCBrickDestroyedEvent;
+struct FBBCLevelStartedEvent;
+
+UENUM()
+enum class EBBCPowerUp : uint8
+{
+	Multiball,
+	WidePaddle,
+	SlowBall,
+	Laser,
+	StickyPaddle,
+	Num UMETA(Hidden)
+};
+
+/**
+ * One power-up as plain data, read from the PowerUps config array. What Magnitude means depends on the kind:
+ *
+ * - Multiball: extra balls split off every ball in play
+ * - WidePaddle: paddle width multiplier per stack
+ * - SlowBall: ball speed multiplier per stack
+ * - Laser: shots per second per stack
+ * - StickyPaddle: seconds a ball stays on the paddle before leaving, unless the launch input releases it sooner
+ */
+USTRUCT()
+struct FBBCPowerUpEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EBBCPowerUp Kind = EBBCPowerUp::Num;
+
+	/** Seconds the effect lasts from its pickup; 0 for effects that act once. */
+	UPROPERTY()
+	float DurationSeconds = 0.f;
+
+	UPROPERTY()
+	float Magnitude = 1.f;
+
+	/** Pickups counted towards the effect at most; further pickups only make it last longer. */
+	UPROPERTY()
+	int32 MaxStacks = 1;
+
+	/** Chance of this kind among the drops, relative to the other kinds. */
+	UPROPERTY()
+	float DropWeight = 1.f;
+};
+
+/**
+ * Power-ups: pickups that drop from destroyed bricks and apply plain data effects to the paddle and the balls.
+ *
+ * No power-up is an actor or ticks. Every effect is an FBBCPowerUpEffect record, and applying one goes through a
+ * handler table indexed by its kind: the handler is handed the number of stacks now in effect and sets the
+ * paddle and ball state from it (paddle width, ball speed scale, sticky hold, laser rate), so applying, stacking
+ * and expiring are the same call. Every pickup of a lasting effect schedules one expiry on a timer wheel; the
+ * stacks in effect are the live timers of the kind, capped at MaxStacks. Activating a power-up is O(1) and a
+ * frame with any number of active power-ups only walks the one wheel slot it reaches.
+ *
+ * Falling pickups and laser bolts are structure of arrays buffers updated in one batched pass from the Bricks
+ * phase of UBBCTickManagerSubsystem, and drawn by fixed size instanced meshes on a single view actor. Drops are
+ * drawn from a stream seeded by the session seed, so replays drop the same power-ups.
+ */
+UCLASS(Config = Game)
+class BRICKBREAKERSCLONE_API UBBCPowerUpSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Moves the pickups and bolts, catches pickups on the paddle, fires the laser and expires effects. */
+	void Advance(float DeltaTime);
+
+	/** Applies a power-up as if its pickup had been caught. Returns false if its kind is not configured. */
+	bool Activate(EBBCPowerUp Kind);
+	/** Adds a falling pickup of Kind at Location, if there is room. */
+	void DropPickup(EBBCPowerUp Kind, const FVector2D& Location);
+	/** Ends every effect, and removes the pickups and bolts too if bPickups is set. */
+	void Clear(bool bPickups);
+
+	/** Stacks of Kind in effect, capped at its MaxStacks. */
+	int32 GetNumStacks(EBBCPowerUp Kind) const;
+	/** Lasting effects picked up and not expired, over every kind. */
+	int32 GetNumActive() const { return Timers.Num(); }
+	int32 GetNumPickups() const { return PickupPositions.Num(); }
+	int32 GetNumBolts() const { return BoltPositions.Num(); }
+	int64 GetNumActivated() const { return NumActivated; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	/** Sets the state of one kind from the stacks now in effect. */
+	using FHandler = void (UBBCPowerUpSubsystem::*)(const FBBCPowerUpEffect& Effect, int32 Stacks);
+	static const FHandler Handlers[static_cast<int32>(EBBCPowerUp::Num)];
+
+	void ApplyMultiball(const FBBCPowerUpEffect& Effect, int32 Stacks);
+	void ApplyWidePaddle(const FBBCPowerUpEffect& Effect, int32 Stacks);
+	void ApplySlowBall(const FBBCPowerUpEffect& Effect, int32 Stacks);
+	void ApplyLaser(const FBBCPowerUpEffect& Effect, int32 Stacks);
+	void ApplyStickyPaddle(const FBBCPowerUpEffect& Effect, int32 Stacks);
+
+	void SetLiveCount(EBBCPowerUp Kind, int32 LiveCount);
+	EBBCPowerUp PickDropKind();
+	void UpdatePickups(float DeltaTime);
+	void UpdateLaser(float DeltaTime);
+	void CreateView();
+	void UpdateView();
+	ABBCPaddle* GetPaddle() const;
+	void HandleBrickDestroyed(const FBBCBrickDestroyedEvent& Event);
+	void HandleBallLost(const FBBCBallLostEvent& Event);
+	void HandleLevelStarted(const FBBCLevelStartedEvent& Event);
+
+private:
+
+	/** Effect records; the last one of a kind wins. */
+	UPROPERTY(Config)
+	TArray<FBBCPowerUpEffect> PowerUps;
+
+	/** Chance that a destroyed brick drops a pickup. */
+	UPROPERTY(Config)
+	float DropChance = 0.12f;
+
+	UPROPERTY(Config)
+	double PickupFallSpeed = 150.0;
+
+	UPROPERTY(Config)
+	FVector2D PickupSize = FVector2D(40.0, 16.0);
+
+	/** Pickups falling at once at most; a brick destroyed while they all fall drops nothing. */
+	UPROPERTY(Config)
+	int32 MaxPickups = 32;
+
+	/** Multiball stops splitting balls once this many are in play. */
+	UPROPERTY(Config)
+	int32 MaxBalls = 64;
+
+	/** Angle between the balls split off one ball. */
+	UPROPERTY(Config)
+	float MultiballSpreadDegrees = 20.f;
+
+	UPROPERTY(Config)
+	double BoltSpeed = 900.0;
+
+	UPROPERTY(Config)
+	double BoltRadius = 4.0;
+
+	UPROPERTY(Config)
+	int32 MaxBolts = 32;
+
+	/** Lasting effects active at once at most; the timer wheel's capacity. */
+	UPROPERTY(Config)
+	int32 MaxActive = 128;
+
+	UPROPERTY(Config)
+	int32 TimerWheelSlots = 64;
+
+	UPROPERTY(Config)
+	double TimerWheelTickSeconds = 0.05;
+
+	/** Effect record and live timer count of each kind. */
+	FBBCPowerUpEffect Effects[static_cast<int32>(EBBCPowerUp::Num)];
+	int32 LiveCounts[static_cast<int32>(EBBCPowerUp::Num)] = {};
+	FBBCTimerWheel Timers;
+	int64 NumActivated = 0;
+	int64 NumDropped = 0;
+	int64 NumCaught = 0;
+
+	/** Falling pickups, reserved to MaxPickups. */
+	TArray<FVector2D> PickupPositions;
+	TArray<EBBCPowerUp> PickupKinds;
+
+	/** Laser bolts in flight, reserved to MaxBolts. */
+	TArray<FVector2D> BoltPositions;
+	double LaserShotsPerSecond = 0.0;
+	double LaserCooldown = 0.0;
+
+	FRandomStream DropRandom;
+	/** Scratch buffer of the view, sized once. */
+	TArray<FTransform> ViewTransforms;
+	int32 NumDrawnPickups = 0;
+	int32 NumDrawnBolts = 0;
+
+	UPROPERTY()
+	TObjectPtr<UBBCBallSubsystem> BallSubsystem;
+	UPROPERTY()
+	TObjectPtr<AActor> ViewActor;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> PickupInstances;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BoltInstances;
+};
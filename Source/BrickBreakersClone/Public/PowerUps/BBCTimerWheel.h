@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hashed timer wheel with a fixed number of slots and a fixed timer capacity.
+ *
+ * Time advances in ticks of TickSeconds. A timer lives in the slot of its expiry tick, in an intrusive doubly
+ * linked list, so scheduling and cancelling are O(1) and advancing one tick only walks the timers of one slot.
+ * Timers further away than one turn of the wheel stay in their slot until the turn that reaches them. Every
+ * buffer is allocated by Init, nothing allocates afterwards.
+ */
+class BRICKBREAKERSCLONE_API FBBCTimerWheel
+{
+public:
+
+	/** Sizes the wheel; NumSlots is rounded up to a power of two. Drops every timer. */
+	void Init(int32 NumSlots, double InTickSeconds, int32 Capacity);
+	/** Drops every timer and restarts time at zero. */
+	void Reset();
+
+	/** Schedules Payload to expire after DelaySeconds, at least one tick. Returns INDEX_NONE when the wheel is full. */
+	int32 Schedule(double DelaySeconds, uint32 Payload);
+	void Cancel(int32 TimerId);
+	bool IsActive(int32 TimerId) const { return Timers.IsValidIndex(TimerId) && Timers[TimerId].bActive; }
+	/** Seconds until the timer expires, 0 if it is not active. */
+	double GetRemainingSeconds(int32 TimerId) const;
+
+	/**
+	 * Advances time by DeltaSeconds and calls OnExpired(Payload) for every timer that expires, in tick order.
+	 * OnExpired may schedule timers but must not cancel any.
+	 */
+	template <typename FunctorType>
+	void Advance(double DeltaSeconds, FunctorType&& OnExpired);
+
+	int32 Num() const { return NumActive; }
+	int32 GetCapacity() const { return Timers.Num(); }
+	SIZE_T GetAllocatedSize() const { return Timers.GetAllocatedSize() + SlotHeads.GetAllocatedSize() + FreeTimers.GetAllocatedSize(); }
+
+private:
+
+	struct FTimer
+	{
+		uint64 ExpireTick = 0;
+		uint32 Payload = 0;
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		bool bActive = false;
+	};
+
+	void Link(int32 TimerId);
+	void Unlink(int32 TimerId);
+
+private:
+
+	TArray<FTimer> Timers;
+	/** First timer of each slot, INDEX_NONE for an empty slot. */
+	TArray<int32> SlotHeads;
+	TArray<int32> FreeTimers;
+	uint32 SlotMask = 0;
+	double TickSeconds = 0.1;
+	double Accumulator = 0.0;
+	uint64 CurrentTick = 0;
+	int32 NumActive = 0;
+};
+
+template <typename FunctorType>
+void FBBCTimerWheel::Advance(double DeltaSeconds, FunctorType&& OnExpired)
+{
+	Accumulator += DeltaSeconds;
+	while (Accumulator >= TickSeconds)
+	{
+		Accumulator -= TickSeconds;
+		++CurrentTick;
+		if (NumActive == 0)
+		{
+			continue;
+		}
+
+		int32 TimerId = SlotHeads[CurrentTick & SlotMask];
+		while (TimerId != INDEX_NONE)
+		{
+			const int32 NextId = Timers[TimerId].Next;
+			if (Timers[TimerId].ExpireTick <= CurrentTick)
+			{
+				const uint32 Payload = Timers[TimerId].Payload;
+				Cancel(TimerId);
+				OnExpired(Payload);
+			}
+			TimerId = NextId;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FBitReader;
+class FBitWriter;
+
+/**
+ * One ball of a recorded frame. Handle is the ball subsystem handle, used to match balls across frames.
+ */
+struct FBBCReplayBall
+{
+	int32 Handle = INDEX_NONE;
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Direction = FVector2D::ZeroVector;
+};
+
+/**
+ * Gameplay state captured at the end of one frame.
+ */
+struct FBBCReplayFrame
+{
+	float DeltaSeconds = 0.f;
+	TArray<FBBCReplayBall> Balls;
+	double PaddleX = 0.0;
+	int32 Columns = 0;
+	int32 Rows = 0;
+	TBitArray<> AliveBits;
+	/**
+	 * Bits to encode in place of AliveBits, if set. A capture points this at the brick field's own bits, which
+	 * must stay unchanged until the frame is encoded, instead of copying them every frame.
+	 */
+	const TBitArray<>* SourceAliveBits = nullptr;
+	int32 Score = 0;
+
+	const TBitArray<>& GetAliveBits() const { return SourceAliveBits != nullptr ? *SourceAliveBits : AliveBits; }
+};
+
+/**
+ * Frame state after quantization, the form the codec predicts from. Positions are in 1/16 units, directions
+ * are 16 bit angles and frame deltas are whole milliseconds.
+ */
+struct FBBCReplayQuantizedState
+{
+	struct FBall
+	{
+		int32 Handle = INDEX_NONE;
+		int32 X = 0;
+		int32 Y = 0;
+		/** Displacement since the previous frame, used to predict the next position. */
+		int32 VelocityX = 0;
+		int32 VelocityY = 0;
+		uint16 Angle = 0;
+	};
+
+	uint32 DeltaMs = 0;
+	TArray<FBall> Balls;
+	int32 PaddleX = 0;
+	int32 Columns = 0;
+	int32 Rows = 0;
+	TBitArray<> AliveBits;
+	int32 Score = 0;
+};
+
+/**
+ * Bit-packed frame codec of the state replay.
+ *
+ * A keyframe holds the whole quantized state. A delta frame holds the difference to the previous frame:
+ * one bit for every unchanged field, ball positions as the residual against a constant velocity prediction,
+ * directions only when a ball bounced and bricks as the list of cells that changed. Integers are written with
+ * Elias gamma codes, so the small residuals of a typical frame cost a few bits each. A frame of one moving ball
+ * and a still wall is about three bytes.
+ *
+ * Encoder and decoder keep the same quantized state, so the decoder reproduces the encoder's predictions
+ * exactly. A decoder must start at a keyframe.
+ *
+ * Both sides update the state in place and build the new ball list in a scratch array swapped with the
+ * previous one, so a stream of frames of the same size allocates nothing after the first.
+ */
+class BRICKBREAKERSCLONE_API FBBCReplayEncoder
+{
+public:
+
+	/**
+	 * Appends one frame to Writer. Forces a keyframe when the wall changed size, since bricks are only sent
+	 * as changes to a wall of the same size.
+	 */
+	void Encode(const FBBCReplayFrame& Frame, bool bKeyframe, FBitWriter& Writer);
+	bool WasKeyframe() const { return bLastKeyframe; }
+
+private:
+
+	FBBCReplayQuantizedState State;
+	/** Balls of the frame being encoded, swapped into State at the end. */
+	TArray<FBBCReplayQuantizedState::FBall> NextBalls;
+	bool bHasState = false;
+	bool bLastKeyframe = false;
+};
+
+class BRICKBREAKERSCLONE_API FBBCReplayDecoder
+{
+public:
+
+	/**
+	 * Reads one frame written by FBBCReplayEncoder::Encode. Returns false on a malformed frame or a delta frame
+	 * without a keyframe before it; after a malformed frame decoding has to restart at a keyframe.
+	 */
+	bool Decode(FBitReader& Reader, bool bKeyframe, FBBCReplayFrame& OutFrame);
+
+private:
+
+	FBBCReplayQuantizedState State;
+	/** Balls of the frame being decoded, swapped into State at the end. */
+	TArray<FBBCReplayQuantizedState::FBall> NextBalls;
+	bool bHasState = false;
+};
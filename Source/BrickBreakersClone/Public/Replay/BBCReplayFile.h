@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Replay/BBCReplayCodec.h"
+#include "Serialization/BitWriter.h"
+#include "Tasks/Pipe.h"
+
+#include <atomic>
+
+class IFileHandle;
+
+/**
+ * State replay file layout: magic, version and keyframe interval, then one record per frame. A record is a
+ * type byte (keyframe or delta), the payload size as a varint and the bit-packed frame from FBBCReplayEncoder.
+ */
+namespace BBCReplayFile
+{
+	constexpr uint32 FileMagic = 0x53434242; // "BBCS"
+	constexpr uint16 FileVersion = 1;
+
+	enum class ERecord : uint8
+	{
+		Keyframe,
+		Delta
+	};
+}
+
+/**
+ * Streams a state replay to disk.
+ *
+ * Frames are encoded on the game thread into a memory buffer. Each time a keyframe starts, the buffer of the
+ * previous interval is handed to a background pipe that writes it, so the game thread never waits on the
+ * disk. Writes of one replay run in order on the pipe. A failed write is logged as an error and closes the
+ * writer at the next frame, which stops the recording.
+ */
+class BRICKBREAKERSCLONE_API FBBCReplayWriter
+{
+public:
+
+	FBBCReplayWriter();
+	~FBBCReplayWriter();
+
+	bool Open(const FString& Path, int32 InKeyframeInterval);
+	void WriteFrame(const FBBCReplayFrame& Frame);
+	/** Writes what is buffered and waits for the background writes to finish. */
+	void Close();
+
+	bool IsOpen() const { return File.IsValid(); }
+	/** True once a background write failed; the replay on disk is incomplete. */
+	bool HasFailed() const { return bWriteFailed; }
+	int64 GetNumFrames() const { return NumFrames; }
+	int64 GetNumKeyframes() const { return NumKeyframes; }
+	/** Bytes written or queued so far, header included. */
+	int64 GetNumBytes() const { return NumBytes; }
+
+private:
+
+	void Flush();
+
+private:
+
+	TSharedPtr<IFileHandle, ESPMode::ThreadSafe> File;
+	FString FilePath;
+	UE::Tasks::FPipe Pipe;
+	FBBCReplayEncoder Encoder;
+	FBitWriter Bits;
+	TArray<uint8> Pending;
+	/** Set by the pipe when a write fails, read by the game thread. */
+	std::atomic<bool> bWriteFailed = false;
+	int32 KeyframeInterval = 60;
+	int64 NumFrames = 0;
+	int64 NumKeyframes = 0;
+	int64 NumBytes = 0;
+};
+
+/**
+ * Reads a state replay and seeks in it.
+ *
+ * Loading indexes every record and keyframe without decoding. Seeking decodes from the closest keyframe at or
+ * before the target, so it costs at most one keyframe interval of frames; stepping forward decodes one frame.
+ */
+class BRICKBREAKERSCLONE_API FBBCReplayReader
+{
+public:
+
+	bool Load(const FString& Path);
+
+	int32 GetNumFrames() const { return Records.Num(); }
+	int32 GetKeyframeInterval() const { return KeyframeInterval; }
+	/** Frame the reader decoded last, INDEX_NONE before the first read. */
+	int32 GetCurrentFrame() const { return CurrentFrame; }
+
+	/** Decodes Frame into OutFrame. Sequential calls decode one frame each. */
+	bool Seek(int32 Frame, FBBCReplayFrame& OutFrame);
+
+private:
+
+	bool DecodeRecord(int32 Record, FBBCReplayFrame& OutFrame);
+
+private:
+
+	struct FRecord
+	{
+		int64 Offset = 0;
+		int32 Size = 0;
+		bool bKeyframe = false;
+	};
+
+	TArray<uint8> Bytes;
+	TArray<FRecord> Records;
+	/** Indices of the keyframe records, in order. */
+	TArray<int32> Keyframes;
+	FBBCReplayDecoder Decoder;
+	int32 KeyframeInterval = 0;
+	int32 CurrentFrame = INDEX_NONE;
+};
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Replay/BBCReplayFile.h"
+#include "BBCStateReplaySubsystem.generated.h"
+
+class UBBCBallSubsystem;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Records the gameplay state of a session for spectating and debugging, and plays it back.
+ *
+ * Unlike the input replay, which re-simulates, a state replay stores what happened: ball positions and
+ * directions, the paddle, the live bricks and the score of every frame, as a keyframe every
+ * KeyframeInterval frames and bit-packed deltas in between (see FBBCReplayEncoder). It plays back without
+ * running the simulation and can jump to any frame.
+ *
+ * -BBCRecordState=Path records the session; -BBCReplayKeyframes=N sets the keyframe interval.
+ * -BBCViewReplay=Path plays a recording instead of the game: the gameplay phases stop and the paddle, the
+ * brick field and an instanced view of the balls show the recorded frames. The viewer is a development tool
+ * driven by console commands, with the frame counter in an on-screen debug message, so it is not available in
+ * shipping builds.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCStateReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static constexpr int32 DefaultKeyframeInterval = 60;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool IsRecording() const { return Writer.IsValid() && Writer->IsOpen(); }
+	bool IsViewing() const { return Reader.IsValid(); }
+
+	/** Records the state at the end of the frame. Called by the tick manager after the GameState phase. */
+	void CaptureFrame(float DeltaTime);
+
+	/** Moves the viewer forward by DeltaTime of recorded time, scaled by its speed. */
+	void AdvanceViewer(float DeltaTime);
+	void SeekViewer(int32 Frame);
+	void SetViewerPaused(bool bPaused) { bViewerPaused = bPaused; }
+	bool IsViewerPaused() const { return bViewerPaused; }
+	void SetViewerSpeed(float Speed) { ViewerSpeed = FMath::Max(Speed, 0.f); }
+
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void ShowFrame();
+	void CreateView();
+
+private:
+
+	UPROPERTY()
+	TObjectPtr<UBBCBallSubsystem> BallSubsystem;
+
+	UPROPERTY()
+	TObjectPtr<AActor> ViewActor;
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BallInstances;
+
+	FString FilePath;
+	TUniquePtr<FBBCReplayWriter> Writer;
+	TUniquePtr<FBBCReplayReader> Reader;
+	/** Frame being captured or shown, reused so neither allocates once warmed up. */
+	FBBCReplayFrame Frame;
+
+	double RecordedSeconds = 0.0;
+	double CaptureSeconds = 0.0;
+
+	int32 ViewerFrame = INDEX_NONE;
+	/** Recorded time elapsed since ViewerFrame was shown. */
+	double ViewerSeconds = 0.0;
+	float ViewerSpeed = 1.f;
+	bool bViewerPaused = false;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/**
+ * Gameplay instrumentation. Everything here is gated by BBC.Stats.Enable (off by default):
+ *
+ *   stat BBC                   Cycle counters and per-frame counters in the stat overlay.
+ *   -trace=cpu,bbc             CPU scopes on the BBC trace channel in Unreal Insights.
+ *
+ * With the console variable off a scope costs one branch, emits no trace event and counters are not touched.
+ * Setting the variable from the console also turns the BBC trace channel on, and off again only if it did so,
+ * so a channel enabled with -trace stays as the command line left it.
+ */
+DECLARE_STATS_GROUP(TEXT("BBC"), STATGROUP_BBC, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ball Movement"), STAT_BBC_BallMovement, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Paddle Movement"), STAT_BBC_PaddleMovement, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Response"), STAT_BBC_CollisionResponse, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Brick Update"), STAT_BBC_BrickUpdate, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Render Sync"), STAT_BBC_RenderSync, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Game State"), STAT_BBC_GameState, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trajectory Query"), STAT_BBC_TrajectoryQuery, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replay Capture"), STAT_BBC_ReplayCapture, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Endless Scroll"), STAT_BBC_EndlessScroll, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effects Flush"), STAT_BBC_EffectsFlush, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Power-Ups"), STAT_BBC_PowerUps, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Balls"), STAT_BBC_ActiveBalls, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Bricks"), STAT_BBC_LiveBricks, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Collisions / Frame"), STAT_BBC_Collisions, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Requested / Frame"), STAT_BBC_EffectsRequested, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Spawned / Frame"), STAT_BBC_EffectsSpawned, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Culled / Frame"), STAT_BBC_EffectsCulled, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pool Hits"), STAT_BBC_PoolHits, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pool Misses"), STAT_BBC_PoolMisses, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Endless Chunks Recycled"), STAT_BBC_EndlessChunksRecycled, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Power-Ups Active"), STAT_BBC_PowerUpsActive, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Power-Up Pickups"), STAT_BBC_PowerUpPickups, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+/** Set by UBBCAssetSubsystem as loads complete. Rare, so not gated by BBC.Stats.Enable. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Gameplay Assets Load (ms)"), STAT_BBC_AssetLoadMs, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Load Stalls"), STAT_BBC_AssetLoadStalls, STATGROUP_BBC, BRICKBREAKERSCLONE_API);
+
+UE_TRACE_CHANNEL_EXTERN(BBCChannel, BRICKBREAKERSCLONE_API);
+
+/** Set by BBC.Stats.Enable. Read directly so gated scopes stay a single load and branch. */
+extern BRICKBREAKERSCLONE_API bool GBBCStatsEnabled;
+
+/** Cycle counter and Insights scope for a gameplay hot path. */
+#define BBC_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CONDITIONAL_CYCLE_COUNTER(Stat, GBBCStatsEnabled); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR_CONDITIONAL(#Stat, BBCChannel, GBBCStatsEnabled)
+
+#define BBC_SET_DWORD_STAT(Stat, Value) \
+	do { if (GBBCStatsEnabled) { SET_DWORD_STAT(Stat, Value); } } while (0)
+
+#define BBC_INC_DWORD_STAT(Stat) \
+	do { if (GBBCStatsEnabled) { INC_DWORD_STAT(Stat); } } while (0)
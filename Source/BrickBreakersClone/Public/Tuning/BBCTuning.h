@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BBCTuning.generated.h"
+
+/**
+ * Tuning can be changed while the game runs: from UBBCTuningAsset, the BBC.Tuning.Set console command and the
+ * -BBCTuning= command line. Off in shipping builds, where every value is a compile-time constant.
+ */
+#ifndef BBC_TUNING_HOT_RELOAD
+#define BBC_TUNING_HOT_RELOAD !UE_BUILD_SHIPPING
+#endif
+
+/**
+ * Gameplay tuning values. The member initializers are the shipping values.
+ */
+USTRUCT(BlueprintType)
+struct FBBCTuningValues
+{
+	GENERATED_BODY()
+
+	/** Speed of the player ball when launched from the paddle. */
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.0"))
+	double BallLaunchSpeed = 300.0;
+
+	/** Largest horizontal component of the launch direction, whose vertical component is 1. */
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.0"))
+	double BallLaunchSpreadX = 1.0;
+
+	/** Scale of the player ball's mesh, which also sets its collision radius. */
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.01"))
+	double BallScale = 0.3;
+
+	/** Largest horizontal share of the ball's direction taken from the paddle's velocity on a bounce. */
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	double MaxPaddleInfluence = 0.75;
+
+	/** Speed and radius of instanced balls spawned by debug commands and the headless harness. */
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.0"))
+	double SpawnedBallSpeed = 300.0;
+
+	UPROPERTY(EditAnywhere, Category = "Ball", meta = (ClampMin = "0.0"))
+	double SpawnedBallRadius = 15.0;
+
+	UPROPERTY(EditAnywhere, Category = "Paddle", meta = (ClampMin = "0.0"))
+	double PaddleMovementSpeed = 350.0;
+
+	/** Horizontal scale of the paddle actor, before the wide paddle power-up. */
+	UPROPERTY(EditAnywhere, Category = "Paddle", meta = (ClampMin = "0.1"))
+	double PaddleWidthScale = 2.0;
+};
+
+namespace BBCTuning
+{
+	/** Shipping values, fixed at compile time. */
+	inline constexpr FBBCTuningValues Defaults{};
+
+#if BBC_TUNING_HOT_RELOAD
+	/** Values in effect; start as Defaults. */
+	extern BRICKBREAKERSCLONE_API FBBCTuningValues GActive;
+
+	inline const FBBCTuningValues& Get() { return GActive; }
+
+	/** Replaces every value, for example with the values of a tuning asset. */
+	BRICKBREAKERSCLONE_API void Apply(const FBBCTuningValues& Values);
+
+	/** Sets one value by property name from text. Returns false if there is no such value or the text does not parse. */
+	BRICKBREAKERSCLONE_API bool SetValue(const FString& Name, const FString& Value);
+
+	/** Applies a comma separated list of Name=Value pairs, as given to -BBCTuning=. */
+	BRICKBREAKERSCLONE_API void ApplyOverrides(const FString& Overrides);
+#else
+	/** Reads fold to constants, so hot paths pay nothing for the table. */
+	constexpr const FBBCTuningValues& Get() { return Defaults; }
+#endif
+
+	/** Logs every value in effect and whether it differs from Defaults. */
+	BRICKBREAKERSCLONE_API void Dump();
+}
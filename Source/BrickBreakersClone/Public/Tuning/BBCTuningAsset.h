@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Tuning/BBCTuning.h"
+#include "BBCTuningAsset.generated.h"
+
+/**
+ * Gameplay tuning edited as an asset. The asset named by TuningAsset in the asset manifest is applied when the
+ * Gameplay bundle loads, and again whenever it is edited, so a PIE session picks up changes as they are made.
+ *
+ * Shipping builds ignore it and use the compile-time values of FBBCTuningValues.
+ */
+UCLASS(BlueprintType)
+class BRICKBREAKERSCLONE_API UBBCTuningAsset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Tuning", meta = (ShowOnlyInnerProperties))
+	FBBCTuningValues Values;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
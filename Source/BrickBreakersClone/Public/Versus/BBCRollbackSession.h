@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Versus/BBCVersusSimulation.h"
+
+struct FBBCVersusPacket;
+
+struct FBBCRollbackStats
+{
+	int32 Rollbacks = 0;
+	int32 ResimulatedFrames = 0;
+	int32 MaxRollbackFrames = 0;
+	int32 Stalls = 0;
+	double LastRollbackSeconds = 0.0;
+	double MaxRollbackSeconds = 0.0;
+};
+
+/**
+ * One peer of a versus match, running lock-step with rollback.
+ *
+ * The local player's input is applied InputDelay frames late, which hides part of the round trip. The remote
+ * player's input is predicted by repeating their last confirmed input, so the match never waits on the
+ * network. The state at the start of each frame is kept in a ring of snapshots; when a confirmed remote input
+ * differs from the prediction used, the state of that frame is restored and every frame since is simulated
+ * again with the corrected inputs.
+ *
+ * A peer that gets more than MaxRollbackFrames ahead of the last confirmed remote input stalls until the
+ * remote catches up, which bounds the cost of a rollback.
+ */
+class BRICKBREAKERSCLONE_API FBBCRollbackSession
+{
+public:
+
+	static constexpr int32 MaxRollbackFrames = 8;
+	static constexpr int32 SnapshotRingSize = 16;
+	static constexpr int32 InputRingSize = 64;
+
+	static_assert(SnapshotRingSize > MaxRollbackFrames, "Snapshots must cover the deepest rollback");
+
+	FBBCRollbackSession(int32 InLocalPlayer, int32 InInputDelay);
+
+	/** Applies confirmed remote inputs from a packet and schedules a rollback on misprediction. */
+	void ReceivePacket(const FBBCVersusPacket& Packet);
+	/** Fills the packet to send this frame: every local input the remote has not acknowledged. */
+	void BuildPacket(FBBCVersusPacket& OutPacket) const;
+
+	/**
+	 * Queues the local input and advances one frame, rolling back first if needed.
+	 * Returns false, without consuming the input, while stalled on the remote.
+	 */
+	bool AdvanceFrame(FBBCVersusInput LocalInput);
+
+	const FBBCVersusState& GetState() const { return State; }
+	int32 GetCurrentFrame() const { return State.Frame; }
+	/** Newest frame for which the remote input is confirmed. */
+	int32 GetConfirmedFrame() const { return ConfirmedRemoteFrame; }
+	/** Checksum of the state at the start of Frame, once every input before it is confirmed. */
+	bool GetConfirmedChecksum(int32 Frame, uint32& OutChecksum) const;
+	const FBBCRollbackStats& GetStats() const { return Stats; }
+	int32 GetLocalPlayer() const { return LocalPlayer; }
+
+private:
+
+	struct FInputSlot
+	{
+		int32 Frame = INDEX_NONE;
+		FBBCVersusInput Input;
+	};
+
+	struct FSnapshot
+	{
+		FBBCVersusState State;
+		/** Remote input the frame was simulated with. */
+		FBBCVersusInput RemoteInput;
+	};
+
+	FBBCVersusInput GetLocalInput(int32 Frame) const;
+	FBBCVersusInput GetRemoteInput(int32 Frame) const;
+	void SimulateFrame();
+	void Rollback();
+
+private:
+
+	int32 LocalPlayer;
+	int32 InputDelay;
+
+	FBBCVersusState State;
+	FSnapshot Snapshots[SnapshotRingSize];
+	FInputSlot LocalInputs[InputRingSize];
+	FInputSlot RemoteInputs[InputRingSize];
+
+	int32 NewestLocalFrame = INDEX_NONE;
+	int32 ConfirmedRemoteFrame = INDEX_NONE;
+	/** Newest local input frame the remote has acknowledged. */
+	int32 RemoteAckFrame = INDEX_NONE;
+	/** Oldest frame simulated with a wrong prediction, INDEX_NONE if none. */
+	int32 RollbackFrame = INDEX_NONE;
+
+	FBBCRollbackStats Stats;
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One player's input for one versus frame. Analog movement is quantized to -1, 0 or 1 so both peers
+ * simulate exactly the same value.
+ */
+struct FBBCVersusInput
+{
+	int8 Move = 0;
+
+	static FBBCVersusInput FromAxis(float Axis) { return FBBCVersusInput{static_cast<int8>(Axis > 0.5f ? 1 : (Axis < -0.5f ? -1 : 0))}; }
+	bool operator==(const FBBCVersusInput& Other) const { return Move == Other.Move; }
+	bool operator!=(const FBBCVersusInput& Other) const { return Move != Other.Move; }
+};
+
+struct FBBCVersusBall
+{
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Velocity = FVector2D::ZeroVector;
+	/** Player whose paddle touched the ball last; brick points go to them. */
+	int32 Owner = 0;
+	/** Frames left resting on the serving paddle, 0 while in play. */
+	int32 ServeFrames = 0;
+};
+
+/**
+ * Complete state of a versus match. It is small and trivially copyable, so a rollback snapshot is a plain
+ * copy of this struct.
+ */
+struct FBBCVersusState
+{
+	static constexpr int32 NumPlayers = 2;
+
+	int32 Frame = 0;
+	double PaddleX[NumPlayers] = {};
+	/** Ball I is served by player I. */
+	FBBCVersusBall Balls[NumPlayers];
+	/** One bit per brick of the shared wall, set while the brick is alive. */
+	uint64 Bricks = 0;
+	int32 Scores[NumPlayers] = {};
+
+	/** Checksum of every field, used to compare the two peers' confirmed frames. */
+	uint32 GetChecksum() const;
+};
+
+/**
+ * Deterministic rules of the two-paddle versus mode. Player 0 defends the bottom edge (+Y) and player 1 the
+ * top edge (-Y); a shared brick wall sits between them. Breaking a brick scores one point for the ball's
+ * owner, and getting a ball past the other paddle scores GoalPoints.
+ *
+ * Everything is computed from the state and the inputs only, in a fixed order, so two peers running the same
+ * build reach the same state from the same inputs.
+ *
+ * This is deliberately separate from the single player simulation. UBBCBallSubsystem, the brick field and the
+ * paddle are one per world, advance with the variable game frame and keep part of their state in actors,
+ * components and the event bus, so they can neither be copied into a rollback snapshot nor run twice in one
+ * process for two peers. The versus rules keep the whole match in FBBCVersusState instead, stepped at a fixed
+ * rate, so a snapshot is a struct copy and a rollback of MaxRollbackFrames costs microseconds.
+ */
+namespace BBCVersus
+{
+	constexpr double StepSeconds = 1.0 / 60.0;
+	constexpr double FieldHalfWidth = 480.0;
+	constexpr double GoalLineY = 460.0;
+	constexpr double PaddleLineY = 420.0;
+	constexpr double PaddleHalfWidth = 60.0;
+	constexpr double PaddleHalfHeight = 10.0;
+	constexpr double PaddleSpeed = 600.0;
+	constexpr double BallRadius = 10.0;
+	constexpr double BallSpeed = 420.0;
+	constexpr int32 ServeDelayFrames = 45;
+	constexpr int32 GoalPoints = 5;
+	constexpr int32 BrickColumns = 16;
+	constexpr int32 BrickRows = 4;
+	constexpr double BrickWidth = 60.0;
+	constexpr double BrickHeight = 24.0;
+	constexpr uint64 AllBricks = ~0ull;
+
+	static_assert(BrickColumns * BrickRows == 64, "The brick wall is stored in one 64 bit mask");
+
+	BRICKBREAKERSCLONE_API void ResetState(FBBCVersusState& State);
+	BRICKBREAKERSCLONE_API void Step(FBBCVersusState& State, const FBBCVersusInput (&Inputs)[FBBCVersusState::NumPlayers]);
+
+	BRICKBREAKERSCLONE_API FBox2D GetPaddleBox(const FBBCVersusState& State, int32 Player);
+	BRICKBREAKERSCLONE_API FBox2D GetBrickBox(int32 Brick);
+}
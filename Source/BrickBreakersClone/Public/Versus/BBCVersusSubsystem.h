@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Versus/BBCRollbackSession.h"
+#include "Versus/BBCVersusTransport.h"
+#include "BBCVersusSubsystem.generated.h"
+
+class ABBCPaddle;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Two-paddle versus mode over rollback netcode.
+ *
+ * Both peers run in this process and talk through a loopback link with injected latency, jitter and loss:
+ * peer 0 is the local player, fed from the possessed paddle's input, and peer 1 stands in for the remote
+ * player with a simple bot. Each peer only sees the other's inputs through the link, so the match exercises
+ * prediction and rollback exactly as two machines would, and the confirmed frames of both peers are compared
+ * to catch desyncs. A desync is logged as an error and ends the match.
+ *
+ * Started by the game mode when -BBCVersus is on the command line, and advanced from the Balls phase of
+ * UBBCTickManagerSubsystem at a fixed 60 Hz. Peer 0's view of the match is drawn with instanced meshes.
+ */
+UCLASS()
+class BRICKBREAKERSCLONE_API UBBCVersusSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** True when the command line asks for a versus match instead of the single player game. */
+	static bool IsRequestedOnCommandLine();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Starts a match with the link settings and input delay from the command line. */
+	void Start(ABBCPaddle* InLocalPaddle);
+	void Start(ABBCPaddle* InLocalPaddle, const FBBCLoopbackSettings& Settings, int32 InputDelay);
+	void Stop();
+	bool IsActive() const { return Sessions[0].IsValid(); }
+
+	/** Runs the versus frames covered by DeltaTime on both peers. */
+	void Advance(float DeltaTime);
+
+	const FBBCRollbackSession* GetSession(int32 Peer) const { return Sessions[Peer].Get(); }
+	int32 GetNumDesyncs() const { return NumDesyncs; }
+	int32 GetLastCheckedFrame() const { return LastCheckedFrame; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void StepPeers();
+	FBBCVersusInput GetBotInput(const FBBCVersusState& State, int32 Player) const;
+	void CheckSync();
+	void CreateView();
+	void UpdateView();
+
+private:
+
+	TUniquePtr<FBBCRollbackSession> Sessions[FBBCVersusState::NumPlayers];
+	TSharedPtr<FBBCLoopbackTransport> Transports[FBBCVersusState::NumPlayers];
+	TWeakObjectPtr<ABBCPaddle> LocalPaddle;
+
+	double Accumulator = 0.0;
+	int32 NumDesyncs = 0;
+	int32 LastCheckedFrame = INDEX_NONE;
+	uint64 ViewBricks = 0;
+
+	UPROPERTY()
+	TObjectPtr<AActor> ViewActor;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BrickInstances;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> PaddleInstances;
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> BallInstances;
+};
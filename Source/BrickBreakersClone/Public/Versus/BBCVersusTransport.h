@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Versus/BBCVersusSimulation.h"
+
+/**
+ * Inputs sent from one peer to the other. Every packet repeats all inputs the other side has not
+ * acknowledged yet, so a lost packet is covered by the next one.
+ */
+struct FBBCVersusPacket
+{
+	static constexpr int32 MaxInputs = 16;
+
+	/** Frame of Inputs[0]. */
+	int32 FirstFrame = 0;
+	int32 NumInputs = 0;
+	/** Newest frame of the receiver's inputs the sender has received, INDEX_NONE for none. */
+	int32 AckFrame = INDEX_NONE;
+	FBBCVersusInput Inputs[MaxInputs];
+};
+
+/**
+ * Unreliable, unordered packet channel between two versus peers.
+ */
+class IBBCVersusTransport
+{
+public:
+
+	virtual ~IBBCVersusTransport() = default;
+
+	virtual void Send(const FBBCVersusPacket& Packet) = 0;
+	/** Pops one packet that has arrived. Returns false when none is waiting. */
+	virtual bool Receive(FBBCVersusPacket& OutPacket) = 0;
+};
+
+struct FBBCLoopbackSettings
+{
+	/** One way delay added to every packet. */
+	double LatencySeconds = 0.05;
+	/** Random extra delay of up to this much, which also reorders packets. */
+	double JitterSeconds = 0.0;
+	/** Fraction of packets dropped, in [0, 1]. */
+	float LossFraction = 0.f;
+	int32 Seed = 0;
+};
+
+/**
+ * In-process stand-in for a network link, used to run both versus peers in one game. Packets are held until
+ * the link clock passes their delivery time. The clock is advanced explicitly, so a run with the same
+ * settings and seed delivers the same packets on the same frames.
+ */
+class BRICKBREAKERSCLONE_API FBBCLoopbackTransport : public IBBCVersusTransport
+{
+public:
+
+	/** Creates the two ends of a link. */
+	static void CreatePair(const FBBCLoopbackSettings& Settings, TSharedPtr<FBBCLoopbackTransport>& OutA, TSharedPtr<FBBCLoopbackTransport>& OutB);
+
+	virtual void Send(const FBBCVersusPacket& Packet) override;
+	virtual bool Receive(FBBCVersusPacket& OutPacket) override;
+
+	/** Advances the clock shared by both ends. */
+	void AdvanceTime(double DeltaSeconds);
+
+private:
+
+	struct FInFlight
+	{
+		double DeliverSeconds = 0.0;
+		FBBCVersusPacket Packet;
+	};
+
+	struct FLink
+	{
+		FBBCLoopbackSettings Settings;
+		FRandomStream Random;
+		double NowSeconds = 0.0;
+		/** Packets travelling to each end. */
+		TArray<FInFlight> InFlight[2];
+	};
+
+	FBBCLoopbackTransport(const TSharedRef<FLink>& InLink, int32 InSide);
+
+	TSharedRef<FLink> Link;
+	int32 Side;
+};